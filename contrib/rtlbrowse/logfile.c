@@ -50,6 +50,7 @@ int width;
 
 JRB varnames;
 int resolved;
+int value_len;	/* longest resolved fst value, sizes the batched reads */
 };
 
 struct text_find_t
@@ -1811,6 +1812,12 @@ void bwlogbox_2(struct logfile_context_t *ctx, GtkWidget *window, GtkWidget *but
 			fstHandle fh = 0;
 			int new_scope_encountered = 1;
 			int good_scope = 0;
+			int value_len = 0;
+			fstHandle *handles = NULL;
+			char **vals = NULL;
+			char *val_mem = NULL;
+			int val_len;
+			int nvals = 0, vi = 0;
 
 			if(ctx->varnames) goto skip_resolved_fst;
 
@@ -1876,6 +1883,7 @@ void bwlogbox_2(struct logfile_context_t *ctx, GtkWidget *window, GtkWidget *but
 							if(!fst_alpha_strcmpeq(h->u.var.name, node->key.s))
 								{
 								resolved++;
+								if((int)h->u.var.length > value_len) value_len = h->u.var.length;
 								if(h->u.var.is_alias)
 									{
 									node->val.i = h->u.var.handle;
@@ -1891,6 +1899,7 @@ void bwlogbox_2(struct logfile_context_t *ctx, GtkWidget *window, GtkWidget *but
 							if(!fst_alpha_strcmpeq(h->u.var.name, node->key.s))
 								{
 								struct jrb_chain *jvc = node->jval_chain;
+								if((int)h->u.var.length > value_len) value_len = h->u.var.length;
 								if(jvc) {
 									while(jvc->next) jvc = jvc->next;
 									jvc->next = calloc(1, sizeof(struct jrb_chain));
@@ -1918,21 +1927,66 @@ void bwlogbox_2(struct logfile_context_t *ctx, GtkWidget *window, GtkWidget *but
 /* resolved_fst: */
 			ctx->varnames = varnames;
 			ctx->resolved = resolved;
+			ctx->value_len = value_len;
 skip_resolved_fst:
 			varnames = ctx->varnames;
 			resolved = ctx->resolved;
 
+			val_len = ((ctx->value_len > 32) ? ctx->value_len : 32) + 1; /* reals are formatted */
+
+			jrb_traverse(node, varnames)
+				{
+				if(node->val.i >= 0)
+					{
+					struct jrb_chain *jvc;
+
+					nvals++;
+					for(jvc = node->jval_chain; jvc; jvc = jvc->next)
+						{
+						nvals++;
+						}
+					}
+				}
+
+			if(nvals)
+				{
+				handles = malloc(nvals * sizeof(fstHandle));
+				vals = malloc(nvals * sizeof(char *));
+				val_mem = malloc(nvals * val_len);
+
+				jrb_traverse(node, varnames)
+					{
+					if(node->val.i >= 0)
+						{
+						struct jrb_chain *jvc;
+
+						handles[vi] = node->val.i;
+						vals[vi] = val_mem + (vi * val_len);
+						vi++;
+
+						for(jvc = node->jval_chain; jvc; jvc = jvc->next)
+							{
+							handles[vi] = jvc->val.i;
+							vals[vi] = val_mem + (vi * val_len);
+							vi++;
+							}
+						}
+					}
+
+				/* every annotated signal is read in a single visit to the block under the marker */
+				fstReaderGetValuesFromHandlesAtTime(fst, anno_ctx->marker, handles, vals, nvals);
+				vi = 0;
+				}
+
 			jrb_traverse(node, varnames)
 				{
 				if(node->val.i >= 0)
 					{
-					char rcb[65537];
-					char *rc;
+					char *rc = vals[vi][0] ? vals[vi] : NULL;
 					struct jrb_chain *jvc = node->jval_chain;
-					char first_char;
+					char first_char = rc ? rc[0] : '?';
 
-					rc = fstReaderGetValueFromHandleAtTime(fst, anno_ctx->marker, node->val.i, rcb);
-					first_char = rc ? rc[0] : '?';
+					vi++;
 
 					if(!jvc)
 						{
@@ -1950,11 +2004,12 @@ skip_resolved_fst:
 						char *rc2;
 						int len = rc ? strlen(rc) : 0;
 						int iter = 1;
+						int chain_vi = vi;
 
 						while(jvc)
 							{
-							fstReaderGetValueFromHandleAtTime(fst, anno_ctx->marker, jvc->val.i, rc);
-							len+= (rc ? strlen(rc) : 0); /* scan-build : possible null pointer */
+							len+= (rc ? strlen(vals[vi]) : 0);
+							vi++;
 							iter++;
 							jvc = jvc->next;
 							}
@@ -1962,16 +2017,12 @@ skip_resolved_fst:
 						if(iter==len)
 							{
 							int pos = 1;
-							jvc = node->jval_chain;
 							rc2 = calloc(1, len+1);
 							rc2[0] = first_char;
 
-							while(jvc)
+							while(chain_vi < vi)
 								{
-								char rcv[65537];
-								fstReaderGetValueFromHandleAtTime(fst, anno_ctx->marker, jvc->val.i, rcv);
-								rc2[pos++] = *rcv;
-								jvc = jvc->next;
+								rc2[pos++] = *vals[chain_vi++];
 								}
 
 							node->val2.v = hexify(strdup(rc2));
@@ -1988,6 +2039,10 @@ skip_resolved_fst:
 					node->val2.v = NULL;
 					}
 				}
+
+			free(val_mem);
+			free(vals);
+			free(handles);
 			}
 /*************************/
 		else if(vzt)
@@ -33,7 +33,7 @@
  *
  * FST_DEBUG : not for production use, only enable for development
  * FST_REMOVE_DUPLICATE_VC : glitch removal (has writer performance impact)
- * HAVE_LIBPTHREAD -> FST_WRITER_PARALLEL : enables inclusion of parallel writer code
+ * HAVE_LIBPTHREAD -> FST_WRITER_PARALLEL : enables inclusion of parallel writer and vcd output code
  * _WAVE_HAVE_JUDY : use Judy arrays instead of Jenkins (undefine if LGPL is not acceptable)
  *
  */
@@ -130,6 +130,9 @@ void **JenkinsIns(void *base_i, const unsigned char *mem, uint32_t length, uint3
 #define FST_HDR_TIMEZERO_SIZE           (8)
 #define FST_GZIO_LEN                    (32768)
 #define FST_HDR_FOURPACK_DUO_SIZE       (4*1024*1024)
+#define FST_RVAT_BLOCK_CACHE            (4)
+#define FST_WRITER_PACK_BATCH           (64)
+#define FST_WRITER_PACK_WINDOW          (65536)
 
 #if defined(__APPLE__) && defined(__MACH__)
 #define FST_MACOSX
@@ -810,6 +813,7 @@ pthread_attr_t thread_attr;
 struct fstWriterContext *xc_parent;
 #endif
 unsigned in_pthread : 1;
+unsigned int pack_threads;      /* threads used to compress value chains in a flush */
 
 size_t fst_orig_break_size;
 size_t fst_orig_break_add_size;
@@ -1262,6 +1266,318 @@ if(xc)
 }
 
 
+/*
+ * value chains are encoded right-aligned into scratchpad and then compressed;
+ * neither step touches state outside the handle's own valpos and curval
+ * entries, so several handles can be packed at once
+ */
+static unsigned char *fstWriterEncodeValueChain(struct fstWriterContext *xc, uint32_t *vm4ip, uint32_t offs, unsigned char *scratchpad)
+{
+unsigned char *vchg_mem = xc->vchg_mem;
+unsigned char *scratchpnt;
+uint32_t next_offs;
+unsigned int wrlen;
+
+scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
+if(vm4ip[1] <= 1)
+        {
+        if(vm4ip[1] == 1)
+                {
+                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
+#endif
+                while(offs)
+                        {
+                        unsigned char val;
+                        uint32_t time_delta, rcv;
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+
+                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+                        val = vchg_mem[offs+wrlen];
+                        offs = next_offs;
+
+                        switch(val)
+                                {
+                                case '0':
+                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
+                                                        break; /* pack more delta bits in for 0/1 vchs */
+
+                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
+                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
+                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
+                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
+                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
+                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
+                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
+                        }
+                }
+                else
+                {
+                /* variable length */
+                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
+                unsigned char *pnt;
+                uint32_t record_len;
+                uint32_t time_delta;
+
+                while(offs)
+                        {
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+                        pnt = vchg_mem + offs;
+                        offs = next_offs;
+                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+
+                        scratchpnt -= record_len;
+                        memcpy(scratchpnt, pnt, record_len);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
+                        }
+                }
+        }
+        else
+        {
+        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+#endif
+        while(offs)
+                {
+                unsigned int idx;
+                char is_binary = 1;
+                unsigned char *pnt;
+                uint32_t time_delta;
+
+                next_offs = fstGetUint32(vchg_mem + offs);
+                offs += 4;
+
+                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+
+                pnt = vchg_mem+offs+wrlen;
+                offs = next_offs;
+
+                for(idx=0;idx<vm4ip[1];idx++)
+                        {
+                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
+                                {
+                                continue;
+                                }
+                                else
+                                {
+                                is_binary = 0;
+                                break;
+                                }
+                        }
+
+                if(is_binary)
+                        {
+                        unsigned char acc = 0;
+                        /* new algorithm */
+                        idx = ((vm4ip[1]+7) & ~7);
+                        switch(vm4ip[1] & 7)
+                                {
+                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
+                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
+                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
+                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
+                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
+                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
+                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
+                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
+                                                *(--scratchpnt) = acc;
+                                                idx -= 8;
+                                        } while(idx);
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
+                        }
+                        else
+                        {
+                        scratchpnt -= vm4ip[1];
+                        memcpy(scratchpnt, pnt, vm4ip[1]);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
+                        }
+                }
+        }
+
+return(scratchpnt);
+}
+
+
+/*
+ * returns the bytes to store for an encoded chain: *pfx is the uncompressed
+ * length, or zero when the chain is stored as-is
+ */
+static unsigned char *fstWriterPackValueChain(struct fstWriterContext *xc, unsigned char *scratchpnt, unsigned int wrlen,
+        unsigned char **packmem, unsigned int *packmemlen, unsigned int *dlen, unsigned int *pfx)
+{
+*pfx = 0;
+*dlen = wrlen;
+
+if(wrlen > 32)
+        {
+        unsigned long destlen = wrlen;
+        unsigned char *dmem;
+        unsigned int rc;
+
+        if(!xc->fastpack)
+                {
+                if(wrlen <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = (unsigned char *)malloc(compressBound(*packmemlen = wrlen));
+                        }
+
+                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
+                if(rc == Z_OK)
+                        {
+                        *pfx = wrlen;
+                        *dlen = destlen;
+                        return(dmem);
+                        }
+                }
+                else
+                {
+                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
+                if(((wrlen * 2) + 2) <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = (unsigned char *)malloc(*packmemlen = (wrlen * 2) + 2);
+                        }
+
+                rc = (xc->fourpack) ? LZ4_compress_default((char *)scratchpnt, (char *)dmem, wrlen, *packmemlen) : fastlz_compress(scratchpnt, wrlen, dmem);
+                if(rc < destlen)
+                        {
+                        *pfx = wrlen;
+                        *dlen = rc;
+                        return(dmem);
+                        }
+                }
+        }
+
+return(scratchpnt);
+}
+
+
+#ifdef FST_WRITER_PARALLEL
+struct fstWriterPackedChain
+{
+unsigned char *mem;
+unsigned int len;
+unsigned int wrlen;
+unsigned int pfx;
+};
+
+struct fstWriterPackJob
+{
+struct fstWriterContext *xc;
+struct fstWriterPackedChain *chains;    /* indexed by handle - base */
+unsigned int base;
+unsigned int end;
+unsigned int next;                      /* next handle to claim, under mutex */
+pthread_mutex_t mutex;
+};
+
+
+static void *fstWriterPackValueChainsWorker(void *arg)
+{
+struct fstWriterPackJob *job = (struct fstWriterPackJob *)arg;
+struct fstWriterContext *xc = job->xc;
+unsigned char *scratchpad = (unsigned char *)malloc(xc->vchg_siz);
+unsigned int packmemlen = 1024;
+unsigned char *packmem = (unsigned char *)malloc(packmemlen);
+
+for(;;)
+        {
+        unsigned int i, iend;
+
+        pthread_mutex_lock(&job->mutex);
+        i = job->next;
+        iend = job->next = ((job->end - i) > FST_WRITER_PACK_BATCH) ? (i + FST_WRITER_PACK_BATCH) : job->end;
+        pthread_mutex_unlock(&job->mutex);
+
+        if(i == iend) break;
+
+        for(;i<iend;i++)
+                {
+                uint32_t *vm4ip = &(xc->valpos_mem[4*i]);
+
+                if(vm4ip[2])
+                        {
+                        struct fstWriterPackedChain *pc = job->chains + (i - job->base);
+                        unsigned char *scratchpnt = fstWriterEncodeValueChain(xc, vm4ip, vm4ip[2], scratchpad);
+                        unsigned char *dmem;
+
+                        pc->wrlen = scratchpad + xc->vchg_siz - scratchpnt;
+                        dmem = fstWriterPackValueChain(xc, scratchpnt, pc->wrlen, &packmem, &packmemlen, &pc->len, &pc->pfx);
+                        pc->mem = (unsigned char *)malloc(pc->len);
+                        memcpy(pc->mem, dmem, pc->len);
+                        }
+                }
+        }
+
+free(packmem);
+free(scratchpad);
+return(NULL);
+}
+
+
+/*
+ * packs the chains of the next FST_WRITER_PACK_WINDOW handles starting at
+ * base on xc->pack_threads threads, returns the end of the window
+ */
+static unsigned int fstWriterPackValueChainsParallel(struct fstWriterContext *xc, struct fstWriterPackedChain *chains, unsigned int base)
+{
+struct fstWriterPackJob job;
+pthread_t *threads = (pthread_t *)malloc((xc->pack_threads - 1) * sizeof(pthread_t));
+unsigned int t, started = 0;
+
+job.xc = xc;
+job.chains = chains;
+job.base = job.next = base;
+job.end = ((xc->maxhandle - base) > FST_WRITER_PACK_WINDOW) ? (base + FST_WRITER_PACK_WINDOW) : xc->maxhandle;
+pthread_mutex_init(&job.mutex, NULL);
+
+for(t=1;t<xc->pack_threads;t++)
+        {
+        if(!pthread_create(&threads[started], NULL, fstWriterPackValueChainsWorker, &job))
+                {
+                started++;
+                }
+        }
+
+fstWriterPackValueChainsWorker(&job);
+
+for(t=0;t<started;t++)
+        {
+        pthread_join(threads[t], NULL);
+        }
+
+pthread_mutex_destroy(&job.mutex);
+free(threads);
+
+return(job.end);
+}
+#endif
+
+
 /*
  * only to be called directly by fst code...otherwise must
  * be synced up with time changes
@@ -1276,7 +1592,6 @@ static void fstWriterFlushContextPrivate(void *ctx)
 int cnt = 0;
 #endif
 unsigned int i;
-unsigned char *vchg_mem;
 FILE *f;
 fst_off_t fpos, indxpos, endpos;
 uint32_t prevpos;
@@ -1291,6 +1606,8 @@ unsigned int packmemlen;
 uint32_t *vm4ip;
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
 #ifdef FST_WRITER_PARALLEL
+struct fstWriterPackedChain *chains = NULL;
+unsigned int chains_base = 0, chains_end = 0;
 struct fstWriterContext *xc2 = xc->xc_parent;
 #else
 struct fstWriterContext *xc2 = xc;
@@ -1314,8 +1631,6 @@ xc->already_in_flush = 1; /* should really do this with a semaphore */
 xc->section_header_only = 0;
 scratchpad = (unsigned char *)malloc(xc->vchg_siz);
 
-vchg_mem = xc->vchg_mem;
-
 f = xc->handle;
 fstWriterVarint(f, xc->maxhandle);      /* emit current number of handles */
 fputc(xc->fourpack ? '4' : (xc->fastpack ? 'F' : 'Z'), f);
@@ -1324,337 +1639,133 @@ fpos = 1;
 packmemlen = 1024;                      /* maintain a running "longest" allocation to */
 packmem = (unsigned char *)malloc(packmemlen);           /* prevent continual malloc...free every loop iter */
 
+#ifdef FST_WRITER_PARALLEL
+if((xc->pack_threads > 1) && (xc->maxhandle > FST_WRITER_PACK_BATCH))
+        {
+        chains = (struct fstWriterPackedChain *)calloc(FST_WRITER_PACK_WINDOW, sizeof(struct fstWriterPackedChain));
+        }
+#endif
+
 for(i=0;i<xc->maxhandle;i++)
         {
         vm4ip = &(xc->valpos_mem[4*i]);
 
-        if(vm4ip[2])
+#ifdef FST_WRITER_PARALLEL
+        if(chains && (i == chains_end))
                 {
-                uint32_t offs = vm4ip[2];
-                uint32_t next_offs;
-                unsigned int wrlen;
-
-                vm4ip[2] = fpos;
+                chains_base = i;
+                chains_end = fstWriterPackValueChainsParallel(xc, chains, chains_base);
+                }
+#endif
 
-                scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
-                if(vm4ip[1] <= 1)
-                        {
-                        if(vm4ip[1] == 1)
-                                {
-                                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
+        if(vm4ip[2])
+                {
+                unsigned char *dmem;
+                unsigned int wrlen, dlen, pfx;
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+                PPvoid_t pv;
 #endif
-                                while(offs)
-                                        {
-                                        unsigned char val;
-                                        uint32_t time_delta, rcv;
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
 
-                                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-                                        val = vchg_mem[offs+wrlen];
-                                        offs = next_offs;
+#ifdef FST_WRITER_PARALLEL
+                if(chains)
+                        {
+                        struct fstWriterPackedChain *pc = chains + (i - chains_base);
 
-                                        switch(val)
-                                                {
-                                                case '0':
-                                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
-                                                                        break; /* pack more delta bits in for 0/1 vchs */
-
-                                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
-                                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
-                                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
-                                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
-                                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
-                                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
-                                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
-                                                }
+                        dmem = pc->mem;
+                        dlen = pc->len;
+                        wrlen = pc->wrlen;
+                        pfx = pc->pfx;
+                        }
+                        else
+#endif
+                        {
+                        scratchpnt = fstWriterEncodeValueChain(xc, vm4ip, vm4ip[2], scratchpad);
+                        wrlen = scratchpad + xc->vchg_siz - scratchpnt;
+                        dmem = fstWriterPackValueChain(xc, scratchpnt, wrlen, &packmem, &packmemlen, &dlen, &pfx);
+                        }
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
-                                        }
-                                }
-                                else
-                                {
-                                /* variable length */
-                                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
-                                unsigned char *pnt;
-                                uint32_t record_len;
-                                uint32_t time_delta;
+                vm4ip[2] = fpos;
+                unc_memreq += wrlen;
 
-                                while(offs)
-                                        {
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-                                        pnt = vchg_mem + offs;
-                                        offs = next_offs;
-                                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-                                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-
-                                        scratchpnt -= record_len;
-                                        memcpy(scratchpnt, pnt, record_len);
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
-                                        }
-                                }
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+                pv = JudyHSIns(&PJHSArray, dmem, dlen, NULL);
+                if(*pv)
+                        {
+                        uint32_t pvi = (intptr_t)(*pv);
+                        vm4ip[2] = -pvi;
                         }
                         else
                         {
-                        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+                        *pv = (void *)(intptr_t)(i+1);
 #endif
-                        while(offs)
-                                {
-                                unsigned int idx;
-                                char is_binary = 1;
-                                unsigned char *pnt;
-                                uint32_t time_delta;
+                        fpos += fstWriterVarint(f, pfx);
+                        fpos += dlen;
+                        fstFwrite(dmem, dlen, 1, f);
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+                        }
+#endif
+
+#ifdef FST_WRITER_PARALLEL
+                if(chains)
+                        {
+                        free(dmem);
+                        chains[i - chains_base].mem = NULL;
+                        }
+#endif
+
+                /* vm4ip[3] = 0; ...redundant with clearing below */
+#ifdef FST_DEBUG
+                cnt++;
+#endif
+                }
+        }
 
-                                next_offs = fstGetUint32(vchg_mem + offs);
-                                offs += 4;
+#ifdef FST_WRITER_PARALLEL
+free(chains);
+#endif
 
-                                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+#ifndef FST_DYNAMIC_ALIAS_DISABLE
+JudyHSFreeArray(&PJHSArray, NULL);
+#endif
 
-                                pnt = vchg_mem+offs+wrlen;
-                                offs = next_offs;
+free(packmem); packmem = NULL; /* packmemlen = 0; */ /* scan-build */
 
-                                for(idx=0;idx<vm4ip[1];idx++)
-                                        {
-                                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
-                                                {
-                                                continue;
-                                                }
-                                                else
-                                                {
-                                                is_binary = 0;
-                                                break;
-                                                }
-                                        }
+prevpos = 0; zerocnt = 0;
+free(scratchpad); scratchpad = NULL;
 
-                                if(is_binary)
-                                        {
-                                        unsigned char acc = 0;
-                                        /* new algorithm */
-                                        idx = ((vm4ip[1]+7) & ~7);
-                                        switch(vm4ip[1] & 7)
-                                                {
-                                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0; /* fallthrough */
-                                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1; /* fallthrough */
-                                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2; /* fallthrough */
-                                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3; /* fallthrough */
-                                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4; /* fallthrough */
-                                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5; /* fallthrough */
-                                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6; /* fallthrough */
-                                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
-                                                                *(--scratchpnt) = acc;
-                                                                idx -= 8;
-                                                        } while(idx);
-                                                }
+indxpos = ftello(f);
+xc->secnum++;
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
-                                        }
-                                        else
-                                        {
-                                        scratchpnt -= vm4ip[1];
-                                        memcpy(scratchpnt, pnt, vm4ip[1]);
+#ifndef FST_DYNAMIC_ALIAS2_DISABLE
+if(1)
+        {
+        uint32_t prev_alias = 0;
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
-                                        }
-                                }
-                        }
+        for(i=0;i<xc->maxhandle;i++)
+                {
+                vm4ip = &(xc->valpos_mem[4*i]);
 
-                wrlen = scratchpad + xc->vchg_siz - scratchpnt;
-                unc_memreq += wrlen;
-                if(wrlen > 32)
+                if(vm4ip[2])
                         {
-                        unsigned long destlen = wrlen;
-                        unsigned char *dmem;
-                        unsigned int rc;
+                        if(zerocnt)
+                                {
+                                fpos += fstWriterVarint(f, (zerocnt << 1));
+                                zerocnt = 0;
+                                }
 
-                        if(!xc->fastpack)
+                        if(vm4ip[2] & 0x80000000)
                                 {
-                                if(wrlen <= packmemlen)
+                                if(vm4ip[2] != prev_alias)
                                         {
-                                        dmem = packmem;
+					int32_t  t_i32 = ((int32_t)(prev_alias = vm4ip[2])); /* vm4ip is generic unsigned data */
+					int64_t  t_i64 = (int64_t)t_i32; /* convert to signed */
+					uint64_t t_u64 = (uint64_t)t_i64; /* sign extend through 64b */
+
+					fpos += fstWriterSVarint(f, (int64_t)((t_u64 << 1) | 1)); /* all in this block was: fpos += fstWriterSVarint(f, (((int64_t)((int32_t)(prev_alias = vm4ip[2]))) << 1) | 1); */
                                         }
                                         else
                                         {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(compressBound(packmemlen = wrlen));
-                                        }
-
-                                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
-                                if(rc == Z_OK)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, destlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += destlen;
-                                                fstFwrite(dmem, destlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                                else
-                                {
-                                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
-                                if(((wrlen * 2) + 2) <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = (unsigned char *)malloc(packmemlen = (wrlen * 2) + 2);
-                                        }
-
-                                rc = (xc->fourpack) ? LZ4_compress_default((char *)scratchpnt, (char *)dmem, wrlen, packmemlen) : fastlz_compress(scratchpnt, wrlen, dmem);
-                                if(rc < destlen)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, rc, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += rc;
-                                                fstFwrite(dmem, rc, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                        }
-                        else
-                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                        if(*pv)
-                                {
-                                uint32_t pvi = (intptr_t)(*pv);
-                                vm4ip[2] = -pvi;
-                                }
-                                else
-                                {
-                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                fpos += fstWriterVarint(f, 0);
-                                fpos += wrlen;
-                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                }
-#endif
-                        }
-
-                /* vm4ip[3] = 0; ...redundant with clearing below */
-#ifdef FST_DEBUG
-                cnt++;
-#endif
-                }
-        }
-
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-JudyHSFreeArray(&PJHSArray, NULL);
-#endif
-
-free(packmem); packmem = NULL; /* packmemlen = 0; */ /* scan-build */
-
-prevpos = 0; zerocnt = 0;
-free(scratchpad); scratchpad = NULL;
-
-indxpos = ftello(f);
-xc->secnum++;
-
-#ifndef FST_DYNAMIC_ALIAS2_DISABLE
-if(1)
-        {
-        uint32_t prev_alias = 0;
-
-        for(i=0;i<xc->maxhandle;i++)
-                {
-                vm4ip = &(xc->valpos_mem[4*i]);
-
-                if(vm4ip[2])
-                        {
-                        if(zerocnt)
-                                {
-                                fpos += fstWriterVarint(f, (zerocnt << 1));
-                                zerocnt = 0;
-                                }
-
-                        if(vm4ip[2] & 0x80000000)
-                                {
-                                if(vm4ip[2] != prev_alias)
-                                        {
-					int32_t  t_i32 = ((int32_t)(prev_alias = vm4ip[2])); /* vm4ip is generic unsigned data */
-					int64_t  t_i64 = (int64_t)t_i32; /* convert to signed */
-					uint64_t t_u64 = (uint64_t)t_i64; /* sign extend through 64b */
-
-					fpos += fstWriterSVarint(f, (int64_t)((t_u64 << 1) | 1)); /* all in this block was: fpos += fstWriterSVarint(f, (((int64_t)((int32_t)(prev_alias = vm4ip[2]))) << 1) | 1); */
-                                        }
-                                        else
-                                        {
-                                        fpos += fstWriterSVarint(f, (0 << 1) | 1);
+                                        fpos += fstWriterSVarint(f, (0 << 1) | 1);
                                         }
                                 }
                                 else
@@ -1836,8 +1947,12 @@ if(xc->parallel_enabled)
         struct fstWriterContext *xc2 = (struct fstWriterContext *)malloc(sizeof(struct fstWriterContext));
         unsigned int i;
 
-        pthread_mutex_lock(&xc->mutex);
-        pthread_mutex_unlock(&xc->mutex);
+        /* the previous flush thread may not hold the mutex yet: wait until it is done with section_start */
+        while (xc->in_pthread)
+                {
+                pthread_mutex_lock(&xc->mutex);
+                pthread_mutex_unlock(&xc->mutex);
+                }
 
         xc->xc_parent = xc;
         memcpy(xc2, xc, sizeof(struct fstWriterContext));
@@ -1931,8 +2046,10 @@ struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
 #ifdef FST_WRITER_PARALLEL
 if(xc)
         {
-        pthread_mutex_lock(&xc->mutex);
-        pthread_mutex_unlock(&xc->mutex);
+        do      {
+                pthread_mutex_lock(&xc->mutex);
+                pthread_mutex_unlock(&xc->mutex);
+                } while(xc->in_pthread);
         }
 #endif
 
@@ -2576,6 +2693,25 @@ if(xc)
 }
 
 
+/*
+ * value chains of a block are compressed on this many threads, which can
+ * be combined with fstWriterSetParallelMode(); ignored without pthreads
+ */
+void fstWriterSetPackThreads(void *ctx, int count)
+{
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+if(xc)
+        {
+#ifdef FST_WRITER_PARALLEL
+        xc->pack_threads = (count > 1) ? count : 1;
+#else
+        (void)count;
+        xc->pack_threads = 1;
+#endif
+        }
+}
+
+
 void fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes)
 {
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
@@ -3333,11 +3469,59 @@ int len;
 };
 
 
+/*
+ * value-at-time reads keep an index of where each value change block lives
+ * and a small lru of decompressed blocks, so moving a marker back and forth
+ * neither walks the section chain nor re-inflates the block it lands in.
+ */
+struct fstRvatIndexEntry
+{
+uint64_t beg_tim, end_tim;
+fst_off_t blkpos;                       /* points past the section type byte */
+uint64_t seclen;
+int sectype;
+};
+
+struct fstRvatChain
+{
+unsigned char *mem;
+uint32_t len;
+
+uint32_t pos_tidx;
+uint32_t pos_idx;
+uint64_t pos_time;
+unsigned pos_valid : 1;
+};
+
+struct fstRvatBlock
+{
+unsigned valid : 1;
+uint64_t index;                         /* into rvat_index */
+uint64_t lru_stamp;
+
+uint64_t *time_table;
+uint64_t tsec_nitems;
+uint64_t beg_tim, end_tim;
+unsigned char *frame_data;
+uint64_t frame_uclen;
+uint64_t frame_maxhandle;
+fst_off_t *chain_table;
+uint32_t *chain_table_lengths;
+uint64_t vc_maxhandle;
+fst_off_t vc_start;
+int packtype;
+
+struct fstRvatChain *chains;            /* vc_maxhandle sized, decompressed on demand */
+};
+
+
 struct fstReaderContext
 {
 /* common entries */
 
 FILE *f, *fh;
+unsigned char *fmap;                    /* read-only mapping of f, see fstReaderSetMmapMode() */
+uint64_t fmap_len;
 
 uint64_t start_time, end_time;
 uint64_t mem_used_by_writer;
@@ -3378,28 +3562,17 @@ unsigned char *blackout_activity;
 
 uint64_t limit_range_start, limit_range_end;
 
-/* entries specific to read value at time functions */
+unsigned int vcd_threads;               /* see fstReaderSetVcdThreads() */
 
-unsigned rvat_data_valid : 1;
-uint64_t *rvat_time_table;
-uint64_t rvat_beg_tim, rvat_end_tim;
-unsigned char *rvat_frame_data;
-uint64_t rvat_frame_maxhandle;
-fst_off_t *rvat_chain_table;
-uint32_t *rvat_chain_table_lengths;
-uint64_t rvat_vc_maxhandle;
-fst_off_t rvat_vc_start;
-uint32_t *rvat_sig_offs;
-int rvat_packtype;
+/* entries specific to read value at time functions */
 
-uint32_t rvat_chain_len;
-unsigned char *rvat_chain_mem;
-fstHandle rvat_chain_facidx;
+struct fstRvatIndexEntry *rvat_index;   /* one entry per value change block, in file order */
+uint64_t rvat_index_count;
+unsigned rvat_index_valid : 1;
 
-uint32_t rvat_chain_pos_tidx;
-uint32_t rvat_chain_pos_idx;
-uint64_t rvat_chain_pos_time;
-unsigned rvat_chain_pos_valid : 1;
+struct fstRvatBlock rvat_blocks[FST_RVAT_BLOCK_CACHE];
+uint64_t rvat_lru_stamp;
+uint32_t *rvat_sig_offs;
 
 /* entries specific to hierarchy traversal */
 
@@ -3872,6 +4045,28 @@ if(xc)
 }
 
 
+/*
+ * splits the vcd output of fstReaderIterBlocks() (fv set, no callbacks) over
+ * count threads which format whole value change blocks, the output stays
+ * identical to the single threaded one.  without FST_WRITER_PARALLEL the
+ * count is ignored.
+ */
+void fstReaderSetVcdThreads(void *ctx, int count)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+
+if(xc)
+        {
+#ifdef FST_WRITER_PARALLEL
+        xc->vcd_threads = (count > 1) ? count : 1;
+#else
+        (void)count;
+        xc->vcd_threads = 1;
+#endif
+        }
+}
+
+
 void fstReaderIterBlocksSetNativeDoublesOnCallback(void *ctx, int enable)
 {
 struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
@@ -3881,6 +4076,80 @@ if(xc)
         }
 }
 
+
+/*
+ * maps the (unpacked) file read-only so that value change blocks are
+ * decompressed straight out of the mapping and uncompressed data is used in
+ * place.  headers are still read through stdio.  returns nonzero when the
+ * mapping is active, on failure reads silently stay on stdio.
+ */
+int fstReaderSetMmapMode(void *ctx, int enable)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+
+if(!xc)
+        {
+        return(0);
+        }
+
+if(xc->fmap && !enable)
+        {
+        fstMunmap(xc->fmap, xc->fmap_len);
+        xc->fmap = NULL;
+        xc->fmap_len = 0;
+        }
+
+#ifndef __MINGW32__
+if(!xc->fmap && enable && xc->f && (fileno(xc->f) >= 0))     /* repacked traces are streams without a descriptor */
+        {
+        fst_off_t pos = ftello(xc->f);
+        fst_off_t len;
+
+        fstReaderFseeko(xc, xc->f, 0, SEEK_END);
+        len = ftello(xc->f);
+        fstReaderFseeko(xc, xc->f, pos, SEEK_SET);
+
+        if((len > 0) && ((uint64_t)len == (uint64_t)(size_t)len))
+                {
+                void *m = fstMmap(NULL, (size_t)len, PROT_READ, MAP_SHARED, fileno(xc->f), 0);
+
+                if(m != MAP_FAILED)
+                        {
+                        xc->fmap = (unsigned char *)m;
+                        xc->fmap_len = len;
+                        }
+                }
+        }
+#endif
+
+return(xc->fmap != NULL);
+}
+
+
+/*
+ * returns len bytes at offs.  with a mapping they are used in place and
+ * *alloc is NULL, otherwise they are read into a buffer that the caller
+ * releases with free(*alloc).  the stdio position is only defined in the
+ * latter case, so callers seek explicitly before reading on.
+ */
+static unsigned char *fstReaderFetch(struct fstReaderContext *xc, fst_off_t offs, uint64_t len, unsigned char **alloc)
+{
+if(xc->fmap && (offs >= 0) && ((uint64_t)offs <= xc->fmap_len) && (len <= (xc->fmap_len - (uint64_t)offs)))
+        {
+        *alloc = NULL;
+        return(xc->fmap + offs);
+        }
+
+*alloc = (unsigned char *)malloc(len);
+if(*alloc)
+        {
+        fstReaderFseeko(xc, xc->f, offs, SEEK_SET);
+        fstFread(*alloc, len, 1, xc->f);
+        }
+
+return(*alloc);
+}
+
 /*
  * hierarchy processing
  */
@@ -3915,6 +4184,52 @@ return(pnt - buf);
 }
 
 
+/*
+ * gzread() needs a descriptor, so streams without one (repacked traces) are
+ * inflated directly from stdio
+ */
+static int fstReaderGunzipStream(FILE *src, FILE *dst, uint64_t uclen)
+{
+z_stream strm;
+unsigned char *ibuf = (unsigned char *)malloc(FST_GZIO_LEN);
+unsigned char *obuf = (unsigned char *)malloc(FST_GZIO_LEN);
+uint64_t done = 0;
+int ret = Z_OK;
+
+memset(&strm, 0, sizeof(z_stream));
+if(!ibuf || !obuf || (inflateInit2(&strm, 15 + 16) != Z_OK))
+        {
+        free(obuf);
+        free(ibuf);
+        return(0);
+        }
+
+while((done < uclen) && (ret == Z_OK))
+        {
+        size_t olen = ((uclen - done) > FST_GZIO_LEN) ? FST_GZIO_LEN : (uclen - done);
+
+        if(!strm.avail_in)
+                {
+                strm.avail_in = fread(ibuf, 1, FST_GZIO_LEN, src);
+                strm.next_in = ibuf;
+                if(!strm.avail_in) break;
+                }
+
+        strm.next_out = obuf;
+        strm.avail_out = olen;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        olen -= strm.avail_out;
+        if(olen && (fstFwrite(obuf, olen, 1, dst) != 1)) break;
+        done += olen;
+        }
+
+inflateEnd(&strm);
+free(obuf);
+free(ibuf);
+return(done == uclen);
+}
+
+
 static int fstReaderRecreateHierFile(struct fstReaderContext *xc)
 {
 int pass_status = 1;
@@ -3955,14 +4270,17 @@ if(!xc->fh)
 #ifndef __MINGW32__
                 fflush(xc->f);
 #endif
-                zfd = dup(fileno(xc->f));
-                zhandle = gzdopen(zfd, "rb");
-                if(!zhandle)
+                if(fileno(xc->f) >= 0)
                         {
-                        close(zfd);
-                        free(mem);
-                        free(fnam);
-                        return(0);
+                        zfd = dup(fileno(xc->f));
+                        zhandle = gzdopen(zfd, "rb");
+                        if(!zhandle)
+                                {
+                                close(zfd);
+                                free(mem);
+                                free(fnam);
+                                return(0);
+                                }
                         }
                 }
         else
@@ -3995,6 +4313,11 @@ if(!xc->fh)
         if(fnam) unlink(fnam);
 #endif
 
+        if((htyp == FST_BL_HIER) && !zhandle)
+                {
+                pass_status = fstReaderGunzipStream(xc->f, xc->fh, uclen);
+                }
+        else
         if(htyp == FST_BL_HIER)
                 {
                 for(hl = 0; hl < uclen; hl += FST_GZIO_LEN)
@@ -4576,2206 +4899,3892 @@ return(1);
 
 
 /*
- * reader file open/close functions
+ * repacked (whole-file gzip) traces are read through a seekable stream: one
+ * inflate pass records restart points (bit offset plus the 32K history
+ * window) every FST_ZRAN_SPAN bytes and in front of every section, and the
+ * index is cached next to the trace as <name>.zidx so later opens neither
+ * inflate nor write a .upk_ copy of the whole file.  built or loaded indexes
+ * are also kept in a small process-wide cache, so when the .zidx can't be
+ * written (read-only archives) only the first reader of a trace inflates it.
  */
-int fstReaderInit(struct fstReaderContext *xc)
+#if !defined(__MINGW32__) && ((defined(__GLIBC__) && defined(_GNU_SOURCE)) || defined(FST_MACOSX) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__))
+#define FST_HAVE_ZRAN
+#include <sys/stat.h>
+
+#define FST_ZRAN_SPAN                   (4*1024*1024)
+#define FST_ZRAN_SECTION_LEAD           (256*1024)
+#define FST_ZRAN_WINSIZE                (32768)
+#define FST_ZRAN_CHUNK                  (65536)
+#define FST_ZRAN_CACHE                  (128)   /* direct mapped chunks of unpacked data, power of two */
+#define FST_ZRAN_MAGIC                  "FSTZIDX2"
+#define FST_ZRAN_SHARED_MAX             (16)    /* unreferenced indexes kept in the process-wide cache */
+
+#if defined(FST_MACOSX)
+#define FST_ZRAN_MTIME_NSEC(sb)         ((sb)->st_mtimespec.tv_nsec)
+#else
+#define FST_ZRAN_MTIME_NSEC(sb)         ((sb)->st_mtim.tv_nsec)
+#endif
+
+struct fstZranPoint
 {
-fst_off_t blkpos = 0;
-fst_off_t endfile;
-uint64_t seclen;
-int sectype;
-uint64_t vc_section_count_actual = 0;
-int hdr_incomplete = 0;
-int hdr_seen = 0;
-int gzread_pass_status = 1;
+uint64_t out;                   /* offset in the unpacked stream */
+uint64_t in;                    /* offset of the first whole input byte in the file */
+uint32_t wlen;                  /* compressed length of win */
+int bits;                       /* bits of the preceding byte still to be consumed */
+unsigned char *win;             /* deflated 32K history window */
+};
 
-sectype = fgetc(xc->f);
-if(sectype == FST_BL_ZWRAPPER)
+struct fstZranChunk
+{
+uint64_t idx;                   /* pos / FST_ZRAN_CHUNK, UINT64_MAX when empty */
+uint32_t len;
+unsigned char *buf;
+};
+
+/* identifies the trace an index belongs to */
+struct fstZranKey
+{
+uint64_t dev;
+uint64_t ino;
+uint64_t fsize;
+uint64_t mtime;
+uint64_t mtime_nsec;
+uint64_t uclen;
+};
+
+struct fstZranShared
+{
+struct fstZranShared *next;
+struct fstZranKey key;
+struct fstZranPoint *points;
+uint64_t num_points;
+unsigned int refcount;
+};
+
+struct fstZran
+{
+FILE *f;
+uint64_t uclen;
+uint64_t pos;                   /* read position as seen through stdio */
+
+struct fstZranPoint *points;    /* owned by shared once the index is complete */
+uint64_t num_points;
+struct fstZranShared *shared;
+
+z_stream strm;
+uint64_t strm_out;              /* unpacked offset strm has reached */
+unsigned strm_valid : 1;
+
+struct fstZranChunk cache[FST_ZRAN_CACHE];
+
+unsigned char inbuf[FST_GZIO_LEN];
+unsigned char window[FST_ZRAN_WINSIZE];
+};
+
+
+static void fstZranFreePoints(struct fstZran *z)
+{
+uint64_t i;
+
+for(i=0;i<z->num_points;i++)
         {
-        FILE *fcomp;
-        fst_off_t offpnt, uclen;
-        char gz_membuf[FST_GZIO_LEN];
-        gzFile zhandle;
-        int zfd;
-        int flen = strlen(xc->filename);
-        char *hf;
-	int hf_len;
+        free(z->points[i].win);
+        }
 
-        seclen = fstReaderUint64(xc->f);
-        uclen = fstReaderUint64(xc->f);
+free(z->points);
+z->points = NULL;
+z->num_points = 0;
+}
 
-        if(!seclen) return(0); /* not finished compressing, this is a failed read */
 
-	hf_len = flen + 16 + 32 + 1;
-        hf = (char *)calloc(1, hf_len);
+static struct fstZranShared *fstZranSharedHead = NULL;
+#ifdef FST_WRITER_PARALLEL
+static pthread_mutex_t fstZranSharedMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
-        snprintf(hf, hf_len, "%s.upk_%d_%p", xc->filename, getpid(), (void *)xc);
-        fcomp = fopen(hf, "w+b");
-        if(!fcomp)
-                {
-                fcomp = tmpfile_open(&xc->f_nam);
-                free(hf); hf = NULL;
-                if(!fcomp) { tmpfile_close(&fcomp, &xc->f_nam); return(0); }
-                }
+static void fstZranSharedLock(void)
+{
+#ifdef FST_WRITER_PARALLEL
+pthread_mutex_lock(&fstZranSharedMutex);
+#endif
+}
 
-#if defined(FST_UNBUFFERED_IO)
-        setvbuf(fcomp, (char *)NULL, _IONBF, 0);   /* keeps gzip from acting weird in tandem with fopen */
+static void fstZranSharedUnlock(void)
+{
+#ifdef FST_WRITER_PARALLEL
+pthread_mutex_unlock(&fstZranSharedMutex);
 #endif
+}
 
-#ifdef __MINGW32__
-        xc->filename_unpacked = hf;
-#else
-        if(hf)
+
+static void fstZranKeyInit(struct fstZranKey *k, const struct stat *sb, uint64_t uclen)
+{
+memset(k, 0, sizeof(struct fstZranKey));
+k->dev = sb->st_dev;
+k->ino = sb->st_ino;
+k->fsize = sb->st_size;
+k->mtime = sb->st_mtime;
+k->mtime_nsec = FST_ZRAN_MTIME_NSEC(sb);
+k->uclen = uclen;
+}
+
+
+/* borrows the points of an index that an earlier reader of the same trace built */
+static int fstZranSharedFind(struct fstZran *z, const struct fstZranKey *k)
+{
+struct fstZranShared **link, *s;
+
+fstZranSharedLock();
+for(link = &fstZranSharedHead; (s = *link); link = &s->next)
+        {
+        if(!memcmp(&s->key, k, sizeof(struct fstZranKey)))
                 {
-                unlink(hf);
-                free(hf);
+                *link = s->next;                /* most recently used first */
+                s->next = fstZranSharedHead;
+                fstZranSharedHead = s;
+
+                s->refcount++;
+                z->shared = s;
+                z->points = s->points;
+                z->num_points = s->num_points;
+                break;
                 }
-#endif
+        }
+fstZranSharedUnlock();
 
-        fstReaderFseeko(xc, xc->f, 1+8+8, SEEK_SET);
-#ifndef __MINGW32__
-        fflush(xc->f);
-#endif
+return(z->shared != NULL);
+}
 
-        zfd = dup(fileno(xc->f));
-        zhandle = gzdopen(zfd, "rb");
-        if(zhandle)
+
+/* hands the points of z over to the process-wide cache */
+static void fstZranSharedAdd(struct fstZran *z, const struct fstZranKey *k)
+{
+struct fstZranShared *s = (struct fstZranShared *)calloc(1, sizeof(struct fstZranShared));
+struct fstZranShared **link;
+int unreferenced = 0;
+
+if(!s) return;                          /* z keeps its own points */
+s->key = *k;
+s->points = z->points;
+s->num_points = z->num_points;
+s->refcount = 1;
+z->shared = s;
+
+fstZranSharedLock();
+s->next = fstZranSharedHead;
+fstZranSharedHead = s;
+
+link = &fstZranSharedHead;
+while((s = *link))
+        {
+        if(!s->refcount && (++unreferenced > FST_ZRAN_SHARED_MAX))
                 {
-                for(offpnt = 0; offpnt < uclen; offpnt += FST_GZIO_LEN)
-                        {
-                        size_t this_len = ((uclen - offpnt) > FST_GZIO_LEN) ? FST_GZIO_LEN : (uclen - offpnt);
-                        size_t gzreadlen = gzread(zhandle, gz_membuf, this_len);
-                        size_t fwlen;
+                uint64_t i;
 
-                        if(gzreadlen != this_len)
-                                {
-                                gzread_pass_status = 0;
-                                break;
-                                }
-                        fwlen = fstFwrite(gz_membuf, this_len, 1, fcomp);
-                        if(fwlen != 1)
-                                {
-                                gzread_pass_status = 0;
-                                break;
-                                }
+                *link = s->next;
+                for(i=0;i<s->num_points;i++)
+                        {
+                        free(s->points[i].win);
                         }
-                gzclose(zhandle);
+                free(s->points);
+                free(s);
                 }
                 else
                 {
-                close(zfd);
+                link = &s->next;
                 }
-        fflush(fcomp);
-        fclose(xc->f);
-        xc->f = fcomp;
         }
+fstZranSharedUnlock();
+}
 
-if(gzread_pass_status)
+
+static void fstZranFree(struct fstZran *z)
+{
+int i;
+
+for(i=0;i<FST_ZRAN_CACHE;i++)
         {
-        fstReaderFseeko(xc, xc->f, 0, SEEK_END);
-        endfile = ftello(xc->f);
+        free(z->cache[i].buf);
+        }
 
-        while(blkpos < endfile)
-                {
-                fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
+if(z->shared)
+        {
+        fstZranSharedLock();
+        z->shared->refcount--;          /* the index stays cached for the next reader */
+        fstZranSharedUnlock();
+        z->points = NULL;
+        z->num_points = 0;
+        }
+fstZranFreePoints(z);
+inflateEnd(&z->strm);
+if(z->f) fclose(z->f);
+free(z);
+}
 
-                sectype = fgetc(xc->f);
-                seclen = fstReaderUint64(xc->f);
 
-                if(sectype == EOF)
-                        {
-                        break;
-                        }
+static int fstZranAddPoint(struct fstZran *z, uint64_t *max_points, unsigned char *lin, uint64_t out, uint64_t in, int bits, unsigned left)
+{
+struct fstZranPoint *p;
+uLongf clen = compressBound(FST_ZRAN_WINSIZE);
+unsigned char *win;
 
-                if((hdr_incomplete) && (!seclen))
-                        {
-                        break;
-                        }
+if(z->num_points == *max_points)
+        {
+        uint64_t nmax = *max_points ? (*max_points * 2) : 64;
 
-                if(!hdr_seen && (sectype != FST_BL_HDR))
-                        {
-                        break;
-                        }
+        p = (struct fstZranPoint *)realloc(z->points, nmax * sizeof(struct fstZranPoint));
+        if(!p) return(0);
+        z->points = p;
+        *max_points = nmax;
+        }
 
-                blkpos++;
-                if(sectype == FST_BL_HDR)
-                        {
-                        if(!hdr_seen)
-                                {
-                                int ch;
-                                double dcheck;
+/* window is circular: the oldest history starts at the write position */
+if(left) memcpy(lin, z->window + FST_ZRAN_WINSIZE - left, left);
+if(left < FST_ZRAN_WINSIZE) memcpy(lin + left, z->window, FST_ZRAN_WINSIZE - left);
 
-                                xc->start_time = fstReaderUint64(xc->f);
-                                xc->end_time = fstReaderUint64(xc->f);
+win = (unsigned char *)malloc(clen);
+if(!win) return(0);
+if(compress2(win, &clen, lin, FST_ZRAN_WINSIZE, 4) != Z_OK)
+        {
+        free(win);
+        return(0);
+        }
 
-                                hdr_incomplete = (xc->start_time == 0) && (xc->end_time == 0);
+p = z->points + z->num_points++;
+p->out = out;
+p->in = in;
+p->bits = bits;
+p->wlen = clen;
+p->win = win;
 
-                                fstFread(&dcheck, 8, 1, xc->f);
-                                xc->double_endian_match = (dcheck == FST_DOUBLE_ENDTEST);
-                                if(!xc->double_endian_match)
-                                        {
-                                        union   {
-                                                unsigned char rvs_buf[8];
-                                                double d;
-                                                } vu;
+return(1);
+}
 
-                                        unsigned char *dcheck_alias = (unsigned char *)&dcheck;
-                                        int rvs_idx;
 
-                                        for(rvs_idx=0;rvs_idx<8;rvs_idx++)
-                                                {
-                                                vu.rvs_buf[rvs_idx] = dcheck_alias[7-rvs_idx];
-                                                }
-                                        if(vu.d != FST_DOUBLE_ENDTEST)
-                                                {
-                                                break; /* either corrupt file or wrong architecture (offset +33 also functions as matchword) */
-                                                }
-                                        }
+static int fstZranBuild(struct fstZran *z, fst_off_t comp_start)
+{
+z_stream strm;
+unsigned char *lin;
+uint64_t max_points = 0;
+uint64_t totin = 0, totout = 0, last = 0;
+uint64_t sec_pos = 0;                   /* next section header in the unpacked stream */
+uint64_t sec_marked = UINT64_MAX;       /* section which already has a restart point */
+unsigned char sec_hdr[9];
+int sec_hdr_len = 0;
+int ret = Z_OK;
+int rc = 0;
 
-                                hdr_seen = 1;
+memset(&strm, 0, sizeof(z_stream));
+memset(z->window, 0, FST_ZRAN_WINSIZE);
+lin = (unsigned char *)malloc(FST_ZRAN_WINSIZE);
+if(!lin) return(0);
+if(inflateInit2(&strm, 15 + 32) != Z_OK)
+        {
+        free(lin);
+        return(0);
+        }
 
-                                xc->mem_used_by_writer = fstReaderUint64(xc->f);
-                                xc->scope_count = fstReaderUint64(xc->f);
-                                xc->var_count = fstReaderUint64(xc->f);
-                                xc->maxhandle = fstReaderUint64(xc->f);
-                                xc->num_alias = xc->var_count - xc->maxhandle;
-                                xc->vc_section_count = fstReaderUint64(xc->f);
-                                ch = fgetc(xc->f);
-                                xc->timescale = (signed char)ch;
-                                fstFread(xc->version, FST_HDR_SIM_VERSION_SIZE, 1, xc->f);
-                                xc->version[FST_HDR_SIM_VERSION_SIZE] = 0;
-                                fstFread(xc->date, FST_HDR_DATE_SIZE, 1, xc->f);
-                                xc->date[FST_HDR_DATE_SIZE] = 0;
-                                ch = fgetc(xc->f);
-                                xc->filetype = (unsigned char)ch;
-                                xc->timezero = fstReaderUint64(xc->f);
-                                }
+if(fseeko(z->f, comp_start, SEEK_SET) < 0) goto bail;
+
+do      {
+        strm.avail_in = fread(z->inbuf, 1, FST_GZIO_LEN, z->f);
+        if(ferror(z->f) || !strm.avail_in) goto bail;
+        strm.next_in = z->inbuf;
+
+        do      {
+                unsigned char *chunk;
+                uint64_t chunk_out;
+
+                if(!strm.avail_out)
+                        {
+                        strm.avail_out = FST_ZRAN_WINSIZE;
+                        strm.next_out = z->window;
                         }
-                else if((sectype == FST_BL_VCDATA) || (sectype == FST_BL_VCDATA_DYN_ALIAS) || (sectype == FST_BL_VCDATA_DYN_ALIAS2))
+
+                chunk = strm.next_out;
+                chunk_out = totout;
+                totin += strm.avail_in;
+                totout += strm.avail_out;
+                ret = inflate(&strm, Z_BLOCK);
+                totin -= strm.avail_in;
+                totout -= strm.avail_out;
+
+                if((ret == Z_NEED_DICT) || (ret == Z_MEM_ERROR) || (ret == Z_DATA_ERROR)) goto bail;
+
+                /* follow the section chain so every section gets a nearby restart point */
+                while((sec_pos != UINT64_MAX) && ((sec_pos + sec_hdr_len) < totout))
                         {
-                        if(hdr_incomplete)
+                        sec_hdr[sec_hdr_len] = chunk[sec_pos + sec_hdr_len - chunk_out];
+                        if(++sec_hdr_len == 9)
                                 {
-                                uint64_t bt = fstReaderUint64(xc->f);
-                                xc->end_time = fstReaderUint64(xc->f);
+                                uint64_t seclen = 0;
+                                int i;
 
-                                if(!vc_section_count_actual) { xc->start_time = bt; }
-                                }
+                                for(i=1;i<9;i++)
+                                        {
+                                        seclen = (seclen << 8) | sec_hdr[i];
+                                        }
 
-                        vc_section_count_actual++;
+                                sec_pos = (seclen && (sec_pos + 1 + seclen <= z->uclen)) ? (sec_pos + 1 + seclen) : UINT64_MAX;
+                                sec_hdr_len = 0;
+                                }
                         }
-                else if(sectype == FST_BL_GEOM)
+
+                if(ret == Z_STREAM_END) break;
+
+                if((strm.data_type & 128) && !(strm.data_type & 64))
                         {
-                        if(!hdr_incomplete)
+                        int near_sec = (sec_pos != UINT64_MAX) && (sec_pos != sec_marked) && !sec_hdr_len &&
+                                        (sec_pos >= totout) && ((sec_pos - totout) <= FST_ZRAN_SECTION_LEAD);
+
+                        if(!totout || ((totout - last) >= FST_ZRAN_SPAN) || (near_sec && ((totout - last) >= FST_ZRAN_SECTION_LEAD)))
                                 {
-                                uint64_t clen = seclen - 24;
-                                uint64_t uclen = fstReaderUint64(xc->f);
-                                unsigned char *ucdata = (unsigned char *)malloc(uclen);
-                                unsigned char *pnt = ucdata;
-                                unsigned int i;
+                                if(!fstZranAddPoint(z, &max_points, lin, totout, comp_start + totin, strm.data_type & 7, strm.avail_out)) goto bail;
+                                last = totout;
+                                if(near_sec) sec_marked = sec_pos;
+                                }
+                        }
+                } while(strm.avail_in);
+        } while(ret != Z_STREAM_END);
 
-                                xc->contains_geom_section = 1;
-                                xc->maxhandle = fstReaderUint64(xc->f);
-                                xc->longest_signal_value_len = 32; /* arbitrarily set at 32...this is much longer than an expanded double */
+rc = (totout == z->uclen) && z->num_points && !z->points[0].out;
 
-                                free(xc->process_mask);
-                                xc->process_mask = (unsigned char *)calloc(1, (xc->maxhandle+7)/8);
+bail:
+inflateEnd(&strm);
+free(lin);
+return(rc);
+}
 
-                                if(clen != uclen)
-                                        {
-                                        unsigned char *cdata = (unsigned char *)malloc(clen);
-                                        unsigned long destlen = uclen;
-                                        unsigned long sourcelen = clen;
-                                        int rc;
 
-                                        fstFread(cdata, clen, 1, xc->f);
-                                        rc = uncompress(ucdata, &destlen, cdata, sourcelen);
+static uLong fstZranPointCrc(uLong crc, const struct fstZranPoint *p)
+{
+uint64_t v[4];
+unsigned char buf[32];
+int i, j;
 
-                                        if(rc != Z_OK)
-                                                {
-                                                fprintf(stderr, FST_APIMESS "fstReaderInit(), geom uncompress rc = %d, exiting.\n", rc);
-                                                exit(255);
-                                                }
+v[0] = p->out; v[1] = p->in; v[2] = p->bits; v[3] = p->wlen;
+for(i=0;i<4;i++)
+        {
+        for(j=0;j<8;j++)
+                {
+                buf[i*8 + j] = (unsigned char)(v[i] >> (56 - j*8));
+                }
+        }
 
-                                        free(cdata);
-                                        }
-                                        else
-                                        {
-                                        fstFread(ucdata, uclen, 1, xc->f);
-                                        }
-
-                                free(xc->signal_lens);
-                                xc->signal_lens = (uint32_t *)malloc(sizeof(uint32_t) * xc->maxhandle);
-                                free(xc->signal_typs);
-                                xc->signal_typs = (unsigned char *)malloc(sizeof(unsigned char) * xc->maxhandle);
-
-                                for(i=0;i<xc->maxhandle;i++)
-                                        {
-                                        int skiplen;
-                                        uint64_t val = fstGetVarint32(pnt, &skiplen);
-
-                                        pnt += skiplen;
+crc = crc32(crc, buf, 32);
+return(crc32(crc, p->win, p->wlen));
+}
 
-                                        if(val)
-                                                {
-                                                xc->signal_lens[i] = (val != 0xFFFFFFFF) ? val : 0;
-                                                xc->signal_typs[i] = FST_VT_VCD_WIRE;
-                                                if(xc->signal_lens[i] > xc->longest_signal_value_len)
-                                                        {
-                                                        xc->longest_signal_value_len = xc->signal_lens[i];
-                                                        }
-                                                }
-                                                else
-                                                {
-                                                xc->signal_lens[i] = 8; /* backpatch in real */
-                                                xc->signal_typs[i] = FST_VT_VCD_REAL;
-                                                /* xc->longest_signal_value_len handled above by overly large init size */
-                                                }
-                                        }
 
-                                free(xc->temp_signal_value_buf);
-                                xc->temp_signal_value_buf = (unsigned char *)malloc(xc->longest_signal_value_len + 1);
+static int fstZranLoadIndex(struct fstZran *z, const char *nam, const struct fstZranKey *k)
+{
+uint64_t fsize = k->fsize;
+FILE *f = fopen(nam, "rb");
+char magic[8];
+uint64_t i, cnt;
+uLong crc = crc32(0L, Z_NULL, 0);
+int rc = 0;
 
-                                free(ucdata);
-                                }
-                        }
-                else if(sectype == FST_BL_HIER)
-                        {
-                        xc->contains_hier_section = 1;
-                        xc->hier_pos = ftello(xc->f);
-                        }
-                else if(sectype == FST_BL_HIER_LZ4DUO)
-                        {
-                        xc->contains_hier_section_lz4    = 1;
-                        xc->contains_hier_section_lz4duo = 1;
-                        xc->hier_pos = ftello(xc->f);
-                        }
-                else if(sectype == FST_BL_HIER_LZ4)
-                        {
-                        xc->contains_hier_section_lz4 = 1;
-                        xc->hier_pos = ftello(xc->f);
-                        }
-                else if(sectype == FST_BL_BLACKOUT)
-                        {
-                        uint32_t i;
-                        uint64_t cur_bl = 0;
-                        uint64_t delta;
+if(!f) return(0);
 
-                        xc->num_blackouts = fstReaderVarint32(xc->f);
-                        free(xc->blackout_times);
-                        xc->blackout_times = (uint64_t *)calloc(xc->num_blackouts, sizeof(uint64_t));
-                        free(xc->blackout_activity);
-                        xc->blackout_activity = (unsigned char *)calloc(xc->num_blackouts, sizeof(unsigned char));
+if((fread(magic, 8, 1, f) != 1) || memcmp(magic, FST_ZRAN_MAGIC, 8)) goto bail;
+if(fstReaderUint64(f) != fsize) goto bail;
+if(fstReaderUint64(f) != k->mtime) goto bail;
+if(fstReaderUint64(f) != k->mtime_nsec) goto bail;
+if(fstReaderUint64(f) != k->ino) goto bail;
+if(fstReaderUint64(f) != z->uclen) goto bail;
+cnt = fstReaderUint64(f);
+if(feof(f) || !cnt || (cnt > (fsize / 2) + 1)) goto bail;
 
-                        for(i=0;i<xc->num_blackouts;i++)
-                                {
-                                xc->blackout_activity[i] = fgetc(xc->f) != 0;
-                                delta = fstReaderVarint64(xc->f);
-                                cur_bl += delta;
-                                xc->blackout_times[i] = cur_bl;
-                                }
-                        }
+z->points = (struct fstZranPoint *)calloc(cnt, sizeof(struct fstZranPoint));
+if(!z->points) goto bail;
 
-                blkpos += seclen;
-                if(!hdr_seen) break;
-                }
+for(i=0;i<cnt;i++)
+        {
+        struct fstZranPoint *p = z->points + i;
 
-        if(hdr_seen)
+        p->out = fstReaderUint64(f);
+        p->in = fstReaderUint64(f);
+        p->bits = (int)fstReaderUint64(f);
+        p->wlen = (uint32_t)fstReaderUint64(f);
+        if(feof(f) || (p->bits > 7) || (p->in > fsize) || (p->out >= z->uclen) ||
+                (i ? (p->out <= p[-1].out) : (p->out != 0)) || !p->wlen || (p->wlen > compressBound(FST_ZRAN_WINSIZE)))
                 {
-                if(xc->vc_section_count != vc_section_count_actual)
-                        {
-                        xc->vc_section_count = vc_section_count_actual;
-                        }
-
-                if(!xc->contains_geom_section)
-                        {
-                        fstReaderProcessHier(xc, NULL); /* recreate signal_lens/signal_typs info */
-                        }
+                goto bail;
                 }
+
+        p->win = (unsigned char *)malloc(p->wlen);
+        if(!p->win) goto bail;
+        z->num_points = i + 1;
+        if(fread(p->win, p->wlen, 1, f) != 1) goto bail;
+        crc = fstZranPointCrc(crc, p);
         }
 
-return(hdr_seen);
+rc = (fstReaderUint64(f) == crc) && !feof(f);
+
+bail:
+fclose(f);
+if(!rc) fstZranFreePoints(z);
+return(rc);
 }
 
 
-void *fstReaderOpenForUtilitiesOnly(void)
+static void fstZranSaveIndex(struct fstZran *z, const char *nam, const struct fstZranKey *k)
 {
-struct fstReaderContext *xc = (struct fstReaderContext *)calloc(1, sizeof(struct fstReaderContext));
+int tnam_len = strlen(nam) + 16 + 1;
+char *tnam = (char *)malloc(tnam_len);
+FILE *f;
+uint64_t i;
+uLong crc = crc32(0L, Z_NULL, 0);
+int ok;
 
-return(xc);
-}
+if(!tnam) return;
+snprintf(tnam, tnam_len, "%s.tmp_%d", nam, getpid());
+f = fopen(tnam, "wb");
+if(!f)
+        {
+        free(tnam);
+        return;     /* read-only directory: the index only lives in the process-wide cache */
+        }
 
+fstFwrite(FST_ZRAN_MAGIC, 8, 1, f);
+fstWriterUint64(f, k->fsize);
+fstWriterUint64(f, k->mtime);
+fstWriterUint64(f, k->mtime_nsec);
+fstWriterUint64(f, k->ino);
+fstWriterUint64(f, z->uclen);
+fstWriterUint64(f, z->num_points);
+for(i=0;i<z->num_points;i++)
+        {
+        struct fstZranPoint *p = z->points + i;
 
-void *fstReaderOpen(const char *nam)
-{
-struct fstReaderContext *xc = (struct fstReaderContext *)calloc(1, sizeof(struct fstReaderContext));
+        fstWriterUint64(f, p->out);
+        fstWriterUint64(f, p->in);
+        fstWriterUint64(f, p->bits);
+        fstWriterUint64(f, p->wlen);
+        fstFwrite(p->win, p->wlen, 1, f);
+        crc = fstZranPointCrc(crc, p);
+        }
+fstWriterUint64(f, crc);
 
-if((!nam)||(!(xc->f=fopen(nam, "rb"))))
+ok = !ferror(f);
+ok = !fclose(f) && ok;
+if(!ok || rename(tnam, nam))
         {
-        free(xc);
-        xc=NULL;
+        unlink(tnam);
         }
-        else
-        {
-        int flen = strlen(nam);
-        char *hf = (char *)calloc(1, flen + 6);
-        int rc;
 
-#if defined(FST_UNBUFFERED_IO)
-        setvbuf(xc->f, (char *)NULL, _IONBF, 0);   /* keeps gzip from acting weird in tandem with fopen */
-#endif
+free(tnam);
+}
 
-        memcpy(hf, nam, flen);
-        strcpy(hf + flen, ".hier");
-        xc->fh = fopen(hf, "rb");
 
-        free(hf);
-        xc->filename = strdup(nam);
-        rc = fstReaderInit(xc);
+static int fstZranRestart(struct fstZran *z, const struct fstZranPoint *p)
+{
+uLongf wlen = FST_ZRAN_WINSIZE;
 
-        if((rc) && (xc->vc_section_count) && (xc->maxhandle) && ((xc->fh)||(xc->contains_hier_section||(xc->contains_hier_section_lz4))))
-                {
-                /* more init */
-                xc->do_rewind = 1;
-                }
-                else
-                {
-                fstReaderClose(xc);
-                xc = NULL;
-                }
+z->strm_valid = 0;
+if(inflateReset(&z->strm) != Z_OK) return(0);
+if(fseeko(z->f, p->in - (p->bits ? 1 : 0), SEEK_SET) < 0) return(0);
+if(p->bits)
+        {
+        int ch = getc(z->f);
+
+        if(ch == EOF) return(0);
+        if(inflatePrime(&z->strm, p->bits, ch >> (8 - p->bits)) != Z_OK) return(0);
         }
 
-return(xc);
+if((uncompress(z->window, &wlen, p->win, p->wlen) != Z_OK) || (wlen != FST_ZRAN_WINSIZE)) return(0);
+if(inflateSetDictionary(&z->strm, z->window, FST_ZRAN_WINSIZE) != Z_OK) return(0);
+
+z->strm.avail_in = 0;
+z->strm_out = p->out;
+z->strm_valid = 1;
+return(1);
 }
 
 
-static void fstReaderDeallocateRvatData(void *ctx)
+static size_t fstZranInflate(struct fstZran *z, unsigned char *dst, size_t len)
 {
-struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
-if(xc)
+z->strm.next_out = dst;
+z->strm.avail_out = len;
+
+while(z->strm.avail_out)
         {
-        free(xc->rvat_chain_mem); xc->rvat_chain_mem = NULL;
-        free(xc->rvat_frame_data); xc->rvat_frame_data = NULL;
-        free(xc->rvat_time_table); xc->rvat_time_table = NULL;
-        free(xc->rvat_chain_table); xc->rvat_chain_table = NULL;
-        free(xc->rvat_chain_table_lengths); xc->rvat_chain_table_lengths = NULL;
+        if(!z->strm.avail_in)
+                {
+                z->strm.avail_in = fread(z->inbuf, 1, FST_GZIO_LEN, z->f);
+                z->strm.next_in = z->inbuf;
+                if(!z->strm.avail_in) break;
+                }
 
-        xc->rvat_data_valid = 0;
+        if(inflate(&z->strm, Z_NO_FLUSH) != Z_OK) break;
         }
+
+len -= z->strm.avail_out;
+z->strm_out += len;
+if(z->strm.avail_out) z->strm_valid = 0;
+
+return(len);
 }
 
 
-void fstReaderClose(void *ctx)
+/*
+ * decodes the chunk holding unpacked offset idx * FST_ZRAN_CHUNK, keeping
+ * every whole chunk passed on the way in the cache
+ */
+static struct fstZranChunk *fstZranFill(struct fstZran *z, uint64_t idx)
 {
-struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+uint64_t target = idx * FST_ZRAN_CHUNK;
+uint64_t lo = 0, hi = z->num_points - 1;
 
-if(xc)
+/* last restart point at or before target */
+while(lo < hi)
         {
-        fstReaderDeallocateScopeData(xc);
-        fstReaderDeallocateRvatData(xc);
-        free(xc->rvat_sig_offs); xc->rvat_sig_offs = NULL;
+        uint64_t mid = lo + (hi - lo + 1) / 2;
 
-        free(xc->process_mask); xc->process_mask = NULL;
-        free(xc->blackout_times); xc->blackout_times = NULL;
-        free(xc->blackout_activity); xc->blackout_activity = NULL;
-        free(xc->temp_signal_value_buf); xc->temp_signal_value_buf = NULL;
-        free(xc->signal_typs); xc->signal_typs = NULL;
-        free(xc->signal_lens); xc->signal_lens = NULL;
-        free(xc->filename); xc->filename = NULL;
-	free(xc->str_scope_attr); xc->str_scope_attr = NULL;
+        if(z->points[mid].out <= target) lo = mid; else hi = mid - 1;
+        }
 
-        if(xc->fh)
+/* keep inflating forward unless a restart point gets closer to target */
+if(!z->strm_valid || (z->strm_out > target) || (z->points[lo].out > z->strm_out))
+        {
+        if(!fstZranRestart(z, z->points + lo)) return(NULL);
+        }
+
+if(z->strm_out % FST_ZRAN_CHUNK)
+        {
+        size_t skip = FST_ZRAN_CHUNK - (z->strm_out % FST_ZRAN_CHUNK);
+
+        while(skip)
                 {
-                tmpfile_close(&xc->fh, &xc->fh_nam);
+                size_t len = (skip > FST_ZRAN_WINSIZE) ? FST_ZRAN_WINSIZE : skip;
+
+                if(fstZranInflate(z, z->window, len) != len) return(NULL);
+                skip -= len;
                 }
+        }
 
-        if(xc->f)
+for(;;)
+        {
+        uint64_t cidx = z->strm_out / FST_ZRAN_CHUNK;
+        struct fstZranChunk *c = z->cache + (cidx & (FST_ZRAN_CACHE - 1));
+        size_t len = ((z->uclen - z->strm_out) > FST_ZRAN_CHUNK) ? FST_ZRAN_CHUNK : (z->uclen - z->strm_out);
+
+        if(!c->buf)
                 {
-                tmpfile_close(&xc->f, &xc->f_nam);
-                if(xc->filename_unpacked)
-                        {
-                        unlink(xc->filename_unpacked);
-                        free(xc->filename_unpacked);
-                        }
+                c->buf = (unsigned char *)malloc(FST_ZRAN_CHUNK);
+                if(!c->buf) return(NULL);
                 }
 
-        free(xc);
+        c->idx = UINT64_MAX;
+        if(fstZranInflate(z, c->buf, len) != len) return(NULL);
+        c->idx = cidx;
+        c->len = len;
+
+        if(cidx == idx) return(c);
         }
 }
 
 
-/*
- * read processing
- */
-
-/* normal read which re-interleaves the value change data */
-int fstReaderIterBlocks(void *ctx,
-        void (*value_change_callback)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value),
-        void *user_callback_data_pointer, FILE *fv)
+static int64_t fstZranRead(struct fstZran *z, unsigned char *buf, size_t len)
 {
-return(fstReaderIterBlocks2(ctx, value_change_callback, NULL, user_callback_data_pointer, fv));
-}
+uint64_t idx, offs;
+struct fstZranChunk *c;
 
+if(z->pos >= z->uclen) return(0);
 
-int fstReaderIterBlocks2(void *ctx,
-        void (*value_change_callback)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value),
-        void (*value_change_callback_varlen)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value, uint32_t len),
-        void *user_callback_data_pointer, FILE *fv)
-{
-struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+idx = z->pos / FST_ZRAN_CHUNK;
+c = z->cache + (idx & (FST_ZRAN_CACHE - 1));
+if(c->idx != idx)
+        {
+        c = fstZranFill(z, idx);
+        if(!c) return(-1);
+        }
 
-uint64_t previous_time = UINT64_MAX;
-uint64_t *time_table = NULL;
-uint64_t tsec_nitems;
-unsigned int secnum = 0;
-int blocks_skipped = 0;
-fst_off_t blkpos = 0;
-uint64_t seclen, beg_tim;
-uint64_t end_tim;
-uint64_t frame_uclen, frame_clen, frame_maxhandle, vc_maxhandle;
-fst_off_t vc_start;
-fst_off_t indx_pntr, indx_pos;
-fst_off_t *chain_table = NULL;
-uint32_t *chain_table_lengths = NULL;
-unsigned char *chain_cmem;
-unsigned char *pnt;
-long chain_clen;
-fstHandle idx, pidx=0, i;
-uint64_t pval;
-uint64_t vc_maxhandle_largest = 0;
-uint64_t tsec_uclen = 0, tsec_clen = 0;
-int sectype;
-uint64_t mem_required_for_traversal;
-unsigned char *mem_for_traversal = NULL;
-uint32_t traversal_mem_offs;
-uint32_t *scatterptr, *headptr, *length_remaining;
-uint32_t cur_blackout = 0;
-int packtype;
-unsigned char *mc_mem = NULL;
-uint32_t mc_mem_len; /* corresponds to largest value encountered in chain_table_lengths[i] */
-int dumpvars_state = 0;
+offs = z->pos - idx * FST_ZRAN_CHUNK;
+if(len > c->len - offs) len = c->len - offs;
+memcpy(buf, c->buf + offs, len);
 
-if(!xc) return(0);
+z->pos += len;
+return(len);
+}
 
-scatterptr = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
-headptr = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
-length_remaining = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
 
-if(fv)
+static int64_t fstZranSeek(struct fstZran *z, int64_t offset, int whence)
+{
+int64_t base;
+
+switch(whence)
         {
-#ifndef FST_WRITEX_DISABLE
-        fflush(fv);
-        setvbuf(fv, (char *) NULL, _IONBF, 0); /* even buffered IO is slow so disable it and use our own routines that don't need seeking */
-        xc->writex_fd = fileno(fv);
-#endif
+        case SEEK_SET:  base = 0; break;
+        case SEEK_CUR:  base = z->pos; break;
+        case SEEK_END:  base = z->uclen; break;
+        default:        errno = EINVAL; return(-1);
         }
 
-for(;;)
+if((offset < 0) && (-offset > base))
         {
-        uint32_t *tc_head = NULL;
-	uint32_t tc_head_items = 0;
-        traversal_mem_offs = 0;
+        errno = EINVAL;
+        return(-1);
+        }
 
-        fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
+z->pos = base + offset;
+return(z->pos);
+}
 
-        sectype = fgetc(xc->f);
-        seclen = fstReaderUint64(xc->f);
 
-        if((sectype == EOF) || (sectype == FST_BL_SKIP))
-                {
-#ifdef FST_DEBUG
-                fprintf(stderr, FST_APIMESS "<< EOF >>\n");
+#if defined(__GLIBC__)
+static ssize_t fstZranCookieRead(void *cookie, char *buf, size_t size)
+{
+return(fstZranRead((struct fstZran *)cookie, (unsigned char *)buf, size));
+}
+
+static int fstZranCookieSeek(void *cookie, off64_t *offset, int whence)
+{
+int64_t pos = fstZranSeek((struct fstZran *)cookie, *offset, whence);
+
+if(pos < 0) return(-1);
+*offset = pos;
+return(0);
+}
+
+static int fstZranCookieClose(void *cookie)
+{
+fstZranFree((struct fstZran *)cookie);
+return(0);
+}
+#else
+static int fstZranCookieRead(void *cookie, char *buf, int size)
+{
+return((int)fstZranRead((struct fstZran *)cookie, (unsigned char *)buf, size));
+}
+
+static fpos_t fstZranCookieSeek(void *cookie, fpos_t offset, int whence)
+{
+return(fstZranSeek((struct fstZran *)cookie, offset, whence));
+}
+
+static int fstZranCookieClose(void *cookie)
+{
+fstZranFree((struct fstZran *)cookie);
+return(0);
+}
 #endif
-                break;
-                }
 
-        blkpos++;
-        if((sectype != FST_BL_VCDATA) && (sectype != FST_BL_VCDATA_DYN_ALIAS) && (sectype != FST_BL_VCDATA_DYN_ALIAS2))
-                {
-                blkpos += seclen;
-                continue;
-                }
 
-        if(!seclen) break;
+/*
+ * returns a read-only stream of the unpacked trace which takes ownership of
+ * xc->f, or NULL (leaving xc->f alone) so the caller falls back to unpacking
+ */
+static FILE *fstReaderOpenRepacked(struct fstReaderContext *xc, uint64_t uclen)
+{
+struct fstZran *z;
+struct fstZranKey key;
+struct stat sb;
+int nam_len;
+char *nam;
+FILE *f;
+int i;
 
-        beg_tim = fstReaderUint64(xc->f);
-        end_tim = fstReaderUint64(xc->f);
+if(fstat(fileno(xc->f), &sb) < 0) return(NULL);
+fstZranKeyInit(&key, &sb, uclen);
 
-        if(xc->limit_range_valid)
+z = (struct fstZran *)calloc(1, sizeof(struct fstZran));
+if(!z) return(NULL);
+z->uclen = uclen;
+for(i=0;i<FST_ZRAN_CACHE;i++)
+        {
+        z->cache[i].idx = UINT64_MAX;
+        }
+
+if(inflateInit2(&z->strm, -15) != Z_OK)
+        {
+        free(z);
+        return(NULL);
+        }
+
+/* the index reads through its own handle so the caller's stays positioned */
+z->f = fopen(xc->filename, "rb");
+nam_len = strlen(xc->filename) + 5 + 1;
+nam = (char *)malloc(nam_len);
+if(z->f && nam && !fstZranSharedFind(z, &key))
+        {
+        snprintf(nam, nam_len, "%s.zidx", xc->filename);
+        if(!fstZranLoadIndex(z, nam, &key))
                 {
-                if(end_tim < xc->limit_range_start)
+                if(fstZranBuild(z, 1+8+8))
                         {
-                        blocks_skipped++;
-                        blkpos += seclen;
-                        continue;
+                        fstZranSaveIndex(z, nam, &key);
                         }
-
-                if(beg_tim > xc->limit_range_end) /* likely the compare in for(i=0;i<tsec_nitems;i++) below would do this earlier */
+                        else
                         {
-                        break;
+                        fstZranFreePoints(z);
                         }
                 }
 
+        if(z->num_points)
+                {
+                fstZranSharedAdd(z, &key);
+                }
+        }
+free(nam);
 
-        mem_required_for_traversal = fstReaderUint64(xc->f) + 66; /* add in potential fastlz overhead */
-        mem_for_traversal = (unsigned char *)malloc(mem_required_for_traversal);
-#ifdef FST_DEBUG
-        fprintf(stderr, FST_APIMESS "sec: %u seclen: %d begtim: %d endtim: %d\n",
-                secnum, (int)seclen, (int)beg_tim, (int)end_tim);
-        fprintf(stderr, FST_APIMESS "mem_required_for_traversal: %d\n", (int)mem_required_for_traversal-66);
+if(!z->num_points)
+        {
+        fstZranFree(z);
+        return(NULL);
+        }
+
+#if defined(__GLIBC__)
+        {
+        cookie_io_functions_t io;
+
+        io.read = fstZranCookieRead;
+        io.write = NULL;
+        io.seek = fstZranCookieSeek;
+        io.close = fstZranCookieClose;
+        f = fopencookie(z, "rb", io);
+        }
+#else
+f = funopen(z, fstZranCookieRead, NULL, fstZranCookieSeek, fstZranCookieClose);
 #endif
-        /* process time block */
+
+if(!f)
         {
-        unsigned char *ucdata;
-        unsigned char *cdata;
-        unsigned long destlen /* = tsec_uclen */; /* scan-build */
-        unsigned long sourcelen /*= tsec_clen */; /* scan-build */
-        int rc;
-        unsigned char *tpnt;
-        uint64_t tpval;
-        unsigned int ti;
+        fstZranFree(z);
+        return(NULL);
+        }
 
-        if(fstReaderFseeko(xc, xc->f, blkpos + seclen - 24, SEEK_SET) != 0) break;
-        tsec_uclen = fstReaderUint64(xc->f);
-        tsec_clen = fstReaderUint64(xc->f);
-        tsec_nitems = fstReaderUint64(xc->f);
-#ifdef FST_DEBUG
-        fprintf(stderr, FST_APIMESS "time section unc: %d, com: %d (%d items)\n",
-                (int)tsec_uclen, (int)tsec_clen, (int)tsec_nitems);
+return(f);
+}
 #endif
-        if(tsec_clen > seclen) break; /* corrupted tsec_clen: by definition it can't be larger than size of section */
-        ucdata = (unsigned char *)malloc(tsec_uclen);
-        if(!ucdata) break; /* malloc fail as tsec_uclen out of range from corrupted file */
-        destlen = tsec_uclen;
-        sourcelen = tsec_clen;
 
-        fstReaderFseeko(xc, xc->f, -24 - ((fst_off_t)tsec_clen), SEEK_CUR);
 
-        if(tsec_uclen != tsec_clen)
-                {
-                cdata = (unsigned char *)malloc(tsec_clen);
-                fstFread(cdata, tsec_clen, 1, xc->f);
+/*
+ * reader file open/close functions
+ */
+int fstReaderInit(struct fstReaderContext *xc)
+{
+fst_off_t blkpos = 0;
+fst_off_t endfile;
+uint64_t seclen;
+int sectype;
+uint64_t vc_section_count_actual = 0;
+int hdr_incomplete = 0;
+int hdr_seen = 0;
+int gzread_pass_status = 1;
 
-                rc = uncompress(ucdata, &destlen, cdata, sourcelen);
+sectype = fgetc(xc->f);
+if(sectype == FST_BL_ZWRAPPER)
+        {
+        FILE *fcomp;
+        fst_off_t offpnt, uclen;
+        char gz_membuf[FST_GZIO_LEN];
+        gzFile zhandle;
+        int zfd;
+        int flen = strlen(xc->filename);
+        char *hf;
+	int hf_len;
 
-                if(rc != Z_OK)
-                        {
-                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), tsec uncompress rc = %d, exiting.\n", rc);
-                        exit(255);
-                        }
+        seclen = fstReaderUint64(xc->f);
+        uclen = fstReaderUint64(xc->f);
 
-                free(cdata);
-                }
-                else
+        if(!seclen) return(0); /* not finished compressing, this is a failed read */
+
+#ifdef FST_HAVE_ZRAN
+        fcomp = fstReaderOpenRepacked(xc, uclen);
+        if(fcomp)
                 {
-                fstFread(ucdata, tsec_uclen, 1, xc->f);
+                fclose(xc->f);
+                xc->f = fcomp;
+                goto unpacked;
                 }
+#endif
 
-        free(time_table);
+	hf_len = flen + 16 + 32 + 1;
+        hf = (char *)calloc(1, hf_len);
 
-	if(sizeof(size_t) < sizeof(uint64_t))
-		{
-		/* TALOS-2023-1792 for 32b overflow */
-		uint64_t chk_64 = tsec_nitems * sizeof(uint64_t);
-		size_t   chk_32 = ((size_t)tsec_nitems) * sizeof(uint64_t);
-		if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1792");
-		}
-	else
-		{
-		uint64_t chk_64 = tsec_nitems * sizeof(uint64_t);
-		if((chk_64/sizeof(uint64_t)) != tsec_nitems)
-			{
-			chk_report_abort("TALOS-2023-1792");
-			}
-		}
-        time_table = (uint64_t *)calloc(tsec_nitems, sizeof(uint64_t));
-        tpnt = ucdata;
-        tpval = 0;
-        for(ti=0;ti<tsec_nitems;ti++)
+        snprintf(hf, hf_len, "%s.upk_%d_%p", xc->filename, getpid(), (void *)xc);
+        fcomp = fopen(hf, "w+b");
+        if(!fcomp)
                 {
-                int skiplen;
-                uint64_t val = fstGetVarint64(tpnt, &skiplen);
-                tpval = time_table[ti] = tpval + val;
-                tpnt += skiplen;
+                fcomp = tmpfile_open(&xc->f_nam);
+                free(hf); hf = NULL;
+                if(!fcomp) { tmpfile_close(&fcomp, &xc->f_nam); return(0); }
                 }
 
-	tc_head_items = tsec_nitems /* scan-build */ ? tsec_nitems : 1;
-	if(sizeof(size_t) < sizeof(uint64_t))
-		{
-		/* TALOS-2023-1792 for 32b overflow */
-		uint64_t chk_64 = tc_head_items * sizeof(uint32_t);
-		size_t   chk_32 = ((size_t)tc_head_items) * sizeof(uint32_t);
-		if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1792");
-		}
-	else
-		{
-		uint64_t chk_64 = tc_head_items * sizeof(uint32_t);
-		if((chk_64/sizeof(uint32_t)) != tc_head_items)
-			{
-			chk_report_abort("TALOS-2023-1792");
-			}
-		}
-        tc_head = (uint32_t *)calloc(tc_head_items, sizeof(uint32_t));
-        free(ucdata);
-        }
+#if defined(FST_UNBUFFERED_IO)
+        setvbuf(fcomp, (char *)NULL, _IONBF, 0);   /* keeps gzip from acting weird in tandem with fopen */
+#endif
 
-        fstReaderFseeko(xc, xc->f, blkpos+32, SEEK_SET);
+#ifdef __MINGW32__
+        xc->filename_unpacked = hf;
+#else
+        if(hf)
+                {
+                unlink(hf);
+                free(hf);
+                }
+#endif
 
-        frame_uclen = fstReaderVarint64(xc->f);
-        frame_clen = fstReaderVarint64(xc->f);
-        frame_maxhandle = fstReaderVarint64(xc->f);
+        fstReaderFseeko(xc, xc->f, 1+8+8, SEEK_SET);
+#ifndef __MINGW32__
+        fflush(xc->f);
+#endif
 
-        if(secnum == 0)
+        zfd = dup(fileno(xc->f));
+        zhandle = gzdopen(zfd, "rb");
+        if(zhandle)
                 {
-                if((beg_tim != time_table[0]) || (blocks_skipped))
+                for(offpnt = 0; offpnt < uclen; offpnt += FST_GZIO_LEN)
                         {
-                        unsigned char *mu = (unsigned char *)malloc(frame_uclen);
-                        uint32_t sig_offs = 0;
+                        size_t this_len = ((uclen - offpnt) > FST_GZIO_LEN) ? FST_GZIO_LEN : (uclen - offpnt);
+                        size_t gzreadlen = gzread(zhandle, gz_membuf, this_len);
+                        size_t fwlen;
 
-                        if(fv)
+                        if(gzreadlen != this_len)
                                 {
-                                char wx_buf[32];
-                                int wx_len;
-
-                                if(beg_tim)
-                                        {
-					if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
-                                        wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", beg_tim);
-                                        fstWritex(xc, wx_buf, wx_len);
-					if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
-                                        }
-                                if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
-                                        {
-                                        if(beg_tim == xc->blackout_times[cur_blackout])
-                                                {
-                                                wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
-                                                fstWritex(xc, wx_buf, wx_len);
-                                                }
-                                        }
+                                gzread_pass_status = 0;
+                                break;
                                 }
-
-                        if(frame_uclen == frame_clen)
+                        fwlen = fstFwrite(gz_membuf, this_len, 1, fcomp);
+                        if(fwlen != 1)
                                 {
-                                fstFread(mu, frame_uclen, 1, xc->f);
+                                gzread_pass_status = 0;
+                                break;
                                 }
-                                else
-                                {
-                                unsigned char *mc = (unsigned char *)malloc(frame_clen);
-                                int rc;
+                        }
+                gzclose(zhandle);
+                }
+                else
+                {
+                close(zfd);
+                }
+        fflush(fcomp);
+        fclose(xc->f);
+        xc->f = fcomp;
+        }
+
+#ifdef FST_HAVE_ZRAN
+unpacked:
+#endif
+
+if(gzread_pass_status)
+        {
+        fstReaderFseeko(xc, xc->f, 0, SEEK_END);
+        endfile = ftello(xc->f);
+
+        while(blkpos < endfile)
+                {
+                fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
+
+                sectype = fgetc(xc->f);
+                seclen = fstReaderUint64(xc->f);
+
+                if(sectype == EOF)
+                        {
+                        break;
+                        }
+
+                if((hdr_incomplete) && (!seclen))
+                        {
+                        break;
+                        }
+
+                if(!hdr_seen && (sectype != FST_BL_HDR))
+                        {
+                        break;
+                        }
+
+                blkpos++;
+                if(sectype == FST_BL_HDR)
+                        {
+                        if(!hdr_seen)
+                                {
+                                int ch;
+                                double dcheck;
+
+                                xc->start_time = fstReaderUint64(xc->f);
+                                xc->end_time = fstReaderUint64(xc->f);
+
+                                hdr_incomplete = (xc->start_time == 0) && (xc->end_time == 0);
+
+                                fstFread(&dcheck, 8, 1, xc->f);
+                                xc->double_endian_match = (dcheck == FST_DOUBLE_ENDTEST);
+                                if(!xc->double_endian_match)
+                                        {
+                                        union   {
+                                                unsigned char rvs_buf[8];
+                                                double d;
+                                                } vu;
+
+                                        unsigned char *dcheck_alias = (unsigned char *)&dcheck;
+                                        int rvs_idx;
+
+                                        for(rvs_idx=0;rvs_idx<8;rvs_idx++)
+                                                {
+                                                vu.rvs_buf[rvs_idx] = dcheck_alias[7-rvs_idx];
+                                                }
+                                        if(vu.d != FST_DOUBLE_ENDTEST)
+                                                {
+                                                break; /* either corrupt file or wrong architecture (offset +33 also functions as matchword) */
+                                                }
+                                        }
+
+                                hdr_seen = 1;
+
+                                xc->mem_used_by_writer = fstReaderUint64(xc->f);
+                                xc->scope_count = fstReaderUint64(xc->f);
+                                xc->var_count = fstReaderUint64(xc->f);
+                                xc->maxhandle = fstReaderUint64(xc->f);
+                                xc->num_alias = xc->var_count - xc->maxhandle;
+                                xc->vc_section_count = fstReaderUint64(xc->f);
+                                ch = fgetc(xc->f);
+                                xc->timescale = (signed char)ch;
+                                fstFread(xc->version, FST_HDR_SIM_VERSION_SIZE, 1, xc->f);
+                                xc->version[FST_HDR_SIM_VERSION_SIZE] = 0;
+                                fstFread(xc->date, FST_HDR_DATE_SIZE, 1, xc->f);
+                                xc->date[FST_HDR_DATE_SIZE] = 0;
+                                ch = fgetc(xc->f);
+                                xc->filetype = (unsigned char)ch;
+                                xc->timezero = fstReaderUint64(xc->f);
+                                }
+                        }
+                else if((sectype == FST_BL_VCDATA) || (sectype == FST_BL_VCDATA_DYN_ALIAS) || (sectype == FST_BL_VCDATA_DYN_ALIAS2))
+                        {
+                        if(hdr_incomplete)
+                                {
+                                uint64_t bt = fstReaderUint64(xc->f);
+                                xc->end_time = fstReaderUint64(xc->f);
+
+                                if(!vc_section_count_actual) { xc->start_time = bt; }
+                                }
+
+                        vc_section_count_actual++;
+                        }
+                else if(sectype == FST_BL_GEOM)
+                        {
+                        if(!hdr_incomplete)
+                                {
+                                uint64_t clen = seclen - 24;
+                                uint64_t uclen = fstReaderUint64(xc->f);
+                                unsigned char *ucdata = (unsigned char *)malloc(uclen);
+                                unsigned char *pnt = ucdata;
+                                unsigned int i;
+
+                                xc->contains_geom_section = 1;
+                                xc->maxhandle = fstReaderUint64(xc->f);
+                                xc->longest_signal_value_len = 32; /* arbitrarily set at 32...this is much longer than an expanded double */
+
+                                free(xc->process_mask);
+                                xc->process_mask = (unsigned char *)calloc(1, (xc->maxhandle+7)/8);
+
+                                if(clen != uclen)
+                                        {
+                                        unsigned char *cdata = (unsigned char *)malloc(clen);
+                                        unsigned long destlen = uclen;
+                                        unsigned long sourcelen = clen;
+                                        int rc;
+
+                                        fstFread(cdata, clen, 1, xc->f);
+                                        rc = uncompress(ucdata, &destlen, cdata, sourcelen);
+
+                                        if(rc != Z_OK)
+                                                {
+                                                fprintf(stderr, FST_APIMESS "fstReaderInit(), geom uncompress rc = %d, exiting.\n", rc);
+                                                exit(255);
+                                                }
+
+                                        free(cdata);
+                                        }
+                                        else
+                                        {
+                                        fstFread(ucdata, uclen, 1, xc->f);
+                                        }
+
+                                free(xc->signal_lens);
+                                xc->signal_lens = (uint32_t *)malloc(sizeof(uint32_t) * xc->maxhandle);
+                                free(xc->signal_typs);
+                                xc->signal_typs = (unsigned char *)malloc(sizeof(unsigned char) * xc->maxhandle);
+
+                                for(i=0;i<xc->maxhandle;i++)
+                                        {
+                                        int skiplen;
+                                        uint64_t val = fstGetVarint32(pnt, &skiplen);
+
+                                        pnt += skiplen;
+
+                                        if(val)
+                                                {
+                                                xc->signal_lens[i] = (val != 0xFFFFFFFF) ? val : 0;
+                                                xc->signal_typs[i] = FST_VT_VCD_WIRE;
+                                                if(xc->signal_lens[i] > xc->longest_signal_value_len)
+                                                        {
+                                                        xc->longest_signal_value_len = xc->signal_lens[i];
+                                                        }
+                                                }
+                                                else
+                                                {
+                                                xc->signal_lens[i] = 8; /* backpatch in real */
+                                                xc->signal_typs[i] = FST_VT_VCD_REAL;
+                                                /* xc->longest_signal_value_len handled above by overly large init size */
+                                                }
+                                        }
+
+                                free(xc->temp_signal_value_buf);
+                                xc->temp_signal_value_buf = (unsigned char *)malloc(xc->longest_signal_value_len + 1);
+
+                                free(ucdata);
+                                }
+                        }
+                else if(sectype == FST_BL_HIER)
+                        {
+                        xc->contains_hier_section = 1;
+                        xc->hier_pos = ftello(xc->f);
+                        }
+                else if(sectype == FST_BL_HIER_LZ4DUO)
+                        {
+                        xc->contains_hier_section_lz4    = 1;
+                        xc->contains_hier_section_lz4duo = 1;
+                        xc->hier_pos = ftello(xc->f);
+                        }
+                else if(sectype == FST_BL_HIER_LZ4)
+                        {
+                        xc->contains_hier_section_lz4 = 1;
+                        xc->hier_pos = ftello(xc->f);
+                        }
+                else if(sectype == FST_BL_BLACKOUT)
+                        {
+                        uint32_t i;
+                        uint64_t cur_bl = 0;
+                        uint64_t delta;
+
+                        xc->num_blackouts = fstReaderVarint32(xc->f);
+                        free(xc->blackout_times);
+                        xc->blackout_times = (uint64_t *)calloc(xc->num_blackouts, sizeof(uint64_t));
+                        free(xc->blackout_activity);
+                        xc->blackout_activity = (unsigned char *)calloc(xc->num_blackouts, sizeof(unsigned char));
+
+                        for(i=0;i<xc->num_blackouts;i++)
+                                {
+                                xc->blackout_activity[i] = fgetc(xc->f) != 0;
+                                delta = fstReaderVarint64(xc->f);
+                                cur_bl += delta;
+                                xc->blackout_times[i] = cur_bl;
+                                }
+                        }
+
+                blkpos += seclen;
+                if(!hdr_seen) break;
+                }
+
+        if(hdr_seen)
+                {
+                if(xc->vc_section_count != vc_section_count_actual)
+                        {
+                        xc->vc_section_count = vc_section_count_actual;
+                        }
+
+                if(!xc->contains_geom_section)
+                        {
+                        fstReaderProcessHier(xc, NULL); /* recreate signal_lens/signal_typs info */
+                        }
+                }
+        }
+
+return(hdr_seen);
+}
+
+
+void *fstReaderOpenForUtilitiesOnly(void)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)calloc(1, sizeof(struct fstReaderContext));
+
+return(xc);
+}
+
+
+void *fstReaderOpen(const char *nam)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)calloc(1, sizeof(struct fstReaderContext));
+
+if((!nam)||(!(xc->f=fopen(nam, "rb"))))
+        {
+        free(xc);
+        xc=NULL;
+        }
+        else
+        {
+        int flen = strlen(nam);
+        char *hf = (char *)calloc(1, flen + 6);
+        int rc;
+
+#if defined(FST_UNBUFFERED_IO)
+        setvbuf(xc->f, (char *)NULL, _IONBF, 0);   /* keeps gzip from acting weird in tandem with fopen */
+#endif
+
+        memcpy(hf, nam, flen);
+        strcpy(hf + flen, ".hier");
+        xc->fh = fopen(hf, "rb");
+
+        free(hf);
+        xc->filename = strdup(nam);
+        rc = fstReaderInit(xc);
+
+        if((rc) && (xc->vc_section_count) && (xc->maxhandle) && ((xc->fh)||(xc->contains_hier_section||(xc->contains_hier_section_lz4))))
+                {
+                /* more init */
+                xc->do_rewind = 1;
+                }
+                else
+                {
+                fstReaderClose(xc);
+                xc = NULL;
+                }
+        }
+
+return(xc);
+}
+
+
+static void fstReaderDeallocateRvatBlock(struct fstRvatBlock *blk)
+{
+if(blk->chains)
+        {
+        uint64_t i;
+
+        for(i=0;i<blk->vc_maxhandle;i++)
+                {
+                free(blk->chains[i].mem);
+                }
+        free(blk->chains); blk->chains = NULL;
+        }
+
+free(blk->frame_data); blk->frame_data = NULL;
+free(blk->time_table); blk->time_table = NULL;
+free(blk->chain_table); blk->chain_table = NULL;
+free(blk->chain_table_lengths); blk->chain_table_lengths = NULL;
+
+blk->valid = 0;
+}
+
+
+static void fstReaderDeallocateRvatData(void *ctx)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+if(xc)
+        {
+        int i;
+
+        for(i=0;i<FST_RVAT_BLOCK_CACHE;i++)
+                {
+                fstReaderDeallocateRvatBlock(&xc->rvat_blocks[i]);
+                }
+
+        free(xc->rvat_index); xc->rvat_index = NULL;
+        xc->rvat_index_count = 0;
+        xc->rvat_index_valid = 0;
+        }
+}
+
+
+void fstReaderClose(void *ctx)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+
+if(xc)
+        {
+        fstReaderDeallocateScopeData(xc);
+        fstReaderDeallocateRvatData(xc);
+        free(xc->rvat_sig_offs); xc->rvat_sig_offs = NULL;
+
+        free(xc->process_mask); xc->process_mask = NULL;
+        free(xc->blackout_times); xc->blackout_times = NULL;
+        free(xc->blackout_activity); xc->blackout_activity = NULL;
+        free(xc->temp_signal_value_buf); xc->temp_signal_value_buf = NULL;
+        free(xc->signal_typs); xc->signal_typs = NULL;
+        free(xc->signal_lens); xc->signal_lens = NULL;
+        free(xc->filename); xc->filename = NULL;
+	free(xc->str_scope_attr); xc->str_scope_attr = NULL;
+
+        if(xc->fh)
+                {
+                tmpfile_close(&xc->fh, &xc->fh_nam);
+                }
+
+        fstReaderSetMmapMode(xc, 0);
+
+        if(xc->f)
+                {
+                tmpfile_close(&xc->f, &xc->f_nam);
+                if(xc->filename_unpacked)
+                        {
+                        unlink(xc->filename_unpacked);
+                        free(xc->filename_unpacked);
+                        }
+                }
+
+        free(xc);
+        }
+}
+
+
+/*
+ * read processing
+ */
+
+/* normal read which re-interleaves the value change data */
+#ifdef FST_WRITER_PARALLEL
+static int fstReaderIterBlocksVcdParallel(struct fstReaderContext *xc, FILE *fv);
+#endif
+
+int fstReaderIterBlocks(void *ctx,
+        void (*value_change_callback)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value),
+        void *user_callback_data_pointer, FILE *fv)
+{
+return(fstReaderIterBlocks2(ctx, value_change_callback, NULL, user_callback_data_pointer, fv));
+}
+
+
+int fstReaderIterBlocks2(void *ctx,
+        void (*value_change_callback)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value),
+        void (*value_change_callback_varlen)(void *user_callback_data_pointer, uint64_t time, fstHandle facidx, const unsigned char *value, uint32_t len),
+        void *user_callback_data_pointer, FILE *fv)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+
+uint64_t previous_time = UINT64_MAX;
+uint64_t *time_table = NULL;
+uint64_t tsec_nitems;
+unsigned int secnum = 0;
+int blocks_skipped = 0;
+fst_off_t blkpos = 0;
+uint64_t seclen, beg_tim;
+uint64_t end_tim;
+uint64_t frame_uclen, frame_clen, frame_maxhandle, vc_maxhandle;
+fst_off_t frame_pos, vc_start;
+fst_off_t indx_pntr, indx_pos;
+fst_off_t *chain_table = NULL;
+uint32_t *chain_table_lengths = NULL;
+unsigned char *chain_cmem, *chain_cmem_alloc = NULL;
+unsigned char *pnt;
+long chain_clen;
+fstHandle idx, pidx=0, i;
+uint64_t pval;
+uint64_t vc_maxhandle_largest = 0;
+uint64_t tsec_uclen = 0, tsec_clen = 0;
+int sectype;
+uint64_t mem_required_for_traversal;
+unsigned char *mem_for_traversal = NULL;
+uint32_t traversal_mem_offs;
+uint32_t *scatterptr, *headptr, *length_remaining;
+uint32_t cur_blackout = 0;
+int packtype;
+unsigned char *mc_mem = NULL;
+uint32_t mc_mem_len; /* corresponds to largest value encountered in chain_table_lengths[i] */
+int dumpvars_state = 0;
+
+if(!xc) return(0);
+
+#ifdef FST_WRITER_PARALLEL
+if(fv && !value_change_callback && !value_change_callback_varlen && (xc->vcd_threads > 1))
+        {
+        return(fstReaderIterBlocksVcdParallel(xc, fv));
+        }
+#endif
+
+scatterptr = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
+headptr = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
+length_remaining = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
+
+if(fv)
+        {
+#ifndef FST_WRITEX_DISABLE
+        fflush(fv);
+        setvbuf(fv, (char *) NULL, _IONBF, 0); /* even buffered IO is slow so disable it and use our own routines that don't need seeking */
+        xc->writex_fd = fileno(fv);
+#endif
+        }
+
+for(;;)
+        {
+        uint32_t *tc_head = NULL;
+	uint32_t tc_head_items = 0;
+        traversal_mem_offs = 0;
+
+        fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
+
+        sectype = fgetc(xc->f);
+        seclen = fstReaderUint64(xc->f);
+
+        if((sectype == EOF) || (sectype == FST_BL_SKIP))
+                {
+#ifdef FST_DEBUG
+                fprintf(stderr, FST_APIMESS "<< EOF >>\n");
+#endif
+                break;
+                }
+
+        blkpos++;
+        if((sectype != FST_BL_VCDATA) && (sectype != FST_BL_VCDATA_DYN_ALIAS) && (sectype != FST_BL_VCDATA_DYN_ALIAS2))
+                {
+                blkpos += seclen;
+                continue;
+                }
+
+        if(!seclen) break;
+
+        beg_tim = fstReaderUint64(xc->f);
+        end_tim = fstReaderUint64(xc->f);
+
+        if(xc->limit_range_valid)
+                {
+                if(end_tim < xc->limit_range_start)
+                        {
+                        blocks_skipped++;
+                        blkpos += seclen;
+                        continue;
+                        }
+
+                if(beg_tim > xc->limit_range_end) /* likely the compare in for(i=0;i<tsec_nitems;i++) below would do this earlier */
+                        {
+                        break;
+                        }
+                }
+
+
+        mem_required_for_traversal = fstReaderUint64(xc->f) + 66; /* add in potential fastlz overhead */
+        mem_for_traversal = (unsigned char *)malloc(mem_required_for_traversal);
+#ifdef FST_DEBUG
+        fprintf(stderr, FST_APIMESS "sec: %u seclen: %d begtim: %d endtim: %d\n",
+                secnum, (int)seclen, (int)beg_tim, (int)end_tim);
+        fprintf(stderr, FST_APIMESS "mem_required_for_traversal: %d\n", (int)mem_required_for_traversal-66);
+#endif
+        /* process time block */
+        {
+        unsigned char *ucdata, *ucdata_alloc = NULL;
+        unsigned char *cdata, *cdata_alloc;
+        unsigned long destlen /* = tsec_uclen */; /* scan-build */
+        unsigned long sourcelen /*= tsec_clen */; /* scan-build */
+        int rc;
+        unsigned char *tpnt;
+        uint64_t tpval;
+        unsigned int ti;
+
+        if(fstReaderFseeko(xc, xc->f, blkpos + seclen - 24, SEEK_SET) != 0) break;
+        tsec_uclen = fstReaderUint64(xc->f);
+        tsec_clen = fstReaderUint64(xc->f);
+        tsec_nitems = fstReaderUint64(xc->f);
+#ifdef FST_DEBUG
+        fprintf(stderr, FST_APIMESS "time section unc: %d, com: %d (%d items)\n",
+                (int)tsec_uclen, (int)tsec_clen, (int)tsec_nitems);
+#endif
+        if(tsec_clen > seclen) break; /* corrupted tsec_clen: by definition it can't be larger than size of section */
+        destlen = tsec_uclen;
+        sourcelen = tsec_clen;
+
+        if(tsec_uclen != tsec_clen)
+                {
+                ucdata = ucdata_alloc = (unsigned char *)malloc(tsec_uclen);
+                if(!ucdata) break; /* malloc fail as tsec_uclen out of range from corrupted file */
+
+                cdata = fstReaderFetch(xc, blkpos + seclen - 24 - tsec_clen, tsec_clen, &cdata_alloc);
+                if(!cdata) { free(ucdata_alloc); break; }
+
+                rc = uncompress(ucdata, &destlen, cdata, sourcelen);
+
+                if(rc != Z_OK)
+                        {
+                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), tsec uncompress rc = %d, exiting.\n", rc);
+                        exit(255);
+                        }
+
+                free(cdata_alloc);
+                }
+                else
+                {
+                ucdata = fstReaderFetch(xc, blkpos + seclen - 24 - tsec_clen, tsec_uclen, &ucdata_alloc);
+                if(!ucdata) break; /* malloc fail as tsec_uclen out of range from corrupted file */
+                }
+
+        free(time_table);
+
+	if(sizeof(size_t) < sizeof(uint64_t))
+		{
+		/* TALOS-2023-1792 for 32b overflow */
+		uint64_t chk_64 = tsec_nitems * sizeof(uint64_t);
+		size_t   chk_32 = ((size_t)tsec_nitems) * sizeof(uint64_t);
+		if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1792");
+		}
+	else
+		{
+		uint64_t chk_64 = tsec_nitems * sizeof(uint64_t);
+		if((chk_64/sizeof(uint64_t)) != tsec_nitems)
+			{
+			chk_report_abort("TALOS-2023-1792");
+			}
+		}
+        time_table = (uint64_t *)calloc(tsec_nitems, sizeof(uint64_t));
+        tpnt = ucdata;
+        tpval = 0;
+        for(ti=0;ti<tsec_nitems;ti++)
+                {
+                int skiplen;
+                uint64_t val = fstGetVarint64(tpnt, &skiplen);
+                tpval = time_table[ti] = tpval + val;
+                tpnt += skiplen;
+                }
+
+	tc_head_items = tsec_nitems /* scan-build */ ? tsec_nitems : 1;
+	if(sizeof(size_t) < sizeof(uint64_t))
+		{
+		/* TALOS-2023-1792 for 32b overflow */
+		uint64_t chk_64 = tc_head_items * sizeof(uint32_t);
+		size_t   chk_32 = ((size_t)tc_head_items) * sizeof(uint32_t);
+		if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1792");
+		}
+	else
+		{
+		uint64_t chk_64 = tc_head_items * sizeof(uint32_t);
+		if((chk_64/sizeof(uint32_t)) != tc_head_items)
+			{
+			chk_report_abort("TALOS-2023-1792");
+			}
+		}
+        tc_head = (uint32_t *)calloc(tc_head_items, sizeof(uint32_t));
+        free(ucdata_alloc);
+        }
+
+        fstReaderFseeko(xc, xc->f, blkpos+32, SEEK_SET);
+
+        frame_uclen = fstReaderVarint64(xc->f);
+        frame_clen = fstReaderVarint64(xc->f);
+        frame_maxhandle = fstReaderVarint64(xc->f);
+        frame_pos = ftello(xc->f);
+
+        if(secnum == 0)
+                {
+                if((beg_tim != time_table[0]) || (blocks_skipped))
+                        {
+                        unsigned char *mu, *mu_alloc = NULL;
+                        uint32_t sig_offs = 0;
+
+                        if(fv)
+                                {
+                                char wx_buf[32];
+                                int wx_len;
+
+                                if(beg_tim)
+                                        {
+					if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
+                                        wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", beg_tim);
+                                        fstWritex(xc, wx_buf, wx_len);
+					if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
+                                        }
+                                if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
+                                        {
+                                        if(beg_tim == xc->blackout_times[cur_blackout])
+                                                {
+                                                wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
+                                                fstWritex(xc, wx_buf, wx_len);
+                                                }
+                                        }
+                                }
+
+                        if(frame_uclen == frame_clen)
+                                {
+                                mu = fstReaderFetch(xc, frame_pos, frame_uclen, &mu_alloc);
+                                }
+                                else
+                                {
+                                unsigned char *mc_alloc;
+                                unsigned char *mc = fstReaderFetch(xc, frame_pos, frame_clen, &mc_alloc);
+                                int rc;
 
                                 unsigned long destlen = frame_uclen;
                                 unsigned long sourcelen = frame_clen;
 
-                                fstFread(mc, sourcelen, 1, xc->f);
-                                rc = uncompress(mu, &destlen, mc, sourcelen);
-                                if(rc != Z_OK)
+                                mu = mu_alloc = (unsigned char *)malloc(frame_uclen);
+                                rc = uncompress(mu, &destlen, mc, sourcelen);
+                                if(rc != Z_OK)
+                                        {
+                                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), frame uncompress rc: %d, exiting.\n", rc);
+                                        exit(255);
+                                        }
+                                free(mc_alloc);
+                                }
+
+
+                        for(idx=0;idx<frame_maxhandle;idx++)
+                                {
+                                int process_idx = idx/8;
+                                int process_bit = idx&7;
+
+                                if(xc->process_mask[process_idx]&(1<<process_bit))
+                                        {
+                                        if(xc->signal_lens[idx] <= 1)
+                                                {
+                                                if(xc->signal_lens[idx] == 1)
+                                                        {
+                                                        unsigned char val = mu[sig_offs];
+                                                        if(value_change_callback)
+                                                                {
+                                                                xc->temp_signal_value_buf[0] = val;
+                                                                xc->temp_signal_value_buf[1] = 0;
+                                                                value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
+                                                                }
+                                                                else
+                                                                {
+                                                                if(fv)
+                                                                        {
+                                                                        char vcd_id[16];
+
+                                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+                                                                        vcd_id[0] = val; /* collapse 3 writes into one I/O call */
+                                                                        vcd_id[vcdid_len + 1] = '\n';
+                                                                        fstWritex(xc, vcd_id, vcdid_len + 2);
+                                                                        }
+                                                                }
+                                                        }
+                                                        else
+                                                        {
+                                                        /* variable-length ("0" length) records have no initial state */
+                                                        }
+                                                }
+                                                else
+                                                {
+                                                if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
+                                                        {
+                                                        if(value_change_callback)
+                                                                {
+								if(xc->signal_lens[idx] > xc->longest_signal_value_len)
+									{
+									chk_report_abort("TALOS-2023-1797");
+									}
+                                                                memcpy(xc->temp_signal_value_buf, mu+sig_offs, xc->signal_lens[idx]);
+                                                                xc->temp_signal_value_buf[xc->signal_lens[idx]] = 0;
+                                                                value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
+                                                                }
+                                                                else
+                                                                {
+                                                                if(fv)
+                                                                        {
+                                                                        char vcd_id[16];
+                                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+
+                                                                        vcd_id[0] = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
+                                                                        fstWritex(xc, vcd_id, 1);
+									if((sig_offs + xc->signal_lens[idx]) > frame_uclen)
+										{
+										chk_report_abort("TALOS-2023-1793");
+										}
+                                                                        fstWritex(xc,mu+sig_offs, xc->signal_lens[idx]);
+
+                                                                        vcd_id[0] = ' '; /* collapse 3 writes into one I/O call */
+                                                                        vcd_id[vcdid_len + 1] = '\n';
+                                                                        fstWritex(xc, vcd_id, vcdid_len + 2);
+                                                                        }
+                                                                }
+                                                        }
+                                                        else
+                                                        {
+                                                        double d;
+                                                        unsigned char *clone_d;
+                                                        unsigned char *srcdata = mu+sig_offs;
+
+                                                        if(value_change_callback)
+                                                                {
+                                                                if(xc->native_doubles_for_cb)
+                                                                        {
+                                                                        if(xc->double_endian_match)
+                                                                                {
+                                                                                clone_d = srcdata;
+                                                                                }
+                                                                                else
+                                                                                {
+                                                                                int j;
+
+                                                                                clone_d = (unsigned char *)&d;
+                                                                                for(j=0;j<8;j++)
+                                                                                        {
+                                                                                        clone_d[j] = srcdata[7-j];
+                                                                                        }
+                                                                                }
+                                                                        value_change_callback(user_callback_data_pointer, beg_tim, idx+1, clone_d);
+                                                                        }
+                                                                        else
+                                                                        {
+                                                                        clone_d = (unsigned char *)&d;
+                                                                        if(xc->double_endian_match)
+                                                                                {
+                                                                                memcpy(clone_d, srcdata, 8);
+                                                                                }
+                                                                                else
+                                                                                {
+                                                                                int j;
+
+                                                                                for(j=0;j<8;j++)
+                                                                                        {
+                                                                                        clone_d[j] = srcdata[7-j];
+                                                                                        }
+                                                                                }
+                                                                        snprintf((char *)xc->temp_signal_value_buf, xc->longest_signal_value_len + 1, "%.16g", d);
+                                                                        value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
+                                                                        }
+                                                                }
+                                                                else
+                                                                {
+                                                                if(fv)
+                                                                        {
+                                                                        char vcdid_buf[16];
+                                                                        char wx_buf[64];
+                                                                        int wx_len;
+
+                                                                        clone_d = (unsigned char *)&d;
+                                                                        if(xc->double_endian_match)
+                                                                                {
+                                                                                memcpy(clone_d, srcdata, 8);
+                                                                                }
+                                                                                else
+                                                                                {
+                                                                                int j;
+
+                                                                                for(j=0;j<8;j++)
+                                                                                        {
+                                                                                        clone_d[j] = srcdata[7-j];
+                                                                                        }
+                                                                                }
+
+                                                                        fstVcdID(vcdid_buf, idx+1);
+                                                                        wx_len = snprintf(wx_buf, 64, "r%.16g %s\n", d, vcdid_buf);
+                                                                        fstWritex(xc, wx_buf, wx_len);
+                                                                        }
+                                                                }
+                                                        }
+                                                }
+                                        }
+
+                                sig_offs += xc->signal_lens[idx];
+                                }
+
+                        free(mu_alloc);
+                        }
+                }
+
+        fstReaderFseeko(xc, xc->f, frame_pos + (fst_off_t)frame_clen, SEEK_SET); /* skip past compressed data */
+
+        vc_maxhandle = fstReaderVarint64(xc->f);
+        vc_start = ftello(xc->f);       /* points to '!' character */
+        packtype = fgetc(xc->f);
+
+#ifdef FST_DEBUG
+        fprintf(stderr, FST_APIMESS "frame_uclen: %d, frame_clen: %d, frame_maxhandle: %d\n",
+                (int)frame_uclen, (int)frame_clen, (int)frame_maxhandle);
+        fprintf(stderr, FST_APIMESS "vc_maxhandle: %d, packtype: %c\n", (int)vc_maxhandle, packtype);
+#endif
+
+        indx_pntr = blkpos + seclen - 24 -tsec_clen -8;
+        fstReaderFseeko(xc, xc->f, indx_pntr, SEEK_SET);
+        chain_clen = fstReaderUint64(xc->f);
+        indx_pos = indx_pntr - chain_clen;
+#ifdef FST_DEBUG
+        fprintf(stderr, FST_APIMESS "indx_pos: %d (%d bytes)\n", (int)indx_pos, (int)chain_clen);
+#endif
+        chain_cmem = fstReaderFetch(xc, indx_pos, chain_clen, &chain_cmem_alloc);
+        if(!chain_cmem) goto block_err;
+
+        if(vc_maxhandle > vc_maxhandle_largest)
+                {
+                free(chain_table);
+                free(chain_table_lengths);
+
+                vc_maxhandle_largest = vc_maxhandle;
+
+		if(!(vc_maxhandle+1))
+			{
+			chk_report_abort("TALOS-2023-1798");
+			}
+
+		if(sizeof(size_t) < sizeof(uint64_t))
+			{
+			/* TALOS-2023-1798 for 32b overflow */
+			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(fst_off_t);
+			size_t   chk_32 = ((size_t)(vc_maxhandle+1)) * sizeof(fst_off_t);
+			if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1798");
+			}
+		else
+			{
+			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(fst_off_t);
+				if((chk_64/sizeof(fst_off_t)) != (vc_maxhandle+1))
+				{
+				chk_report_abort("TALOS-2023-1798");
+				}
+			}
+                chain_table = (fst_off_t *)calloc((vc_maxhandle+1), sizeof(fst_off_t));
+
+		if(sizeof(size_t) < sizeof(uint64_t))
+			{
+			/* TALOS-2023-1798 for 32b overflow */
+			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(uint32_t);
+			size_t   chk_32 = ((size_t)(vc_maxhandle+1)) * sizeof(uint32_t);
+			if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1798");
+			}
+		else
+			{
+			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(uint32_t);
+				if((chk_64/sizeof(uint32_t)) != (vc_maxhandle+1))
+				{
+				chk_report_abort("TALOS-2023-1798");
+				}
+			}
+                chain_table_lengths = (uint32_t *)calloc((vc_maxhandle+1), sizeof(uint32_t));
+                }
+
+        if(!chain_table || !chain_table_lengths) goto block_err;
+
+        pnt = chain_cmem;
+        idx = 0;
+        pval = 0;
+
+        if(sectype == FST_BL_VCDATA_DYN_ALIAS2)
+                {
+                uint32_t prev_alias = 0;
+
+                do      {
+                        int skiplen;
+
+                        if(*pnt & 0x01)
+                                {
+                                int64_t shval = fstGetSVarint64(pnt, &skiplen) >> 1;
+                                if(shval > 0)
+                                        {
+                                        pval = chain_table[idx] = pval + shval;
+                                        if(idx) { chain_table_lengths[pidx] = pval - chain_table[pidx]; }
+                                        pidx = idx++;
+                                        }
+                                else if(shval < 0)
+                                        {
+                                        chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
+                                        chain_table_lengths[idx] = prev_alias = shval;          /* because during this loop iter would give stale data! */
+                                        idx++;
+                                        }
+                                else
+                                        {
+                                        chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
+                                        chain_table_lengths[idx] = prev_alias;                  /* because during this loop iter would give stale data! */
+                                        idx++;
+                                        }
+                                }
+                                else
+                                {
+                                uint64_t val = fstGetVarint32(pnt, &skiplen);
+
+                                fstHandle loopcnt = val >> 1;
+				if((idx+loopcnt-1) > vc_maxhandle) /* TALOS-2023-1789 */
+					{
+					chk_report_abort("TALOS-2023-1789");
+					}
+
+                                for(i=0;i<loopcnt;i++)
+                                        {
+                                        chain_table[idx++] = 0;
+                                        }
+                                }
+
+                        pnt += skiplen;
+                        } while (pnt != (chain_cmem + chain_clen));
+                }
+                else
+                {
+                do      {
+                        int skiplen;
+                        uint64_t val = fstGetVarint32(pnt, &skiplen);
+
+                        if(!val)
+                                {
+                                pnt += skiplen;
+                                val = fstGetVarint32(pnt, &skiplen);
+                                chain_table[idx] = 0;                   /* need to explicitly zero as calloc above might not run */
+                                chain_table_lengths[idx] = -val;        /* because during this loop iter would give stale data! */
+                                idx++;
+                                }
+                        else
+                        if(val&1)
+                                {
+                                pval = chain_table[idx] = pval + (val >> 1);
+                                if(idx) { chain_table_lengths[pidx] = pval - chain_table[pidx]; }
+                                pidx = idx++;
+                                }
+                        else
+                                {
+                                fstHandle loopcnt = val >> 1;
+
+				if((idx+loopcnt-1) > vc_maxhandle) /* TALOS-2023-1789 */
+					{
+					chk_report_abort("TALOS-2023-1789");
+					}
+
+                                for(i=0;i<loopcnt;i++)
+                                        {
+                                        chain_table[idx++] = 0;
+                                        }
+                                }
+
+                        pnt += skiplen;
+                        } while (pnt != (chain_cmem + chain_clen));
+                }
+
+        chain_table[idx] = indx_pos - vc_start;
+        chain_table_lengths[pidx] = chain_table[idx] - chain_table[pidx];
+
+        for(i=0;i<idx;i++)
+                {
+                int32_t v32 = chain_table_lengths[i];
+                if((v32 < 0) && (!chain_table[i]))
+                        {
+                        v32 = -v32;
+                        v32--;
+                        if(((uint32_t)v32) < i) /* sanity check */
+                                {
+                                chain_table[i] = chain_table[v32];
+                                chain_table_lengths[i] = chain_table_lengths[v32];
+                                }
+                        }
+                }
+
+#ifdef FST_DEBUG
+        fprintf(stderr, FST_APIMESS "decompressed chain idx len: %" PRIu32 "\n", idx);
+#endif
+
+        mc_mem_len = 16384;
+        mc_mem = (unsigned char *)malloc(mc_mem_len); /* buffer for compressed reads */
+
+        /* check compressed VC data */
+        if(idx > xc->maxhandle) idx = xc->maxhandle;
+        for(i=0;i<idx;i++)
+                {
+                if(chain_table[i])
+                        {
+                        int process_idx = i/8;
+                        int process_bit = i&7;
+
+                        if(xc->process_mask[process_idx]&(1<<process_bit))
+                                {
+                                int rc = Z_OK;
+                                uint32_t val;
+                                uint32_t skiplen;
+                                uint32_t tdelta;
+                                unsigned char *mapped = NULL;
+
+                                if(xc->fmap && ((uint64_t)(vc_start + chain_table[i]) + chain_table_lengths[i] + 5 <= xc->fmap_len)) /* 5: varint */
+                                        {
+                                        int mskiplen;
+
+                                        mapped = xc->fmap + vc_start + chain_table[i];
+                                        val = fstGetVarint32(mapped, &mskiplen);
+                                        skiplen = mskiplen;
+                                        mapped += skiplen;
+                                        }
+                                        else
+                                        {
+                                        fstReaderFseeko(xc, xc->f, vc_start + chain_table[i], SEEK_SET);
+                                        val = fstReaderVarint32WithSkip(xc->f, &skiplen);
+                                        }
+
+                                if(val)
+                                        {
+                                        unsigned char *mu = mem_for_traversal + traversal_mem_offs; /* uncomp: dst */
+                                        unsigned char *mc;                                          /* comp:   src */
+                                        unsigned long destlen = val;
+                                        unsigned long sourcelen = chain_table_lengths[i];
+
+					if(traversal_mem_offs >= mem_required_for_traversal)
+						{
+						chk_report_abort("TALOS-2023-1785");
+						}
+
+                                        if(mapped)
+                                                {
+                                                mc = mapped;
+                                                }
+                                                else
+                                                {
+                                                if(mc_mem_len < chain_table_lengths[i])
+                                                        {
+                                                        free(mc_mem);
+                                                        mc_mem = (unsigned char *)malloc(mc_mem_len = chain_table_lengths[i]);
+                                                        }
+                                                mc = mc_mem;
+
+                                                fstFread(mc, chain_table_lengths[i], 1, xc->f);
+                                                }
+
+                                        switch(packtype)
+                                                {
+                                                case '4': rc = (destlen == (unsigned long)LZ4_decompress_safe_partial((char *)mc, (char *)mu, sourcelen, destlen, destlen)) ? Z_OK : Z_DATA_ERROR;
+                                                          break;
+                                                case 'F': fastlz_decompress(mc, sourcelen, mu, destlen); /* rc appears unreliable */
+                                                          break;
+                                                default:  rc = uncompress(mu, &destlen, mc, sourcelen);
+                                                          break;
+                                                }
+
+                                        /* data to process is for(j=0;j<destlen;j++) in mu[j] */
+                                        headptr[i] = traversal_mem_offs;
+                                        length_remaining[i] = val;
+                                        traversal_mem_offs += val;
+                                        }
+                                        else
+                                        {
+                                        int destlen = chain_table_lengths[i] - skiplen;
+                                        unsigned char *mu = mem_for_traversal + traversal_mem_offs;
+
+					if(traversal_mem_offs >= mem_required_for_traversal)
+						{
+						chk_report_abort("TALOS-2023-1785");
+						}
+
+                                        if(mapped)
+                                                {
+                                                memcpy(mu, mapped, destlen);
+                                                }
+                                                else
+                                                {
+                                                fstFread(mu, destlen, 1, xc->f);
+                                                }
+                                        /* data to process is for(j=0;j<destlen;j++) in mu[j] */
+                                        headptr[i] = traversal_mem_offs;
+                                        length_remaining[i] = destlen;
+                                        traversal_mem_offs += destlen;
+                                        }
+
+                                if(rc != Z_OK)
+                                        {
+                                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), fac: %d clen: %d (rc=%d), exiting.\n", (int)i, (int)val, rc);
+                                        exit(255);
+                                        }
+
+                                if(xc->signal_lens[i] == 1)
+                                        {
+                                        uint32_t vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[i]);
+                                        uint32_t shcnt = 2 << (vli & 1);
+                                        tdelta = vli >> shcnt;
+                                        }
+                                        else
+                                        {
+                                        uint32_t vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[i]);
+                                        tdelta = vli >> 1;
+                                        }
+
+				if(tdelta >= tc_head_items)
+					{
+					chk_report_abort("TALOS-2023-1791");
+					}
+
+                                scatterptr[i] = tc_head[tdelta];
+                                tc_head[tdelta] = i+1;
+                                }
+                        }
+                }
+
+        free(mc_mem); /* there is no usage below for this, no real need to clear out mc_mem or mc_mem_len */
+
+        for(i=0;i<tsec_nitems;i++)
+                {
+                uint32_t tdelta;
+                int skiplen, skiplen2;
+                uint32_t vli;
+
+                if(fv)
+                        {
+                        char wx_buf[32];
+                        int wx_len;
+
+                        if(time_table[i] != previous_time)
+                                {
+                                if(xc->limit_range_valid)
                                         {
-                                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), frame uncompress rc: %d, exiting.\n", rc);
-                                        exit(255);
+                                        if(time_table[i] > xc->limit_range_end)
+                                                {
+                                                break;
+                                                }
+                                        }
+
+				if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
+                                wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", time_table[i]);
+                                fstWritex(xc, wx_buf, wx_len);
+				if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
+
+                                if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
+                                        {
+                                        if(time_table[i] == xc->blackout_times[cur_blackout])
+                                                {
+                                                wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
+                                                fstWritex(xc, wx_buf, wx_len);
+                                                }
+                                        }
+                                previous_time = time_table[i];
+                                }
+                        }
+
+                while(tc_head[i])
+                        {
+                        idx = tc_head[i] - 1;
+                        vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
+
+                        if(xc->signal_lens[idx] <= 1)
+                                {
+                                if(xc->signal_lens[idx] == 1)
+                                        {
+                                        unsigned char val;
+                                        if(!(vli & 1))
+                                                {
+                                                /* tdelta = vli >> 2; */ /* scan-build */
+                                                val = ((vli >> 1) & 1) | '0';
+                                                }
+                                                else
+                                                {
+                                                /* tdelta = vli >> 4; */ /* scan-build */
+                                                val = FST_RCV_STR[((vli >> 1) & 7)];
+                                                }
+
+                                        if(value_change_callback)
+                                                {
+                                                xc->temp_signal_value_buf[0] = val;
+                                                xc->temp_signal_value_buf[1] = 0;
+                                                value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
+                                                }
+                                                else
+                                                {
+                                                if(fv)
+                                                        {
+                                                        char vcd_id[16];
+                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+
+                                                        vcd_id[0] = val;
+                                                        vcd_id[vcdid_len+1] = '\n';
+                                                        fstWritex(xc, vcd_id, vcdid_len+2);
+                                                        }
+                                                }
+                                        headptr[idx] += skiplen;
+                                        length_remaining[idx] -= skiplen;
+
+                                        tc_head[i] = scatterptr[idx];
+                                        scatterptr[idx] = 0;
+
+                                        if(length_remaining[idx])
+                                                {
+                                                int shamt;
+                                                vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
+                                                shamt = 2 << (vli & 1);
+                                                tdelta = vli >> shamt;
+
+						if((tdelta+i) >= tc_head_items)
+							{
+							chk_report_abort("TALOS-2023-1791");
+							}
+
+                                                scatterptr[idx] = tc_head[i+tdelta];
+                                                tc_head[i+tdelta] = idx+1;
+                                                }
+                                        }
+                                        else
+                                        {
+                                        unsigned char *vdata;
+                                        uint32_t len;
+
+                                        vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
+                                        len = fstGetVarint32(mem_for_traversal + headptr[idx] + skiplen, &skiplen2);
+                                        /* tdelta = vli >> 1; */ /* scan-build */
+                                        skiplen += skiplen2;
+                                        vdata = mem_for_traversal + headptr[idx] + skiplen;
+
+                                        if(!(vli & 1))
+                                                {
+                                                if(value_change_callback_varlen)
+                                                        {
+                                                        value_change_callback_varlen(user_callback_data_pointer, time_table[i], idx+1, vdata, len);
+                                                        }
+                                                        else
+                                                        {
+                                                        if(fv)
+                                                                {
+                                                                char vcd_id[16];
+                                                                int vcdid_len;
+
+                                                                vcd_id[0] = 's';
+                                                                fstWritex(xc, vcd_id, 1);
+
+                                                                vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+                                                                {
+								if(sizeof(size_t) < sizeof(uint64_t))
+                							{
+                							/* TALOS-2023-1790 for 32b overflow */
+                							uint64_t chk_64 = len*4 + 1;
+                							size_t   chk_32 = len*4 + 1;
+                							if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1790");
+                							}
+
+                                                                unsigned char *vesc = (unsigned char *)malloc(len*4 + 1);
+                                                                int vlen = fstUtilityBinToEsc(vesc, vdata, len);
+                                                                fstWritex(xc, vesc, vlen);
+                                                                free(vesc);
+                                                                }
+
+                                                                vcd_id[0] = ' ';
+                                                                vcd_id[vcdid_len + 1] = '\n';
+                                                                fstWritex(xc, vcd_id, vcdid_len+2);
+                                                                }
+                                                        }
+                                                }
+
+                                        skiplen += len;
+                                        headptr[idx] += skiplen;
+                                        length_remaining[idx] -= skiplen;
+
+                                        tc_head[i] = scatterptr[idx];
+                                        scatterptr[idx] = 0;
+
+                                        if(length_remaining[idx])
+                                                {
+                                                vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
+                                                tdelta = vli >> 1;
+
+						if((tdelta+i) >= tc_head_items)
+							{
+							chk_report_abort("TALOS-2023-1791");
+							}
+
+                                                scatterptr[idx] = tc_head[i+tdelta];
+                                                tc_head[i+tdelta] = idx+1;
+                                                }
                                         }
-                                free(mc);
                                 }
+                                else
+                                {
+                                uint32_t len = xc->signal_lens[idx];
+                                unsigned char *vdata;
+
+                                vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
+                                /* tdelta = vli >> 1; */ /* scan-build */
+                                vdata = mem_for_traversal + headptr[idx] + skiplen;
+
+                                if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
+                                        {
+					if(len > xc->longest_signal_value_len)
+						{
+						chk_report_abort("TALOS-2023-1797");
+						}
+
+                                        if(!(vli & 1))
+                                                {
+                                                int byte = 0;
+                                                int bit;
+                                                unsigned int j;
+
+                                                for(j=0;j<len;j++)
+                                                        {
+                                                        unsigned char ch;
+                                                        byte = j/8;
+                                                        bit = 7 - (j & 7);
+                                                        ch = ((vdata[byte] >> bit) & 1) | '0';
+                                                        xc->temp_signal_value_buf[j] = ch;
+                                                        }
+                                                xc->temp_signal_value_buf[j] = 0;
+
+                                                if(value_change_callback)
+                                                        {
+                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
+                                                        }
+                                                        else
+                                                        {
+                                                        if(fv)  {
+                                                                unsigned char ch_bp = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
+
+                                                                fstWritex(xc, &ch_bp, 1);
+                                                                fstWritex(xc, xc->temp_signal_value_buf, len);
+                                                                }
+                                                        }
+
+                                                len = byte+1;
+                                                }
+                                                else
+                                                {
+                                                if(value_change_callback)
+                                                        {
+                                                        memcpy(xc->temp_signal_value_buf, vdata, len);
+                                                        xc->temp_signal_value_buf[len] = 0;
+                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
+                                                        }
+                                                        else
+                                                        {
+                                                        if(fv)
+                                                                {
+                                                                unsigned char ch_bp =  (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
+								uint64_t mem_required_for_traversal_chk = vdata - mem_for_traversal + len;
+
+                                                                fstWritex(xc, &ch_bp, 1);
+								if(mem_required_for_traversal_chk > mem_required_for_traversal)
+									{
+									chk_report_abort("TALOS-2023-1793");
+									}
+                                                                fstWritex(xc, vdata, len);
+                                                                }
+                                                        }
+                                                }
+                                        }
+                                        else
+                                        {
+                                        double d;
+                                        unsigned char *clone_d /*= (unsigned char *)&d */; /* scan-build */
+                                        unsigned char buf[8];
+                                        unsigned char *srcdata;
+
+                                        if(!(vli & 1))  /* very rare case, but possible */
+                                                {
+                                                int bit;
+                                                int j;
 
+                                                for(j=0;j<8;j++)
+                                                        {
+                                                        unsigned char ch;
+                                                        bit = 7 - (j & 7);
+                                                        ch = ((vdata[0] >> bit) & 1) | '0';
+                                                        buf[j] = ch;
+                                                        }
 
-                        for(idx=0;idx<frame_maxhandle;idx++)
-                                {
-                                int process_idx = idx/8;
-                                int process_bit = idx&7;
+                                                len = 1;
+                                                srcdata = buf;
+                                                }
+                                                else
+                                                {
+                                                srcdata = vdata;
+                                                }
 
-                                if(xc->process_mask[process_idx]&(1<<process_bit))
-                                        {
-                                        if(xc->signal_lens[idx] <= 1)
+                                        if(value_change_callback)
                                                 {
-                                                if(xc->signal_lens[idx] == 1)
+                                                if(xc->native_doubles_for_cb)
                                                         {
-                                                        unsigned char val = mu[sig_offs];
-                                                        if(value_change_callback)
+                                                        if(xc->double_endian_match)
                                                                 {
-                                                                xc->temp_signal_value_buf[0] = val;
-                                                                xc->temp_signal_value_buf[1] = 0;
-                                                                value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
+                                                                clone_d = srcdata;
                                                                 }
                                                                 else
                                                                 {
-                                                                if(fv)
-                                                                        {
-                                                                        char vcd_id[16];
+                                                                int j;
 
-                                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
-                                                                        vcd_id[0] = val; /* collapse 3 writes into one I/O call */
-                                                                        vcd_id[vcdid_len + 1] = '\n';
-                                                                        fstWritex(xc, vcd_id, vcdid_len + 2);
+                                                                clone_d = (unsigned char *)&d;
+                                                                for(j=0;j<8;j++)
+                                                                        {
+                                                                        clone_d[j] = srcdata[7-j];
                                                                         }
                                                                 }
+                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, clone_d);
                                                         }
                                                         else
                                                         {
-                                                        /* variable-length ("0" length) records have no initial state */
-                                                        }
-                                                }
-                                                else
-                                                {
-                                                if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
-                                                        {
-                                                        if(value_change_callback)
+                                                        clone_d = (unsigned char *)&d;
+                                                        if(xc->double_endian_match)
                                                                 {
-								if(xc->signal_lens[idx] > xc->longest_signal_value_len)
-									{
-									chk_report_abort("TALOS-2023-1797");
-									}
-                                                                memcpy(xc->temp_signal_value_buf, mu+sig_offs, xc->signal_lens[idx]);
-                                                                xc->temp_signal_value_buf[xc->signal_lens[idx]] = 0;
-                                                                value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
+                                                                memcpy(clone_d, srcdata, 8);
                                                                 }
                                                                 else
                                                                 {
-                                                                if(fv)
-                                                                        {
-                                                                        char vcd_id[16];
-                                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
-
-                                                                        vcd_id[0] = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
-                                                                        fstWritex(xc, vcd_id, 1);
-									if((sig_offs + xc->signal_lens[idx]) > frame_uclen)
-										{
-										chk_report_abort("TALOS-2023-1793");
-										}
-                                                                        fstWritex(xc,mu+sig_offs, xc->signal_lens[idx]);
+                                                                int j;
 
-                                                                        vcd_id[0] = ' '; /* collapse 3 writes into one I/O call */
-                                                                        vcd_id[vcdid_len + 1] = '\n';
-                                                                        fstWritex(xc, vcd_id, vcdid_len + 2);
+                                                                for(j=0;j<8;j++)
+                                                                        {
+                                                                        clone_d[j] = srcdata[7-j];
                                                                         }
                                                                 }
+                                                        snprintf((char *)xc->temp_signal_value_buf, xc->longest_signal_value_len + 1, "%.16g", d);
+                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
                                                         }
-                                                        else
+                                                }
+                                                else
+                                                {
+                                                if(fv)
                                                         {
-                                                        double d;
-                                                        unsigned char *clone_d;
-                                                        unsigned char *srcdata = mu+sig_offs;
+                                                        char wx_buf[32];
+                                                        int wx_len;
 
-                                                        if(value_change_callback)
+                                                        clone_d = (unsigned char *)&d;
+                                                        if(xc->double_endian_match)
                                                                 {
-                                                                if(xc->native_doubles_for_cb)
-                                                                        {
-                                                                        if(xc->double_endian_match)
-                                                                                {
-                                                                                clone_d = srcdata;
-                                                                                }
-                                                                                else
-                                                                                {
-                                                                                int j;
-
-                                                                                clone_d = (unsigned char *)&d;
-                                                                                for(j=0;j<8;j++)
-                                                                                        {
-                                                                                        clone_d[j] = srcdata[7-j];
-                                                                                        }
-                                                                                }
-                                                                        value_change_callback(user_callback_data_pointer, beg_tim, idx+1, clone_d);
-                                                                        }
-                                                                        else
-                                                                        {
-                                                                        clone_d = (unsigned char *)&d;
-                                                                        if(xc->double_endian_match)
-                                                                                {
-                                                                                memcpy(clone_d, srcdata, 8);
-                                                                                }
-                                                                                else
-                                                                                {
-                                                                                int j;
-
-                                                                                for(j=0;j<8;j++)
-                                                                                        {
-                                                                                        clone_d[j] = srcdata[7-j];
-                                                                                        }
-                                                                                }
-                                                                        snprintf((char *)xc->temp_signal_value_buf, xc->longest_signal_value_len + 1, "%.16g", d);
-                                                                        value_change_callback(user_callback_data_pointer, beg_tim, idx+1, xc->temp_signal_value_buf);
-                                                                        }
+                                                                memcpy(clone_d, srcdata, 8);
                                                                 }
                                                                 else
                                                                 {
-                                                                if(fv)
-                                                                        {
-                                                                        char vcdid_buf[16];
-                                                                        char wx_buf[64];
-                                                                        int wx_len;
-
-                                                                        clone_d = (unsigned char *)&d;
-                                                                        if(xc->double_endian_match)
-                                                                                {
-                                                                                memcpy(clone_d, srcdata, 8);
-                                                                                }
-                                                                                else
-                                                                                {
-                                                                                int j;
-
-                                                                                for(j=0;j<8;j++)
-                                                                                        {
-                                                                                        clone_d[j] = srcdata[7-j];
-                                                                                        }
-                                                                                }
+                                                                int j;
 
-                                                                        fstVcdID(vcdid_buf, idx+1);
-                                                                        wx_len = snprintf(wx_buf, 64, "r%.16g %s\n", d, vcdid_buf);
-                                                                        fstWritex(xc, wx_buf, wx_len);
+                                                                for(j=0;j<8;j++)
+                                                                        {
+                                                                        clone_d[j] = srcdata[7-j];
                                                                         }
                                                                 }
+
+                                                        wx_len = snprintf(wx_buf, 32, "r%.16g", d);
+                                                        fstWritex(xc, wx_buf, wx_len);
                                                         }
                                                 }
                                         }
 
-                                sig_offs += xc->signal_lens[idx];
-                                }
-
-                        free(mu);
-                        fstReaderFseeko(xc, xc->f, -((fst_off_t)frame_clen), SEEK_CUR);
-                        }
-                }
-
-        fstReaderFseeko(xc, xc->f, (fst_off_t)frame_clen, SEEK_CUR); /* skip past compressed data */
+                                if(fv)
+                                        {
+                                        char vcd_id[16];
+                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+                                        vcd_id[0] = ' ';
+                                        vcd_id[vcdid_len+1] = '\n';
+                                        fstWritex(xc, vcd_id, vcdid_len+2);
+                                        }
 
-        vc_maxhandle = fstReaderVarint64(xc->f);
-        vc_start = ftello(xc->f);       /* points to '!' character */
-        packtype = fgetc(xc->f);
+                                skiplen += len;
+                                headptr[idx] += skiplen;
+                                length_remaining[idx] -= skiplen;
 
-#ifdef FST_DEBUG
-        fprintf(stderr, FST_APIMESS "frame_uclen: %d, frame_clen: %d, frame_maxhandle: %d\n",
-                (int)frame_uclen, (int)frame_clen, (int)frame_maxhandle);
-        fprintf(stderr, FST_APIMESS "vc_maxhandle: %d, packtype: %c\n", (int)vc_maxhandle, packtype);
-#endif
+                                tc_head[i] = scatterptr[idx];
+                                scatterptr[idx] = 0;
 
-        indx_pntr = blkpos + seclen - 24 -tsec_clen -8;
-        fstReaderFseeko(xc, xc->f, indx_pntr, SEEK_SET);
-        chain_clen = fstReaderUint64(xc->f);
-        indx_pos = indx_pntr - chain_clen;
-#ifdef FST_DEBUG
-        fprintf(stderr, FST_APIMESS "indx_pos: %d (%d bytes)\n", (int)indx_pos, (int)chain_clen);
-#endif
-        chain_cmem = (unsigned char *)malloc(chain_clen);
-        if(!chain_cmem) goto block_err;
-        fstReaderFseeko(xc, xc->f, indx_pos, SEEK_SET);
-        fstFread(chain_cmem, chain_clen, 1, xc->f);
+                                if(length_remaining[idx])
+                                        {
+                                        vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
+                                        tdelta = vli >> 1;
 
-        if(vc_maxhandle > vc_maxhandle_largest)
-                {
-                free(chain_table);
-                free(chain_table_lengths);
+					if((tdelta+i) >= tc_head_items)
+						{
+						chk_report_abort("TALOS-2023-1791");
+						}
 
-                vc_maxhandle_largest = vc_maxhandle;
+                                        scatterptr[idx] = tc_head[i+tdelta];
+                                        tc_head[i+tdelta] = idx+1;
+                                        }
+                                }
+                        }
+                }
 
-		if(!(vc_maxhandle+1))
-			{
-			chk_report_abort("TALOS-2023-1798");
-			}
+block_err:
+        free(tc_head);
+        free(chain_cmem_alloc); chain_cmem_alloc = NULL;
+        free(mem_for_traversal); mem_for_traversal = NULL;
 
-		if(sizeof(size_t) < sizeof(uint64_t))
-			{
-			/* TALOS-2023-1798 for 32b overflow */
-			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(fst_off_t);
-			size_t   chk_32 = ((size_t)(vc_maxhandle+1)) * sizeof(fst_off_t);
-			if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1798");
-			}
-		else
-			{
-			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(fst_off_t);
-				if((chk_64/sizeof(fst_off_t)) != (vc_maxhandle+1))
-				{
-				chk_report_abort("TALOS-2023-1798");
-				}
-			}
-                chain_table = (fst_off_t *)calloc((vc_maxhandle+1), sizeof(fst_off_t));
+        secnum++;
+        if(secnum == xc->vc_section_count) break; /* in case file is growing, keep with original block count */
+        blkpos += seclen;
+        }
 
-		if(sizeof(size_t) < sizeof(uint64_t))
-			{
-			/* TALOS-2023-1798 for 32b overflow */
-			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(uint32_t);
-			size_t   chk_32 = ((size_t)(vc_maxhandle+1)) * sizeof(uint32_t);
-			if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1798");
-			}
-		else
-			{
-			uint64_t chk_64 = (vc_maxhandle+1) * sizeof(uint32_t);
-				if((chk_64/sizeof(uint32_t)) != (vc_maxhandle+1))
-				{
-				chk_report_abort("TALOS-2023-1798");
-				}
-			}
-                chain_table_lengths = (uint32_t *)calloc((vc_maxhandle+1), sizeof(uint32_t));
-                }
+if(mem_for_traversal) free(mem_for_traversal); /* scan-build */
+free(length_remaining);
+free(headptr);
+free(scatterptr);
 
-        if(!chain_table || !chain_table_lengths) goto block_err;
+if(chain_table) free(chain_table);
+if(chain_table_lengths) free(chain_table_lengths);
 
-        pnt = chain_cmem;
-        idx = 0;
-        pval = 0;
+free(time_table);
 
-        if(sectype == FST_BL_VCDATA_DYN_ALIAS2)
-                {
-                uint32_t prev_alias = 0;
+#ifndef FST_WRITEX_DISABLE
+if(fv)
+        {
+        fstWritex(xc, NULL, 0);
+        }
+#endif
 
-                do      {
-                        int skiplen;
+return(1);
+}
 
-                        if(*pnt & 0x01)
-                                {
-                                int64_t shval = fstGetSVarint64(pnt, &skiplen) >> 1;
-                                if(shval > 0)
-                                        {
-                                        pval = chain_table[idx] = pval + shval;
-                                        if(idx) { chain_table_lengths[pidx] = pval - chain_table[pidx]; }
-                                        pidx = idx++;
-                                        }
-                                else if(shval < 0)
-                                        {
-                                        chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
-                                        chain_table_lengths[idx] = prev_alias = shval;          /* because during this loop iter would give stale data! */
-                                        idx++;
-                                        }
-                                else
-                                        {
-                                        chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
-                                        chain_table_lengths[idx] = prev_alias;                  /* because during this loop iter would give stale data! */
-                                        idx++;
-                                        }
-                                }
-                                else
-                                {
-                                uint64_t val = fstGetVarint32(pnt, &skiplen);
 
-                                fstHandle loopcnt = val >> 1;
-				if((idx+loopcnt-1) > vc_maxhandle) /* TALOS-2023-1789 */
-					{
-					chk_report_abort("TALOS-2023-1789");
-					}
+/* rvat functions */
 
-                                for(i=0;i<loopcnt;i++)
-                                        {
-                                        chain_table[idx++] = 0;
-                                        }
-                                }
+static char *fstExtractRvatDataFromFrame(struct fstReaderContext *xc, struct fstRvatBlock *blk, fstHandle facidx, char *buf)
+{
+if(facidx >= blk->frame_maxhandle)
+        {
+        return(NULL);
+        }
 
-                        pnt += skiplen;
-                        } while (pnt != (chain_cmem + chain_clen));
+if(xc->signal_lens[facidx] == 1)
+        {
+        buf[0] = (char)blk->frame_data[xc->rvat_sig_offs[facidx]];
+        buf[1] = 0;
+        }
+        else
+        {
+        if(xc->signal_typs[facidx] != FST_VT_VCD_REAL)
+                {
+                memcpy(buf, blk->frame_data + xc->rvat_sig_offs[facidx], xc->signal_lens[facidx]);
+                buf[xc->signal_lens[facidx]] = 0;
                 }
                 else
                 {
-                do      {
-                        int skiplen;
-                        uint64_t val = fstGetVarint32(pnt, &skiplen);
+                double d;
+                unsigned char *clone_d = (unsigned char *)&d;
+                unsigned char *srcdata = blk->frame_data + xc->rvat_sig_offs[facidx];
 
-                        if(!val)
-                                {
-                                pnt += skiplen;
-                                val = fstGetVarint32(pnt, &skiplen);
-                                chain_table[idx] = 0;                   /* need to explicitly zero as calloc above might not run */
-                                chain_table_lengths[idx] = -val;        /* because during this loop iter would give stale data! */
-                                idx++;
-                                }
+                if(xc->double_endian_match)
+                        {
+                        memcpy(clone_d, srcdata, 8);
+                        }
                         else
-                        if(val&1)
+                        {
+                        int j;
+
+                        for(j=0;j<8;j++)
                                 {
-                                pval = chain_table[idx] = pval + (val >> 1);
-                                if(idx) { chain_table_lengths[pidx] = pval - chain_table[pidx]; }
-                                pidx = idx++;
+                                clone_d[j] = srcdata[7-j];
                                 }
-                        else
-                                {
-                                fstHandle loopcnt = val >> 1;
+                        }
 
-				if((idx+loopcnt-1) > vc_maxhandle) /* TALOS-2023-1789 */
-					{
-					chk_report_abort("TALOS-2023-1789");
-					}
+                snprintf((char *)buf, 32, "%.16g", d); /* this will write 18 bytes */
+                }
+        }
 
-                                for(i=0;i<loopcnt;i++)
-                                        {
-                                        chain_table[idx++] = 0;
-                                        }
-                                }
+return(buf);
+}
 
-                        pnt += skiplen;
-                        } while (pnt != (chain_cmem + chain_clen));
-                }
 
-        chain_table[idx] = indx_pos - vc_start;
-        chain_table_lengths[pidx] = chain_table[idx] - chain_table[pidx];
+/*
+ * walk the section chain once and remember where each value change block is,
+ * subsequent lookups are then a binary search on the block end times
+ */
+static void fstReaderBuildRvatIndex(struct fstReaderContext *xc)
+{
+fst_off_t blkpos = 0;
+uint64_t alloc_count = 0;
 
-        for(i=0;i<idx;i++)
-                {
-                int32_t v32 = chain_table_lengths[i];
-                if((v32 < 0) && (!chain_table[i]))
-                        {
-                        v32 = -v32;
-                        v32--;
-                        if(((uint32_t)v32) < i) /* sanity check */
-                                {
-                                chain_table[i] = chain_table[v32];
-                                chain_table_lengths[i] = chain_table_lengths[v32];
-                                }
-                        }
-                }
+xc->rvat_index_count = 0;
 
-#ifdef FST_DEBUG
-        fprintf(stderr, FST_APIMESS "decompressed chain idx len: %" PRIu32 "\n", idx);
-#endif
+for(;;)
+        {
+        int sectype;
+        uint64_t seclen;
 
-        mc_mem_len = 16384;
-        mc_mem = (unsigned char *)malloc(mc_mem_len); /* buffer for compressed reads */
+        fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
 
-        /* check compressed VC data */
-        if(idx > xc->maxhandle) idx = xc->maxhandle;
-        for(i=0;i<idx;i++)
+        sectype = fgetc(xc->f);
+        seclen = fstReaderUint64(xc->f);
+
+        if((sectype == EOF) || (sectype == FST_BL_SKIP) || (!seclen))
                 {
-                if(chain_table[i])
+                break;
+                }
+
+        blkpos++;
+        if((sectype == FST_BL_VCDATA) || (sectype == FST_BL_VCDATA_DYN_ALIAS) || (sectype == FST_BL_VCDATA_DYN_ALIAS2))
+                {
+                struct fstRvatIndexEntry *ent;
+
+                if(xc->rvat_index_count == alloc_count)
                         {
-                        int process_idx = i/8;
-                        int process_bit = i&7;
+                        alloc_count = alloc_count ? (alloc_count * 2) : 16;
+                        xc->rvat_index = (struct fstRvatIndexEntry *)realloc(xc->rvat_index, alloc_count * sizeof(struct fstRvatIndexEntry));
+                        }
 
-                        if(xc->process_mask[process_idx]&(1<<process_bit))
-                                {
-                                int rc = Z_OK;
-                                uint32_t val;
-                                uint32_t skiplen;
-                                uint32_t tdelta;
+                ent = &xc->rvat_index[xc->rvat_index_count++];
+                ent->beg_tim = fstReaderUint64(xc->f);
+                ent->end_tim = fstReaderUint64(xc->f);
+                ent->blkpos = blkpos;
+                ent->seclen = seclen;
+                ent->sectype = sectype;
+                }
 
-                                fstReaderFseeko(xc, xc->f, vc_start + chain_table[i], SEEK_SET);
-                                val = fstReaderVarint32WithSkip(xc->f, &skiplen);
-                                if(val)
-                                        {
-                                        unsigned char *mu = mem_for_traversal + traversal_mem_offs; /* uncomp: dst */
-                                        unsigned char *mc;                                          /* comp:   src */
-                                        unsigned long destlen = val;
-                                        unsigned long sourcelen = chain_table_lengths[i];
+        blkpos += seclen;
+        }
 
-					if(traversal_mem_offs >= mem_required_for_traversal)
-						{
-						chk_report_abort("TALOS-2023-1785");
-						}
+xc->rvat_index_valid = 1;
+}
 
-                                        if(mc_mem_len < chain_table_lengths[i])
-                                                {
-                                                free(mc_mem);
-                                                mc_mem = (unsigned char *)malloc(mc_mem_len = chain_table_lengths[i]);
-                                                }
-                                        mc = mc_mem;
 
-                                        fstFread(mc, chain_table_lengths[i], 1, xc->f);
+/*
+ * returns the index of the block holding the value at tim, a time that ends
+ * one block and starts the next is taken from the later block so that value
+ * changes at the boundary are seen
+ */
+static int fstReaderFindRvatIndex(struct fstReaderContext *xc, uint64_t tim, uint64_t *index)
+{
+uint64_t lo = 0, hi = xc->rvat_index_count;
 
-                                        switch(packtype)
-                                                {
-                                                case '4': rc = (destlen == (unsigned long)LZ4_decompress_safe_partial((char *)mc, (char *)mu, sourcelen, destlen, destlen)) ? Z_OK : Z_DATA_ERROR;
-                                                          break;
-                                                case 'F': fastlz_decompress(mc, sourcelen, mu, destlen); /* rc appears unreliable */
-                                                          break;
-                                                default:  rc = uncompress(mu, &destlen, mc, sourcelen);
-                                                          break;
-                                                }
+while(lo < hi)
+        {
+        uint64_t mid = lo + ((hi - lo) / 2);
 
-                                        /* data to process is for(j=0;j<destlen;j++) in mu[j] */
-                                        headptr[i] = traversal_mem_offs;
-                                        length_remaining[i] = val;
-                                        traversal_mem_offs += val;
-                                        }
-                                        else
-                                        {
-                                        int destlen = chain_table_lengths[i] - skiplen;
-                                        unsigned char *mu = mem_for_traversal + traversal_mem_offs;
+        if(xc->rvat_index[mid].end_tim < tim)
+                {
+                lo = mid + 1;
+                }
+                else
+                {
+                hi = mid;
+                }
+        }
 
-					if(traversal_mem_offs >= mem_required_for_traversal)
-						{
-						chk_report_abort("TALOS-2023-1785");
-						}
+if((lo == xc->rvat_index_count) || (xc->rvat_index[lo].beg_tim > tim))
+        {
+        return(0);
+        }
 
-                                        fstFread(mu, destlen, 1, xc->f);
-                                        /* data to process is for(j=0;j<destlen;j++) in mu[j] */
-                                        headptr[i] = traversal_mem_offs;
-                                        length_remaining[i] = destlen;
-                                        traversal_mem_offs += destlen;
-                                        }
+if((tim == xc->rvat_index[lo].end_tim) && (tim != xc->end_time) &&
+        ((lo + 1) < xc->rvat_index_count) && (xc->rvat_index[lo + 1].beg_tim == tim))
+        {
+        lo++;
+        }
 
-                                if(rc != Z_OK)
-                                        {
-                                        fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), fac: %d clen: %d (rc=%d), exiting.\n", (int)i, (int)val, rc);
-                                        exit(255);
-                                        }
+*index = lo;
+return(1);
+}
 
-                                if(xc->signal_lens[i] == 1)
-                                        {
-                                        uint32_t vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[i]);
-                                        uint32_t shcnt = 2 << (vli & 1);
-                                        tdelta = vli >> shcnt;
-                                        }
-                                        else
-                                        {
-                                        uint32_t vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[i]);
-                                        tdelta = vli >> 1;
-                                        }
 
-				if(tdelta >= tc_head_items)
-					{
-					chk_report_abort("TALOS-2023-1791");
-					}
+static void fstReaderLoadRvatBlock(struct fstReaderContext *xc, struct fstRvatBlock *blk, uint64_t index)
+{
+const struct fstRvatIndexEntry *ent = &xc->rvat_index[index];
+fst_off_t blkpos = ent->blkpos;
+uint64_t seclen = ent->seclen;
+int sectype = ent->sectype;
+uint64_t tsec_uclen = 0, tsec_clen = 0;
+uint64_t tsec_nitems;
+uint64_t frame_uclen, frame_clen;
+#ifdef FST_DEBUG
+uint64_t mem_required_for_traversal;
+#endif
+fst_off_t frame_pos, indx_pntr, indx_pos;
+long chain_clen;
+unsigned char *chain_cmem, *chain_cmem_alloc;
+unsigned char *pnt;
+fstHandle idx, pidx=0, i;
+uint64_t pval;
 
-                                scatterptr[i] = tc_head[tdelta];
-                                tc_head[tdelta] = i+1;
-                                }
-                        }
-                }
+blk->index = index;
+blk->beg_tim = ent->beg_tim;
+blk->end_tim = ent->end_tim;
 
-        free(mc_mem); /* there is no usage below for this, no real need to clear out mc_mem or mc_mem_len */
+fstReaderFseeko(xc, xc->f, blkpos + 24, SEEK_SET);
 
-        for(i=0;i<tsec_nitems;i++)
-                {
-                uint32_t tdelta;
-                int skiplen, skiplen2;
-                uint32_t vli;
+#ifdef FST_DEBUG
+mem_required_for_traversal =
+#endif
+        fstReaderUint64(xc->f);
 
-                if(fv)
-                        {
-                        char wx_buf[32];
-                        int wx_len;
+#ifdef FST_DEBUG
+fprintf(stderr, FST_APIMESS "rvat sec: %u seclen: %d begtim: %d endtim: %d\n",
+        (unsigned int)index, (int)seclen, (int)blk->beg_tim, (int)blk->end_tim);
+fprintf(stderr, FST_APIMESS "mem_required_for_traversal: %d\n", (int)mem_required_for_traversal);
+#endif
 
-                        if(time_table[i] != previous_time)
-                                {
-                                if(xc->limit_range_valid)
-                                        {
-                                        if(time_table[i] > xc->limit_range_end)
-                                                {
-                                                break;
-                                                }
-                                        }
+/* process time block */
+{
+unsigned char *ucdata, *ucdata_alloc = NULL;
+unsigned char *cdata, *cdata_alloc;
+unsigned long destlen /* = tsec_uclen */; /* scan-build */
+unsigned long sourcelen /* = tsec_clen */; /* scan-build */
+int rc;
+unsigned char *tpnt;
+uint64_t tpval;
+unsigned int ti;
 
-				if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
-                                wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", time_table[i]);
-                                fstWritex(xc, wx_buf, wx_len);
-				if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
+fstReaderFseeko(xc, xc->f, blkpos + seclen - 24, SEEK_SET);
+tsec_uclen = fstReaderUint64(xc->f);
+tsec_clen = fstReaderUint64(xc->f);
+tsec_nitems = fstReaderUint64(xc->f);
+#ifdef FST_DEBUG
+fprintf(stderr, FST_APIMESS "time section unc: %d, com: %d (%d items)\n",
+        (int)tsec_uclen, (int)tsec_clen, (int)tsec_nitems);
+#endif
+destlen = tsec_uclen;
+sourcelen = tsec_clen;
 
-                                if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
-                                        {
-                                        if(time_table[i] == xc->blackout_times[cur_blackout])
-                                                {
-                                                wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
-                                                fstWritex(xc, wx_buf, wx_len);
-                                                }
-                                        }
-                                previous_time = time_table[i];
-                                }
-                        }
+if(tsec_uclen != tsec_clen)
+        {
+        ucdata = ucdata_alloc = (unsigned char *)malloc(tsec_uclen);
+        cdata = fstReaderFetch(xc, blkpos + seclen - 24 - tsec_clen, tsec_clen, &cdata_alloc);
 
-                while(tc_head[i])
-                        {
-                        idx = tc_head[i] - 1;
-                        vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
+        rc = uncompress(ucdata, &destlen, cdata, sourcelen);
 
-                        if(xc->signal_lens[idx] <= 1)
-                                {
-                                if(xc->signal_lens[idx] == 1)
-                                        {
-                                        unsigned char val;
-                                        if(!(vli & 1))
-                                                {
-                                                /* tdelta = vli >> 2; */ /* scan-build */
-                                                val = ((vli >> 1) & 1) | '0';
-                                                }
-                                                else
-                                                {
-                                                /* tdelta = vli >> 4; */ /* scan-build */
-                                                val = FST_RCV_STR[((vli >> 1) & 7)];
-                                                }
+        if(rc != Z_OK)
+                {
+                fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), tsec uncompress rc = %d, exiting.\n", rc);
+                exit(255);
+                }
 
-                                        if(value_change_callback)
-                                                {
-                                                xc->temp_signal_value_buf[0] = val;
-                                                xc->temp_signal_value_buf[1] = 0;
-                                                value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
-                                                }
-                                                else
-                                                {
-                                                if(fv)
-                                                        {
-                                                        char vcd_id[16];
-                                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
+        free(cdata_alloc);
+        }
+        else
+        {
+        ucdata = fstReaderFetch(xc, blkpos + seclen - 24 - tsec_clen, tsec_uclen, &ucdata_alloc);
+        }
 
-                                                        vcd_id[0] = val;
-                                                        vcd_id[vcdid_len+1] = '\n';
-                                                        fstWritex(xc, vcd_id, vcdid_len+2);
-                                                        }
-                                                }
-                                        headptr[idx] += skiplen;
-                                        length_remaining[idx] -= skiplen;
+blk->time_table = (uint64_t *)calloc(tsec_nitems, sizeof(uint64_t));
+blk->tsec_nitems = tsec_nitems;
+tpnt = ucdata;
+tpval = 0;
+for(ti=0;ti<tsec_nitems;ti++)
+        {
+        int skiplen;
+        uint64_t val = fstGetVarint64(tpnt, &skiplen);
+        tpval = blk->time_table[ti] = tpval + val;
+        tpnt += skiplen;
+        }
 
-                                        tc_head[i] = scatterptr[idx];
-                                        scatterptr[idx] = 0;
+free(ucdata_alloc);
+}
 
-                                        if(length_remaining[idx])
-                                                {
-                                                int shamt;
-                                                vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
-                                                shamt = 2 << (vli & 1);
-                                                tdelta = vli >> shamt;
+fstReaderFseeko(xc, xc->f, blkpos+32, SEEK_SET);
 
-						if((tdelta+i) >= tc_head_items)
-							{
-							chk_report_abort("TALOS-2023-1791");
-							}
+frame_uclen = fstReaderVarint64(xc->f);
+frame_clen = fstReaderVarint64(xc->f);
+blk->frame_maxhandle = fstReaderVarint64(xc->f);
+frame_pos = ftello(xc->f);
+blk->frame_data = (unsigned char *)malloc(frame_uclen);
+blk->frame_uclen = frame_uclen;
 
-                                                scatterptr[idx] = tc_head[i+tdelta];
-                                                tc_head[i+tdelta] = idx+1;
-                                                }
-                                        }
-                                        else
-                                        {
-                                        unsigned char *vdata;
-                                        uint32_t len;
+if(frame_uclen == frame_clen)
+        {
+        fstFread(blk->frame_data, frame_uclen, 1, xc->f);
+        }
+        else
+        {
+        unsigned char *mc_alloc;
+        unsigned char *mc = fstReaderFetch(xc, frame_pos, frame_clen, &mc_alloc);
+        int rc;
 
-                                        vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
-                                        len = fstGetVarint32(mem_for_traversal + headptr[idx] + skiplen, &skiplen2);
-                                        /* tdelta = vli >> 1; */ /* scan-build */
-                                        skiplen += skiplen2;
-                                        vdata = mem_for_traversal + headptr[idx] + skiplen;
+        unsigned long destlen = frame_uclen;
+        unsigned long sourcelen = frame_clen;
 
-                                        if(!(vli & 1))
-                                                {
-                                                if(value_change_callback_varlen)
-                                                        {
-                                                        value_change_callback_varlen(user_callback_data_pointer, time_table[i], idx+1, vdata, len);
-                                                        }
-                                                        else
-                                                        {
-                                                        if(fv)
-                                                                {
-                                                                char vcd_id[16];
-                                                                int vcdid_len;
+        rc = uncompress(blk->frame_data, &destlen, mc, sourcelen);
+        if(rc != Z_OK)
+                {
+                fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), frame decompress rc: %d, exiting.\n", rc);
+                exit(255);
+                }
+        free(mc_alloc);
+        }
 
-                                                                vcd_id[0] = 's';
-                                                                fstWritex(xc, vcd_id, 1);
+fstReaderFseeko(xc, xc->f, frame_pos + (fst_off_t)frame_clen, SEEK_SET);
 
-                                                                vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
-                                                                {
-								if(sizeof(size_t) < sizeof(uint64_t))
-                							{
-                							/* TALOS-2023-1790 for 32b overflow */
-                							uint64_t chk_64 = len*4 + 1;
-                							size_t   chk_32 = len*4 + 1;
-                							if(chk_64 != chk_32) chk_report_abort("TALOS-2023-1790");
-                							}
+blk->vc_maxhandle = fstReaderVarint64(xc->f);
+blk->vc_start = ftello(xc->f);      /* points to '!' character */
+blk->packtype = fgetc(xc->f);
 
-                                                                unsigned char *vesc = (unsigned char *)malloc(len*4 + 1);
-                                                                int vlen = fstUtilityBinToEsc(vesc, vdata, len);
-                                                                fstWritex(xc, vesc, vlen);
-                                                                free(vesc);
-                                                                }
+#ifdef FST_DEBUG
+fprintf(stderr, FST_APIMESS "frame_uclen: %d, frame_clen: %d, frame_maxhandle: %d\n",
+        (int)frame_uclen, (int)frame_clen, (int)blk->frame_maxhandle);
+fprintf(stderr, FST_APIMESS "vc_maxhandle: %d\n", (int)blk->vc_maxhandle);
+#endif
 
-                                                                vcd_id[0] = ' ';
-                                                                vcd_id[vcdid_len + 1] = '\n';
-                                                                fstWritex(xc, vcd_id, vcdid_len+2);
-                                                                }
-                                                        }
-                                                }
+indx_pntr = blkpos + seclen - 24 -tsec_clen -8;
+fstReaderFseeko(xc, xc->f, indx_pntr, SEEK_SET);
+chain_clen = fstReaderUint64(xc->f);
+indx_pos = indx_pntr - chain_clen;
+#ifdef FST_DEBUG
+fprintf(stderr, FST_APIMESS "indx_pos: %d (%d bytes)\n", (int)indx_pos, (int)chain_clen);
+#endif
+chain_cmem = fstReaderFetch(xc, indx_pos, chain_clen, &chain_cmem_alloc);
 
-                                        skiplen += len;
-                                        headptr[idx] += skiplen;
-                                        length_remaining[idx] -= skiplen;
+blk->chain_table = (fst_off_t *)calloc((blk->vc_maxhandle+1), sizeof(fst_off_t));
+blk->chain_table_lengths = (uint32_t *)calloc((blk->vc_maxhandle+1), sizeof(uint32_t));
+blk->chains = (struct fstRvatChain *)calloc((blk->vc_maxhandle+1), sizeof(struct fstRvatChain));
 
-                                        tc_head[i] = scatterptr[idx];
-                                        scatterptr[idx] = 0;
+pnt = chain_cmem;
+idx = 0;
+pval = 0;
 
-                                        if(length_remaining[idx])
-                                                {
-                                                vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
-                                                tdelta = vli >> 1;
+if(sectype == FST_BL_VCDATA_DYN_ALIAS2)
+        {
+        uint32_t prev_alias = 0;
 
-						if((tdelta+i) >= tc_head_items)
-							{
-							chk_report_abort("TALOS-2023-1791");
-							}
+        do      {
+                int skiplen;
 
-                                                scatterptr[idx] = tc_head[i+tdelta];
-                                                tc_head[i+tdelta] = idx+1;
-                                                }
-                                        }
+                if(*pnt & 0x01)
+                        {
+                        int64_t shval = fstGetSVarint64(pnt, &skiplen) >> 1;
+                        if(shval > 0)
+                                {
+                                pval = blk->chain_table[idx] = pval + shval;
+                                if(idx) { blk->chain_table_lengths[pidx] = pval - blk->chain_table[pidx]; }
+                                pidx = idx++;
+                                }
+                        else if(shval < 0)
+                                {
+                                blk->chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
+                                blk->chain_table_lengths[idx] = prev_alias = shval;          /* because during this loop iter would give stale data! */
+                                idx++;
+                                }
+                        else
+                                {
+                                blk->chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
+                                blk->chain_table_lengths[idx] = prev_alias;                  /* because during this loop iter would give stale data! */
+                                idx++;
                                 }
-                                else
+                        }
+                        else
+                        {
+                        uint64_t val = fstGetVarint32(pnt, &skiplen);
+
+                        fstHandle loopcnt = val >> 1;
+                        for(i=0;i<loopcnt;i++)
                                 {
-                                uint32_t len = xc->signal_lens[idx];
-                                unsigned char *vdata;
+                                blk->chain_table[idx++] = 0;
+                                }
+                        }
 
-                                vli = fstGetVarint32(mem_for_traversal + headptr[idx], &skiplen);
-                                /* tdelta = vli >> 1; */ /* scan-build */
-                                vdata = mem_for_traversal + headptr[idx] + skiplen;
+                pnt += skiplen;
+                } while (pnt != (chain_cmem + chain_clen));
+        }
+        else
+	{
+	do
+	        {
+	        int skiplen;
+	        uint64_t val = fstGetVarint32(pnt, &skiplen);
 
-                                if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
-                                        {
-					if(len > xc->longest_signal_value_len)
-						{
-						chk_report_abort("TALOS-2023-1797");
-						}
+	        if(!val)
+	                {
+	                pnt += skiplen;
+	                val = fstGetVarint32(pnt, &skiplen);
+	                blk->chain_table[idx] = 0;
+	                blk->chain_table_lengths[idx] = -val;
+	                idx++;
+	                }
+	        else
+	        if(val&1)
+	                {
+	                pval = blk->chain_table[idx] = pval + (val >> 1);
+	                if(idx) { blk->chain_table_lengths[pidx] = pval - blk->chain_table[pidx]; }
+	                pidx = idx++;
+	                }
+	                else
+	                {
+	                fstHandle loopcnt = val >> 1;
+	                for(i=0;i<loopcnt;i++)
+	                        {
+	                        blk->chain_table[idx++] = 0;
+	                        }
+	                }
 
-                                        if(!(vli & 1))
-                                                {
-                                                int byte = 0;
-                                                int bit;
-                                                unsigned int j;
+	        pnt += skiplen;
+	        } while (pnt != (chain_cmem + chain_clen));
+	}
 
-                                                for(j=0;j<len;j++)
-                                                        {
-                                                        unsigned char ch;
-                                                        byte = j/8;
-                                                        bit = 7 - (j & 7);
-                                                        ch = ((vdata[byte] >> bit) & 1) | '0';
-                                                        xc->temp_signal_value_buf[j] = ch;
-                                                        }
-                                                xc->temp_signal_value_buf[j] = 0;
+free(chain_cmem_alloc);
+blk->chain_table[idx] = indx_pos - blk->vc_start;
+blk->chain_table_lengths[pidx] = blk->chain_table[idx] - blk->chain_table[pidx];
 
-                                                if(value_change_callback)
-                                                        {
-                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
-                                                        }
-                                                        else
-                                                        {
-                                                        if(fv)  {
-                                                                unsigned char ch_bp = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
+for(i=0;i<idx;i++)
+        {
+        int32_t v32 = blk->chain_table_lengths[i];
+        if((v32 < 0) && (!blk->chain_table[i]))
+                {
+                v32 = -v32;
+                v32--;
+                if(((uint32_t)v32) < i) /* sanity check */
+                        {
+                        blk->chain_table[i] = blk->chain_table[v32];
+                        blk->chain_table_lengths[i] = blk->chain_table_lengths[v32];
+                        }
+                }
+        }
 
-                                                                fstWritex(xc, &ch_bp, 1);
-                                                                fstWritex(xc, xc->temp_signal_value_buf, len);
-                                                                }
-                                                        }
+#ifdef FST_DEBUG
+fprintf(stderr, FST_APIMESS "decompressed chain idx len: %" PRIu32 "\n", idx);
+#endif
 
-                                                len = byte+1;
-                                                }
-                                                else
-                                                {
-                                                if(value_change_callback)
-                                                        {
-                                                        memcpy(xc->temp_signal_value_buf, vdata, len);
-                                                        xc->temp_signal_value_buf[len] = 0;
-                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
-                                                        }
-                                                        else
-                                                        {
-                                                        if(fv)
-                                                                {
-                                                                unsigned char ch_bp =  (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
-								uint64_t mem_required_for_traversal_chk = vdata - mem_for_traversal + len;
+blk->valid = 1;
+}
 
-                                                                fstWritex(xc, &ch_bp, 1);
-								if(mem_required_for_traversal_chk > mem_required_for_traversal)
-									{
-									chk_report_abort("TALOS-2023-1793");
-									}
-                                                                fstWritex(xc, vdata, len);
-                                                                }
-                                                        }
-                                                }
-                                        }
-                                        else
-                                        {
-                                        double d;
-                                        unsigned char *clone_d /*= (unsigned char *)&d */; /* scan-build */
-                                        unsigned char buf[8];
-                                        unsigned char *srcdata;
 
-                                        if(!(vli & 1))  /* very rare case, but possible */
-                                                {
-                                                int bit;
-                                                int j;
+/* find the block for tim in the lru, loading it over the stalest entry if needed */
+static struct fstRvatBlock *fstReaderGetRvatBlock(struct fstReaderContext *xc, uint64_t tim)
+{
+struct fstRvatBlock *blk = NULL;
+uint64_t index;
+int i;
 
-                                                for(j=0;j<8;j++)
-                                                        {
-                                                        unsigned char ch;
-                                                        bit = 7 - (j & 7);
-                                                        ch = ((vdata[0] >> bit) & 1) | '0';
-                                                        buf[j] = ch;
-                                                        }
+if(!xc->rvat_index_valid)
+        {
+        fstReaderBuildRvatIndex(xc);
+        }
 
-                                                len = 1;
-                                                srcdata = buf;
-                                                }
-                                                else
-                                                {
-                                                srcdata = vdata;
-                                                }
+if(!fstReaderFindRvatIndex(xc, tim, &index))
+        {
+        return(NULL);
+        }
 
-                                        if(value_change_callback)
-                                                {
-                                                if(xc->native_doubles_for_cb)
-                                                        {
-                                                        if(xc->double_endian_match)
-                                                                {
-                                                                clone_d = srcdata;
-                                                                }
-                                                                else
-                                                                {
-                                                                int j;
+for(i=0;i<FST_RVAT_BLOCK_CACHE;i++)
+        {
+        struct fstRvatBlock *cand = &xc->rvat_blocks[i];
 
-                                                                clone_d = (unsigned char *)&d;
-                                                                for(j=0;j<8;j++)
-                                                                        {
-                                                                        clone_d[j] = srcdata[7-j];
-                                                                        }
-                                                                }
-                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, clone_d);
-                                                        }
-                                                        else
-                                                        {
-                                                        clone_d = (unsigned char *)&d;
-                                                        if(xc->double_endian_match)
-                                                                {
-                                                                memcpy(clone_d, srcdata, 8);
-                                                                }
-                                                                else
-                                                                {
-                                                                int j;
+        if(cand->valid && (cand->index == index))
+                {
+                cand->lru_stamp = ++xc->rvat_lru_stamp;
+                return(cand);
+                }
 
-                                                                for(j=0;j<8;j++)
-                                                                        {
-                                                                        clone_d[j] = srcdata[7-j];
-                                                                        }
-                                                                }
-                                                        snprintf((char *)xc->temp_signal_value_buf, xc->longest_signal_value_len + 1, "%.16g", d);
-                                                        value_change_callback(user_callback_data_pointer, time_table[i], idx+1, xc->temp_signal_value_buf);
-                                                        }
-                                                }
-                                                else
-                                                {
-                                                if(fv)
-                                                        {
-                                                        char wx_buf[32];
-                                                        int wx_len;
+        if((!blk) || (!cand->valid) || (blk->valid && (cand->lru_stamp < blk->lru_stamp)))
+                {
+                blk = cand;
+                }
+        }
 
-                                                        clone_d = (unsigned char *)&d;
-                                                        if(xc->double_endian_match)
-                                                                {
-                                                                memcpy(clone_d, srcdata, 8);
-                                                                }
-                                                                else
-                                                                {
-                                                                int j;
+fstReaderDeallocateRvatBlock(blk);
+fstReaderLoadRvatBlock(xc, blk, index);
+blk->lru_stamp = ++xc->rvat_lru_stamp;
 
-                                                                for(j=0;j<8;j++)
-                                                                        {
-                                                                        clone_d[j] = srcdata[7-j];
-                                                                        }
-                                                                }
+return(blk);
+}
 
-                                                        wx_len = snprintf(wx_buf, 32, "r%.16g", d);
-                                                        fstWritex(xc, wx_buf, wx_len);
-                                                        }
-                                                }
-                                        }
 
-                                if(fv)
-                                        {
-                                        char vcd_id[16];
-                                        int vcdid_len = fstVcdIDForFwrite(vcd_id+1, idx+1);
-                                        vcd_id[0] = ' ';
-                                        vcd_id[vcdid_len+1] = '\n';
-                                        fstWritex(xc, vcd_id, vcdid_len+2);
-                                        }
+/* decompress the value chain of facidx (zero based) unless it is already resident */
+static struct fstRvatChain *fstReaderGetRvatChain(struct fstReaderContext *xc, struct fstRvatBlock *blk, fstHandle facidx)
+{
+struct fstRvatChain *chain = &blk->chains[facidx];
 
-                                skiplen += len;
-                                headptr[idx] += skiplen;
-                                length_remaining[idx] -= skiplen;
+if(!chain->mem)
+        {
+        fst_off_t chain_pos = blk->vc_start + blk->chain_table[facidx];
+        unsigned char *mc_alloc = NULL;
+        unsigned char *mapped = NULL;
+        uint32_t skiplen;
 
-                                tc_head[i] = scatterptr[idx];
-                                scatterptr[idx] = 0;
+        if(xc->fmap && ((uint64_t)chain_pos + blk->chain_table_lengths[facidx] + 5 <= xc->fmap_len)) /* 5: varint */
+                {
+                int mskiplen;
 
-                                if(length_remaining[idx])
-                                        {
-                                        vli = fstGetVarint32NoSkip(mem_for_traversal + headptr[idx]);
-                                        tdelta = vli >> 1;
+                mapped = xc->fmap + chain_pos;
+                chain->len = fstGetVarint32(mapped, &mskiplen);
+                skiplen = mskiplen;
+                mapped += skiplen;
+                }
+                else
+                {
+                fstReaderFseeko(xc, xc->f, chain_pos, SEEK_SET);
+                chain->len = fstReaderVarint32WithSkip(xc->f, &skiplen);
+                }
+
+        if(chain->len)
+                {
+                unsigned char *mu = (unsigned char *)malloc(chain->len);
+                unsigned char *mc = mapped;
+                unsigned long destlen = chain->len;
+                unsigned long sourcelen = blk->chain_table_lengths[facidx];
+                int rc = Z_OK;
+
+                if(!mc)
+                        {
+                        mc = mc_alloc = (unsigned char *)malloc(blk->chain_table_lengths[facidx]);
+                        fstFread(mc, blk->chain_table_lengths[facidx], 1, xc->f);
+                        }
+
+                switch(blk->packtype)
+			{
+                        case '4': rc = (destlen == (unsigned long)LZ4_decompress_safe_partial((char *)mc, (char *)mu, sourcelen, destlen, destlen)) ? Z_OK : Z_DATA_ERROR;
+                        	break;
+                        case 'F': fastlz_decompress(mc, sourcelen, mu, destlen); /* rc appears unreliable */
+                        	break;
+                        default:  rc = uncompress(mu, &destlen, mc, sourcelen);
+                        	break;
+                        }
 
-					if((tdelta+i) >= tc_head_items)
-						{
-						chk_report_abort("TALOS-2023-1791");
-						}
+                free(mc_alloc);
 
-                                        scatterptr[idx] = tc_head[i+tdelta];
-                                        tc_head[i+tdelta] = idx+1;
-                                        }
-                                }
+                if(rc != Z_OK)
+                        {
+                        fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), rvat decompress clen: %d (rc=%d), exiting.\n", (int)chain->len, rc);
+                        exit(255);
                         }
+
+                /* data to process is for(j=0;j<destlen;j++) in mu[j] */
+                chain->mem = mu;
                 }
+                else
+                {
+                int destlen = blk->chain_table_lengths[facidx] - skiplen;
+                unsigned char *mu = (unsigned char *)malloc(chain->len = destlen);
 
-block_err:
-        free(tc_head);
-        free(chain_cmem);
-        free(mem_for_traversal); mem_for_traversal = NULL;
+                if(mapped)
+                        {
+                        memcpy(mu, mapped, destlen);
+                        }
+                        else
+                        {
+                        fstFread(mu, destlen, 1, xc->f);
+                        }
+                /* data to process is for(j=0;j<destlen;j++) in mu[j] */
+                chain->mem = mu;
+                }
 
-        secnum++;
-        if(secnum == xc->vc_section_count) break; /* in case file is growing, keep with original block count */
-        blkpos += seclen;
+        chain->pos_valid = 0;
         }
 
-if(mem_for_traversal) free(mem_for_traversal); /* scan-build */
-free(length_remaining);
-free(headptr);
-free(scatterptr);
+return(chain);
+}
 
-if(chain_table) free(chain_table);
-if(chain_table_lengths) free(chain_table_lengths);
 
-free(time_table);
+static char *fstReaderGetRvatValue(struct fstReaderContext *xc, struct fstRvatBlock *blk, uint64_t tim, fstHandle facidx, char *buf)
+{
+struct fstRvatChain *chain;
 
-#ifndef FST_WRITEX_DISABLE
-if(fv)
+if(facidx > blk->vc_maxhandle)
         {
-        fstWritex(xc, NULL, 0);
+        return(NULL);
         }
-#endif
 
-return(1);
-}
+facidx--; /* scale down for array which starts at zero */
 
 
-/* rvat functions */
+if(((tim == blk->beg_tim)&&(!blk->chain_table[facidx])) || (!blk->chain_table[facidx]))
+        {
+        return(fstExtractRvatDataFromFrame(xc, blk, facidx, buf));
+        }
+
+chain = fstReaderGetRvatChain(xc, blk, facidx);
+
+/* process value chain here */
 
-static char *fstExtractRvatDataFromFrame(struct fstReaderContext *xc, fstHandle facidx, char *buf)
 {
-if(facidx >= xc->rvat_frame_maxhandle)
+uint32_t tidx = 0, ptidx = 0;
+uint32_t tdelta;
+int skiplen;
+unsigned int i;
+unsigned int iprev = chain->len;
+uint32_t pvli = 0;
+int pskip = 0;
+
+if((chain->pos_valid)&&(tim >= chain->pos_time))
         {
-        return(NULL);
+        i = chain->pos_idx;
+        tidx = chain->pos_tidx;
+        }
+        else
+        {
+        i = 0;
+        tidx = 0;
+        chain->pos_valid = 0; /* a stale hint would otherwise survive a miss below */
+        chain->pos_time = blk->beg_tim;
         }
 
 if(xc->signal_lens[facidx] == 1)
         {
-        buf[0] = (char)xc->rvat_frame_data[xc->rvat_sig_offs[facidx]];
-        buf[1] = 0;
+        while(i<chain->len)
+                {
+                uint32_t vli = fstGetVarint32(chain->mem + i, &skiplen);
+                uint32_t shcnt = 2 << (vli & 1);
+                tdelta = vli >> shcnt;
+
+                if(blk->time_table[tidx + tdelta] <= tim)
+                        {
+                        iprev = i;
+                        pvli = vli;
+                        ptidx = tidx;
+                        /* pskip = skiplen; */ /* scan-build */
+
+                        tidx += tdelta;
+                        i+=skiplen;
+                        }
+                        else
+                        {
+                        break;
+                        }
+                }
+        if(iprev != chain->len)
+                {
+                chain->pos_tidx = ptidx;
+                chain->pos_idx = iprev;
+                chain->pos_time = tim;
+                chain->pos_valid = 1;
+
+                if(!(pvli & 1))
+                        {
+                        buf[0] = ((pvli >> 1) & 1) | '0';
+                        }
+                        else
+                        {
+                        buf[0] = FST_RCV_STR[((pvli >> 1) & 7)];
+                        }
+                buf[1] = 0;
+                return(buf);
+                }
+                else
+                {
+                return(fstExtractRvatDataFromFrame(xc, blk, facidx, buf));
+                }
         }
         else
         {
-        if(xc->signal_typs[facidx] != FST_VT_VCD_REAL)
+        while(i<chain->len)
                 {
-                memcpy(buf, xc->rvat_frame_data + xc->rvat_sig_offs[facidx], xc->signal_lens[facidx]);
-                buf[xc->signal_lens[facidx]] = 0;
+                uint32_t vli = fstGetVarint32(chain->mem + i, &skiplen);
+                tdelta = vli >> 1;
+
+                if(blk->time_table[tidx + tdelta] <= tim)
+                        {
+                        iprev = i;
+                        pvli = vli;
+                        ptidx = tidx;
+                        pskip = skiplen;
+
+                        tidx += tdelta;
+                        i+=skiplen;
+
+                        if(!(pvli & 1))
+                                {
+                                i+=((xc->signal_lens[facidx]+7)/8);
+                                }
+                                else
+                                {
+                                i+=xc->signal_lens[facidx];
+                                }
+                        }
+                        else
+                        {
+                        break;
+                        }
                 }
-                else
+
+        if(iprev != chain->len)
                 {
-                double d;
-                unsigned char *clone_d = (unsigned char *)&d;
-                unsigned char *srcdata = xc->rvat_frame_data + xc->rvat_sig_offs[facidx];
+                unsigned char *vdata = chain->mem + iprev + pskip;
 
-                if(xc->double_endian_match)
+                chain->pos_tidx = ptidx;
+                chain->pos_idx = iprev;
+                chain->pos_time = tim;
+                chain->pos_valid = 1;
+
+                if(xc->signal_typs[facidx] != FST_VT_VCD_REAL)
                         {
-                        memcpy(clone_d, srcdata, 8);
+                        if(!(pvli & 1))
+                                {
+                                int byte = 0;
+                                int bit;
+                                unsigned int j;
+
+                                for(j=0;j<xc->signal_lens[facidx];j++)
+                                        {
+                                        unsigned char ch;
+                                        byte = j/8;
+                                        bit = 7 - (j & 7);
+                                        ch = ((vdata[byte] >> bit) & 1) | '0';
+                                        buf[j] = ch;
+                                        }
+                                buf[j] = 0;
+
+                                return(buf);
+                                }
+                                else
+                                {
+                                memcpy(buf, vdata, xc->signal_lens[facidx]);
+                                buf[xc->signal_lens[facidx]] = 0;
+                                return(buf);
+                                }
                         }
                         else
                         {
-                        int j;
+                        double d;
+                        unsigned char *clone_d = (unsigned char *)&d;
+                        unsigned char bufd[8];
+                        unsigned char *srcdata;
 
-                        for(j=0;j<8;j++)
+                        if(!(pvli & 1)) /* very rare case, but possible */
                                 {
-                                clone_d[j] = srcdata[7-j];
+                                int bit;
+                                int j;
+
+                                for(j=0;j<8;j++)
+                                        {
+                                        unsigned char ch;
+                                        bit = 7 - (j & 7);
+                                        ch = ((vdata[0] >> bit) & 1) | '0';
+                                        bufd[j] = ch;
+                                        }
+
+                                srcdata = bufd;
+                                }
+                                else
+                                {
+                                srcdata = vdata;
                                 }
-                        }
 
-                snprintf((char *)buf, 32, "%.16g", d); /* this will write 18 bytes */
+                        if(xc->double_endian_match)
+                                {
+                                memcpy(clone_d, srcdata, 8);
+                                }
+                                else
+                                {
+                                int j;
+
+                                for(j=0;j<8;j++)
+                                        {
+                                        clone_d[j] = srcdata[7-j];
+                                        }
+                                }
+
+                        snprintf(buf, 32, "r%.16g", d); /* this will write 19 bytes */
+                        return(buf);
+                        }
+                }
+                else
+                {
+                return(fstExtractRvatDataFromFrame(xc, blk, facidx, buf));
                 }
         }
+}
 
-return(buf);
+/* return(NULL); */
+}
+
+
+static void fstReaderSetupRvatSigOffs(struct fstReaderContext *xc)
+{
+if(!xc->rvat_sig_offs)
+        {
+        uint32_t cur_offs = 0;
+        fstHandle i;
+
+        xc->rvat_sig_offs = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
+        for(i=0;i<xc->maxhandle;i++)
+                {
+                xc->rvat_sig_offs[i] = cur_offs;
+                cur_offs += xc->signal_lens[i];
+                }
+        }
 }
 
 
 char *fstReaderGetValueFromHandleAtTime(void *ctx, uint64_t tim, fstHandle facidx, char *buf)
 {
 struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
-fst_off_t blkpos = 0, prev_blkpos;
-uint64_t beg_tim, end_tim, beg_tim2, end_tim2;
-int sectype;
-unsigned int secnum = 0;
-uint64_t seclen;
-uint64_t tsec_uclen = 0, tsec_clen = 0;
-uint64_t tsec_nitems;
-uint64_t frame_uclen, frame_clen;
-#ifdef FST_DEBUG
-uint64_t mem_required_for_traversal;
-#endif
-fst_off_t indx_pntr, indx_pos;
-long chain_clen;
-unsigned char *chain_cmem;
-unsigned char *pnt;
-fstHandle idx, pidx=0, i;
-uint64_t pval;
+struct fstRvatBlock *blk;
+
+if((!xc) || (!facidx) || (facidx > xc->maxhandle) || (!buf) || (!xc->signal_lens[facidx-1]))
+        {
+        return(NULL);
+        }
+
+fstReaderSetupRvatSigOffs(xc);
+
+blk = fstReaderGetRvatBlock(xc, tim);
+if(!blk)
+        {
+        return(NULL);
+        }
+
+return(fstReaderGetRvatValue(xc, blk, tim, facidx, buf));
+}
+
+
+static int fstReaderRvatHandleCompare(const void *v1, const void *v2)
+{
+fstHandle h1 = *(const fstHandle *)v1;
+fstHandle h2 = *(const fstHandle *)v2;
+
+return((h1 > h2) - (h1 < h2));
+}
+
+
+/*
+ * batched form of fstReaderGetValueFromHandleAtTime(): the block is located
+ * once, chains not yet resident are inflated in handle order (which is file
+ * order) and bufs[i] receives the value of facidxs[i].  handles with no value
+ * get an empty string.  returns the number of values found.
+ */
+unsigned int fstReaderGetValuesFromHandlesAtTime(void *ctx, uint64_t tim, const fstHandle *facidxs, char **bufs, unsigned int count)
+{
+struct fstReaderContext *xc = (struct fstReaderContext *)ctx;
+struct fstRvatBlock *blk = NULL;
+fstHandle *pending;
+unsigned int npending = 0;
+unsigned int found = 0;
+unsigned int i;
 
-if((!xc) || (!facidx) || (facidx > xc->maxhandle) || (!buf) || (!xc->signal_lens[facidx-1]))
+if((!xc) || (!facidxs) || (!bufs) || (!count))
         {
-        return(NULL);
+        return(0);
         }
 
-if(!xc->rvat_sig_offs)
-        {
-        uint32_t cur_offs = 0;
+fstReaderSetupRvatSigOffs(xc);
+blk = fstReaderGetRvatBlock(xc, tim);
 
-        xc->rvat_sig_offs = (uint32_t *)calloc(xc->maxhandle, sizeof(uint32_t));
-        for(i=0;i<xc->maxhandle;i++)
+pending = blk ? (fstHandle *)malloc(count * sizeof(fstHandle)) : NULL;
+if(pending)
+        {
+        for(i=0;i<count;i++)
                 {
-                xc->rvat_sig_offs[i] = cur_offs;
-                cur_offs += xc->signal_lens[i];
+                fstHandle facidx = facidxs[i];
+
+                if((facidx) && (facidx <= xc->maxhandle) && (facidx <= blk->vc_maxhandle) &&
+                        (xc->signal_lens[facidx-1]) && (blk->chain_table[facidx-1]) && (!blk->chains[facidx-1].mem))
+                        {
+                        pending[npending++] = facidx - 1;
+                        }
                 }
-        }
 
-if(xc->rvat_data_valid)
-        {
-        if((xc->rvat_beg_tim <= tim) && (tim <= xc->rvat_end_tim))
+        qsort(pending, npending, sizeof(fstHandle), fstReaderRvatHandleCompare);
+        for(i=0;i<npending;i++)
                 {
-                goto process_value;
+                fstReaderGetRvatChain(xc, blk, pending[i]);
                 }
 
-        fstReaderDeallocateRvatData(xc);
+        free(pending);
         }
 
-xc->rvat_chain_pos_valid = 0;
-
-for(;;)
+for(i=0;i<count;i++)
         {
-        fstReaderFseeko(xc, xc->f, (prev_blkpos = blkpos), SEEK_SET);
+        fstHandle facidx = facidxs[i];
+        char *rc = NULL;
 
-        sectype = fgetc(xc->f);
-        seclen = fstReaderUint64(xc->f);
-
-        if((sectype == EOF) || (sectype == FST_BL_SKIP) || (!seclen))
+        if(!bufs[i])
                 {
-                return(NULL); /* if this loop exits on break, it's successful */
+                continue;
                 }
 
-        blkpos++;
-        if((sectype != FST_BL_VCDATA) && (sectype != FST_BL_VCDATA_DYN_ALIAS) && (sectype != FST_BL_VCDATA_DYN_ALIAS2))
+        if((blk) && (facidx) && (facidx <= xc->maxhandle) && (xc->signal_lens[facidx-1]))
                 {
-                blkpos += seclen;
-                continue;
+                rc = fstReaderGetRvatValue(xc, blk, tim, facidx, bufs[i]);
                 }
 
-        beg_tim = fstReaderUint64(xc->f);
-        end_tim = fstReaderUint64(xc->f);
-
-        if((beg_tim <= tim) && (tim <= end_tim))
+        if(rc)
                 {
-                if((tim == end_tim) && (tim != xc->end_time))
-                        {
-                        fst_off_t cached_pos = ftello(xc->f);
-                        fstReaderFseeko(xc, xc->f, blkpos, SEEK_SET);
-
-                        sectype = fgetc(xc->f);
-                        seclen = fstReaderUint64(xc->f);
-
-                        beg_tim2 = fstReaderUint64(xc->f);
-                        end_tim2 = fstReaderUint64(xc->f);
-
-                        if(((sectype != FST_BL_VCDATA)&&(sectype != FST_BL_VCDATA_DYN_ALIAS)&&(sectype != FST_BL_VCDATA_DYN_ALIAS2)) || (!seclen) || (beg_tim2 != tim))
-                                {
-                                blkpos = prev_blkpos;
-                                break;
-                                }
-                        beg_tim = beg_tim2;
-                        end_tim = end_tim2;
-                        fstReaderFseeko(xc, xc->f, cached_pos, SEEK_SET);
-                        }
-                break;
+                found++;
+                }
+                else
+                {
+                bufs[i][0] = 0;
                 }
-
-        blkpos += seclen;
-        secnum++;
         }
 
-xc->rvat_beg_tim = beg_tim;
-xc->rvat_end_tim = end_tim;
-
-#ifdef FST_DEBUG
-mem_required_for_traversal =
-#endif
-        fstReaderUint64(xc->f);
+return(found);
+}
 
-#ifdef FST_DEBUG
-fprintf(stderr, FST_APIMESS "rvat sec: %u seclen: %d begtim: %d endtim: %d\n",
-        secnum, (int)seclen, (int)beg_tim, (int)end_tim);
-fprintf(stderr, FST_APIMESS "mem_required_for_traversal: %d\n", (int)mem_required_for_traversal);
-#endif
+#ifdef FST_WRITER_PARALLEL
 
-/* process time block */
+/*
+ * parallel vcd output: workers load, decompress and format whole value change
+ * blocks into their own text buffers and the caller writes the blocks out in
+ * file order.  the time lines depend on the blocks before ($dumpvars, a time
+ * repeated across a block boundary, blackouts) so they are left to the
+ * caller, the workers only record where the changes of each time start.
+ */
+enum fstVcdJobState
 {
-unsigned char *ucdata;
-unsigned char *cdata;
-unsigned long destlen /* = tsec_uclen */; /* scan-build */
-unsigned long sourcelen /* = tsec_clen */; /* scan-build */
-int rc;
-unsigned char *tpnt;
-uint64_t tpval;
-unsigned int ti;
+FST_VCD_JOB_FREE,
+FST_VCD_JOB_CLAIMED,
+FST_VCD_JOB_DONE
+};
 
-fstReaderFseeko(xc, xc->f, blkpos + seclen - 24, SEEK_SET);
-tsec_uclen = fstReaderUint64(xc->f);
-tsec_clen = fstReaderUint64(xc->f);
-tsec_nitems = fstReaderUint64(xc->f);
-#ifdef FST_DEBUG
-fprintf(stderr, FST_APIMESS "time section unc: %d, com: %d (%d items)\n",
-        (int)tsec_uclen, (int)tsec_clen, (int)tsec_nitems);
-#endif
-ucdata = (unsigned char *)malloc(tsec_uclen);
-destlen = tsec_uclen;
-sourcelen = tsec_clen;
+struct fstVcdJob
+{
+uint64_t index;                         /* into rvat_index */
+struct fstRvatBlock blk;
+unsigned char *text;
+size_t text_len, text_size;
+size_t *tofs;                           /* tsec_nitems + 1 offsets into text, the frame precedes tofs[0] */
+enum fstVcdJobState state;
+unsigned frame : 1;                     /* initial values were formatted */
+unsigned failed : 1;
+};
 
-fstReaderFseeko(xc, xc->f, -24 - ((fst_off_t)tsec_clen), SEEK_CUR);
-if(tsec_uclen != tsec_clen)
-        {
-        cdata = (unsigned char *)malloc(tsec_clen);
-        fstFread(cdata, tsec_clen, 1, xc->f);
+struct fstVcdScratch
+{
+uint32_t *scatterptr, *headptr, *length_remaining;      /* maxhandle sized */
+uint32_t *tc_head;
+uint64_t tc_head_size;
+unsigned char *mem;                     /* decompressed chains */
+size_t mem_size;
+};
 
-        rc = uncompress(ucdata, &destlen, cdata, sourcelen);
+struct fstVcdParallel
+{
+struct fstReaderContext *xc;
+uint64_t *indices;                      /* rvat_index entries to output, in order */
+uint64_t count;
+uint64_t blocks_skipped;
+struct fstVcdJob *jobs;                 /* ring, indices[k] goes to jobs[k % num_jobs] */
+unsigned int num_jobs;
+uint64_t next;                          /* next indices[] entry to claim */
+uint64_t emitted;                       /* indices[] entries written out */
+pthread_mutex_t mutex;                  /* guards the counters, job states and all reads of xc->f */
+pthread_cond_t cond;
+};
 
-        if(rc != Z_OK)
-                {
-                fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), tsec uncompress rc = %d, exiting.\n", rc);
-                exit(255);
-                }
 
-        free(cdata);
-        }
-        else
+static unsigned char *fstVcdJobReserve(struct fstVcdJob *job, size_t len)
+{
+if(job->text_len + len > job->text_size)
         {
-        fstFread(ucdata, tsec_uclen, 1, xc->f);
+        job->text_size = (job->text_len + len) * 2;
+        job->text = (unsigned char *)realloc(job->text, job->text_size);
         }
 
-xc->rvat_time_table = (uint64_t *)calloc(tsec_nitems, sizeof(uint64_t));
-tpnt = ucdata;
-tpval = 0;
-for(ti=0;ti<tsec_nitems;ti++)
-        {
-        int skiplen;
-        uint64_t val = fstGetVarint64(tpnt, &skiplen);
-        tpval = xc->rvat_time_table[ti] = tpval + val;
-        tpnt += skiplen;
-        }
+return(job->text + job->text_len);
+}
+
 
-free(ucdata);
+static void fstVcdJobPut(struct fstVcdJob *job, const void *v, size_t len)
+{
+memcpy(fstVcdJobReserve(job, len), v, len);
+job->text_len += len;
 }
 
-fstReaderFseeko(xc, xc->f, blkpos+32, SEEK_SET);
 
-frame_uclen = fstReaderVarint64(xc->f);
-frame_clen = fstReaderVarint64(xc->f);
-xc->rvat_frame_maxhandle = fstReaderVarint64(xc->f);
-xc->rvat_frame_data = (unsigned char *)malloc(frame_uclen);
+/* lead character, vcd id and newline: "1!\n" or the " !\n" ending a vector */
+static void fstVcdJobPutId(struct fstVcdJob *job, unsigned char lead, fstHandle handle)
+{
+unsigned char *pnt = fstVcdJobReserve(job, 16);
+int vcdid_len = fstVcdIDForFwrite((char *)pnt + 1, handle);
 
-if(frame_uclen == frame_clen)
+pnt[0] = lead;
+pnt[vcdid_len + 1] = '\n';
+job->text_len += vcdid_len + 2;
+}
+
+
+static void fstVcdJobPutReal(struct fstReaderContext *xc, struct fstVcdJob *job, const unsigned char *srcdata)
+{
+double d;
+unsigned char *clone_d = (unsigned char *)&d;
+char wx_buf[32];
+int wx_len;
+
+if(xc->double_endian_match)
         {
-        fstFread(xc->rvat_frame_data, frame_uclen, 1, xc->f);
+        memcpy(clone_d, srcdata, 8);
         }
         else
         {
-        unsigned char *mc = (unsigned char *)malloc(frame_clen);
-        int rc;
+        int j;
 
-        unsigned long destlen = frame_uclen;
-        unsigned long sourcelen = frame_clen;
-
-        fstFread(mc, sourcelen, 1, xc->f);
-        rc = uncompress(xc->rvat_frame_data, &destlen, mc, sourcelen);
-        if(rc != Z_OK)
+        for(j=0;j<8;j++)
                 {
-                fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), frame decompress rc: %d, exiting.\n", rc);
-                exit(255);
+                clone_d[j] = srcdata[7-j];
                 }
-        free(mc);
         }
 
-xc->rvat_vc_maxhandle = fstReaderVarint64(xc->f);
-xc->rvat_vc_start = ftello(xc->f);      /* points to '!' character */
-xc->rvat_packtype = fgetc(xc->f);
-
-#ifdef FST_DEBUG
-fprintf(stderr, FST_APIMESS "frame_uclen: %d, frame_clen: %d, frame_maxhandle: %d\n",
-        (int)frame_uclen, (int)frame_clen, (int)xc->rvat_frame_maxhandle);
-fprintf(stderr, FST_APIMESS "vc_maxhandle: %d\n", (int)xc->rvat_vc_maxhandle);
-#endif
-
-indx_pntr = blkpos + seclen - 24 -tsec_clen -8;
-fstReaderFseeko(xc, xc->f, indx_pntr, SEEK_SET);
-chain_clen = fstReaderUint64(xc->f);
-indx_pos = indx_pntr - chain_clen;
-#ifdef FST_DEBUG
-fprintf(stderr, FST_APIMESS "indx_pos: %d (%d bytes)\n", (int)indx_pos, (int)chain_clen);
-#endif
-chain_cmem = (unsigned char *)malloc(chain_clen);
-fstReaderFseeko(xc, xc->f, indx_pos, SEEK_SET);
-fstFread(chain_cmem, chain_clen, 1, xc->f);
+wx_len = snprintf(wx_buf, 32, "r%.16g", d);
+fstVcdJobPut(job, wx_buf, wx_len);
+}
 
-xc->rvat_chain_table = (fst_off_t *)calloc((xc->rvat_vc_maxhandle+1), sizeof(fst_off_t));
-xc->rvat_chain_table_lengths = (uint32_t *)calloc((xc->rvat_vc_maxhandle+1), sizeof(uint32_t));
 
-pnt = chain_cmem;
-idx = 0;
-pval = 0;
+static void fstVcdJobFormatFrame(struct fstReaderContext *xc, struct fstVcdJob *job)
+{
+struct fstRvatBlock *blk = &job->blk;
+uint64_t sig_offs = 0;
+fstHandle idx;
 
-if(sectype == FST_BL_VCDATA_DYN_ALIAS2)
+for(idx=0;idx<blk->frame_maxhandle;idx++)
         {
-        uint32_t prev_alias = 0;
-
-        do      {
-                int skiplen;
-
-                if(*pnt & 0x01)
+        if(xc->process_mask[idx/8]&(1<<(idx&7)))
+                {
+                if(xc->signal_lens[idx] == 1)
                         {
-                        int64_t shval = fstGetSVarint64(pnt, &skiplen) >> 1;
-                        if(shval > 0)
-                                {
-                                pval = xc->rvat_chain_table[idx] = pval + shval;
-                                if(idx) { xc->rvat_chain_table_lengths[pidx] = pval - xc->rvat_chain_table[pidx]; }
-                                pidx = idx++;
-                                }
-                        else if(shval < 0)
-                                {
-                                xc->rvat_chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
-                                xc->rvat_chain_table_lengths[idx] = prev_alias = shval;          /* because during this loop iter would give stale data! */
-                                idx++;
-                                }
-                        else
-                                {
-                                xc->rvat_chain_table[idx] = 0;                                   /* need to explicitly zero as calloc above might not run */
-                                xc->rvat_chain_table_lengths[idx] = prev_alias;                  /* because during this loop iter would give stale data! */
-                                idx++;
-                                }
+                        fstVcdJobPutId(job, blk->frame_data[sig_offs], idx+1);
                         }
-                        else
+                else if(xc->signal_lens[idx] > 1) /* variable-length ("0" length) records have no initial state */
                         {
-                        uint64_t val = fstGetVarint32(pnt, &skiplen);
-
-                        fstHandle loopcnt = val >> 1;
-                        for(i=0;i<loopcnt;i++)
+                        if((sig_offs + xc->signal_lens[idx]) > blk->frame_uclen)
                                 {
-                                xc->rvat_chain_table[idx++] = 0;
+                                chk_report_abort("TALOS-2023-1793");
                                 }
-                        }
-
-                pnt += skiplen;
-                } while (pnt != (chain_cmem + chain_clen));
-        }
-        else
-	{
-	do
-	        {
-	        int skiplen;
-	        uint64_t val = fstGetVarint32(pnt, &skiplen);
-
-	        if(!val)
-	                {
-	                pnt += skiplen;
-	                val = fstGetVarint32(pnt, &skiplen);
-	                xc->rvat_chain_table[idx] = 0;
-	                xc->rvat_chain_table_lengths[idx] = -val;
-	                idx++;
-	                }
-	        else
-	        if(val&1)
-	                {
-	                pval = xc->rvat_chain_table[idx] = pval + (val >> 1);
-	                if(idx) { xc->rvat_chain_table_lengths[pidx] = pval - xc->rvat_chain_table[pidx]; }
-	                pidx = idx++;
-	                }
-	                else
-	                {
-	                fstHandle loopcnt = val >> 1;
-	                for(i=0;i<loopcnt;i++)
-	                        {
-	                        xc->rvat_chain_table[idx++] = 0;
-	                        }
-	                }
 
-	        pnt += skiplen;
-	        } while (pnt != (chain_cmem + chain_clen));
-	}
+                        if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
+                                {
+                                unsigned char ch_bp = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
 
-free(chain_cmem);
-xc->rvat_chain_table[idx] = indx_pos - xc->rvat_vc_start;
-xc->rvat_chain_table_lengths[pidx] = xc->rvat_chain_table[idx] - xc->rvat_chain_table[pidx];
+                                fstVcdJobPut(job, &ch_bp, 1);
+                                fstVcdJobPut(job, blk->frame_data + sig_offs, xc->signal_lens[idx]);
+                                }
+                                else
+                                {
+                                fstVcdJobPutReal(xc, job, blk->frame_data + sig_offs);
+                                }
 
-for(i=0;i<idx;i++)
-        {
-        int32_t v32 = xc->rvat_chain_table_lengths[i];
-        if((v32 < 0) && (!xc->rvat_chain_table[i]))
-                {
-                v32 = -v32;
-                v32--;
-                if(((uint32_t)v32) < i) /* sanity check */
-                        {
-                        xc->rvat_chain_table[i] = xc->rvat_chain_table[v32];
-                        xc->rvat_chain_table_lengths[i] = xc->rvat_chain_table_lengths[v32];
+                        fstVcdJobPutId(job, ' ', idx+1);
                         }
                 }
-        }
-
-#ifdef FST_DEBUG
-fprintf(stderr, FST_APIMESS "decompressed chain idx len: %" PRIu32 "\n", idx);
-#endif
-
-xc->rvat_data_valid = 1;
 
-/* all data at this point is loaded or resident in fst cache, process and return appropriate value */
-process_value:
-if(facidx > xc->rvat_vc_maxhandle)
-        {
-        return(NULL);
+        sig_offs += xc->signal_lens[idx];
         }
+}
 
-facidx--; /* scale down for array which starts at zero */
-
-
-if(((tim == xc->rvat_beg_tim)&&(!xc->rvat_chain_table[facidx])) || (!xc->rvat_chain_table[facidx]))
-        {
-        return(fstExtractRvatDataFromFrame(xc, facidx, buf));
-        }
 
-if(facidx != xc->rvat_chain_facidx)
-        {
-        if(xc->rvat_chain_mem)
-                {
-                free(xc->rvat_chain_mem);
-                xc->rvat_chain_mem = NULL;
+/* the same traversal as fstReaderIterBlocks2() with fv set, into job->text */
+static void fstVcdJobFormat(struct fstVcdParallel *vp, struct fstVcdJob *job, struct fstVcdScratch *ws, int first)
+{
+struct fstReaderContext *xc = vp->xc;
+struct fstRvatBlock *blk = &job->blk;
+unsigned char *vc_mem, *vc_alloc = NULL;
+uint64_t vc_len = 0;
+uint64_t traversal_mem_offs = 0;
+uint64_t tc_head_items;
+fstHandle i, idx, maxidx;
 
-                xc->rvat_chain_pos_valid = 0;
-                }
-        }
+job->text_len = 0;
+job->frame = 0;
+job->failed = 0;
 
-if(!xc->rvat_chain_mem)
+pthread_mutex_lock(&vp->mutex);
+fstReaderLoadRvatBlock(xc, blk, job->index);
+for(i=0;i<=blk->vc_maxhandle;i++)
         {
-        uint32_t skiplen;
-        fstReaderFseeko(xc, xc->f, xc->rvat_vc_start + xc->rvat_chain_table[facidx], SEEK_SET);
-        xc->rvat_chain_len = fstReaderVarint32WithSkip(xc->f, &skiplen);
-        if(xc->rvat_chain_len)
-                {
-                unsigned char *mu = (unsigned char *)malloc(xc->rvat_chain_len);
-                unsigned char *mc = (unsigned char *)malloc(xc->rvat_chain_table_lengths[facidx]);
-                unsigned long destlen = xc->rvat_chain_len;
-                unsigned long sourcelen = xc->rvat_chain_table_lengths[facidx];
-                int rc = Z_OK;
-
-                fstFread(mc, xc->rvat_chain_table_lengths[facidx], 1, xc->f);
-
-                switch(xc->rvat_packtype)
-			{
-                        case '4': rc = (destlen == (unsigned long)LZ4_decompress_safe_partial((char *)mc, (char *)mu, sourcelen, destlen, destlen)) ? Z_OK : Z_DATA_ERROR;
-                        	break;
-                        case 'F': fastlz_decompress(mc, sourcelen, mu, destlen); /* rc appears unreliable */
-                        	break;
-                        default:  rc = uncompress(mu, &destlen, mc, sourcelen);
-                        	break;
-                        }
-
-                free(mc);
-
-                if(rc != Z_OK)
-                        {
-                        fprintf(stderr, FST_APIMESS "fstReaderGetValueFromHandleAtTime(), rvat decompress clen: %d (rc=%d), exiting.\n", (int)xc->rvat_chain_len, rc);
-                        exit(255);
-                        }
-
-                /* data to process is for(j=0;j<destlen;j++) in mu[j] */
-                xc->rvat_chain_mem = mu;
-                }
-                else
+        if(blk->chain_table[i] && ((uint64_t)blk->chain_table[i] + blk->chain_table_lengths[i] > vc_len))
                 {
-                int destlen = xc->rvat_chain_table_lengths[facidx] - skiplen;
-                unsigned char *mu = (unsigned char *)malloc(xc->rvat_chain_len = destlen);
-                fstFread(mu, destlen, 1, xc->f);
-                /* data to process is for(j=0;j<destlen;j++) in mu[j] */
-                xc->rvat_chain_mem = mu;
+                vc_len = blk->chain_table[i] + blk->chain_table_lengths[i];
                 }
-
-        xc->rvat_chain_facidx = facidx;
         }
+vc_mem = fstReaderFetch(xc, blk->vc_start, vc_len, &vc_alloc);
+pthread_mutex_unlock(&vp->mutex);
 
-/* process value chain here */
+if(!vc_mem && vc_len)
+        {
+        job->failed = 1;
+        return;
+        }
 
-{
-uint32_t tidx = 0, ptidx = 0;
-uint32_t tdelta;
-int skiplen;
-unsigned int iprev = xc->rvat_chain_len;
-uint32_t pvli = 0;
-int pskip = 0;
+job->tofs = (size_t *)realloc(job->tofs, (blk->tsec_nitems + 1) * sizeof(size_t));
 
-if((xc->rvat_chain_pos_valid)&&(tim >= xc->rvat_chain_pos_time))
+if(first && (vp->blocks_skipped || !blk->tsec_nitems || (blk->beg_tim != blk->time_table[0])))
         {
-        i = xc->rvat_chain_pos_idx;
-        tidx = xc->rvat_chain_pos_tidx;
+        fstVcdJobFormatFrame(xc, job);
+        job->frame = 1;
         }
-        else
+
+tc_head_items = blk->tsec_nitems ? blk->tsec_nitems : 1;
+if(tc_head_items > ws->tc_head_size)
         {
-        i = 0;
-        tidx = 0;
-        xc->rvat_chain_pos_time = xc->rvat_beg_tim;
+        free(ws->tc_head);
+        ws->tc_head = (uint32_t *)malloc(tc_head_items * sizeof(uint32_t));
+        ws->tc_head_size = tc_head_items;
         }
+memset(ws->tc_head, 0, tc_head_items * sizeof(uint32_t));
 
-if(xc->signal_lens[facidx] == 1)
+maxidx = (blk->vc_maxhandle < xc->maxhandle) ? blk->vc_maxhandle : xc->maxhandle;
+for(i=0;i<maxidx;i++)
         {
-        while(i<xc->rvat_chain_len)
+        if(blk->chain_table[i] && (xc->process_mask[i/8]&(1<<(i&7))))
                 {
-                uint32_t vli = fstGetVarint32(xc->rvat_chain_mem + i, &skiplen);
-                uint32_t shcnt = 2 << (vli & 1);
-                tdelta = vli >> shcnt;
+                unsigned char *cpnt = vc_mem + blk->chain_table[i];
+                int skiplen;
+                uint32_t val = fstGetVarint32(cpnt, &skiplen);
+                uint32_t destlen = val ? val : (blk->chain_table_lengths[i] - skiplen);
+                uint32_t vli, tdelta;
+                int rc = Z_OK;
 
-                if(xc->rvat_time_table[tidx + tdelta] <= tim)
+                if(traversal_mem_offs + destlen > ws->mem_size)
                         {
-                        iprev = i;
-                        pvli = vli;
-                        ptidx = tidx;
-                        /* pskip = skiplen; */ /* scan-build */
+                        ws->mem_size = (traversal_mem_offs + destlen) * 2;
+                        ws->mem = (unsigned char *)realloc(ws->mem, ws->mem_size);
+                        }
 
-                        tidx += tdelta;
-                        i+=skiplen;
+                if(val)
+                        {
+                        unsigned char *mu = ws->mem + traversal_mem_offs;
+                        unsigned long udestlen = val;
+                        unsigned long sourcelen = blk->chain_table_lengths[i] - skiplen;
+
+                        switch(blk->packtype)
+                                {
+                                case '4': rc = (udestlen == (unsigned long)LZ4_decompress_safe_partial((char *)cpnt + skiplen, (char *)mu, sourcelen, udestlen, udestlen)) ? Z_OK : Z_DATA_ERROR;
+                                          break;
+                                case 'F': fastlz_decompress(cpnt + skiplen, sourcelen, mu, udestlen); /* rc appears unreliable */
+                                          break;
+                                default:  rc = uncompress(mu, &udestlen, cpnt + skiplen, sourcelen);
+                                          break;
+                                }
+
+                        if(rc != Z_OK)
+                                {
+                                fprintf(stderr, FST_APIMESS "fstReaderIterBlocks2(), fac: %d clen: %d (rc=%d), exiting.\n", (int)i, (int)val, rc);
+                                exit(255);
+                                }
                         }
                         else
                         {
-                        break;
+                        memcpy(ws->mem + traversal_mem_offs, cpnt + skiplen, destlen);
                         }
-                }
-        if(iprev != xc->rvat_chain_len)
-                {
-                xc->rvat_chain_pos_tidx = ptidx;
-                xc->rvat_chain_pos_idx = iprev;
-                xc->rvat_chain_pos_time = tim;
-                xc->rvat_chain_pos_valid = 1;
 
-                if(!(pvli & 1))
+                ws->headptr[i] = traversal_mem_offs;
+                ws->length_remaining[i] = destlen;
+                traversal_mem_offs += destlen;
+
+                vli = fstGetVarint32NoSkip(ws->mem + ws->headptr[i]);
+                if(xc->signal_lens[i] == 1)
                         {
-                        buf[0] = ((pvli >> 1) & 1) | '0';
+                        uint32_t shcnt = 2 << (vli & 1);
+                        tdelta = vli >> shcnt;
                         }
                         else
                         {
-                        buf[0] = FST_RCV_STR[((pvli >> 1) & 7)];
+                        tdelta = vli >> 1;
                         }
-                buf[1] = 0;
-                return(buf);
-                }
-                else
-                {
-                return(fstExtractRvatDataFromFrame(xc, facidx, buf));
+
+                if(tdelta >= tc_head_items)
+                        {
+                        chk_report_abort("TALOS-2023-1791");
+                        }
+
+                ws->scatterptr[i] = ws->tc_head[tdelta];
+                ws->tc_head[tdelta] = i+1;
                 }
         }
-        else
+
+free(vc_alloc);
+
+for(i=0;i<blk->tsec_nitems;i++)
         {
-        while(i<xc->rvat_chain_len)
+        job->tofs[i] = job->text_len;
+
+        while(ws->tc_head[i])
                 {
-                uint32_t vli = fstGetVarint32(xc->rvat_chain_mem + i, &skiplen);
-                tdelta = vli >> 1;
+                unsigned char *hpnt;
+                uint32_t vli, len, tdelta;
+                int skiplen, skiplen2;
 
-                if(xc->rvat_time_table[tidx + tdelta] <= tim)
-                        {
-                        iprev = i;
-                        pvli = vli;
-                        ptidx = tidx;
-                        pskip = skiplen;
+                idx = ws->tc_head[i] - 1;
+                hpnt = ws->mem + ws->headptr[idx];
+                vli = fstGetVarint32(hpnt, &skiplen);
 
-                        tidx += tdelta;
-                        i+=skiplen;
+                if(xc->signal_lens[idx] == 1)
+                        {
+                        unsigned char val;
 
-                        if(!(pvli & 1))
+                        if(!(vli & 1))
                                 {
-                                i+=((xc->signal_lens[facidx]+7)/8);
+                                val = ((vli >> 1) & 1) | '0';
                                 }
                                 else
                                 {
-                                i+=xc->signal_lens[facidx];
+                                val = FST_RCV_STR[((vli >> 1) & 7)];
                                 }
-                        }
-                        else
-                        {
-                        break;
-                        }
-                }
-
-        if(iprev != xc->rvat_chain_len)
-                {
-                unsigned char *vdata = xc->rvat_chain_mem + iprev + pskip;
-
-                xc->rvat_chain_pos_tidx = ptidx;
-                xc->rvat_chain_pos_idx = iprev;
-                xc->rvat_chain_pos_time = tim;
-                xc->rvat_chain_pos_valid = 1;
 
-                if(xc->signal_typs[facidx] != FST_VT_VCD_REAL)
+                        fstVcdJobPutId(job, val, idx+1);
+                        }
+                else if(!xc->signal_lens[idx])
                         {
-                        if(!(pvli & 1))
+                        len = fstGetVarint32(hpnt + skiplen, &skiplen2);
+                        if(!(vli & 1))
                                 {
-                                int byte = 0;
-                                int bit;
-                                unsigned int j;
+                                unsigned char *vesc;
 
-                                for(j=0;j<xc->signal_lens[facidx];j++)
+                                if((uint64_t)(hpnt + skiplen + skiplen2 - ws->mem) + len > traversal_mem_offs)
                                         {
-                                        unsigned char ch;
-                                        byte = j/8;
-                                        bit = 7 - (j & 7);
-                                        ch = ((vdata[byte] >> bit) & 1) | '0';
-                                        buf[j] = ch;
+                                        chk_report_abort("TALOS-2023-1790");
                                         }
-                                buf[j] = 0;
 
-                                return(buf);
-                                }
-                                else
-                                {
-                                memcpy(buf, vdata, xc->signal_lens[facidx]);
-                                buf[xc->signal_lens[facidx]] = 0;
-                                return(buf);
+                                fstVcdJobPut(job, "s", 1);
+                                vesc = fstVcdJobReserve(job, (size_t)len * 4 + 1);
+                                job->text_len += fstUtilityBinToEsc(vesc, hpnt + skiplen + skiplen2, len);
+                                fstVcdJobPutId(job, ' ', idx+1);
                                 }
+                        skiplen += skiplen2 + len;
                         }
                         else
                         {
-                        double d;
-                        unsigned char *clone_d = (unsigned char *)&d;
-                        unsigned char bufd[8];
-                        unsigned char *srcdata;
+                        unsigned char *vdata = hpnt + skiplen;
 
-                        if(!(pvli & 1)) /* very rare case, but possible */
+                        len = xc->signal_lens[idx];
+                        if(xc->signal_typs[idx] != FST_VT_VCD_REAL)
                                 {
-                                int bit;
-                                int j;
+                                unsigned char ch_bp = (xc->signal_typs[idx] != FST_VT_VCD_PORT) ? 'b' : 'p';
 
-                                for(j=0;j<8;j++)
+                                fstVcdJobPut(job, &ch_bp, 1);
+                                if(!(vli & 1))
                                         {
-                                        unsigned char ch;
-                                        bit = 7 - (j & 7);
-                                        ch = ((vdata[0] >> bit) & 1) | '0';
-                                        bufd[j] = ch;
+                                        unsigned char *bits;
+                                        uint32_t j;
+
+                                        if((uint64_t)(vdata - ws->mem) + ((len + 7) / 8) > traversal_mem_offs)
+                                                {
+                                                chk_report_abort("TALOS-2023-1793");
+                                                }
+
+                                        bits = fstVcdJobReserve(job, len);
+                                        for(j=0;j<len;j++)
+                                                {
+                                                bits[j] = ((vdata[j/8] >> (7 - (j & 7))) & 1) | '0';
+                                                }
+                                        job->text_len += len;
+                                        len = ((len - 1) / 8) + 1;
                                         }
+                                        else
+                                        {
+                                        if((uint64_t)(vdata - ws->mem) + len > traversal_mem_offs)
+                                                {
+                                                chk_report_abort("TALOS-2023-1793");
+                                                }
 
-                                srcdata = bufd;
+                                        fstVcdJobPut(job, vdata, len);
+                                        }
                                 }
                                 else
                                 {
-                                srcdata = vdata;
+                                unsigned char buf[8];
+                                unsigned char *srcdata = vdata;
+
+                                if(!(vli & 1))  /* very rare case, but possible */
+                                        {
+                                        int j;
+
+                                        for(j=0;j<8;j++)
+                                                {
+                                                buf[j] = ((vdata[0] >> (7 - (j & 7))) & 1) | '0';
+                                                }
+
+                                        len = 1;
+                                        srcdata = buf;
+                                        }
+
+                                fstVcdJobPutReal(xc, job, srcdata);
                                 }
 
-                        if(xc->double_endian_match)
+                        fstVcdJobPutId(job, ' ', idx+1);
+                        skiplen += len;
+                        }
+
+                ws->headptr[idx] += skiplen;
+                ws->length_remaining[idx] -= skiplen;
+
+                ws->tc_head[i] = ws->scatterptr[idx];
+                ws->scatterptr[idx] = 0;
+
+                if(ws->length_remaining[idx])
+                        {
+                        vli = fstGetVarint32NoSkip(ws->mem + ws->headptr[idx]);
+                        if(xc->signal_lens[idx] == 1)
                                 {
-                                memcpy(clone_d, srcdata, 8);
+                                int shamt = 2 << (vli & 1);
+                                tdelta = vli >> shamt;
                                 }
                                 else
                                 {
-                                int j;
+                                tdelta = vli >> 1;
+                                }
 
-                                for(j=0;j<8;j++)
-                                        {
-                                        clone_d[j] = srcdata[7-j];
-                                        }
+                        if((tdelta+i) >= tc_head_items)
+                                {
+                                chk_report_abort("TALOS-2023-1791");
                                 }
 
-                        snprintf(buf, 32, "r%.16g", d); /* this will write 19 bytes */
-                        return(buf);
+                        ws->scatterptr[idx] = ws->tc_head[i+tdelta];
+                        ws->tc_head[i+tdelta] = idx+1;
                         }
                 }
-                else
+        }
+
+job->tofs[blk->tsec_nitems] = job->text_len;
+}
+
+
+static void *fstVcdParallelWorker(void *arg)
+{
+struct fstVcdParallel *vp = (struct fstVcdParallel *)arg;
+struct fstReaderContext *xc = vp->xc;
+struct fstVcdScratch ws;
+
+memset(&ws, 0, sizeof(struct fstVcdScratch));
+ws.scatterptr = (uint32_t *)calloc(xc->maxhandle + 1, sizeof(uint32_t));
+ws.headptr = (uint32_t *)calloc(xc->maxhandle + 1, sizeof(uint32_t));
+ws.length_remaining = (uint32_t *)calloc(xc->maxhandle + 1, sizeof(uint32_t));
+
+for(;;)
+        {
+        struct fstVcdJob *job;
+        uint64_t pos;
+
+        pthread_mutex_lock(&vp->mutex);
+        while((vp->next < vp->count) && (vp->next - vp->emitted >= vp->num_jobs))
+                {
+                pthread_cond_wait(&vp->cond, &vp->mutex);
+                }
+        if(vp->next == vp->count)
                 {
-                return(fstExtractRvatDataFromFrame(xc, facidx, buf));
+                pthread_mutex_unlock(&vp->mutex);
+                break;
                 }
+        pos = vp->next++;
+        job = &vp->jobs[pos % vp->num_jobs];
+        job->index = vp->indices[pos];
+        job->state = FST_VCD_JOB_CLAIMED;
+        pthread_mutex_unlock(&vp->mutex);
+
+        fstVcdJobFormat(vp, job, &ws, (pos == 0));
+
+        pthread_mutex_lock(&vp->mutex);
+        job->state = FST_VCD_JOB_DONE;
+        pthread_cond_broadcast(&vp->cond);
+        pthread_mutex_unlock(&vp->mutex);
         }
+
+free(ws.scatterptr);
+free(ws.headptr);
+free(ws.length_remaining);
+free(ws.tc_head);
+free(ws.mem);
+
+return(NULL);
 }
 
-/* return(NULL); */
+
+static int fstReaderIterBlocksVcdParallel(struct fstReaderContext *xc, FILE *fv)
+{
+struct fstVcdParallel vp;
+pthread_t *threads;
+uint64_t previous_time = UINT64_MAX;
+uint32_t cur_blackout = 0;
+int dumpvars_state = 0;
+uint64_t k, i;
+unsigned int t;
+
+#ifndef FST_WRITEX_DISABLE
+fflush(fv);
+setvbuf(fv, (char *) NULL, _IONBF, 0); /* even buffered IO is slow so disable it and use our own routines that don't need seeking */
+xc->writex_fd = fileno(fv);
+#endif
+
+if(!xc->rvat_index_valid)
+        {
+        fstReaderBuildRvatIndex(xc);
+        }
+
+memset(&vp, 0, sizeof(struct fstVcdParallel));
+vp.xc = xc;
+vp.indices = (uint64_t *)malloc((xc->rvat_index_count + 1) * sizeof(uint64_t));
+for(k=0;k<xc->rvat_index_count;k++)
+        {
+        const struct fstRvatIndexEntry *ent = &xc->rvat_index[k];
+
+        if(xc->limit_range_valid)
+                {
+                if(ent->end_tim < xc->limit_range_start)
+                        {
+                        vp.blocks_skipped++;
+                        continue;
+                        }
+
+                if(ent->beg_tim > xc->limit_range_end)
+                        {
+                        break;
+                        }
+                }
+
+        vp.indices[vp.count++] = k;
+        if(vp.count == xc->vc_section_count) break; /* in case file is growing, keep with original block count */
+        }
+
+vp.num_jobs = 2 * xc->vcd_threads;
+vp.jobs = (struct fstVcdJob *)calloc(vp.num_jobs, sizeof(struct fstVcdJob));
+threads = (pthread_t *)malloc(xc->vcd_threads * sizeof(pthread_t));
+pthread_mutex_init(&vp.mutex, NULL);
+pthread_cond_init(&vp.cond, NULL);
+
+for(t=0;t<xc->vcd_threads;t++)
+        {
+        pthread_create(&threads[t], NULL, fstVcdParallelWorker, &vp);
+        }
+
+for(k=0;k<vp.count;k++)
+        {
+        struct fstVcdJob *job = &vp.jobs[k % vp.num_jobs];
+        struct fstRvatBlock *blk = &job->blk;
+        char wx_buf[32];
+        int wx_len;
+
+        pthread_mutex_lock(&vp.mutex);
+        while(job->state != FST_VCD_JOB_DONE)
+                {
+                pthread_cond_wait(&vp.cond, &vp.mutex);
+                }
+        pthread_mutex_unlock(&vp.mutex);
+
+        if(!job->failed)
+                {
+                if(job->frame)
+                        {
+                        if(blk->beg_tim)
+                                {
+                                if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
+                                wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", blk->beg_tim);
+                                fstWritex(xc, wx_buf, wx_len);
+                                if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
+                                }
+                        if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
+                                {
+                                if(blk->beg_tim == xc->blackout_times[cur_blackout])
+                                        {
+                                        wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
+                                        fstWritex(xc, wx_buf, wx_len);
+                                        }
+                                }
+
+                        fstWritex(xc, job->text, job->tofs[0]);
+                        }
+
+                for(i=0;i<blk->tsec_nitems;i++)
+                        {
+                        if(blk->time_table[i] != previous_time)
+                                {
+                                if(xc->limit_range_valid)
+                                        {
+                                        if(blk->time_table[i] > xc->limit_range_end)
+                                                {
+                                                break;
+                                                }
+                                        }
+
+                                if(dumpvars_state == 1) { wx_len = snprintf(wx_buf, 32, "$end\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 2; }
+                                wx_len = snprintf(wx_buf, 32, "#%" PRIu64 "\n", blk->time_table[i]);
+                                fstWritex(xc, wx_buf, wx_len);
+                                if(!dumpvars_state) { wx_len = snprintf(wx_buf, 32, "$dumpvars\n"); fstWritex(xc, wx_buf, wx_len); dumpvars_state = 1; }
+
+                                if((xc->num_blackouts)&&(cur_blackout != xc->num_blackouts))
+                                        {
+                                        if(blk->time_table[i] == xc->blackout_times[cur_blackout])
+                                                {
+                                                wx_len = snprintf(wx_buf, 32, "$dump%s $end\n", (xc->blackout_activity[cur_blackout++]) ? "on" : "off");
+                                                fstWritex(xc, wx_buf, wx_len);
+                                                }
+                                        }
+                                previous_time = blk->time_table[i];
+                                }
+
+                        if(job->tofs[i+1] != job->tofs[i])
+                                {
+                                fstWritex(xc, job->text + job->tofs[i], job->tofs[i+1] - job->tofs[i]);
+                                }
+                        }
+                }
+
+        fstReaderDeallocateRvatBlock(blk);
+
+        pthread_mutex_lock(&vp.mutex);
+        job->state = FST_VCD_JOB_FREE;
+        vp.emitted++;
+        pthread_cond_broadcast(&vp.cond);
+        pthread_mutex_unlock(&vp.mutex);
+        }
+
+for(t=0;t<xc->vcd_threads;t++)
+        {
+        pthread_join(threads[t], NULL);
+        }
+
+pthread_cond_destroy(&vp.cond);
+pthread_mutex_destroy(&vp.mutex);
+
+for(t=0;t<vp.num_jobs;t++)
+        {
+        free(vp.jobs[t].text);
+        free(vp.jobs[t].tofs);
+        }
+free(vp.jobs);
+free(vp.indices);
+free(threads);
+
+#ifndef FST_WRITEX_DISABLE
+fstWritex(xc, NULL, 0);
+#endif
+
+return(1);
 }
 
+#endif
+
 
 
 /**********************************************************************/
@@ -383,6 +383,7 @@ void            fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes);
 void            fstWriterSetEnvVar(void *ctx, const char *envvar);
 void            fstWriterSetFileType(void *ctx, enum fstFileType filetype);
 void            fstWriterSetPackType(void *ctx, enum fstWriterPackType typ);
+void            fstWriterSetPackThreads(void *ctx, int count);
 void            fstWriterSetParallelMode(void *ctx, int enable);
 void            fstWriterSetRepackOnClose(void *ctx, int enable);       /* type = 0 (none), 1 (libz) */
 void            fstWriterSetScope(void *ctx, enum fstScopeType scopetype,
@@ -424,6 +425,7 @@ signed char     fstReaderGetTimescale(void *ctx);
 int64_t         fstReaderGetTimezero(void *ctx);
 uint64_t        fstReaderGetValueChangeSectionCount(void *ctx);
 char *          fstReaderGetValueFromHandleAtTime(void *ctx, uint64_t tim, fstHandle facidx, char *buf);
+unsigned int    fstReaderGetValuesFromHandlesAtTime(void *ctx, uint64_t tim, const fstHandle *facidxs, char **bufs, unsigned int count);
 uint64_t        fstReaderGetVarCount(void *ctx);
 const char *    fstReaderGetVersionString(void *ctx);
 struct fstHier *fstReaderIterateHier(void *ctx);
@@ -445,8 +447,10 @@ void            fstReaderResetScope(void *ctx);
 void            fstReaderSetFacProcessMask(void *ctx, fstHandle facidx);
 void            fstReaderSetFacProcessMaskAll(void *ctx);
 void            fstReaderSetLimitTimeRange(void *ctx, uint64_t start_time, uint64_t end_time);
+int             fstReaderSetMmapMode(void *ctx, int enable);
 void            fstReaderSetUnlimitedTimeRange(void *ctx);
 void            fstReaderSetVcdExtensions(void *ctx, int enable);
+void            fstReaderSetVcdThreads(void *ctx, int count);
 
 
 /*
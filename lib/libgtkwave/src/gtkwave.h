@@ -14,6 +14,7 @@
 #include "gw-color-theme.h"
 #include "gw-hist-ent.h"
 #include "gw-hist-ent-factory.h"
+#include "gw-hist-columns.h"
 #include "gw-vector-ent.h"
 #include "gw-node.h"
 #include "gw-fac.h"
@@ -27,6 +28,7 @@
 #include "gw-blackout-regions.h"
 #include "gw-symbol.h"
 #include "gw-string-table.h"
+#include "gw-name-pool.h"
 #include "gw-enum-filter.h"
 #include "gw-enum-filter-list.h"
 #include "gw-dump-file.h"
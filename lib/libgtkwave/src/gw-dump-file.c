@@ -25,6 +25,9 @@ typedef struct
     gboolean has_supplemental_vartypes;
     gboolean has_escaped_names;
     gboolean uses_vhdl_component_format;
+
+    gboolean unloadable_traces;
+    gboolean compact_histories;
 } GwDumpFilePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(GwDumpFile, gw_dump_file, G_TYPE_OBJECT)
@@ -142,15 +145,9 @@ static void gw_dump_file_set_property(GObject *object,
             priv->time_dimension = g_value_get_enum(value);
             break;
 
-        case PROP_TIME_RANGE: {
-            GwTimeRange *time_range = g_value_get_object(value);
-            if (time_range == NULL) {
-                time_range = gw_time_range_new(0, 0);
-            }
-
-            g_set_object(&priv->time_range, time_range);
+        case PROP_TIME_RANGE:
+            gw_dump_file_set_time_range(self, g_value_get_object(value));
             break;
-        }
 
         case PROP_GLOBAL_TIME_OFFSET:
             priv->global_time_offset = g_value_get_int64(value);
@@ -328,7 +325,8 @@ static void gw_dump_file_class_init(GwDumpFileClass *klass)
                             NULL,
                             NULL,
                             GW_TYPE_TIME_RANGE,
-                            G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+                            G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                                G_PARAM_STATIC_STRINGS);
 
     properties[PROP_GLOBAL_TIME_OFFSET] =
         g_param_spec_int64("global-time-offset",
@@ -439,6 +437,187 @@ gboolean gw_dump_file_import_all(GwDumpFile *self, GError **error)
     return ret;
 }
 
+/**
+ * gw_dump_file_set_unloadable_traces:
+ * @self: A #GwDumpFile.
+ * @unloadable: Whether traces that are imported from now on can be unloaded.
+ *
+ * Unloadable traces keep their on-disk form after the import, so that they
+ * can be dropped with gw_dump_file_unload_trace() and imported again later.
+ * Histents are freed in batches: the memory of an import is only returned
+ * once all traces of that import are unloaded.
+ */
+void gw_dump_file_set_unloadable_traces(GwDumpFile *self, gboolean unloadable)
+{
+    g_return_if_fail(GW_IS_DUMP_FILE(self));
+
+    GwDumpFilePrivate *priv = gw_dump_file_get_instance_private(self);
+
+    priv->unloadable_traces = unloadable;
+}
+
+/**
+ * gw_dump_file_get_unloadable_traces:
+ * @self: A #GwDumpFile.
+ *
+ * Returns: %TRUE if imported traces can be unloaded.
+ */
+gboolean gw_dump_file_get_unloadable_traces(GwDumpFile *self)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), FALSE);
+
+    GwDumpFilePrivate *priv = gw_dump_file_get_instance_private(self);
+
+    return priv->unloadable_traces;
+}
+
+/**
+ * gw_dump_file_set_compact_histories:
+ * @self: A #GwDumpFile.
+ * @compact: Whether traces that are imported from now on are compacted.
+ *
+ * Compacted traces keep their history in #GwHistColumns instead of histents
+ * and have no harray, they have to be read through a #GwHistIter. The
+ * histents of an import are freed as soon as it is done. Files that are
+ * followed while they are being written keep their histents, because updates
+ * append to them.
+ */
+void gw_dump_file_set_compact_histories(GwDumpFile *self, gboolean compact)
+{
+    g_return_if_fail(GW_IS_DUMP_FILE(self));
+
+    GwDumpFilePrivate *priv = gw_dump_file_get_instance_private(self);
+
+    priv->compact_histories = compact;
+}
+
+/**
+ * gw_dump_file_get_compact_histories:
+ * @self: A #GwDumpFile.
+ *
+ * Returns: %TRUE if the histories of imported traces are compacted.
+ */
+gboolean gw_dump_file_get_compact_histories(GwDumpFile *self)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), FALSE);
+
+    GwDumpFilePrivate *priv = gw_dump_file_get_instance_private(self);
+
+    return priv->compact_histories;
+}
+
+/**
+ * gw_dump_file_unload_trace:
+ * @self: A #GwDumpFile.
+ * @node: An imported #GwNode.
+ *
+ * Drops the history of @node and puts it back into its unimported state, so
+ * the next import reads it again. The caller has to release the node's
+ * harray and columns beforehand, because they describe the dropped history.
+ *
+ * Returns: %TRUE if @node was unloaded, %FALSE if it can't be unloaded.
+ */
+gboolean gw_dump_file_unload_trace(GwDumpFile *self, GwNode *node)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), FALSE);
+    g_return_val_if_fail(node != NULL, FALSE);
+
+    if (GW_DUMP_FILE_GET_CLASS(self)->unload_trace == NULL) {
+        return FALSE;
+    }
+
+    return GW_DUMP_FILE_GET_CLASS(self)->unload_trace(self, node);
+}
+
+/**
+ * gw_dump_file_get_unloadable_nodes:
+ * @self: A #GwDumpFile.
+ *
+ * Returns: (transfer container) (element-type GwNode): The imported nodes
+ *          that can be unloaded.
+ */
+GPtrArray *gw_dump_file_get_unloadable_nodes(GwDumpFile *self)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), NULL);
+
+    if (GW_DUMP_FILE_GET_CLASS(self)->get_unloadable_nodes == NULL) {
+        return g_ptr_array_new();
+    }
+
+    return GW_DUMP_FILE_GET_CLASS(self)->get_unloadable_nodes(self);
+}
+
+/**
+ * gw_dump_file_get_trace_factory:
+ * @self: A #GwDumpFile.
+ * @node: An unloadable #GwNode.
+ *
+ * Returns the factory that holds the history of @node. Nodes that were
+ * imported together share a factory, whose memory is only returned once all
+ * of them are unloaded, see gw_hist_ent_factory_get_size().
+ *
+ * Returns: (transfer none) (nullable): The factory of @node, or %NULL if
+ *          @node can't be unloaded or its history was compacted.
+ */
+GwHistEntFactory *gw_dump_file_get_trace_factory(GwDumpFile *self, GwNode *node)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), NULL);
+    g_return_val_if_fail(node != NULL, NULL);
+
+    if (GW_DUMP_FILE_GET_CLASS(self)->get_trace_factory == NULL) {
+        return NULL;
+    }
+
+    return GW_DUMP_FILE_GET_CLASS(self)->get_trace_factory(self, node);
+}
+
+/**
+ * gw_dump_file_update:
+ * @self: A #GwDumpFile.
+ * @changed: (out) (optional): Return location for whether new data was read.
+ * @changed_nodes: (out) (optional) (transfer container) (element-type GwNode):
+ *                 Return location for the imported nodes whose history grew.
+ * @error: Return location for a #GError, or %NULL.
+ *
+ * Reads the data that was appended to a dump file which is still being
+ * written, if the file was loaded in follow mode. The value changes are
+ * added to the imported traces and the time range is extended. The harrays
+ * of the nodes in @changed_nodes have to be rebuilt by the caller, all other
+ * traces are unchanged.
+ *
+ * Returns: %TRUE on success, %FALSE if the file can't be updated anymore.
+ */
+gboolean gw_dump_file_update(GwDumpFile *self,
+                             gboolean *changed,
+                             GPtrArray **changed_nodes,
+                             GError **error)
+{
+    g_return_val_if_fail(GW_IS_DUMP_FILE(self), FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    gboolean changed_internal = FALSE;
+    GPtrArray *changed_nodes_internal = g_ptr_array_new();
+    gboolean ret = TRUE;
+
+    if (GW_DUMP_FILE_GET_CLASS(self)->update != NULL) {
+        ret = GW_DUMP_FILE_GET_CLASS(self)->update(self,
+                                                   &changed_internal,
+                                                   changed_nodes_internal,
+                                                   error);
+    }
+
+    if (changed != NULL) {
+        *changed = changed_internal;
+    }
+    if (changed_nodes != NULL) {
+        *changed_nodes = changed_nodes_internal;
+    } else {
+        g_ptr_array_free(changed_nodes_internal, TRUE);
+    }
+
+    return ret;
+}
+
 /**
  * gw_dump_file_get_tree:
  * @self: A #GwDumpFile.
@@ -614,6 +793,32 @@ GwTimeRange *gw_dump_file_get_time_range(GwDumpFile *self)
     return priv->time_range;
 }
 
+/**
+ * gw_dump_file_set_time_range:
+ * @self: A #GwDumpFile.
+ * @time_range: (nullable): The new time range.
+ *
+ * Sets the time range, which grows while a file in follow mode is updated.
+ */
+void gw_dump_file_set_time_range(GwDumpFile *self, GwTimeRange *time_range)
+{
+    g_return_if_fail(GW_IS_DUMP_FILE(self));
+
+    GwDumpFilePrivate *priv = gw_dump_file_get_instance_private(self);
+
+    GwTimeRange *empty_range = NULL;
+    if (time_range == NULL) {
+        empty_range = gw_time_range_new(0, 0);
+        time_range = empty_range;
+    }
+
+    if (g_set_object(&priv->time_range, time_range)) {
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_TIME_RANGE]);
+    }
+
+    g_clear_object(&empty_range);
+}
+
 /**
  * gw_dump_file_get_global_time_offset:
  * @self: A #GwDumpFile.
@@ -9,6 +9,7 @@
 #include "gw-facs.h"
 #include "gw-enum-filter-list.h"
 #include "gw-string-table.h"
+#include "gw-hist-ent-factory.h"
 
 G_BEGIN_DECLS
 
@@ -31,11 +32,31 @@ struct _GwDumpFileClass
 
     gboolean (*import_traces)(GwDumpFile *self, GwNode **nodes, GError **error);
     guint (*get_enum_filter_for_node)(GwDumpFile *self, GwNode *node);
+    gboolean (*unload_trace)(GwDumpFile *self, GwNode *node);
+    GPtrArray *(*get_unloadable_nodes)(GwDumpFile *self);
+    GwHistEntFactory *(*get_trace_factory)(GwDumpFile *self, GwNode *node);
+    gboolean (*update)(GwDumpFile *self,
+                       gboolean *changed,
+                       GPtrArray *changed_nodes,
+                       GError **error);
 };
 
 gboolean gw_dump_file_import_traces(GwDumpFile *self, GwNode **nodes, GError **error);
 gboolean gw_dump_file_import_all(GwDumpFile *self, GError **error);
 
+void gw_dump_file_set_unloadable_traces(GwDumpFile *self, gboolean unloadable);
+gboolean gw_dump_file_get_unloadable_traces(GwDumpFile *self);
+void gw_dump_file_set_compact_histories(GwDumpFile *self, gboolean compact);
+gboolean gw_dump_file_get_compact_histories(GwDumpFile *self);
+gboolean gw_dump_file_unload_trace(GwDumpFile *self, GwNode *node);
+GPtrArray *gw_dump_file_get_unloadable_nodes(GwDumpFile *self);
+GwHistEntFactory *gw_dump_file_get_trace_factory(GwDumpFile *self, GwNode *node);
+
+gboolean gw_dump_file_update(GwDumpFile *self,
+                             gboolean *changed,
+                             GPtrArray **changed_nodes,
+                             GError **error);
+
 GwTree *gw_dump_file_get_tree(GwDumpFile *self);
 GwFacs *gw_dump_file_get_facs(GwDumpFile *self);
 GwBlackoutRegions *gw_dump_file_get_blackout_regions(GwDumpFile *self);
@@ -47,6 +68,7 @@ guint gw_dump_file_get_enum_filter_for_node(GwDumpFile *self, GwNode *node);
 GwTimeDimension gw_dump_file_get_time_dimension(GwDumpFile *self);
 GwTime gw_dump_file_get_time_scale(GwDumpFile *self);
 GwTimeRange *gw_dump_file_get_time_range(GwDumpFile *self);
+void gw_dump_file_set_time_range(GwDumpFile *self, GwTimeRange *time_range);
 GwTime gw_dump_file_get_global_time_offset(GwDumpFile *self);
 
 gboolean gw_dump_file_has_nonimplicit_directions(GwDumpFile *self);
@@ -1,11 +1,16 @@
 #include "gw-facs.h"
 #include "gw-util.h"
 
+/* facs per work item of gw_facs_find(), small enough to balance the threads */
+#define GW_FACS_FIND_CHUNK 4096
+
 struct _GwFacs
 {
     GObject parent_instance;
 
     GPtrArray *facs;
+    GHashTable *index; /* name -> first symbol with that name, built by the first lookup */
+    GwNamePool *names;
 };
 
 G_DEFINE_TYPE(GwFacs, gw_facs, G_TYPE_OBJECT)
@@ -18,10 +23,18 @@ enum
 
 static GParamSpec *properties[N_PROPERTIES];
 
+static void gw_facs_invalidate_index(GwFacs *self)
+{
+    g_clear_pointer(&self->index, g_hash_table_unref);
+}
+
 static void gw_facs_finalize(GObject *object)
 {
     GwFacs *self = GW_FACS(object);
 
+    gw_facs_invalidate_index(self);
+    g_clear_object(&self->names);
+
     if (self->facs != NULL) {
         g_ptr_array_free(self->facs, TRUE);
     }
@@ -38,6 +51,7 @@ static void gw_facs_set_property(GObject *object,
 
     switch (property_id) {
         case PROP_LENGTH:
+            gw_facs_invalidate_index(self);
             g_ptr_array_set_size(self->facs, g_value_get_uint(value));
             break;
 
@@ -99,6 +113,7 @@ void gw_facs_set(GwFacs *self, guint index, GwSymbol *symbol)
     g_return_if_fail(GW_IS_FACS(self));
     g_return_if_fail(index < self->facs->len);
 
+    gw_facs_invalidate_index(self);
     g_ptr_array_index(self->facs, index) = symbol;
 }
 
@@ -128,6 +143,22 @@ guint gw_facs_get_length(GwFacs *self)
     return self->facs->len;
 }
 
+/**
+ * gw_facs_set_name_pool:
+ * @self: A #GwFacs.
+ * @names: (nullable): The pool that holds the symbol names.
+ *
+ * Keeps the pool the loader allocated the symbol names from alive as long
+ * as the facs.
+ */
+void gw_facs_set_name_pool(GwFacs *self, GwNamePool *names)
+{
+    g_return_if_fail(GW_IS_FACS(self));
+    g_return_if_fail(names == NULL || GW_IS_NAME_POOL(names));
+
+    g_set_object(&self->names, names);
+}
+
 // TODO: remove
 GwSymbol **gw_facs_get_array(GwFacs *self)
 {
@@ -168,6 +199,7 @@ void gw_facs_order_from_tree(GwFacs *self, GwTree *tree)
 
     g_ptr_array_free(self->facs, TRUE);
     self->facs = g_steal_pointer(&sorted_facs->facs);
+    gw_facs_invalidate_index(self);
 
     g_object_unref(sorted_facs);
 }
@@ -187,4 +219,217 @@ void gw_facs_sort(GwFacs *self)
     // used a custom heapsort for some platforms, because quicksort can be very
     // slow if the facs are already sorted.
     g_ptr_array_sort(self->facs, sigcmp);
+    gw_facs_invalidate_index(self);
+}
+
+static void gw_facs_build_index(GwFacs *self)
+{
+    self->index = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (guint i = 0; i < self->facs->len; i++) {
+        GwSymbol *symbol = g_ptr_array_index(self->facs, i);
+
+        if (symbol != NULL && !g_hash_table_contains(self->index, symbol->name)) {
+            g_hash_table_insert(self->index, symbol->name, symbol);
+        }
+    }
+}
+
+/**
+ * gw_facs_lookup:
+ * @self: A #GwFacs.
+ * @name: The full name of the symbol.
+ *
+ * Looks up a symbol by its exact name. The first lookup builds a hash index
+ * of all names, which is kept until the facs are changed. If several
+ * symbols have the same name the first one in the facs is returned.
+ *
+ * Returns: (transfer none) (nullable): The symbol or %NULL if no symbol has
+ *          this name.
+ */
+GwSymbol *gw_facs_lookup(GwFacs *self, const gchar *name)
+{
+    g_return_val_if_fail(GW_IS_FACS(self), NULL);
+    g_return_val_if_fail(name != NULL, NULL);
+
+    if (self->index == NULL) {
+        gw_facs_build_index(self);
+    }
+
+    return g_hash_table_lookup(self->index, name);
+}
+
+/**
+ * gw_facs_lookup_many:
+ * @self: A #GwFacs.
+ * @names: (array length=n_names): The names to look up, %NULL entries are
+ *         skipped.
+ * @n_names: The number of names.
+ * @symbols: (out caller-allocates) (array length=n_names): Receives the
+ *           symbol for every name, or %NULL if it wasn't found.
+ *
+ * Looks up a whole list of names, like gw_facs_lookup() does for a single
+ * name.
+ *
+ * Returns: The number of names that were found.
+ */
+guint gw_facs_lookup_many(GwFacs *self,
+                          const gchar *const *names,
+                          guint n_names,
+                          GwSymbol **symbols)
+{
+    g_return_val_if_fail(GW_IS_FACS(self), 0);
+    g_return_val_if_fail(names != NULL || n_names == 0, 0);
+    g_return_val_if_fail(symbols != NULL || n_names == 0, 0);
+
+    if (self->index == NULL) {
+        gw_facs_build_index(self);
+    }
+
+    guint found = 0;
+    for (guint i = 0; i < n_names; i++) {
+        symbols[i] = names[i] != NULL ? g_hash_table_lookup(self->index, names[i]) : NULL;
+        if (symbols[i] != NULL) {
+            found++;
+        }
+    }
+
+    return found;
+}
+
+typedef struct
+{
+    GwFacs *self;
+    GwFacsMatchFunc func;
+    gpointer user_data;
+    guint max_matches;
+
+    guint n_chunks;
+    gint next_chunk;
+    gint matches; /* matches in all finished chunks */
+    GPtrArray **chunk_matches;
+} FindJob;
+
+static void gw_facs_find_chunk(FindJob *job, guint chunk)
+{
+    GPtrArray *facs = job->self->facs;
+    guint start = chunk * GW_FACS_FIND_CHUNK;
+    guint end = MIN(start + GW_FACS_FIND_CHUNK, facs->len);
+
+    GPtrArray *matches = g_ptr_array_new();
+
+    for (guint i = start; i < end; i++) {
+        GwSymbol *symbol = g_ptr_array_index(facs, i);
+
+        // Duplicate names are next to each other in the sorted facs.
+        if (i > 0) {
+            GwSymbol *prev = g_ptr_array_index(facs, i - 1);
+            if (strcmp(symbol->name, prev->name) == 0) {
+                continue;
+            }
+        }
+
+        if (job->func(symbol, job->user_data)) {
+            g_ptr_array_add(matches, symbol);
+        }
+    }
+
+    job->chunk_matches[chunk] = matches;
+    g_atomic_int_add(&job->matches, matches->len);
+}
+
+static gpointer gw_facs_find_worker(gpointer data)
+{
+    FindJob *job = data;
+
+    while (TRUE) {
+        // Chunks are handed out in order, so once the finished chunks hold
+        // enough matches the remaining ones can't contribute anymore.
+        if (job->max_matches > 0 && (guint)g_atomic_int_get(&job->matches) >= job->max_matches) {
+            break;
+        }
+
+        guint chunk = g_atomic_int_add(&job->next_chunk, 1);
+        if (chunk >= job->n_chunks) {
+            break;
+        }
+
+        gw_facs_find_chunk(job, chunk);
+    }
+
+    return NULL;
+}
+
+/**
+ * gw_facs_find:
+ * @self: A #GwFacs.
+ * @func: (scope call): The function that decides whether a symbol matches.
+ * @user_data: User data for @func.
+ * @max_matches: The maximum number of matches, or 0 for no limit.
+ *
+ * Finds the symbols for which @func returns %TRUE. Symbols with the same
+ * name as their predecessor are skipped, so every name is reported once.
+ *
+ * Large facs are searched by several threads, @func therefore has to be
+ * thread-safe. The matches are returned in the order of the facs all the
+ * same, and a limited search returns the first @max_matches of them.
+ *
+ * Returns: (transfer container) (element-type GwSymbol): The matching
+ *          symbols.
+ */
+GPtrArray *gw_facs_find(GwFacs *self,
+                        GwFacsMatchFunc func,
+                        gpointer user_data,
+                        guint max_matches)
+{
+    g_return_val_if_fail(GW_IS_FACS(self), NULL);
+    g_return_val_if_fail(func != NULL, NULL);
+
+    FindJob job = {
+        .self = self,
+        .func = func,
+        .user_data = user_data,
+        .max_matches = max_matches,
+        .n_chunks = (self->facs->len + GW_FACS_FIND_CHUNK - 1) / GW_FACS_FIND_CHUNK,
+        .next_chunk = 0,
+        .matches = 0,
+    };
+    job.chunk_matches = g_new0(GPtrArray *, job.n_chunks);
+
+    guint n_workers = MIN((guint)g_get_num_processors(), job.n_chunks);
+    if (n_workers > 1) {
+        GThread **threads = g_new(GThread *, n_workers);
+        for (guint i = 0; i < n_workers; i++) {
+            threads[i] = g_thread_new("facs-find", gw_facs_find_worker, &job);
+        }
+        for (guint i = 0; i < n_workers; i++) {
+            g_thread_join(threads[i]);
+        }
+        g_free(threads);
+    } else {
+        gw_facs_find_worker(&job);
+    }
+
+    GPtrArray *matches = g_ptr_array_new();
+
+    // Unsearched chunks only follow the searched ones.
+    for (guint i = 0; i < job.n_chunks && job.chunk_matches[i] != NULL; i++) {
+        GPtrArray *chunk_matches = job.chunk_matches[i];
+
+        for (guint j = 0; j < chunk_matches->len; j++) {
+            if (max_matches > 0 && matches->len >= max_matches) {
+                break;
+            }
+            g_ptr_array_add(matches, g_ptr_array_index(chunk_matches, j));
+        }
+    }
+
+    for (guint i = 0; i < job.n_chunks; i++) {
+        if (job.chunk_matches[i] != NULL) {
+            g_ptr_array_free(job.chunk_matches[i], TRUE);
+        }
+    }
+    g_free(job.chunk_matches);
+
+    return matches;
 }
@@ -2,6 +2,7 @@
 
 #include <glib-object.h>
 #include "gw-symbol.h"
+#include "gw-name-pool.h"
 #include "gw-tree.h"
 
 G_BEGIN_DECLS
@@ -9,6 +10,8 @@ G_BEGIN_DECLS
 #define GW_TYPE_FACS (gw_facs_get_type())
 G_DECLARE_FINAL_TYPE(GwFacs, gw_facs, GW, FACS, GObject)
 
+typedef gboolean (*GwFacsMatchFunc)(GwSymbol *symbol, gpointer user_data);
+
 GwFacs *gw_facs_new(guint length);
 
 void gw_facs_set(GwFacs *self, guint index, GwSymbol *symbol);
@@ -16,9 +19,21 @@ GwSymbol *gw_facs_get(GwFacs *self, guint index);
 const GwSymbol *gw_facs_get_const(GwFacs *self, guint index);
 
 guint gw_facs_get_length(GwFacs *self);
+void gw_facs_set_name_pool(GwFacs *self, GwNamePool *names);
 GwSymbol **gw_facs_get_array(GwFacs *self);
 
 void gw_facs_order_from_tree(GwFacs *self, GwTree *tree);
 void gw_facs_sort(GwFacs *self);
 
+GwSymbol *gw_facs_lookup(GwFacs *self, const gchar *name);
+guint gw_facs_lookup_many(GwFacs *self,
+                          const gchar *const *names,
+                          guint n_names,
+                          GwSymbol **symbols);
+
+GPtrArray *gw_facs_find(GwFacs *self,
+                        GwFacsMatchFunc func,
+                        gpointer user_data,
+                        guint max_matches);
+
 G_END_DECLS
@@ -21,6 +21,15 @@ typedef struct
 #pragma pack(pop)
 #endif
 
+/* a trace that was imported for a time window only */
+typedef struct
+{
+    GwFac *fac;
+    GwTime start;
+    GwTime end;
+    GwHistEntFactory *hist_ent_factory;
+} GwWindowedTrace;
+
 struct _GwFstFile
 {
     GwDumpFile parent_instance;
@@ -43,6 +52,16 @@ struct _GwFstFile
     GwTime time_scale;
 
     GwHistEntFactory *hist_ent_factory;
+    GByteArray *vector_buffer;
+    GPtrArray *compact_nodes; /* the nodes of the running import, if it is compacted */
+
+    gchar *filename;
+    guint64 limit_start;
+    guint64 limit_end;
+    gboolean use_mmap; /* also map the readers of import workers */
+
+    GwTimeRange *import_window;
+    GHashTable *windowed_traces; /* GwNode* -> GwWindowedTrace* */
 
     gboolean preserve_glitches;
     gboolean preserve_glitches_real;
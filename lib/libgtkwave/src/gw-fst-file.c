@@ -4,15 +4,58 @@
 
 G_DEFINE_TYPE(GwFstFile, gw_fst_file, GW_TYPE_DUMP_FILE)
 
+/*
+ * Where fst_callback2() stores the value changes. The serial import writes
+ * straight into fst_table, parallel workers use their own table and time
+ * window. All of them share the histent factory of the file.
+ */
+typedef struct
+{
+    GwFstFile *self;
+    GwLx2Entry *table; /* indexed by fac, or through slots by handle if slots is set */
+    const gint *slots;
+    GByteArray *vector_buffer;
+    guint64 min_time;
+    guint64 max_time;
+} ImportContext;
+
+typedef struct
+{
+    ImportContext context;
+    void *fst_reader;
+    guint64 limit_start;
+    guint64 limit_end;
+    const fstHandle *handles;
+    guint num_handles;
+    GThread *thread;
+} ImportWorker;
+
 static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np);
 static void gw_fst_file_set_fac_process_mask(GwFstFile *self, GwNode *np);
 static void gw_fst_file_import_masked(GwFstFile *self);
+static void gw_fst_file_import_windowed(GwFstFile *self, GwNode **nodes);
+
+static void gw_windowed_trace_free(GwWindowedTrace *trace)
+{
+    g_clear_object(&trace->hist_ent_factory);
+    g_free(trace);
+}
+
+/* remembers the nodes whose histents are compacted at the end of the import */
+static void gw_fst_file_add_compact_node(GwFstFile *self, GwNode *np)
+{
+    if (self->compact_nodes != NULL && np->head.next != NULL) {
+        g_ptr_array_add(self->compact_nodes, np);
+    }
+}
 
 static void gw_fst_file_dispose(GObject *object)
 {
     GwFstFile *self = GW_FST_FILE(object);
 
     g_clear_object(&self->hist_ent_factory);
+    g_clear_pointer(&self->windowed_traces, g_hash_table_unref);
+    g_clear_object(&self->import_window);
 
     G_OBJECT_CLASS(gw_fst_file_parent_class)->dispose(object);
 }
@@ -25,6 +68,8 @@ static void gw_fst_file_finalize(GObject *object)
     g_clear_pointer(&self->subvar_jrb, jrb_free_tree);
     g_clear_pointer(&self->synclock_jrb, jrb_free_tree);
     g_clear_pointer(&self->enum_nptrs_jrb, jrb_free_tree);
+    g_clear_pointer(&self->vector_buffer, g_byte_array_unref);
+    g_clear_pointer(&self->filename, g_free);
 
     G_OBJECT_CLASS(gw_fst_file_parent_class)->finalize(object);
 }
@@ -34,12 +79,30 @@ static gboolean gw_fst_file_import_traces(GwDumpFile *dump_file, GwNode **nodes,
     GwFstFile *self = GW_FST_FILE(dump_file);
     (void)error;
 
-    for (GwNode **iter = nodes; *iter != NULL; iter++) {
-        GwNode *node = *iter;
+    // The histents of a compacted import only live until the import is done.
+    GwHistEntFactory *file_hist_ent_factory = self->hist_ent_factory;
+    if (gw_dump_file_get_compact_histories(dump_file)) {
+        self->hist_ent_factory = gw_hist_ent_factory_new();
+        self->compact_nodes = g_ptr_array_new();
+    }
+
+    if (self->import_window != NULL || gw_dump_file_get_unloadable_traces(dump_file)) {
+        gw_fst_file_import_windowed(self, nodes);
+    } else {
+        for (GwNode **iter = nodes; *iter != NULL; iter++) {
+            GwNode *node = *iter;
 
-        gw_fst_file_set_fac_process_mask(self, node);
+            gw_fst_file_set_fac_process_mask(self, node);
+        }
+        gw_fst_file_import_masked(self);
+    }
+
+    if (self->compact_nodes != NULL) {
+        gw_hist_columns_compact_nodes(self->compact_nodes);
+        g_clear_pointer(&self->compact_nodes, g_ptr_array_unref);
+        g_object_unref(self->hist_ent_factory);
+        self->hist_ent_factory = file_hist_ent_factory;
     }
-    gw_fst_file_import_masked(self);
 
     return TRUE;
 }
@@ -57,6 +120,50 @@ static guint gw_fst_file_get_enum_filter_for_node(GwDumpFile *dump_file, GwNode
     return enum_nptr != NULL ? enum_nptr->val.ui : 0;
 }
 
+static gboolean gw_fst_file_unload_trace(GwDumpFile *dump_file, GwNode *node)
+{
+    GwFstFile *self = GW_FST_FILE(dump_file);
+
+    GwWindowedTrace *trace = g_hash_table_lookup(self->windowed_traces, node);
+    if (trace == NULL) {
+        return FALSE;
+    }
+
+    memset(&node->head, 0, sizeof(GwHistEnt));
+    node->curr = NULL;
+    node->harray = NULL;
+    node->numhist = 0;
+    node->mv.mvlfac = trace->fac;
+
+    g_hash_table_remove(self->windowed_traces, node);
+
+    return TRUE;
+}
+
+static GPtrArray *gw_fst_file_get_unloadable_nodes(GwDumpFile *dump_file)
+{
+    GwFstFile *self = GW_FST_FILE(dump_file);
+    GPtrArray *nodes = g_ptr_array_sized_new(g_hash_table_size(self->windowed_traces));
+
+    GHashTableIter iter;
+    gpointer node;
+    g_hash_table_iter_init(&iter, self->windowed_traces);
+    while (g_hash_table_iter_next(&iter, &node, NULL)) {
+        g_ptr_array_add(nodes, node);
+    }
+
+    return nodes;
+}
+
+static GwHistEntFactory *gw_fst_file_get_trace_factory(GwDumpFile *dump_file, GwNode *node)
+{
+    GwFstFile *self = GW_FST_FILE(dump_file);
+
+    GwWindowedTrace *trace = g_hash_table_lookup(self->windowed_traces, node);
+
+    return trace != NULL ? trace->hist_ent_factory : NULL;
+}
+
 static void gw_fst_file_class_init(GwFstFileClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
@@ -67,11 +174,30 @@ static void gw_fst_file_class_init(GwFstFileClass *klass)
 
     dump_file_class->import_traces = gw_fst_file_import_traces;
     dump_file_class->get_enum_filter_for_node = gw_fst_file_get_enum_filter_for_node;
+    dump_file_class->unload_trace = gw_fst_file_unload_trace;
+    dump_file_class->get_unloadable_nodes = gw_fst_file_get_unloadable_nodes;
+    dump_file_class->get_trace_factory = gw_fst_file_get_trace_factory;
 }
 
 static void gw_fst_file_init(GwFstFile *self)
 {
     self->hist_ent_factory = gw_hist_ent_factory_new();
+    self->vector_buffer = g_byte_array_new();
+    self->windowed_traces =
+        g_hash_table_new_full(g_direct_hash,
+                              g_direct_equal,
+                              NULL,
+                              (GDestroyNotify)gw_windowed_trace_free);
+}
+
+static void import_context_init(ImportContext *context, GwFstFile *self)
+{
+    context->self = self;
+    context->table = self->fst_table;
+    context->slots = NULL;
+    context->vector_buffer = self->vector_buffer;
+    context->min_time = 0;
+    context->max_time = G_MAXUINT64;
 }
 
 /*
@@ -110,11 +236,18 @@ static void fst_callback2(void *user_callback_data_pointer,
                           const unsigned char *value,
                           uint32_t plen)
 {
-    GwFstFile *self = user_callback_data_pointer;
+    ImportContext *context = user_callback_data_pointer;
+    GwFstFile *self = context->self;
 
-    fstHandle facidx = self->mvlfacs_rvs_alias[--txidx];
+    if (tim < context->min_time || tim > context->max_time) {
+        return; /* belongs to another worker */
+    }
+
+    txidx--;
+    fstHandle facidx = self->mvlfacs_rvs_alias[txidx];
     GwHistEnt *htemp;
-    GwLx2Entry *l2e = &self->fst_table[facidx];
+    GwLx2Entry *l2e = context->slots != NULL ? &context->table[context->slots[txidx]]
+                                             : &context->table[facidx];
     GwFac *f = &self->mvlfacs[facidx];
 
     // TODO: report progress
@@ -133,7 +266,9 @@ static void fst_callback2(void *user_callback_data_pointer,
         }
 
         if (f->len > 1) {
-            char *h_vector = g_malloc(f->len);
+            // Decode into a scratch buffer first, so duplicates never touch the vector pool.
+            g_byte_array_set_size(context->vector_buffer, f->len);
+            char *h_vector = (char *)context->vector_buffer->data;
             if (vt != GW_VAR_TYPE_VCD_PORT) {
                 memcpy(h_vector, value, f->len);
             } else {
@@ -149,13 +284,14 @@ static void fst_callback2(void *user_callback_data_pointer,
             {
                 if ((!memcmp(l2e->histent_curr->v.h_vector, h_vector, f->len)) &&
                     (!self->preserve_glitches)) {
-                    g_free(h_vector);
                     return;
                 }
             }
 
-            htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
-            htemp->v.h_vector = h_vector;
+            htemp = gw_hist_ent_factory_alloc(context->self->hist_ent_factory);
+            htemp->v.h_vector =
+                gw_hist_ent_factory_alloc_vector(context->self->hist_ent_factory, f->len);
+            memcpy(htemp->v.h_vector, h_vector, f->len);
         } else {
             unsigned char h_val;
 
@@ -188,7 +324,7 @@ static void fst_callback2(void *user_callback_data_pointer,
                 }
             }
 
-            htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            htemp = gw_hist_ent_factory_alloc(context->self->hist_ent_factory);
             htemp->v.h_val = h_val;
         }
     } else if (f->flags & GW_FAC_FLAG_DOUBLE) {
@@ -211,12 +347,23 @@ static void fst_callback2(void *user_callback_data_pointer,
         otherwise...
         */
 
-        htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        htemp = gw_hist_ent_factory_alloc(context->self->hist_ent_factory);
         memcpy(&htemp->v.h_double, value, sizeof(double));
         htemp->flags = GW_HIST_ENT_FLAG_REAL;
     } else /* string */
     {
-        unsigned char *s = g_malloc(plen + 1);
+        if ((l2e->histent_curr) && (l2e->histent_curr->v.h_vector)) /* remove duplicate values */
+        {
+            if ((strlen(l2e->histent_curr->v.h_vector) == plen) &&
+                (!memcmp(l2e->histent_curr->v.h_vector, value, plen)) &&
+                (!self->preserve_glitches)) {
+                return;
+            }
+        }
+
+        unsigned char *s =
+            (unsigned char *)gw_hist_ent_factory_alloc_vector(context->self->hist_ent_factory,
+                                                              plen + 1);
         uint32_t pidx;
 
         for (pidx = 0; pidx < plen; pidx++) {
@@ -234,16 +381,7 @@ static void fst_callback2(void *user_callback_data_pointer,
         }
         s[pidx] = 0;
 
-        if ((l2e->histent_curr) && (l2e->histent_curr->v.h_vector)) /* remove duplicate values */
-        {
-            if ((!strcmp(l2e->histent_curr->v.h_vector, (const char *)value)) &&
-                (!self->preserve_glitches)) {
-                g_free(s);
-                return;
-            }
-        }
-
-        htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        htemp = gw_hist_ent_factory_alloc(context->self->hist_ent_factory);
         htemp->v.h_vector = (char *)s;
         htemp->flags = GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING;
     }
@@ -281,6 +419,9 @@ static void fst_resolver(GwNode *np, GwNode *resolve)
     np->curr = resolve->curr;
     np->harray = resolve->harray;
     np->numhist = resolve->numhist;
+    if (resolve->columns != NULL) {
+        np->columns = gw_hist_columns_ref(resolve->columns);
+    }
     np->mv.mvlfac = NULL;
 }
 
@@ -309,6 +450,7 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
 
         if (!(f = np->mv.mvlfac)) {
             fst_resolver(nold, np);
+            gw_fst_file_add_compact_node(self, nold);
             return; /* already imported */
         }
     }
@@ -325,13 +467,18 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
 
     if (!(f->flags & GW_FAC_FLAG_SYNVEC)) {
         fstReaderSetFacProcessMask(self->fst_reader, self->mvlfacs[txidx].node_alias + 1);
-        fstReaderIterBlocks2(self->fst_reader, fst_callback, fst_callback2, self, NULL);
+        ImportContext context;
+        import_context_init(&context, self);
+        fstReaderIterBlocks2(self->fst_reader, fst_callback, fst_callback2, &context, NULL);
         fstReaderClrFacProcessMask(self->fst_reader, self->mvlfacs[txidx].node_alias + 1);
     }
 
-    histent_tail = htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+    /* the end caps and the initial value are needed in any case */
+    GwHistEnt *caps = gw_hist_ent_factory_alloc_n(self->hist_ent_factory, 3);
+
+    histent_tail = htemp = &caps[0];
     if (len > 1) {
-        htemp->v.h_vector = g_malloc(len);
+        htemp->v.h_vector = gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
         for (i = 0; i < len; i++)
             htemp->v.h_vector[i] = GW_BIT_Z;
     } else {
@@ -339,15 +486,17 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
     }
     htemp->time = GW_TIME_MAX;
 
-    htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+    htemp = &caps[1];
     if (len > 1) {
         if (!(f->flags & GW_FAC_FLAG_DOUBLE)) {
             if (!(f->flags & GW_FAC_FLAG_STRING)) {
-                htemp->v.h_vector = g_malloc(len);
+                htemp->v.h_vector = gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
                 for (i = 0; i < len; i++)
                     htemp->v.h_vector[i] = GW_BIT_X;
             } else {
-                htemp->v.h_vector = g_strdup("UNDEF");
+                htemp->v.h_vector =
+                    gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, sizeof("UNDEF"));
+                memcpy(htemp->v.h_vector, "UNDEF", sizeof("UNDEF"));
                 htemp->flags = GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING;
             }
         } else {
@@ -369,7 +518,7 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
 
     if (!(f->flags & (GW_FAC_FLAG_DOUBLE | GW_FAC_FLAG_STRING))) {
         if (len > 1) {
-            np->head.v.h_vector = g_malloc(len);
+            np->head.v.h_vector = gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
             for (i = 0; i < len; i++)
                 np->head.v.h_vector[i] = GW_BIT_X;
         } else {
@@ -383,7 +532,7 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
     }
 
     {
-        GwHistEnt *htemp2 = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *htemp2 = &caps[2];
         htemp2->time = -1;
         if (len > 1) {
             htemp2->v.h_vector = htempx->v.h_vector;
@@ -404,9 +553,11 @@ static void gw_fst_file_import_trace(GwFstFile *self, GwNode *np)
 
     np->curr = histent_tail;
     np->mv.mvlfac = NULL; /* it's imported and cached so we can forget it's an mvlfac now */
+    gw_fst_file_add_compact_node(self, np);
 
     if (nold != np) {
         fst_resolver(nold, np);
+        gw_fst_file_add_compact_node(self, nold);
     }
 }
 
@@ -427,6 +578,9 @@ static void expand_synvec(GwFstFile *self, int txidx, const char *s)
     unsigned char value[2] = {0, 0};
     unsigned char pval = 0;
 
+    ImportContext context;
+    import_context_init(&context, self);
+
     scopy = g_strdup(s);
     vs = g_malloc0(strlen(s) + 1); /* will never be as big as original string */
     pnt = scopy;
@@ -457,7 +611,7 @@ static void expand_synvec(GwFstFile *self, int txidx, const char *s)
                 if (value[0] != pval) /* collapse new == old value transitions so new is ignored */
                 {
                     if ((tim >= tim_max) || (xi == xs)) {
-                        fst_callback2(self, tim, txidx, value, 0);
+                        fst_callback2(&context, tim, txidx, value, 0);
                         tim_max = tim;
                     }
                     pval = value[0];
@@ -497,6 +651,7 @@ static void gw_fst_file_set_fac_process_mask(GwFstFile *self, GwNode *np)
 
         if (!(np->mv.mvlfac)) {
             fst_resolver(nold, np);
+            gw_fst_file_add_compact_node(self, nold);
             return; /* already imported */
         }
     }
@@ -517,6 +672,187 @@ static void gw_fst_file_set_fac_process_mask(GwFstFile *self, GwNode *np)
     }
 }
 
+/*
+ * mirrors the duplicate value checks in fst_callback2()
+ */
+static gboolean import_is_duplicate(GwFac *f, GwHistEnt *prev, GwHistEnt *h)
+{
+    if (f->flags & GW_FAC_FLAG_STRING) {
+        return prev->v.h_vector != NULL && strcmp(prev->v.h_vector, h->v.h_vector) == 0;
+    } else if (f->flags & GW_FAC_FLAG_DOUBLE) {
+        return prev->v.h_vector != NULL &&
+               memcmp(&prev->v.h_double, &h->v.h_double, sizeof(double)) == 0;
+    } else if (f->len > 1) {
+        return prev->v.h_vector != NULL && memcmp(prev->v.h_vector, h->v.h_vector, f->len) == 0;
+    } else {
+        return prev->v.h_val == h->v.h_val;
+    }
+}
+
+static gpointer gw_fst_file_import_worker(gpointer data)
+{
+    ImportWorker *worker = data;
+
+    fstReaderIterBlocksSetNativeDoublesOnCallback(worker->fst_reader, 1);
+    fstReaderSetLimitTimeRange(worker->fst_reader, worker->limit_start, worker->limit_end);
+    for (guint i = 0; i < worker->num_handles; i++) {
+        fstReaderSetFacProcessMask(worker->fst_reader, worker->handles[i]);
+    }
+
+    fstReaderIterBlocks2(worker->fst_reader,
+                         fst_callback,
+                         fst_callback2,
+                         &worker->context,
+                         NULL);
+
+    return NULL;
+}
+
+static gboolean gw_fst_file_is_zwrapped(GwFstFile *self)
+{
+    FILE *file = fopen(self->filename, "rb");
+    if (file == NULL) {
+        return TRUE;
+    }
+
+    gboolean zwrapped = fgetc(file) == FST_BL_ZWRAPPER;
+    fclose(file);
+
+    return zwrapped;
+}
+
+/*
+ * Value change blocks are compressed independently, so the masked traces can
+ * be extracted by several readers at once. Each worker opens its own reader
+ * on the file and gets a slice of the time range. Blocks that straddle a
+ * slice boundary are decoded by both neighbours, but every value change is
+ * kept only by the worker that owns its time. Afterwards the per-worker
+ * histories are chained together in time order.
+ *
+ * Returns FALSE if the import has to be done serially.
+ */
+static gboolean gw_fst_file_iter_blocks_parallel(GwFstFile *self)
+{
+    // Windowed imports only read a few blocks, which isn't worth the threads.
+    if (self->filename == NULL || self->import_window != NULL || self->preserve_glitches ||
+        self->preserve_glitches_real) {
+        return FALSE;
+    }
+
+    guint64 span = self->limit_end - self->limit_start;
+    guint n_workers = MIN((guint64)g_get_num_processors(),
+                          fstReaderGetValueChangeSectionCount(self->fst_reader));
+    n_workers = MIN(n_workers, span);
+    if (n_workers < 2 || gw_fst_file_is_zwrapped(self)) {
+        return FALSE;
+    }
+
+    GArray *handles = g_array_new(FALSE, FALSE, sizeof(fstHandle));
+    gint *slots = g_new(gint, self->fst_maxhandle);
+
+    for (fstHandle txidxi = 0; txidxi < self->fst_maxhandle; txidxi++) {
+        if (!fstReaderGetFacProcessMask(self->fst_reader, txidxi + 1)) {
+            continue;
+        }
+
+        /* the first value of a slice would look like a new event */
+        GwNode *np = self->fst_table[self->mvlfacs_rvs_alias[txidxi]].np;
+        if (np->vartype == GW_VAR_TYPE_VCD_EVENT) {
+            g_array_free(handles, TRUE);
+            g_free(slots);
+            return FALSE;
+        }
+
+        fstHandle handle = txidxi + 1;
+        slots[txidxi] = handles->len;
+        g_array_append_val(handles, handle);
+    }
+
+    ImportWorker *workers = g_new0(ImportWorker, n_workers);
+    guint started = 0;
+
+    for (guint i = 0; i < n_workers; i++) {
+        ImportWorker *worker = &workers[i];
+
+        worker->fst_reader = fstReaderOpen(self->filename);
+        if (worker->fst_reader == NULL) {
+            break;
+        }
+        if (self->use_mmap) {
+            fstReaderSetMmapMode(worker->fst_reader, TRUE);
+        }
+
+        guint64 slice_start = self->limit_start + span / n_workers * i;
+        guint64 slice_end = self->limit_start + span / n_workers * (i + 1) - 1;
+
+        worker->limit_start = i == 0 ? self->limit_start : slice_start;
+        worker->limit_end = i == n_workers - 1 ? self->limit_end : slice_end;
+        worker->handles = (const fstHandle *)handles->data;
+        worker->num_handles = handles->len;
+
+        worker->context.self = self;
+        worker->context.table = g_new0(GwLx2Entry, handles->len);
+        worker->context.slots = slots;
+        worker->context.vector_buffer = g_byte_array_new();
+        worker->context.min_time = i == 0 ? 0 : slice_start;
+        worker->context.max_time = i == n_workers - 1 ? G_MAXUINT64 : slice_end;
+
+        started++;
+    }
+
+    if (started == n_workers) {
+        for (guint i = 0; i < n_workers; i++) {
+            workers[i].thread = g_thread_new("fst-import", gw_fst_file_import_worker, &workers[i]);
+        }
+        for (guint i = 0; i < n_workers; i++) {
+            g_thread_join(workers[i].thread);
+        }
+
+        for (guint j = 0; j < handles->len; j++) {
+            fstHandle txidxi = g_array_index(handles, fstHandle, j) - 1;
+            int txidx = self->mvlfacs_rvs_alias[txidxi];
+            GwLx2Entry *dst = &self->fst_table[txidx];
+            GwFac *f = &self->mvlfacs[txidx];
+
+            for (guint i = 0; i < n_workers; i++) {
+                GwLx2Entry *src = &workers[i].context.table[j];
+                GwHistEnt *h = src->histent_head;
+                int numtrans = src->numtrans;
+
+                /* drop the initial values a worker reports for its slice */
+                while (h != NULL && dst->histent_curr != NULL &&
+                       import_is_duplicate(f, dst->histent_curr, h)) {
+                    h = h->next;
+                    numtrans--;
+                }
+                if (h == NULL) {
+                    continue;
+                }
+
+                if (dst->histent_curr != NULL) {
+                    dst->histent_curr->next = h;
+                } else {
+                    dst->histent_head = h;
+                }
+                dst->histent_curr = src->histent_curr;
+                dst->numtrans += numtrans;
+            }
+        }
+    }
+
+    for (guint i = 0; i < started; i++) {
+        fstReaderClose(workers[i].fst_reader);
+        g_free(workers[i].context.table);
+        g_byte_array_unref(workers[i].context.vector_buffer);
+    }
+
+    g_free(workers);
+    g_free(slots);
+    g_array_free(handles, TRUE);
+
+    return started == n_workers;
+}
+
 static void gw_fst_file_import_masked(GwFstFile *self)
 {
     unsigned int txidxi;
@@ -541,7 +877,11 @@ static void gw_fst_file_import_masked(GwFstFile *self)
     // TODO: report progress
     // set_window_busy(NULL);
 
-    fstReaderIterBlocks2(self->fst_reader, fst_callback, fst_callback2, self, NULL);
+    if (!gw_fst_file_iter_blocks_parallel(self)) {
+        ImportContext context;
+        import_context_init(&context, self);
+        fstReaderIterBlocks2(self->fst_reader, fst_callback, fst_callback2, &context, NULL);
+    }
 
     // TODO: report progress
     // set_window_idle(NULL);
@@ -554,9 +894,12 @@ static void gw_fst_file_import_masked(GwFstFile *self)
             int len = f->len;
             GwNode *np = self->fst_table[txidx].np;
 
-            histent_tail = htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            /* the end caps and the initial value are needed in any case */
+            GwHistEnt *caps = gw_hist_ent_factory_alloc_n(self->hist_ent_factory, 3);
+
+            histent_tail = htemp = &caps[0];
             if (len > 1) {
-                htemp->v.h_vector = g_malloc(len);
+                htemp->v.h_vector = gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
                 for (i = 0; i < len; i++) {
                     if (f->flags & GW_FAC_FLAG_STRING) {
                         htemp->v.h_vector[i] = 0;
@@ -570,15 +913,19 @@ static void gw_fst_file_import_masked(GwFstFile *self)
             }
             htemp->time = GW_TIME_MAX;
 
-            htemp = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            htemp = &caps[1];
             if (len > 1) {
                 if (!(f->flags & GW_FAC_FLAG_DOUBLE)) {
                     if (!(f->flags & GW_FAC_FLAG_STRING)) {
-                        htemp->v.h_vector = g_malloc(len);
+                        htemp->v.h_vector =
+                            gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
                         for (i = 0; i < len; i++)
                             htemp->v.h_vector[i] = GW_BIT_X;
                     } else {
-                        htemp->v.h_vector = g_strdup("UNDEF");
+                        htemp->v.h_vector =
+                            gw_hist_ent_factory_alloc_vector(self->hist_ent_factory,
+                                                             sizeof("UNDEF"));
+                        memcpy(htemp->v.h_vector, "UNDEF", sizeof("UNDEF"));
                         htemp->flags = GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING;
                     }
                     htempx = htemp;
@@ -601,7 +948,8 @@ static void gw_fst_file_import_masked(GwFstFile *self)
 
             if (!(f->flags & (GW_FAC_FLAG_DOUBLE | GW_FAC_FLAG_STRING))) {
                 if (len > 1) {
-                    np->head.v.h_vector = g_malloc(len);
+                    np->head.v.h_vector =
+                        gw_hist_ent_factory_alloc_vector(self->hist_ent_factory, len);
                     for (i = 0; i < len; i++)
                         np->head.v.h_vector[i] = GW_BIT_X;
                 } else {
@@ -615,7 +963,7 @@ static void gw_fst_file_import_masked(GwFstFile *self)
             }
 
             {
-                GwHistEnt *htemp2 = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+                GwHistEnt *htemp2 = &caps[2];
                 htemp2->time = -1;
                 if (len > 1) {
                     htemp2->v.h_vector = htempx->v.h_vector;
@@ -636,14 +984,158 @@ static void gw_fst_file_import_masked(GwFstFile *self)
 
             np->curr = histent_tail;
             np->mv.mvlfac = NULL; /* it's imported and cached so we can forget it's an mvlfac now */
+            gw_fst_file_add_compact_node(self, np);
             fstReaderClrFacProcessMask(self->fst_reader, txidxi + 1);
         }
     }
 }
 
+/*
+ * Imports the nodes for the import window only, or for the whole time range
+ * if unloadable traces are requested without a window. Unlike the regular
+ * import, aliases are not resolved to the node that owns the handle but get
+ * their own copy of the history, so that every node can be unloaded on its
+ * own. A node that shares its handle with another node of the same batch is
+ * picked up by the next round.
+ */
+static void gw_fst_file_import_windowed(GwFstFile *self, GwNode **nodes)
+{
+    GPtrArray *facs = g_ptr_array_new();
+    for (GwNode **iter = nodes; *iter != NULL; iter++) {
+        g_ptr_array_add(facs, (*iter)->mv.mvlfac);
+    }
+
+    GwTime window_start = -1;
+    GwTime window_end = GW_TIME_MAX;
+    guint64 start = self->limit_start;
+    guint64 end = self->limit_end;
+
+    if (self->import_window != NULL) {
+        window_start = gw_time_range_get_start(self->import_window);
+        window_end = gw_time_range_get_end(self->import_window);
+        start = CLAMP(MAX(window_start, 0) / self->time_scale, self->limit_start, self->limit_end);
+        end = CLAMP(MAX(window_end, 0) / self->time_scale, self->limit_start, self->limit_end);
+    }
+
+    // The histents of each batch go to their own factory, which is freed
+    // once all of the batch's traces are unloaded. Compacted imports have a
+    // factory of their own already.
+    GwHistEntFactory *file_hist_ent_factory = self->hist_ent_factory;
+    if (self->compact_nodes == NULL) {
+        self->hist_ent_factory = gw_hist_ent_factory_new();
+    }
+
+    fstReaderSetLimitTimeRange(self->fst_reader, start, end);
+
+    gboolean pending = TRUE;
+    while (pending) {
+        pending = FALSE;
+
+        for (GwNode **iter = nodes; *iter != NULL; iter++) {
+            GwNode *np = *iter;
+            GwFac *f = np->mv.mvlfac;
+            if (f == NULL) {
+                continue;
+            }
+
+            int txidx = f - self->mvlfacs;
+            if (f->flags & GW_FAC_FLAG_ALIAS) {
+                txidx = self->mvlfacs_rvs_alias[self->mvlfacs[txidx].node_alias];
+            }
+
+            if (self->mvlfacs[txidx].flags & GW_FAC_FLAG_SYNVEC) {
+                gw_fst_file_set_fac_process_mask(self, np);
+            } else if (self->fst_table[txidx].np == NULL) {
+                fstReaderSetFacProcessMask(self->fst_reader, self->mvlfacs[txidx].node_alias + 1);
+                self->fst_table[txidx].np = np;
+            } else {
+                pending = TRUE;
+            }
+        }
+        gw_fst_file_import_masked(self);
+    }
+
+    fstReaderSetLimitTimeRange(self->fst_reader, self->limit_start, self->limit_end);
+
+    for (guint i = 0; i < facs->len; i++) {
+        GwNode *np = nodes[i];
+        GwFac *f = g_ptr_array_index(facs, i);
+
+        if (f == NULL || np->mv.mvlfac != NULL) {
+            continue; /* was already imported */
+        }
+
+        GwWindowedTrace *trace = g_new0(GwWindowedTrace, 1);
+        trace->fac = f;
+        trace->start = start > self->limit_start ? window_start : -1;
+        trace->end = end < self->limit_end ? window_end : GW_TIME_MAX;
+        if (self->compact_nodes == NULL) {
+            trace->hist_ent_factory = g_object_ref(self->hist_ent_factory);
+        }
+        g_hash_table_insert(self->windowed_traces, np, trace);
+    }
+
+    if (self->compact_nodes == NULL) {
+        g_object_unref(self->hist_ent_factory);
+        self->hist_ent_factory = file_hist_ent_factory;
+    }
+
+    g_ptr_array_free(facs, TRUE);
+}
+
 gchar *gw_fst_file_get_subvar(GwFstFile *self, gint index)
 {
     g_return_val_if_fail(self != NULL, NULL);
 
     return self->subvar_pnt[index];
 }
+
+/**
+ * gw_fst_file_set_import_window:
+ * @self: A #GwFstFile.
+ * @window: (nullable): The time range to import, or %NULL to import the whole file.
+ *
+ * Restricts subsequent trace imports to the value change blocks that overlap
+ * @window. The imported history starts and ends with the first and last of
+ * these blocks, so the values inside @window are exact.
+ * Traces imported this way can be unloaded with gw_dump_file_unload_trace()
+ * and imported again for another window.
+ */
+void gw_fst_file_set_import_window(GwFstFile *self, GwTimeRange *window)
+{
+    g_return_if_fail(GW_IS_FST_FILE(self));
+
+    if (window != NULL) {
+        g_object_ref(window);
+    }
+    g_clear_object(&self->import_window);
+    self->import_window = window;
+}
+
+/**
+ * gw_fst_file_get_trace_window:
+ * @self: A #GwFstFile.
+ * @node: A #GwNode.
+ * @start: (out): The start of the imported window.
+ * @end: (out): The end of the imported window.
+ *
+ * Returns the time window for which @node's history is valid.
+ *
+ * Returns: %TRUE if @node was imported for a window, %FALSE if it wasn't
+ *          imported yet or its whole history was imported.
+ */
+gboolean gw_fst_file_get_trace_window(GwFstFile *self, GwNode *node, GwTime *start, GwTime *end)
+{
+    g_return_val_if_fail(GW_IS_FST_FILE(self), FALSE);
+    g_return_val_if_fail(node != NULL, FALSE);
+
+    GwWindowedTrace *trace = g_hash_table_lookup(self->windowed_traces, node);
+    if (trace == NULL) {
+        return FALSE;
+    }
+
+    *start = trace->start;
+    *end = trace->end;
+
+    return TRUE;
+}
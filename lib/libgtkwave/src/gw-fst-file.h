@@ -10,4 +10,7 @@ G_DECLARE_FINAL_TYPE(GwFstFile, gw_fst_file, GW, FST_FILE, GwDumpFile)
 gchar *gw_fst_file_get_subvar(GwFstFile *self, gint index);
 void gw_fst_file_limit_time_range(GwFstFile *self, GwTimeRange *range);
 
+void gw_fst_file_set_import_window(GwFstFile *self, GwTimeRange *window);
+gboolean gw_fst_file_get_trace_window(GwFstFile *self, GwNode *node, GwTime *start, GwTime *end);
+
 G_END_DECLS
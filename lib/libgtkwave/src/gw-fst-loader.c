@@ -57,6 +57,8 @@ struct _GwFstLoader
     gchar *start_time;
     gchar *end_time;
 
+    gboolean use_mmap;
+
     GwEnumFilterList *enum_filters;
 
     gboolean has_nonimplicit_directions;
@@ -74,6 +76,7 @@ enum
 {
     PROP_START_TIME = 1,
     PROP_END_TIME,
+    PROP_USE_MMAP,
     N_PROPERTIES,
 };
 
@@ -704,6 +707,10 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
         return NULL;
     }
 
+    if (self->use_mmap) {
+        fstReaderSetMmapMode(self->fst_reader, TRUE);
+    }
+
     // TODO: update splash
     // /* SPLASH */ splash_create();
 
@@ -733,6 +740,9 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
     guint64 numfacs = fstReaderGetVarCount(self->fst_reader);
 
     GwFacs *facs = gw_facs_new(numfacs);
+    GwNamePool *names = gw_name_pool_new();
+    gw_facs_set_name_pool(facs, names);
+    g_object_unref(names); /* owned by the facs */
     self->mvlfacs = g_new0(GwFac, numfacs);
     sym_block = g_new0(GwSymbol, numfacs);
     node_block = g_new0(GwNode, numfacs);
@@ -755,7 +765,6 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
 
     for (guint i = 0; i < numfacs; i++) {
         char buf[65537];
-        char *str;
         GwFac *f;
         int hier_len, name_len, tlen;
         unsigned char nvt, nvd, ndt;
@@ -911,10 +920,8 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
                 node_block[i].lsi = 0;
             }
 
-            str = g_malloc(len + 1);
-            memcpy(str, buf, len + 1);
             s = &sym_block[i];
-            s->name = str;
+            s->name = gw_name_pool_add_len(names, buf, len);
             prevsymroot = prevsym = NULL;
 
             len = sprintf_2_sdd(buf, nnam, node_block[i].msi, node_block[i].lsi);
@@ -933,10 +940,8 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
             if (gatecmp) {
                 int len = sprintf_2_sd(buf, f_name[(i)&F_NAME_MODULUS], node_block[i].msi);
 
-                str = g_malloc(len + 1);
-                memcpy(str, buf, len + 1);
                 s = &sym_block[i];
-                s->name = str;
+                s->name = gw_name_pool_add_len(names, buf, len);
                 if (allowed_to_autocoalesce && prevsym &&
                     revcmp) /* allow chaining for search functions.. */
                 {
@@ -953,10 +958,8 @@ static GwDumpFile *gw_fst_loader_load(GwLoader *loader, const char *fname, GErro
             } else {
                 int len = f_name_len[(i)&F_NAME_MODULUS];
 
-                str = g_malloc(len + 1);
-                memcpy(str, f_name[(i)&F_NAME_MODULUS], len + 1);
                 s = &sym_block[i];
-                s->name = str;
+                s->name = gw_name_pool_add_len(names, f_name[(i)&F_NAME_MODULUS], len);
                 prevsymroot = prevsym = NULL;
 
                 if (f->flags & GW_FAC_FLAG_INTEGER) {
@@ -1132,6 +1135,8 @@ if(num_dups)
     // /* SPLASH */ splash_finalize();
 
     GwTimeRange *time_range;
+    guint64 limit_start = fstReaderGetStartTime(self->fst_reader);
+    guint64 limit_end = fstReaderGetEndTime(self->fst_reader);
 
     if (self->start_time || self->end_time) {
         GwTime b_start = self->first_cycle;
@@ -1155,6 +1160,8 @@ if(num_dups)
         }
 
         fstReaderSetLimitTimeRange(self->fst_reader, b_start, b_end);
+        limit_start = b_start;
+        limit_end = b_end;
 
         time_range = gw_time_range_new(b_start, b_end);
     } else {
@@ -1189,6 +1196,10 @@ if(num_dups)
     dump_file->synclock_jrb = g_steal_pointer(&self->synclock_jrb);
     dump_file->enum_nptrs_jrb = g_steal_pointer(&self->enum_nptrs_jrb);
     dump_file->time_scale = self->time_scale;
+    dump_file->filename = g_strdup(fname);
+    dump_file->limit_start = limit_start;
+    dump_file->limit_end = limit_end;
+    dump_file->use_mmap = self->use_mmap;
 
     g_object_unref(blackout_regions);
     g_object_unref(self->stems);
@@ -1216,6 +1227,28 @@ static void gw_fst_loader_set_property(GObject *object,
             gw_fst_loader_set_end_time(self, g_value_get_string(value));
             break;
 
+        case PROP_USE_MMAP:
+            gw_fst_loader_set_use_mmap(self, g_value_get_boolean(value));
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+    }
+}
+
+static void gw_fst_loader_get_property(GObject *object,
+                                       guint property_id,
+                                       GValue *value,
+                                       GParamSpec *pspec)
+{
+    GwFstLoader *self = GW_FST_LOADER(object);
+
+    switch (property_id) {
+        case PROP_USE_MMAP:
+            g_value_set_boolean(value, gw_fst_loader_get_use_mmap(self));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -1229,6 +1262,7 @@ static void gw_fst_loader_class_init(GwFstLoaderClass *klass)
 
     object_class->dispose = gw_fst_loader_dispose;
     object_class->set_property = gw_fst_loader_set_property;
+    object_class->get_property = gw_fst_loader_get_property;
 
     loader_class->load = gw_fst_loader_load;
 
@@ -1244,6 +1278,13 @@ static void gw_fst_loader_class_init(GwFstLoaderClass *klass)
                            NULL,
                            G_PARAM_WRITABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+    properties[PROP_USE_MMAP] =
+        g_param_spec_boolean("use-mmap",
+                             NULL,
+                             NULL,
+                             TRUE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties(object_class, N_PROPERTIES, properties);
 }
 
@@ -1253,6 +1294,7 @@ static void gw_fst_loader_init(GwFstLoader *self)
     self->stems = gw_stems_new();
     self->component_names = gw_string_table_new();
     self->enum_filters = gw_enum_filter_list_new();
+    self->use_mmap = TRUE;
 }
 
 GwLoader *gw_fst_loader_new(void)
@@ -1282,6 +1324,26 @@ void gw_fst_loader_set_end_time(GwFstLoader *self, const gchar *end_time)
     }
 }
 
+void gw_fst_loader_set_use_mmap(GwFstLoader *self, gboolean use_mmap)
+{
+    g_return_if_fail(GW_IS_FST_LOADER(self));
+
+    use_mmap = !!use_mmap;
+
+    if (self->use_mmap != use_mmap) {
+        self->use_mmap = use_mmap;
+
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_USE_MMAP]);
+    }
+}
+
+gboolean gw_fst_loader_get_use_mmap(GwFstLoader *self)
+{
+    g_return_val_if_fail(GW_IS_FST_LOADER(self), FALSE);
+
+    return self->use_mmap;
+}
+
 static GwTreeKind fst_scope_type_to_gw_tree_kind(enum fstScopeType scope_type)
 {
     switch (scope_type) {
@@ -12,5 +12,7 @@ GwLoader *gw_fst_loader_new(void);
 
 void gw_fst_loader_set_start_time(GwFstLoader *self, const gchar *start_time);
 void gw_fst_loader_set_end_time(GwFstLoader *self, const gchar *end_time);
+void gw_fst_loader_set_use_mmap(GwFstLoader *self, gboolean use_mmap);
+gboolean gw_fst_loader_get_use_mmap(GwFstLoader *self);
 
 G_END_DECLS
@@ -31,6 +31,7 @@ struct _GwGhwLoader
     GSList *sym_chain;
 
     GwFacs *facs;
+    GwNamePool *names; /* owned by facs */
     GwTreeNode *treeroot;
     GwTime max_time;
 
@@ -755,6 +756,9 @@ void facs_debug(GwGhwLoader *self)
 static void create_facs(GwGhwLoader *self)
 {
     self->facs = gw_facs_new(self->nbr_sig_ref);
+    self->names = gw_name_pool_new();
+    gw_facs_set_name_pool(self->facs, self->names);
+    g_object_unref(self->names);
 
     guint i = 0;
     for (GSList *iter = self->sym_chain; iter != NULL; iter = iter->next, i++) {
@@ -843,7 +847,7 @@ static void set_fac_name_1(GwGhwLoader *self, GwTreeNode *t)
         if (t->t_which >= 0) {
             GwSymbol *s = self->sym_chain->data;
 
-            s->name = g_strdup(self->fac_name);
+            s->name = gw_name_pool_add(self->names, self->fac_name);
             size_t nxp_idx = (size_t)t->t_which;
             if (nxp_idx > self->h->nbr_sigs)
                 ghw_error_exit();
@@ -0,0 +1,767 @@
+#include "gw-hist-columns.h"
+#include "gw-node.h"
+#include "gw-bit.h"
+
+// The history is stored in parallel arrays instead of a linked list of
+// histents. Times are stored as variable length deltas to the previous entry.
+// Every GROUP_SIZE entries the absolute time is stored separately, which
+// allows to binary search the groups and to start decoding at any group.
+//
+// Bit values are packed with 4 bits per bit if all of them are valid GwBit
+// values and with 8 bits otherwise. Vector nodes store the bits of all values
+// back to back in the same array. Real nodes keep the raw value of each entry
+// and string nodes an offset into a pool that holds every distinct string
+// once. Flags and vectors without a value are rare, their columns are only
+// allocated if they are needed.
+#define GROUP_SIZE (64)
+
+// Marks an entry of a string node without a string.
+#define NULL_STRING G_MAXUINT32
+
+typedef enum
+{
+    COLUMNS_BITS,
+    COLUMNS_REAL,
+    COLUMNS_STRING,
+} ColumnsKind;
+
+struct _GwHistColumns
+{
+    gint ref_count;
+    ColumnsKind kind;
+    guint length;
+    guint width; // 0 for single bit nodes, the number of bits for vector nodes
+    guint bits_per_value;
+
+    guint num_groups;
+    GwTime *group_times;
+    guint32 *group_offsets; // offset of the deltas of the second entry of each group
+    guint8 *deltas;
+    gsize deltas_size;
+
+    guint8 *values;
+    guint8 *flags;
+    guint8 *null_vectors; // bitmap of vector entries without a value
+
+    gdouble *reals;
+    guint32 *strings; // the bit value for entries without the string flag
+    gchar *string_pool;
+    gsize string_pool_size;
+};
+
+static void append_delta(GByteArray *deltas, GwTime previous, GwTime time)
+{
+    // The difference is calculated modulo 2^64, which keeps the encoding exact
+    // for the negative times in front of the history and the end caps.
+    gint64 delta = (gint64)((guint64)time - (guint64)previous);
+    guint64 v = ((guint64)delta << 1) ^ (guint64)(delta >> 63);
+    guint8 buf[10];
+    guint n = 0;
+
+    while (v >= 0x80) {
+        buf[n++] = (guint8)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (guint8)v;
+
+    g_byte_array_append(deltas, buf, n);
+}
+
+static inline GwTime read_delta(const guint8 *deltas, guint *offset, GwTime previous)
+{
+    guint64 v = 0;
+    guint shift = 0;
+    guint8 b;
+
+    do {
+        b = deltas[(*offset)++];
+        v |= (guint64)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    guint64 delta = (v >> 1) ^ (~(v & 1) + 1);
+
+    return (GwTime)((guint64)previous + delta);
+}
+
+static inline guint values_per_entry(const GwHistColumns *self)
+{
+    return self->width > 0 ? self->width : 1;
+}
+
+static inline guint8 get_packed(const GwHistColumns *self, gsize k)
+{
+    if (self->bits_per_value == 8) {
+        return self->values[k];
+    }
+
+    return (self->values[k / 2] >> ((k & 1) * 4)) & 0xF;
+}
+
+static inline void set_packed(GwHistColumns *self, gsize k, guint8 value)
+{
+    if (self->bits_per_value == 8) {
+        self->values[k] = value;
+    } else {
+        self->values[k / 2] |= (value & 0xF) << ((k & 1) * 4);
+    }
+}
+
+static guint32 add_string(GString *pool, GHashTable *offsets, const gchar *str)
+{
+    if (str == NULL) {
+        return NULL_STRING;
+    }
+
+    gpointer offset = g_hash_table_lookup(offsets, str);
+    if (offset != NULL) {
+        return GPOINTER_TO_UINT(offset) - 1;
+    }
+
+    guint32 new_offset = pool->len;
+    g_string_append_len(pool, str, strlen(str) + 1);
+    g_hash_table_insert(offsets, (gpointer)str, GUINT_TO_POINTER(new_offset + 1));
+
+    return new_offset;
+}
+
+/**
+ * gw_hist_columns_new:
+ * @node: A node with an imported history.
+ *
+ * Creates a columnar copy of the history that starts at @node->head. Single
+ * bit nodes are read from h_val, vector nodes from h_vector, real nodes from
+ * h_double and string nodes from the strings in h_vector. The head entry of a
+ * vector node has no value that the loaders set, it reads as undefined.
+ *
+ * Returns: (transfer full): The columns.
+ */
+GwHistColumns *gw_hist_columns_new(GwNode *node)
+{
+    g_return_val_if_fail(node != NULL, NULL);
+
+    GwHistEnt *head = &node->head;
+    ColumnsKind kind = COLUMNS_BITS;
+    guint length = 0;
+    gboolean has_flags = FALSE;
+
+    for (GwHistEnt *h = head; h != NULL; h = h->next) {
+        if (h->flags & GW_HIST_ENT_FLAG_STRING) {
+            kind = COLUMNS_STRING;
+        } else if ((h->flags & GW_HIST_ENT_FLAG_REAL) && kind == COLUMNS_BITS) {
+            kind = COLUMNS_REAL;
+        }
+        if (h->flags != 0) {
+            has_flags = TRUE;
+        }
+        length++;
+    }
+
+    guint width = 0;
+    gboolean has_null_vectors = FALSE;
+    guint max_value = 0;
+
+    if (kind == COLUMNS_BITS && node->extvals) {
+        width = ABS(node->msi - node->lsi) + 1;
+        for (GwHistEnt *h = head->next; h != NULL; h = h->next) {
+            if (h->v.h_vector == NULL) {
+                has_null_vectors = TRUE;
+                continue;
+            }
+            for (guint b = 0; b < width; b++) {
+                max_value = MAX(max_value, (guchar)h->v.h_vector[b]);
+            }
+        }
+    } else if (kind == COLUMNS_BITS) {
+        for (GwHistEnt *h = head; h != NULL; h = h->next) {
+            max_value = MAX(max_value, h->v.h_val);
+        }
+    }
+
+    GwHistColumns *self = g_new0(GwHistColumns, 1);
+    self->ref_count = 1;
+    self->kind = kind;
+    self->length = length;
+    self->width = width;
+    self->bits_per_value = max_value < GW_BIT_COUNT ? 4 : 8;
+
+    self->num_groups = (length + GROUP_SIZE - 1) / GROUP_SIZE;
+    self->group_times = g_new(GwTime, self->num_groups);
+    self->group_offsets = g_new(guint32, self->num_groups);
+
+    GString *pool = NULL;
+    GHashTable *offsets = NULL;
+
+    if (kind == COLUMNS_REAL) {
+        self->reals = g_new(gdouble, length);
+    } else if (kind == COLUMNS_STRING) {
+        self->strings = g_new(guint32, length);
+        pool = g_string_new(NULL);
+        offsets = g_hash_table_new(g_str_hash, g_str_equal);
+    } else {
+        gsize num_values = (gsize)length * values_per_entry(self);
+        self->values = g_malloc0(self->bits_per_value == 8 ? num_values : (num_values + 1) / 2);
+    }
+    if (has_flags) {
+        self->flags = g_malloc(length);
+    }
+    if (has_null_vectors) {
+        self->null_vectors = g_malloc0((length + 7) / 8);
+    }
+
+    GByteArray *deltas = g_byte_array_new();
+    GwTime previous = 0;
+    guint i = 0;
+
+    for (GwHistEnt *h = head; h != NULL; h = h->next, i++) {
+        if (i % GROUP_SIZE == 0) {
+            self->group_times[i / GROUP_SIZE] = h->time;
+            self->group_offsets[i / GROUP_SIZE] = deltas->len;
+        } else {
+            append_delta(deltas, previous, h->time);
+        }
+        previous = h->time;
+
+        if (self->flags != NULL) {
+            self->flags[i] = h->flags;
+        }
+
+        if (kind == COLUMNS_REAL) {
+            self->reals[i] = h->v.h_double;
+        } else if (kind == COLUMNS_STRING) {
+            if (h->flags & GW_HIST_ENT_FLAG_STRING) {
+                self->strings[i] = add_string(pool, offsets, h->v.h_vector);
+            } else {
+                self->strings[i] = h->v.h_val;
+            }
+        } else if (width == 0) {
+            set_packed(self, i, h->v.h_val);
+        } else if (h == head) {
+            for (guint b = 0; b < width; b++) {
+                set_packed(self, b, GW_BIT_X);
+            }
+        } else if (h->v.h_vector == NULL) {
+            self->null_vectors[i / 8] |= 1 << (i % 8);
+        } else {
+            for (guint b = 0; b < width; b++) {
+                set_packed(self, (gsize)i * width + b, h->v.h_vector[b]);
+            }
+        }
+    }
+
+    self->deltas_size = deltas->len;
+    self->deltas = g_realloc(g_byte_array_free(deltas, FALSE), MAX(self->deltas_size, 1));
+
+    if (pool != NULL) {
+        self->string_pool_size = pool->len;
+        self->string_pool = g_string_free(pool, FALSE);
+        g_hash_table_destroy(offsets);
+    }
+
+    return self;
+}
+
+GwHistColumns *gw_hist_columns_ref(GwHistColumns *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    g_atomic_int_inc(&self->ref_count);
+
+    return self;
+}
+
+void gw_hist_columns_unref(GwHistColumns *self)
+{
+    if (self == NULL || !g_atomic_int_dec_and_test(&self->ref_count)) {
+        return;
+    }
+
+    g_free(self->group_times);
+    g_free(self->group_offsets);
+    g_free(self->deltas);
+    g_free(self->values);
+    g_free(self->flags);
+    g_free(self->null_vectors);
+    g_free(self->reals);
+    g_free(self->strings);
+    g_free(self->string_pool);
+    g_free(self);
+}
+
+guint gw_hist_columns_get_length(const GwHistColumns *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->length;
+}
+
+guint gw_hist_columns_get_width(const GwHistColumns *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->width;
+}
+
+/**
+ * gw_hist_columns_get_memory_size:
+ * @self: A #GwHistColumns.
+ *
+ * Returns: The number of bytes that are used by the columns.
+ */
+gsize gw_hist_columns_get_memory_size(const GwHistColumns *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    gsize size = sizeof(GwHistColumns);
+
+    size += self->num_groups * (sizeof(GwTime) + sizeof(guint32));
+    size += self->deltas_size;
+    if (self->values != NULL) {
+        gsize num_values = (gsize)self->length * values_per_entry(self);
+        size += self->bits_per_value == 8 ? num_values : (num_values + 1) / 2;
+    }
+    if (self->reals != NULL) {
+        size += self->length * sizeof(gdouble);
+    }
+    if (self->strings != NULL) {
+        size += self->length * sizeof(guint32) + self->string_pool_size;
+    }
+    if (self->flags != NULL) {
+        size += self->length;
+    }
+    if (self->null_vectors != NULL) {
+        size += (self->length + 7) / 8;
+    }
+
+    return size;
+}
+
+static GwTime gw_hist_columns_decode_time(const GwHistColumns *self, guint index, guint *offset)
+{
+    guint group = index / GROUP_SIZE;
+    GwTime time = self->group_times[group];
+
+    *offset = self->group_offsets[group];
+    for (guint i = group * GROUP_SIZE; i < index; i++) {
+        time = read_delta(self->deltas, offset, time);
+    }
+
+    return time;
+}
+
+GwTime gw_hist_columns_get_time(const GwHistColumns *self, guint index)
+{
+    g_return_val_if_fail(self != NULL, 0);
+    g_return_val_if_fail(index < self->length, 0);
+
+    guint offset;
+    return gw_hist_columns_decode_time(self, index, &offset);
+}
+
+// Returns the last group in [first, num_groups) that starts at or before key,
+// or first - 1 if there is none.
+static gint gw_hist_columns_find_group(const GwHistColumns *self, guint first, GwTime key)
+{
+    gint lo = (gint)first - 1;
+    gint hi = (gint)self->num_groups - 1;
+
+    while (lo < hi) {
+        gint mid = lo + (hi - lo + 1) / 2;
+
+        if (self->group_times[mid] <= key) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * gw_hist_columns_find:
+ * @self: A #GwHistColumns.
+ * @key: The time to search for.
+ *
+ * Searches the columns for the entry that is active at @key. Only the group
+ * start times and the deltas of a single group are read.
+ *
+ * Returns: The index of the last entry with a time less than or equal to
+ * @key or -1 if there is none.
+ */
+gint gw_hist_columns_find(const GwHistColumns *self, GwTime key)
+{
+    g_return_val_if_fail(self != NULL, -1);
+
+    gint group = gw_hist_columns_find_group(self, 0, key);
+    if (group < 0) {
+        return -1;
+    }
+
+    guint index = group * GROUP_SIZE;
+    guint end = MIN(index + GROUP_SIZE, self->length);
+    guint offset = self->group_offsets[group];
+    GwTime time = self->group_times[group];
+
+    while (index + 1 < end) {
+        time = read_delta(self->deltas, &offset, time);
+        if (time > key) {
+            break;
+        }
+        index++;
+    }
+
+    return index;
+}
+
+/**
+ * gw_hist_columns_compact_nodes:
+ * @nodes: (element-type GwNode): Nodes with imported histories.
+ *
+ * Replaces the histents of @nodes by columns. Nodes that share their
+ * histents, like aliases, share the columns. Afterwards none of the nodes
+ * references its histents anymore, so the loader can free them. Nodes that
+ * have no histents are skipped.
+ */
+void gw_hist_columns_compact_nodes(GPtrArray *nodes)
+{
+    g_return_if_fail(nodes != NULL);
+
+    // Aliases have a copy of the head of their target, the rest of the
+    // history is shared.
+    GHashTable *shared = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for (guint i = 0; i < nodes->len; i++) {
+        GwNode *node = g_ptr_array_index(nodes, i);
+        GwHistEnt *first = node->head.next;
+
+        if (first == NULL || node->columns != NULL) {
+            continue;
+        }
+
+        GwHistColumns *columns = g_hash_table_lookup(shared, first);
+        if (columns == NULL) {
+            columns = gw_hist_columns_new(node);
+            g_hash_table_insert(shared, first, columns);
+        } else {
+            gw_hist_columns_ref(columns);
+        }
+
+        node->columns = columns;
+        node->numhist = columns->length;
+        node->head.next = NULL;
+        node->curr = NULL;
+    }
+
+    g_hash_table_destroy(shared);
+}
+
+/**
+ * gw_hist_iter_init:
+ * @iter: An uninitialized #GwHistIter.
+ * @node: The node whose history is walked.
+ *
+ * Initializes @iter to point at the first entry of the history of @node,
+ * which is @node->head.
+ */
+void gw_hist_iter_init(GwHistIter *iter, GwNode *node)
+{
+    gw_hist_iter_init_at(iter, node, 0);
+}
+
+/**
+ * gw_hist_iter_init_at:
+ * @iter: An uninitialized #GwHistIter.
+ * @node: The node whose history is walked.
+ * @index: The index of the entry in the history.
+ *
+ * Initializes @iter to point at the entry with the given index, or at the
+ * last entry if the history is shorter. This is cheap for nodes with columns
+ * or a harray.
+ */
+void gw_hist_iter_init_at(GwHistIter *iter, GwNode *node, guint index)
+{
+    g_return_if_fail(iter != NULL);
+    g_return_if_fail(node != NULL);
+
+    iter->node = node;
+    iter->columns = node->columns;
+    iter->hist_ent = NULL;
+    iter->offset = 0;
+    iter->time = 0;
+
+    if (iter->columns != NULL) {
+        iter->index = MIN(index, iter->columns->length - 1);
+        iter->time = gw_hist_columns_decode_time(iter->columns, iter->index, &iter->offset);
+    } else if (node->harray != NULL && node->numhist > 0) {
+        iter->index = MIN(index, (guint)node->numhist - 1);
+        iter->hist_ent = node->harray[iter->index];
+    } else {
+        iter->index = 0;
+        iter->hist_ent = &node->head;
+        while (iter->index < index && iter->hist_ent->next != NULL) {
+            iter->hist_ent = iter->hist_ent->next;
+            iter->index++;
+        }
+    }
+}
+
+/**
+ * gw_hist_iter_next:
+ * @iter: A #GwHistIter.
+ *
+ * Moves @iter to the next entry.
+ *
+ * Returns: %FALSE if @iter already pointed at the last entry, which leaves
+ * @iter unchanged.
+ */
+gboolean gw_hist_iter_next(GwHistIter *iter)
+{
+    const GwHistColumns *columns = iter->columns;
+
+    if (columns == NULL) {
+        if (iter->hist_ent->next == NULL) {
+            return FALSE;
+        }
+        iter->hist_ent = iter->hist_ent->next;
+        iter->index++;
+        return TRUE;
+    }
+
+    if (iter->index + 1 >= columns->length) {
+        return FALSE;
+    }
+
+    iter->index++;
+    if (iter->index % GROUP_SIZE == 0) {
+        iter->time = columns->group_times[iter->index / GROUP_SIZE];
+        iter->offset = columns->group_offsets[iter->index / GROUP_SIZE];
+    } else {
+        iter->time = read_delta(columns->deltas, &iter->offset, iter->time);
+    }
+
+    return TRUE;
+}
+
+/**
+ * gw_hist_iter_prev:
+ * @iter: A #GwHistIter.
+ *
+ * Moves @iter to the previous entry. Histories without columns or a harray
+ * are walked from their head.
+ *
+ * Returns: %FALSE if @iter already pointed at the first entry, which leaves
+ * @iter unchanged.
+ */
+gboolean gw_hist_iter_prev(GwHistIter *iter)
+{
+    if (iter->index == 0) {
+        return FALSE;
+    }
+
+    gw_hist_iter_init_at(iter, iter->node, iter->index - 1);
+
+    return TRUE;
+}
+
+/**
+ * gw_hist_iter_seek:
+ * @iter: A #GwHistIter.
+ * @key: The time to search for.
+ *
+ * Moves @iter forward to the last entry with a time less than or equal to
+ * @key. @iter is never moved backwards. Nodes with columns or a harray skip
+ * over the entries in between instead of visiting each of them.
+ */
+void gw_hist_iter_seek(GwHistIter *iter, GwTime key)
+{
+    const GwHistColumns *columns = iter->columns;
+    GwNode *node = iter->node;
+
+    if (columns != NULL) {
+        guint group = iter->index / GROUP_SIZE;
+        gint found = gw_hist_columns_find_group(columns, group + 1, key);
+
+        if (found > (gint)group) {
+            iter->index = found * GROUP_SIZE;
+            iter->time = columns->group_times[found];
+            iter->offset = columns->group_offsets[found];
+        }
+
+        GwHistIter next = *iter;
+        while (gw_hist_iter_next(&next) && next.time <= key) {
+            *iter = next;
+        }
+    } else if (node->harray != NULL && iter->index < (guint)node->numhist &&
+               node->harray[iter->index] == iter->hist_ent) {
+        gint lo = iter->index;
+        gint hi = node->numhist - 1;
+
+        while (lo < hi) {
+            gint mid = lo + (hi - lo + 1) / 2;
+
+            if (node->harray[mid]->time <= key) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+
+        iter->index = lo;
+        iter->hist_ent = node->harray[lo];
+    } else {
+        while (iter->hist_ent->next != NULL && iter->hist_ent->next->time <= key) {
+            iter->hist_ent = iter->hist_ent->next;
+            iter->index++;
+        }
+    }
+}
+
+guint gw_hist_iter_get_index(const GwHistIter *iter)
+{
+    return iter->index;
+}
+
+GwTime gw_hist_iter_get_time(const GwHistIter *iter)
+{
+    return iter->columns != NULL ? iter->time : iter->hist_ent->time;
+}
+
+/**
+ * gw_hist_iter_get_next_time:
+ * @iter: A #GwHistIter.
+ * @time: (out): The time of the next entry.
+ *
+ * Returns: %FALSE if @iter points at the last entry.
+ */
+gboolean gw_hist_iter_get_next_time(const GwHistIter *iter, GwTime *time)
+{
+    GwHistIter next = *iter;
+
+    if (!gw_hist_iter_next(&next)) {
+        return FALSE;
+    }
+
+    *time = gw_hist_iter_get_time(&next);
+    return TRUE;
+}
+
+/**
+ * gw_hist_iter_get_value:
+ * @iter: A #GwHistIter.
+ *
+ * Returns: The value of a single bit node at the current entry.
+ */
+guint8 gw_hist_iter_get_value(const GwHistIter *iter)
+{
+    const GwHistColumns *columns = iter->columns;
+
+    if (columns == NULL) {
+        return iter->hist_ent->v.h_val;
+    }
+
+    switch (columns->kind) {
+        case COLUMNS_REAL: {
+            // h_val overlaps the first byte of h_double in a histent.
+            GwHistEnt h;
+            h.v.h_double = columns->reals[iter->index];
+            return h.v.h_val;
+        }
+
+        case COLUMNS_STRING:
+            return (guint8)columns->strings[iter->index];
+
+        default:
+            return get_packed(columns, iter->index);
+    }
+}
+
+guint8 gw_hist_iter_get_flags(const GwHistIter *iter)
+{
+    if (iter->columns == NULL) {
+        return iter->hist_ent->flags;
+    }
+
+    return iter->columns->flags != NULL ? iter->columns->flags[iter->index] : 0;
+}
+
+/**
+ * gw_hist_iter_get_vector:
+ * @iter: A #GwHistIter.
+ * @vector: (out caller-allocates): Storage for one byte per bit of the node.
+ *
+ * Copies the value of a vector node at the current entry to @vector. The
+ * value isn't terminated.
+ *
+ * Returns: %FALSE if the entry has no value.
+ */
+gboolean gw_hist_iter_get_vector(const GwHistIter *iter, gchar *vector)
+{
+    const GwHistColumns *columns = iter->columns;
+
+    if (columns == NULL) {
+        GwNode *node = iter->node;
+
+        if (iter->hist_ent->v.h_vector == NULL) {
+            return FALSE;
+        }
+        memcpy(vector, iter->hist_ent->v.h_vector, ABS(node->msi - node->lsi) + 1);
+        return TRUE;
+    }
+
+    if (columns->kind != COLUMNS_BITS || columns->width == 0) {
+        return FALSE;
+    }
+
+    if (columns->null_vectors != NULL &&
+        (columns->null_vectors[iter->index / 8] & (1 << (iter->index % 8)))) {
+        return FALSE;
+    }
+
+    gsize first = (gsize)iter->index * columns->width;
+    for (guint b = 0; b < columns->width; b++) {
+        vector[b] = get_packed(columns, first + b);
+    }
+
+    return TRUE;
+}
+
+/**
+ * gw_hist_iter_get_real:
+ * @iter: A #GwHistIter.
+ *
+ * Returns: The value of a real node at the current entry.
+ */
+gdouble gw_hist_iter_get_real(const GwHistIter *iter)
+{
+    const GwHistColumns *columns = iter->columns;
+
+    if (columns == NULL) {
+        return iter->hist_ent->v.h_double;
+    }
+
+    return columns->reals != NULL ? columns->reals[iter->index] : 0.0;
+}
+
+/**
+ * gw_hist_iter_get_string:
+ * @iter: A #GwHistIter.
+ *
+ * Returns: (transfer none) (nullable): The value of a string node at the
+ * current entry, which stays valid as long as the history of the node.
+ */
+const gchar *gw_hist_iter_get_string(const GwHistIter *iter)
+{
+    const GwHistColumns *columns = iter->columns;
+
+    if (columns == NULL) {
+        return iter->hist_ent->v.h_vector;
+    }
+
+    if (columns->strings == NULL || columns->strings[iter->index] == NULL_STRING ||
+        !(gw_hist_iter_get_flags(iter) & GW_HIST_ENT_FLAG_STRING)) {
+        return NULL;
+    }
+
+    return columns->string_pool + columns->strings[iter->index];
+}
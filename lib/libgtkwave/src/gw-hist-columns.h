@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glib.h>
+#include "gw-types.h"
+#include "gw-time.h"
+#include "gw-hist-ent.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GwHistColumns GwHistColumns;
+
+/**
+ * GwHistIter:
+ *
+ * Walks the history of a node. Nodes whose history was compacted into
+ * columns are read from the columns, all other nodes from their #GwHistEnt
+ * list. The fields are private.
+ */
+typedef struct
+{
+    /*< private >*/
+    GwNode *node;
+    GwHistEnt *hist_ent;
+    const GwHistColumns *columns;
+    guint index;
+    guint offset;
+    GwTime time;
+} GwHistIter;
+
+GwHistColumns *gw_hist_columns_new(GwNode *node);
+GwHistColumns *gw_hist_columns_ref(GwHistColumns *self);
+void gw_hist_columns_unref(GwHistColumns *self);
+
+guint gw_hist_columns_get_length(const GwHistColumns *self);
+guint gw_hist_columns_get_width(const GwHistColumns *self);
+gsize gw_hist_columns_get_memory_size(const GwHistColumns *self);
+GwTime gw_hist_columns_get_time(const GwHistColumns *self, guint index);
+gint gw_hist_columns_find(const GwHistColumns *self, GwTime key);
+
+void gw_hist_columns_compact_nodes(GPtrArray *nodes);
+
+void gw_hist_iter_init(GwHistIter *iter, GwNode *node);
+void gw_hist_iter_init_at(GwHistIter *iter, GwNode *node, guint index);
+gboolean gw_hist_iter_next(GwHistIter *iter);
+gboolean gw_hist_iter_prev(GwHistIter *iter);
+void gw_hist_iter_seek(GwHistIter *iter, GwTime key);
+
+guint gw_hist_iter_get_index(const GwHistIter *iter);
+GwTime gw_hist_iter_get_time(const GwHistIter *iter);
+gboolean gw_hist_iter_get_next_time(const GwHistIter *iter, GwTime *time);
+guint8 gw_hist_iter_get_value(const GwHistIter *iter);
+guint8 gw_hist_iter_get_flags(const GwHistIter *iter);
+gboolean gw_hist_iter_get_vector(const GwHistIter *iter, gchar *vector);
+gdouble gw_hist_iter_get_real(const GwHistIter *iter);
+const gchar *gw_hist_iter_get_string(const GwHistIter *iter);
+
+G_END_DECLS
@@ -3,22 +3,60 @@
 #define BLOCK_SIZE (64 * 1024)
 #define HIST_ENTS_PER_BLOCK (BLOCK_SIZE / sizeof(GwHistEnt))
 
+// Vectors larger than this get their own allocation instead of wasting the
+// rest of the current vector block. The same applies to bulk allocations of
+// more than a quarter block of histents.
+#define MAX_POOLED_VECTOR_SIZE (BLOCK_SIZE / 4)
+#define MAX_POOLED_HIST_ENTS (HIST_ENTS_PER_BLOCK / 4)
+
+// Every thread allocates from its own magazine, which holds the rest of the
+// last blocks it took from a factory. Only taking a new block needs the lock.
+// Factories are identified by a serial number instead of their address,
+// because a new factory might reuse the address of a finalized one.
+typedef struct
+{
+    guint factory_id;
+
+    GwHistEnt *hist_ents;
+    gsize hist_ents_left;
+
+    guint8 *vector_block;
+    gsize vector_block_left;
+} Magazine;
+
+// A thread can alternate between a few factories, e.g. while following a
+// file that appends to the traces of an earlier import or with two dump files
+// open in the GUI. Each thread keeps a magazine for the most recently used
+// factories, ordered from the most to the least recently used one.
+#define MAGAZINES_PER_THREAD (8)
+
+typedef struct
+{
+    Magazine magazines[MAGAZINES_PER_THREAD];
+} MagazineSet;
+
 struct _GwHistEntFactory
 {
     GObject parent_instance;
 
+    guint id;
+
+    GMutex lock;
     GPtrArray *blocks;
-    GwHistEnt *current_block;
-    gint next_index;
+    gsize size;
 };
 
 G_DEFINE_TYPE(GwHistEntFactory, gw_hist_ent_factory, G_TYPE_OBJECT)
 
+static GPrivate magazine_key = G_PRIVATE_INIT(g_free);
+static gint next_factory_id = 1;
+
 static void gw_hist_ent_factory_finalize(GObject *object)
 {
     GwHistEntFactory *self = GW_HIST_ENT_FACTORY(object);
 
     g_ptr_array_free(self->blocks, TRUE);
+    g_mutex_clear(&self->lock);
 
     G_OBJECT_CLASS(gw_hist_ent_factory_parent_class)->finalize(object);
 }
@@ -32,6 +70,9 @@ static void gw_hist_ent_factory_class_init(GwHistEntFactoryClass *klass)
 
 static void gw_hist_ent_factory_init(GwHistEntFactory *self)
 {
+    self->id = (guint)g_atomic_int_add(&next_factory_id, 1);
+
+    g_mutex_init(&self->lock);
     self->blocks = g_ptr_array_new_with_free_func(g_free);
 }
 
@@ -40,20 +81,155 @@ GwHistEntFactory *gw_hist_ent_factory_new(void)
     return g_object_new(GW_TYPE_HIST_ENT_FACTORY, NULL);
 }
 
+static gpointer gw_hist_ent_factory_new_block(GwHistEntFactory *self, gsize size, gboolean clear)
+{
+    gpointer block = clear ? g_malloc0(size) : g_malloc(size);
+
+    g_mutex_lock(&self->lock);
+    g_ptr_array_add(self->blocks, block);
+    self->size += size;
+    g_mutex_unlock(&self->lock);
+
+    return block;
+}
+
+static Magazine *gw_hist_ent_factory_get_magazine(GwHistEntFactory *self)
+{
+    MagazineSet *set = g_private_get(&magazine_key);
+
+    if (G_UNLIKELY(set == NULL)) {
+        set = g_new0(MagazineSet, 1);
+        g_private_set(&magazine_key, set);
+    }
+
+    Magazine *magazines = set->magazines;
+
+    if (G_LIKELY(magazines[0].factory_id == self->id)) {
+        return &magazines[0];
+    }
+
+    // Move the magazine of this factory to the front. If there is none, the
+    // least recently used magazine is replaced. The rest of its blocks is
+    // abandoned and freed along with its factory.
+    guint i = 1;
+    while (i < MAGAZINES_PER_THREAD - 1 && magazines[i].factory_id != self->id) {
+        i++;
+    }
+
+    Magazine magazine = magazines[i];
+    memmove(&magazines[1], &magazines[0], i * sizeof(Magazine));
+
+    if (magazine.factory_id != self->id) {
+        memset(&magazine, 0, sizeof(Magazine));
+        magazine.factory_id = self->id;
+    }
+    magazines[0] = magazine;
+
+    return &magazines[0];
+}
+
 GwHistEnt *gw_hist_ent_factory_alloc(GwHistEntFactory *self)
+{
+    return gw_hist_ent_factory_alloc_n(self, 1);
+}
+
+/**
+ * gw_hist_ent_factory_alloc_n:
+ * @self: A #GwHistEntFactory.
+ * @n: The number of histents.
+ *
+ * Allocates @n zero initialized histents in one contiguous array. This is
+ * cheaper than @n calls to gw_hist_ent_factory_alloc() if the number of
+ * value changes is known in advance. Linking the histents is up to the
+ * caller.
+ *
+ * All allocation functions of the factory can be called from multiple threads
+ * at the same time. Each thread allocates from its own blocks, so histents
+ * that are allocated by the same thread end up next to each other in memory.
+ *
+ * The returned memory must not be freed with g_free(). It stays valid until
+ * the factory is finalized.
+ *
+ * Returns: (transfer none): The first of @n histents.
+ */
+GwHistEnt *gw_hist_ent_factory_alloc_n(GwHistEntFactory *self, gsize n)
 {
     g_return_val_if_fail(GW_IS_HIST_ENT_FACTORY(self), NULL);
+    g_return_val_if_fail(n > 0, NULL);
+
+    Magazine *magazine = gw_hist_ent_factory_get_magazine(self);
 
-    if (self->next_index == HIST_ENTS_PER_BLOCK || self->blocks->len == 0) {
-        self->current_block = g_malloc0(BLOCK_SIZE);
+    if (G_UNLIKELY(magazine->hist_ents_left < n)) {
+        if (n > MAX_POOLED_HIST_ENTS) {
+            return gw_hist_ent_factory_new_block(self, n * sizeof(GwHistEnt), TRUE);
+        }
 
-        g_ptr_array_add(self->blocks, self->current_block);
-        self->next_index = 0;
+        magazine->hist_ents = gw_hist_ent_factory_new_block(self, BLOCK_SIZE, TRUE);
+        magazine->hist_ents_left = HIST_ENTS_PER_BLOCK;
     }
 
-    GwHistEnt *h = &self->current_block[self->next_index];
+    GwHistEnt *h = magazine->hist_ents;
 
-    self->next_index++;
+    magazine->hist_ents += n;
+    magazine->hist_ents_left -= n;
 
     return h;
-}
\ No newline at end of file
+}
+
+/**
+ * gw_hist_ent_factory_alloc_vector:
+ * @self: A #GwHistEntFactory.
+ * @len: The vector size in bytes.
+ *
+ * Allocates storage for a vector value from a contiguous pool owned by the
+ * factory. Consecutive values end up next to each other in memory, which
+ * avoids a separate heap allocation per value change.
+ *
+ * The returned memory must not be freed with g_free(). It stays valid until
+ * the factory is finalized.
+ *
+ * Returns: (transfer none): Uninitialized storage for @len bytes.
+ */
+gchar *gw_hist_ent_factory_alloc_vector(GwHistEntFactory *self, gsize len)
+{
+    g_return_val_if_fail(GW_IS_HIST_ENT_FACTORY(self), NULL);
+
+    if (len > MAX_POOLED_VECTOR_SIZE) {
+        return gw_hist_ent_factory_new_block(self, len, FALSE);
+    }
+
+    Magazine *magazine = gw_hist_ent_factory_get_magazine(self);
+
+    if (G_UNLIKELY(magazine->vector_block_left < len)) {
+        magazine->vector_block = gw_hist_ent_factory_new_block(self, BLOCK_SIZE, FALSE);
+        magazine->vector_block_left = BLOCK_SIZE;
+    }
+
+    gchar *vector = (gchar *)magazine->vector_block;
+
+    magazine->vector_block += len;
+    magazine->vector_block_left -= len;
+
+    return vector;
+}
+
+/**
+ * gw_hist_ent_factory_get_size:
+ * @self: A #GwHistEntFactory.
+ *
+ * Returns the number of bytes the factory has allocated for histents and
+ * vectors so far, including the unused rest of partially filled blocks.
+ * All of it is freed together when the factory is finalized.
+ *
+ * Returns: The allocated size in bytes.
+ */
+gsize gw_hist_ent_factory_get_size(GwHistEntFactory *self)
+{
+    g_return_val_if_fail(GW_IS_HIST_ENT_FACTORY(self), 0);
+
+    g_mutex_lock(&self->lock);
+    gsize size = self->size;
+    g_mutex_unlock(&self->lock);
+
+    return size;
+}
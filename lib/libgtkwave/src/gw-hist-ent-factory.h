@@ -11,5 +11,8 @@ G_DECLARE_FINAL_TYPE(GwHistEntFactory, gw_hist_ent_factory, GW, HIST_ENT_FACTORY
 GwHistEntFactory *gw_hist_ent_factory_new(void);
 
 GwHistEnt *gw_hist_ent_factory_alloc(GwHistEntFactory *self);
+GwHistEnt *gw_hist_ent_factory_alloc_n(GwHistEntFactory *self, gsize n);
+gchar *gw_hist_ent_factory_alloc_vector(GwHistEntFactory *self, gsize len);
+gsize gw_hist_ent_factory_get_size(GwHistEntFactory *self);
 
 G_END_DECLS
@@ -0,0 +1,80 @@
+#include "gw-name-pool.h"
+
+/* large enough that the per block overhead doesn't matter even for millions of names */
+#define GW_NAME_POOL_BLOCK_SIZE (64 * 1024)
+
+struct _GwNamePool
+{
+    GObject parent_instance;
+
+    GStringChunk *chunk;
+};
+
+G_DEFINE_TYPE(GwNamePool, gw_name_pool, G_TYPE_OBJECT)
+
+static void gw_name_pool_finalize(GObject *object)
+{
+    GwNamePool *self = GW_NAME_POOL(object);
+
+    g_string_chunk_free(self->chunk);
+
+    G_OBJECT_CLASS(gw_name_pool_parent_class)->finalize(object);
+}
+
+static void gw_name_pool_class_init(GwNamePoolClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = gw_name_pool_finalize;
+}
+
+static void gw_name_pool_init(GwNamePool *self)
+{
+    self->chunk = g_string_chunk_new(GW_NAME_POOL_BLOCK_SIZE);
+}
+
+/**
+ * gw_name_pool_new:
+ *
+ * Creates a pool for signal names. The names are packed into large blocks
+ * without the per allocation overhead of g_malloc() and are all freed
+ * together when the pool is finalized.
+ *
+ * Returns: (transfer full): A new #GwNamePool.
+ */
+GwNamePool *gw_name_pool_new(void)
+{
+    return g_object_new(GW_TYPE_NAME_POOL, NULL);
+}
+
+/**
+ * gw_name_pool_add:
+ * @self: A #GwNamePool.
+ * @name: The name.
+ *
+ * Stores a copy of @name in the pool.
+ *
+ * Returns: (transfer none): The copy, which stays valid as long as the pool.
+ */
+gchar *gw_name_pool_add(GwNamePool *self, const gchar *name)
+{
+    return gw_name_pool_add_len(self, name, -1);
+}
+
+/**
+ * gw_name_pool_add_len:
+ * @self: A #GwNamePool.
+ * @name: The name.
+ * @len: The length of @name in bytes, or -1 if it is nul-terminated.
+ *
+ * Stores a nul-terminated copy of the first @len bytes of @name in the pool.
+ *
+ * Returns: (transfer none): The copy, which stays valid as long as the pool.
+ */
+gchar *gw_name_pool_add_len(GwNamePool *self, const gchar *name, gssize len)
+{
+    g_return_val_if_fail(GW_IS_NAME_POOL(self), NULL);
+    g_return_val_if_fail(name != NULL, NULL);
+
+    return g_string_chunk_insert_len(self->chunk, name, len);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GW_TYPE_NAME_POOL (gw_name_pool_get_type())
+G_DECLARE_FINAL_TYPE(GwNamePool, gw_name_pool, GW, NAME_POOL, GObject)
+
+GwNamePool *gw_name_pool_new(void);
+
+gchar *gw_name_pool_add(GwNamePool *self, const gchar *name);
+gchar *gw_name_pool_add_len(GwNamePool *self, const gchar *name, gssize len);
+
+G_END_DECLS
@@ -2,6 +2,7 @@
 
 #include "gw-types.h"
 #include "gw-hist-ent.h"
+#include "gw-hist-columns.h"
 #include "gw-vlist-writer.h"
 
 /* struct Node bitfield widths */
@@ -34,6 +35,8 @@ struct _GwNode
 
     GwHistEnt **harray; /* fill this in when we make a trace.. contains  */
     /*  a ptr to an array of histents for bsearching */
+    void *lod; /* level-of-detail summary of harray, built lazily by the renderer */
+    GwHistColumns *columns; /* optional columnar copy of the history, see GwHistIter */
     union
     {
         GwFac *mvlfac; /* for use with mvlsim aets */
@@ -0,0 +1,608 @@
+#include "gw-vcd-cache.h"
+#include "gw-vcd-file-private.h"
+#include "gw-vlist.h"
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <errno.h>
+
+// The cache stores the state of a VCD file after gw_loader_load(), before any
+// trace is imported. It is written next to the VCD file and is only used if
+// the path, size, inode and modification time (with nanoseconds where the
+// platform has them) of the VCD file still match. All
+// values are stored in host byte order, a cache from a different platform
+// fails the magic check and is rebuilt.
+
+#define CACHE_SUFFIX ".gwcache"
+#define CACHE_MAGIC "GWVCDC\0\0"
+#define CACHE_VERSION (2)
+#define CACHE_BYTE_ORDER (0x01020304)
+
+#define TREE_HAS_CHILD (1 << 0)
+#define TREE_HAS_NEXT (1 << 1)
+
+typedef struct
+{
+    FILE *handle;
+    gboolean ok;
+} CacheWriter;
+
+typedef struct
+{
+    const guint8 *pnt;
+    const guint8 *end;
+    gboolean ok;
+} CacheReader;
+
+static void write_bytes(CacheWriter *writer, gconstpointer data, gsize len)
+{
+    if (writer->ok && fwrite(data, 1, len, writer->handle) != len) {
+        writer->ok = FALSE;
+    }
+}
+
+static void write_u32(CacheWriter *writer, guint32 value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_i32(CacheWriter *writer, gint32 value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_i64(CacheWriter *writer, gint64 value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_string(CacheWriter *writer, const gchar *str)
+{
+    guint32 len = strlen(str);
+    write_u32(writer, len);
+    write_bytes(writer, str, len);
+}
+
+static void write_vlist(CacheWriter *writer, GwVlist *vlist)
+{
+    write_u32(writer, vlist != NULL);
+    if (vlist != NULL && writer->ok) {
+        writer->ok = gw_vlist_write(vlist, writer->handle);
+    }
+}
+
+static const guint8 *read_bytes(CacheReader *reader, gsize len)
+{
+    if (!reader->ok || (gsize)(reader->end - reader->pnt) < len) {
+        reader->ok = FALSE;
+        return NULL;
+    }
+
+    const guint8 *data = reader->pnt;
+    reader->pnt += len;
+
+    return data;
+}
+
+static guint32 read_u32(CacheReader *reader)
+{
+    guint32 value = 0;
+    const guint8 *data = read_bytes(reader, sizeof(value));
+    if (data != NULL) {
+        memcpy(&value, data, sizeof(value));
+    }
+    return value;
+}
+
+static gint32 read_i32(CacheReader *reader)
+{
+    gint32 value = 0;
+    const guint8 *data = read_bytes(reader, sizeof(value));
+    if (data != NULL) {
+        memcpy(&value, data, sizeof(value));
+    }
+    return value;
+}
+
+static gint64 read_i64(CacheReader *reader)
+{
+    gint64 value = 0;
+    const guint8 *data = read_bytes(reader, sizeof(value));
+    if (data != NULL) {
+        memcpy(&value, data, sizeof(value));
+    }
+    return value;
+}
+
+static gchar *read_name(CacheReader *reader, GwNamePool *names)
+{
+    guint32 len = read_u32(reader);
+    const guint8 *data = read_bytes(reader, len);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    return gw_name_pool_add_len(names, (const gchar *)data, len);
+}
+
+static gchar *read_string(CacheReader *reader)
+{
+    guint32 len = read_u32(reader);
+    const guint8 *data = read_bytes(reader, len);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    return g_strndup((const gchar *)data, len);
+}
+
+static GwVlist *read_vlist(CacheReader *reader)
+{
+    if (read_u32(reader) == 0 || !reader->ok) {
+        return NULL;
+    }
+
+    GwVlist *vlist = gw_vlist_read(&reader->pnt, reader->end);
+    if (vlist == NULL) {
+        reader->ok = FALSE;
+    }
+
+    return vlist;
+}
+
+static gint64 stat_mtime_nsec(GStatBuf *st)
+{
+#if defined(G_OS_WIN32)
+    (void)st;
+    return 0;
+#elif defined(__APPLE__)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return st->st_mtim.tv_nsec;
+#endif
+}
+
+/* the key identifies the VCD file and everything that changes the result of a load */
+static void write_key(CacheWriter *writer,
+                      const gchar *path,
+                      GStatBuf *st,
+                      gchar hierarchy_delimiter)
+{
+    write_bytes(writer, CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1);
+    write_u32(writer, CACHE_BYTE_ORDER);
+    write_u32(writer, CACHE_VERSION);
+    write_u32(writer, sizeof(GwTime));
+    write_string(writer, path);
+    write_i64(writer, st->st_size);
+    write_i64(writer, st->st_mtime);
+    write_i64(writer, stat_mtime_nsec(st));
+    write_i64(writer, st->st_ino);
+    write_u32(writer, (guchar)hierarchy_delimiter);
+}
+
+static gboolean check_key(CacheReader *reader,
+                          const gchar *path,
+                          GStatBuf *st,
+                          gchar hierarchy_delimiter)
+{
+    const guint8 *magic = read_bytes(reader, sizeof(CACHE_MAGIC) - 1);
+    if (magic == NULL || memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1) != 0) {
+        return FALSE;
+    }
+
+    if (read_u32(reader) != CACHE_BYTE_ORDER || read_u32(reader) != CACHE_VERSION ||
+        read_u32(reader) != sizeof(GwTime)) {
+        return FALSE;
+    }
+
+    gchar *cached_path = read_string(reader);
+    gboolean same_path = g_strcmp0(cached_path, path) == 0;
+    g_free(cached_path);
+
+    return same_path && read_i64(reader) == (gint64)st->st_size &&
+           read_i64(reader) == (gint64)st->st_mtime && read_i64(reader) == stat_mtime_nsec(st) &&
+           read_i64(reader) == (gint64)st->st_ino &&
+           read_u32(reader) == (guchar)hierarchy_delimiter && reader->ok;
+}
+
+static void write_tree(CacheWriter *writer, GwTreeNode *t)
+{
+    for (; t != NULL && writer->ok; t = t->next) {
+        guint32 flags = 0;
+        if (t->child != NULL) {
+            flags |= TREE_HAS_CHILD;
+        }
+        if (t->next != NULL) {
+            flags |= TREE_HAS_NEXT;
+        }
+
+        write_u32(writer, flags);
+        write_u32(writer, t->kind);
+        write_i32(writer, t->t_which);
+        write_u32(writer, t->t_stem);
+        write_u32(writer, t->t_istem);
+        write_string(writer, t->name);
+
+        if (t->child != NULL) {
+            write_tree(writer, t->child);
+        }
+    }
+}
+
+static GwTreeNode *read_tree(CacheReader *reader, guint numfacs)
+{
+    GwTreeNode *first = NULL;
+    GwTreeNode **link = &first;
+
+    while (reader->ok) {
+        guint32 flags = read_u32(reader);
+        guint32 kind = read_u32(reader);
+        gint32 which = read_i32(reader);
+        guint32 stem = read_u32(reader);
+        guint32 istem = read_u32(reader);
+        gchar *name = read_string(reader);
+
+        if (name == NULL || which >= (gint32)numfacs) {
+            g_free(name);
+            reader->ok = FALSE;
+            break;
+        }
+
+        GwTreeNode *t = gw_tree_node_new(kind, name);
+        t->t_which = which;
+        t->t_stem = stem;
+        t->t_istem = istem;
+        g_free(name);
+
+        *link = t;
+        link = &t->next;
+
+        if (flags & TREE_HAS_CHILD) {
+            t->child = read_tree(reader, numfacs);
+        }
+        if (!(flags & TREE_HAS_NEXT)) {
+            break;
+        }
+    }
+
+    return first;
+}
+
+static void write_blackout_region(GwTime start, GwTime end, gpointer user_data)
+{
+    CacheWriter *writer = user_data;
+
+    write_i64(writer, start);
+    write_i64(writer, end);
+}
+
+static void write_facs(CacheWriter *writer, GwFacs *facs)
+{
+    guint numfacs = gw_facs_get_length(facs);
+
+    // Aliases and vector chains point to other symbols, which are stored as
+    // indices into the facs.
+    GHashTable *node_indices = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GHashTable *symbol_indices = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (guint i = 0; i < numfacs; i++) {
+        GwSymbol *fac = gw_facs_get(facs, i);
+        g_hash_table_insert(node_indices, fac->n, GUINT_TO_POINTER(i + 1));
+        g_hash_table_insert(symbol_indices, fac, GUINT_TO_POINTER(i + 1));
+    }
+
+    write_u32(writer, numfacs);
+
+    for (guint i = 0; i < numfacs && writer->ok; i++) {
+        GwSymbol *fac = gw_facs_get(facs, i);
+        GwNode *n = fac->n;
+
+        write_string(writer, fac->name);
+        write_u32(writer, GPOINTER_TO_UINT(g_hash_table_lookup(symbol_indices, fac->vec_root)));
+        write_u32(writer, GPOINTER_TO_UINT(g_hash_table_lookup(symbol_indices, fac->vec_chain)));
+
+        write_u32(writer, GPOINTER_TO_UINT(g_hash_table_lookup(node_indices, n->curr)));
+        write_i32(writer, n->msi);
+        write_i32(writer, n->lsi);
+        write_i32(writer, n->numhist);
+        write_u32(writer, n->vartype);
+        write_u32(writer, n->vardt);
+        write_u32(writer, n->vardir);
+        write_u32(writer, n->extvals);
+
+        write_vlist(writer, n->mv.mvlfac_vlist);
+    }
+
+    g_hash_table_destroy(node_indices);
+    g_hash_table_destroy(symbol_indices);
+}
+
+static GwFacs *read_facs(CacheReader *reader)
+{
+    guint32 numfacs = read_u32(reader);
+    if (!reader->ok || numfacs == 0 || numfacs > (gsize)(reader->end - reader->pnt)) {
+        reader->ok = FALSE;
+        return NULL;
+    }
+
+    GwFacs *facs = gw_facs_new(numfacs);
+    GwNamePool *names = gw_name_pool_new();
+    gw_facs_set_name_pool(facs, names);
+    g_object_unref(names); /* owned by the facs */
+
+    // Allocate everything first, so that references to later facs can be
+    // resolved in a single pass.
+    for (guint i = 0; i < numfacs; i++) {
+        GwSymbol *fac = g_new0(GwSymbol, 1);
+        fac->n = g_new0(GwNode, 1);
+        fac->n->head.time = -2;
+        fac->n->head.v.h_val = GW_BIT_X;
+        gw_facs_set(facs, i, fac);
+    }
+
+    for (guint i = 0; i < numfacs && reader->ok; i++) {
+        GwSymbol *fac = gw_facs_get(facs, i);
+        GwNode *n = fac->n;
+
+        fac->name = read_name(reader, names);
+        n->nname = fac->name;
+
+        guint32 vec_root = read_u32(reader);
+        guint32 vec_chain = read_u32(reader);
+        guint32 alias = read_u32(reader);
+        if (vec_root > numfacs || vec_chain > numfacs || alias > numfacs) {
+            reader->ok = FALSE;
+            break;
+        }
+        fac->vec_root = vec_root > 0 ? gw_facs_get(facs, vec_root - 1) : NULL;
+        fac->vec_chain = vec_chain > 0 ? gw_facs_get(facs, vec_chain - 1) : NULL;
+        n->curr = alias > 0 ? (GwHistEnt *)gw_facs_get(facs, alias - 1)->n : NULL;
+
+        n->msi = read_i32(reader);
+        n->lsi = read_i32(reader);
+        n->numhist = read_i32(reader);
+        n->vartype = read_u32(reader);
+        n->vardt = read_u32(reader);
+        n->vardir = read_u32(reader);
+        n->extvals = read_u32(reader);
+
+        n->mv.mvlfac_vlist = read_vlist(reader);
+    }
+
+    return facs;
+}
+
+static void free_facs(GwFacs *facs)
+{
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwSymbol *fac = gw_facs_get(facs, i);
+        if (fac->n->mv.mvlfac_vlist != NULL) {
+            gw_vlist_destroy(fac->n->mv.mvlfac_vlist);
+        }
+        g_free(fac->n);
+        g_free(fac);
+    }
+    g_object_unref(facs);
+}
+
+/**
+ * gw_vcd_cache_get_filename:
+ * @vcd_filename: The VCD file.
+ *
+ * Returns: (transfer full): The filename of the cache that belongs to @vcd_filename.
+ */
+gchar *gw_vcd_cache_get_filename(const gchar *vcd_filename)
+{
+    return g_strconcat(vcd_filename, CACHE_SUFFIX, NULL);
+}
+
+/**
+ * gw_vcd_cache_load:
+ * @vcd_filename: The VCD file.
+ * @hierarchy_delimiter: The hierarchy delimiter of the loader.
+ *
+ * Restores a VCD file from its cache. The cache file is mapped into memory
+ * and the value changes of all signals are copied out of it in their frozen
+ * form, so traces are imported from them exactly like after a full parse.
+ *
+ * Returns: (transfer full) (nullable): The file or %NULL if there is no
+ *     usable cache for @vcd_filename.
+ */
+GwVcdFile *gw_vcd_cache_load(const gchar *vcd_filename, gchar hierarchy_delimiter)
+{
+    GStatBuf st;
+    if (g_stat(vcd_filename, &st) != 0) {
+        return NULL;
+    }
+
+    gchar *cache_filename = gw_vcd_cache_get_filename(vcd_filename);
+    GMappedFile *mapped = g_mapped_file_new(cache_filename, FALSE, NULL);
+    g_free(cache_filename);
+
+    if (mapped == NULL) {
+        return NULL;
+    }
+
+    CacheReader reader = {
+        .pnt = (const guint8 *)g_mapped_file_get_contents(mapped),
+        .end = (const guint8 *)g_mapped_file_get_contents(mapped) +
+               g_mapped_file_get_length(mapped),
+        .ok = TRUE,
+    };
+
+    gchar *path = g_canonicalize_filename(vcd_filename, NULL);
+    gboolean valid = check_key(&reader, path, &st, hierarchy_delimiter);
+    g_free(path);
+
+    if (!valid) {
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+
+    GwTime time_scale = read_i64(&reader);
+    GwTimeDimension time_dimension = read_u32(&reader);
+    GwTime min_time = read_i64(&reader);
+    GwTime max_time = read_i64(&reader);
+    GwTime global_time_offset = read_i64(&reader);
+    gboolean has_escaped_names = read_u32(&reader);
+    GwTime start_time = read_i64(&reader);
+    GwTime end_time = read_i64(&reader);
+    gboolean is_prepacked = read_u32(&reader);
+
+    // The regions were written in list order, adding them prepends.
+    GwBlackoutRegions *blackout_regions = gw_blackout_regions_new();
+    guint32 num_blackout_regions = read_u32(&reader);
+    const guint8 *regions = read_bytes(&reader, (gsize)num_blackout_regions * 2 * sizeof(GwTime));
+    for (guint32 i = num_blackout_regions; i > 0 && regions != NULL; i--) {
+        GwTime region[2];
+        memcpy(region, regions + (i - 1) * sizeof(region), sizeof(region));
+        gw_blackout_regions_add(blackout_regions, region[0], region[1]);
+    }
+
+    GwVlist *time_vlist = read_vlist(&reader);
+    GwFacs *facs = read_facs(&reader);
+    GwTreeNode *root = reader.ok ? read_tree(&reader, gw_facs_get_length(facs)) : NULL;
+
+    g_mapped_file_unref(mapped);
+
+    if (!reader.ok || root == NULL) {
+        gw_tree_node_free(root);
+        if (facs != NULL) {
+            free_facs(facs);
+        }
+        if (time_vlist != NULL) {
+            gw_vlist_destroy(time_vlist);
+        }
+        g_object_unref(blackout_regions);
+        return NULL;
+    }
+
+    GwTree *tree = gw_tree_new(root);
+    GwTimeRange *time_range = gw_time_range_new(min_time, max_time);
+
+    // clang-format off
+    GwVcdFile *file = g_object_new(GW_TYPE_VCD_FILE,
+                                   "tree", tree,
+                                   "facs", facs,
+                                   "blackout-regions", blackout_regions,
+                                   "time-scale", time_scale,
+                                   "time-dimension", time_dimension,
+                                   "time-range", time_range,
+                                   "global-time-offset", global_time_offset,
+                                   "has-escaped-names", has_escaped_names,
+                                   NULL);
+    // clang-format on
+
+    file->start_time = start_time;
+    file->end_time = end_time;
+    file->time_vlist = time_vlist;
+    file->is_prepacked = is_prepacked;
+
+    g_object_unref(tree);
+    g_object_unref(facs);
+    g_object_unref(blackout_regions);
+    g_object_unref(time_range);
+
+    return file;
+}
+
+/**
+ * gw_vcd_cache_save:
+ * @file: A #GwVcdFile that was just loaded.
+ * @vcd_filename: The VCD file @file was loaded from.
+ * @hierarchy_delimiter: The hierarchy delimiter of the loader.
+ * @error: Return location for a #GError.
+ *
+ * Writes the cache for @vcd_filename. This must happen before any trace of
+ * @file is imported, because importing consumes the value changes.
+ *
+ * The cache is written to a temporary file first and renamed afterwards, so
+ * an interrupted write never leaves a truncated cache behind.
+ *
+ * Returns: %TRUE if the cache was written.
+ */
+gboolean gw_vcd_cache_save(GwVcdFile *file,
+                           const gchar *vcd_filename,
+                           gchar hierarchy_delimiter,
+                           GError **error)
+{
+    g_return_val_if_fail(GW_IS_VCD_FILE(file), FALSE);
+    g_return_val_if_fail(vcd_filename != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    GStatBuf st;
+    if (g_stat(vcd_filename, &st) != 0) {
+        g_set_error(error,
+                    G_FILE_ERROR,
+                    g_file_error_from_errno(errno),
+                    "Can't stat '%s': %s",
+                    vcd_filename,
+                    g_strerror(errno));
+        return FALSE;
+    }
+
+    gchar *cache_filename = gw_vcd_cache_get_filename(vcd_filename);
+    gchar *tmp_filename = g_strconcat(cache_filename, ".tmp", NULL);
+
+    CacheWriter writer = {
+        .handle = g_fopen(tmp_filename, "wb"),
+        .ok = TRUE,
+    };
+
+    if (writer.handle == NULL) {
+        g_set_error(error,
+                    G_FILE_ERROR,
+                    g_file_error_from_errno(errno),
+                    "Can't create '%s': %s",
+                    tmp_filename,
+                    g_strerror(errno));
+        g_free(tmp_filename);
+        g_free(cache_filename);
+        return FALSE;
+    }
+
+    GwDumpFile *dump_file = GW_DUMP_FILE(file);
+    GwTimeRange *time_range = gw_dump_file_get_time_range(dump_file);
+    GwBlackoutRegions *blackout_regions = gw_dump_file_get_blackout_regions(dump_file);
+
+    gchar *path = g_canonicalize_filename(vcd_filename, NULL);
+    write_key(&writer, path, &st, hierarchy_delimiter);
+    g_free(path);
+
+    write_i64(&writer, gw_dump_file_get_time_scale(dump_file));
+    write_u32(&writer, gw_dump_file_get_time_dimension(dump_file));
+    write_i64(&writer, gw_time_range_get_start(time_range));
+    write_i64(&writer, gw_time_range_get_end(time_range));
+    write_i64(&writer, gw_dump_file_get_global_time_offset(dump_file));
+    write_u32(&writer, gw_dump_file_has_escaped_names(dump_file));
+    write_i64(&writer, file->start_time);
+    write_i64(&writer, file->end_time);
+    write_u32(&writer, file->is_prepacked);
+
+    write_u32(&writer, gw_blackout_regions_length(blackout_regions));
+    gw_blackout_regions_foreach(blackout_regions, write_blackout_region, &writer);
+
+    write_vlist(&writer, file->time_vlist);
+    write_facs(&writer, gw_dump_file_get_facs(dump_file));
+    write_tree(&writer, gw_tree_get_root(gw_dump_file_get_tree(dump_file)));
+
+    if (fclose(writer.handle) != 0) {
+        writer.ok = FALSE;
+    }
+
+    if (!writer.ok || g_rename(tmp_filename, cache_filename) != 0) {
+        g_set_error(error,
+                    G_FILE_ERROR,
+                    g_file_error_from_errno(errno),
+                    "Can't write '%s': %s",
+                    cache_filename,
+                    g_strerror(errno));
+        g_unlink(tmp_filename);
+        g_free(tmp_filename);
+        g_free(cache_filename);
+        return FALSE;
+    }
+
+    g_free(tmp_filename);
+    g_free(cache_filename);
+
+    return TRUE;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "gw-vcd-file.h"
+
+gchar *gw_vcd_cache_get_filename(const gchar *vcd_filename);
+GwVcdFile *gw_vcd_cache_load(const gchar *vcd_filename, gchar hierarchy_delimiter);
+gboolean gw_vcd_cache_save(GwVcdFile *file,
+                           const gchar *vcd_filename,
+                           gchar hierarchy_delimiter,
+                           GError **error);
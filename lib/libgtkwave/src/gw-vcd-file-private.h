@@ -14,4 +14,24 @@ struct _GwVcdFile
     GwTime end_time;
 
     GwHistEntFactory *hist_ent_factory;
+
+    GHashTable *unloadable_traces; /* GwNode* -> UnloadableTrace* */
+
+    GwVcdLoader *follow_loader; /* parses the appended data, NULL if not in follow mode */
+    GHashTable *follow_chunks; /* GwNode* -> GPtrArray* of FollowChunk* */
+    GHashTable *follow_tails; /* GwNode* -> last GwHistEnt before the end caps */
+    GHashTable *follow_aliases; /* GwNode* -> GPtrArray* of its imported aliases */
+    GwHistEnt *spare_hist_ents; /* end caps detached by gw_vcd_file_append_changes() */
 };
+
+void gw_vcd_file_append_changes(GwVcdFile *self,
+                                GwNode *np,
+                                GwVlist *vlist,
+                                guint time_idx,
+                                GPtrArray *changed_nodes);
+
+gboolean gw_vcd_loader_update(GwVcdLoader *self,
+                              GwVcdFile *file,
+                              gboolean *changed,
+                              GPtrArray *changed_nodes,
+                              GError **error);
@@ -3,31 +3,291 @@
 #include "gw-vlist-reader.h"
 #include <stdio.h>
 
+/* below this number of traces the import isn't worth spreading over threads */
+#define VCD_IMPORT_PARALLEL_MIN 32
+
 G_DEFINE_TYPE(GwVcdFile, gw_vcd_file, GW_TYPE_DUMP_FILE)
 
-static void gw_vcd_file_import_trace(GwVcdFile *self, GwNode *np);
+typedef struct
+{
+    GwVcdFile *self;
+    GwHistEntFactory *hist_ent_factory;
+    GPtrArray *nodes;
+    gint next_node;
+} ImportJob;
+
+typedef struct
+{
+    ImportJob *job;
+    GThread *thread;
+    GPtrArray *aliases;
+} ImportWorker;
+
+/* what is needed to put an imported trace back into its unimported state */
+typedef struct
+{
+    GwNode *node;
+    GwVlist *vlist;
+    GwNode *alias_of;
+    GwHistEntFactory *hist_ent_factory;
+} UnloadableTrace;
+
+/* value changes that were appended to the file after it was loaded */
+typedef struct
+{
+    GwVlist *vlist;
+    guint time_idx;
+} FollowChunk;
+
+static void gw_vcd_file_import_trace(GwVcdFile *self, GwHistEntFactory *factory, GwNode *np);
+static gboolean gw_vcd_file_import_trace_data(GwVcdFile *self,
+                                              GwHistEntFactory *factory,
+                                              GwNode *np);
+
+static void unloadable_trace_free(UnloadableTrace *trace)
+{
+    g_clear_pointer(&trace->vlist, gw_vlist_destroy);
+    g_clear_object(&trace->hist_ent_factory);
+    g_free(trace);
+}
+
+static void follow_chunk_free(FollowChunk *chunk)
+{
+    g_clear_pointer(&chunk->vlist, gw_vlist_destroy);
+    g_free(chunk);
+}
+
+static gpointer gw_vcd_file_import_worker(gpointer data)
+{
+    ImportWorker *worker = data;
+    ImportJob *job = worker->job;
+
+    while (TRUE) {
+        guint i = g_atomic_int_add(&job->next_node, 1);
+        if (i >= job->nodes->len) {
+            break;
+        }
+
+        GwNode *node = g_ptr_array_index(job->nodes, i);
+        if (!gw_vcd_file_import_trace_data(job->self, job->hist_ent_factory, node)) {
+            g_ptr_array_add(worker->aliases, node);
+        }
+    }
+
+    return NULL;
+}
+
+static void gw_vcd_file_import_traces_parallel(GwVcdFile *self,
+                                               GPtrArray *nodes,
+                                               GwHistEntFactory *factory)
+{
+    ImportJob job = {
+        .self = self,
+        .hist_ent_factory = factory,
+        .nodes = nodes,
+        .next_node = 0,
+    };
+
+    guint n_workers = MIN((guint)g_get_num_processors(), nodes->len);
+    ImportWorker *workers = g_new0(ImportWorker, n_workers);
+
+    for (guint i = 0; i < n_workers; i++) {
+        workers[i].job = &job;
+        workers[i].aliases = g_ptr_array_new();
+        workers[i].thread = g_thread_new("vcd-import", gw_vcd_file_import_worker, &workers[i]);
+    }
+
+    for (guint i = 0; i < n_workers; i++) {
+        g_thread_join(workers[i].thread);
+    }
+
+    // Aliases refer to the history of another node, which is only safe to
+    // touch once all workers are done.
+    for (guint i = 0; i < n_workers; i++) {
+        for (guint j = 0; j < workers[i].aliases->len; j++) {
+            gw_vcd_file_import_trace(self, factory, g_ptr_array_index(workers[i].aliases, j));
+        }
+        g_ptr_array_free(workers[i].aliases, TRUE);
+    }
+
+    g_free(workers);
+}
 
 static gboolean gw_vcd_file_import_traces(GwDumpFile *dump_file, GwNode **nodes, GError **error)
 {
     GwVcdFile *self = GW_VCD_FILE(dump_file);
     (void)error;
 
+    GPtrArray *pending = g_ptr_array_new();
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+
     for (GwNode **iter = nodes; *iter != NULL; iter++) {
         GwNode *node = *iter;
 
-        if (node->mv.mvlfac_vlist != NULL) {
-            gw_vcd_file_import_trace(self, node);
+        if (node->mv.mvlfac_vlist != NULL && g_hash_table_add(seen, node)) {
+            g_ptr_array_add(pending, node);
+        }
+    }
+
+    GwHistEntFactory *factory = self->hist_ent_factory;
+    GPtrArray *unloadable = NULL;
+
+    // Follow mode updates append to the histents.
+    gboolean compact =
+        gw_dump_file_get_compact_histories(dump_file) && self->follow_loader == NULL;
+
+    if (gw_dump_file_get_unloadable_traces(dump_file) || compact) {
+        // The histents of each batch go to their own factory, which is freed
+        // once all of the batch's traces are unloaded, or right after the
+        // import if they are compacted.
+        factory = gw_hist_ent_factory_new();
+
+        // Alias targets are imported along with their aliases.
+        for (guint i = 0; i < pending->len; i++) {
+            GwNode *n2 = (GwNode *)((GwNode *)g_ptr_array_index(pending, i))->curr;
+            if (n2 != NULL && n2->mv.mvlfac_vlist != NULL && g_hash_table_add(seen, n2)) {
+                g_ptr_array_add(pending, n2);
+            }
+        }
+    }
+
+    if (gw_dump_file_get_unloadable_traces(dump_file)) {
+        // The import reads the vlists without consuming them, they are kept
+        // to import the traces again.
+        unloadable = g_ptr_array_new();
+        for (guint i = 0; i < pending->len; i++) {
+            GwNode *node = g_ptr_array_index(pending, i);
+            UnloadableTrace *trace = g_new0(UnloadableTrace, 1);
+            trace->node = node;
+            trace->vlist = node->mv.mvlfac_vlist;
+            trace->alias_of = (GwNode *)node->curr;
+            g_ptr_array_add(unloadable, trace);
+        }
+    }
+
+    g_hash_table_destroy(seen);
+
+    // The follow mode bookkeeping isn't thread-safe.
+    if (pending->len >= VCD_IMPORT_PARALLEL_MIN && g_get_num_processors() > 1 &&
+        self->follow_loader == NULL) {
+        gw_vcd_file_import_traces_parallel(self, pending, factory);
+    } else {
+        for (guint i = 0; i < pending->len; i++) {
+            gw_vcd_file_import_trace(self, factory, g_ptr_array_index(pending, i));
+        }
+    }
+
+    if (compact) {
+        gw_hist_columns_compact_nodes(pending);
+    }
+
+    if (unloadable != NULL) {
+        for (guint i = 0; i < unloadable->len; i++) {
+            UnloadableTrace *trace = g_ptr_array_index(unloadable, i);
+
+            // Aliases point into the history of their target.
+            UnloadableTrace *target = NULL;
+            if (trace->alias_of != NULL) {
+                target = g_hash_table_lookup(self->unloadable_traces, trace->alias_of);
+            }
+            if (!compact) {
+                trace->hist_ent_factory =
+                    g_object_ref(target != NULL ? target->hist_ent_factory : factory);
+            }
+
+            g_hash_table_replace(self->unloadable_traces, trace->node, trace);
         }
+
+        g_ptr_array_free(unloadable, TRUE);
+    }
+
+    if (factory != self->hist_ent_factory) {
+        g_object_unref(factory);
     }
 
+    g_ptr_array_free(pending, TRUE);
+
     return TRUE;
 }
 
+static gboolean gw_vcd_file_unload_trace(GwDumpFile *dump_file, GwNode *node)
+{
+    GwVcdFile *self = GW_VCD_FILE(dump_file);
+
+    UnloadableTrace *trace = g_hash_table_lookup(self->unloadable_traces, node);
+    if (trace == NULL) {
+        return FALSE;
+    }
+
+    node->head.next = NULL;
+    node->curr = (GwHistEnt *)trace->alias_of;
+    node->harray = NULL;
+    node->numhist = 0;
+    node->mv.mvlfac_vlist = g_steal_pointer(&trace->vlist);
+
+    GPtrArray *aliases = NULL;
+    if (trace->alias_of != NULL) {
+        aliases = g_hash_table_lookup(self->follow_aliases, trace->alias_of);
+    }
+    if (aliases != NULL) {
+        g_ptr_array_remove_fast(aliases, node);
+    }
+
+    g_hash_table_remove(self->unloadable_traces, node);
+    g_hash_table_remove(self->follow_tails, node);
+    g_hash_table_remove(self->follow_aliases, node);
+
+    return TRUE;
+}
+
+static gboolean gw_vcd_file_update(GwDumpFile *dump_file,
+                                   gboolean *changed,
+                                   GPtrArray *changed_nodes,
+                                   GError **error)
+{
+    GwVcdFile *self = GW_VCD_FILE(dump_file);
+
+    if (self->follow_loader == NULL) {
+        return TRUE;
+    }
+
+    return gw_vcd_loader_update(self->follow_loader, self, changed, changed_nodes, error);
+}
+
+static GPtrArray *gw_vcd_file_get_unloadable_nodes(GwDumpFile *dump_file)
+{
+    GwVcdFile *self = GW_VCD_FILE(dump_file);
+    GPtrArray *nodes = g_ptr_array_sized_new(g_hash_table_size(self->unloadable_traces));
+
+    GHashTableIter iter;
+    gpointer node;
+    g_hash_table_iter_init(&iter, self->unloadable_traces);
+    while (g_hash_table_iter_next(&iter, &node, NULL)) {
+        g_ptr_array_add(nodes, node);
+    }
+
+    return nodes;
+}
+
+static GwHistEntFactory *gw_vcd_file_get_trace_factory(GwDumpFile *dump_file, GwNode *node)
+{
+    GwVcdFile *self = GW_VCD_FILE(dump_file);
+
+    UnloadableTrace *trace = g_hash_table_lookup(self->unloadable_traces, node);
+
+    return trace != NULL ? trace->hist_ent_factory : NULL;
+}
+
 static void gw_vcd_file_dispose(GObject *object)
 {
     GwVcdFile *self = GW_VCD_FILE(object);
 
     g_clear_object(&self->hist_ent_factory);
+    g_clear_pointer(&self->unloadable_traces, g_hash_table_unref);
+    g_clear_pointer(&self->follow_chunks, g_hash_table_unref);
+    g_clear_pointer(&self->follow_tails, g_hash_table_unref);
+    g_clear_pointer(&self->follow_aliases, g_hash_table_unref);
+    g_clear_object(&self->follow_loader);
 
     G_OBJECT_CLASS(gw_vcd_file_parent_class)->dispose(object);
 }
@@ -40,17 +300,68 @@ static void gw_vcd_file_class_init(GwVcdFileClass *klass)
     object_class->dispose = gw_vcd_file_dispose;
 
     dump_file_class->import_traces = gw_vcd_file_import_traces;
+    dump_file_class->unload_trace = gw_vcd_file_unload_trace;
+    dump_file_class->get_unloadable_nodes = gw_vcd_file_get_unloadable_nodes;
+    dump_file_class->get_trace_factory = gw_vcd_file_get_trace_factory;
+    dump_file_class->update = gw_vcd_file_update;
 }
 
 static void gw_vcd_file_init(GwVcdFile *self)
 {
     self->hist_ent_factory = gw_hist_ent_factory_new();
+    self->unloadable_traces =
+        g_hash_table_new_full(g_direct_hash,
+                              g_direct_equal,
+                              NULL,
+                              (GDestroyNotify)unloadable_trace_free);
+    self->follow_chunks = g_hash_table_new_full(g_direct_hash,
+                                                g_direct_equal,
+                                                NULL,
+                                                (GDestroyNotify)g_ptr_array_unref);
+    self->follow_tails = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->follow_aliases = g_hash_table_new_full(g_direct_hash,
+                                                 g_direct_equal,
+                                                 NULL,
+                                                 (GDestroyNotify)g_ptr_array_unref);
 }
 
-static void add_histent_string(GwVcdFile *self, GwTime tim, GwNode *n, const char *str)
+/*
+ * takes one of the end caps that a follow mode update detached before
+ * allocating a new histent.  the storage of a vector value is kept, all
+ * values of a vector node have the same length.
+ */
+static GwHistEnt *alloc_histent(GwVcdFile *self, GwHistEntFactory *factory)
+{
+    GwHistEnt *he = self->spare_hist_ents;
+
+    if (he == NULL) {
+        return gw_hist_ent_factory_alloc(factory);
+    }
+
+    self->spare_hist_ents = he->next;
+    he->next = NULL;
+    he->flags = 0;
+
+    return he;
+}
+
+/* strings live in the factory's pool like the vectors */
+static gchar *histent_strdup(GwHistEntFactory *factory, const gchar *str)
+{
+    gsize len = strlen(str) + 1;
+    gchar *s = gw_hist_ent_factory_alloc_vector(factory, len);
+    memcpy(s, str, len);
+    return s;
+}
+
+static void add_histent_string(GwVcdFile *self,
+                               GwHistEntFactory *factory,
+                               GwTime tim,
+                               GwNode *n,
+                               const char *str)
 {
     if (!n->curr) {
-        GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *he = gw_hist_ent_factory_alloc(factory);
         he->flags = (GW_HIST_ENT_FLAG_STRING | GW_HIST_ENT_FLAG_REAL);
         he->time = -1;
         he->v.h_vector = NULL;
@@ -65,27 +376,30 @@ static void add_histent_string(GwVcdFile *self, GwTime tim, GwNode *n, const cha
         //              "] Signal [%p].\n",
         //              tim,
         //              n));
-        g_free(n->curr->v.h_vector);
-        n->curr->v.h_vector = g_strdup(str); /* we have a glitch! */
+        n->curr->v.h_vector = histent_strdup(factory, str); /* we have a glitch! */
 
         if (!(n->curr->flags & GW_HIST_ENT_FLAG_GLITCH)) {
             n->curr->flags |= GW_HIST_ENT_FLAG_GLITCH; /* set the glitch flag */
         }
     } else {
-        GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *he = alloc_histent(self, factory);
         he->flags = (GW_HIST_ENT_FLAG_STRING | GW_HIST_ENT_FLAG_REAL);
         he->time = tim;
-        he->v.h_vector = g_strdup(str);
+        he->v.h_vector = histent_strdup(factory, str);
 
         n->curr->next = he;
         n->curr = he;
     }
 }
 
-static void add_histent_real(GwVcdFile *self, GwTime tim, GwNode *n, gdouble value)
+static void add_histent_real(GwVcdFile *self,
+                             GwHistEntFactory *factory,
+                             GwTime tim,
+                             GwNode *n,
+                             gdouble value)
 {
     if (!n->curr) {
-        GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *he = gw_hist_ent_factory_alloc(factory);
         he->flags = GW_HIST_ENT_FLAG_REAL;
         he->time = -1;
         he->v.h_double = strtod("NaN", NULL);
@@ -108,7 +422,7 @@ static void add_histent_real(GwVcdFile *self, GwTime tim, GwNode *n, gdouble val
                 n->curr->flags |= GW_HIST_ENT_FLAG_GLITCH; /* set the glitch flag */
             }
         } else {
-            GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            GwHistEnt *he = alloc_histent(self, factory);
             he->flags = GW_HIST_ENT_FLAG_REAL;
             he->time = tim;
             he->v.h_double = value;
@@ -118,10 +432,15 @@ static void add_histent_real(GwVcdFile *self, GwTime tim, GwNode *n, gdouble val
     }
 }
 
-static void add_histent_vector(GwVcdFile *self, GwTime tim, GwNode *n, guint8 *vector, guint len)
+static void add_histent_vector(GwVcdFile *self,
+                               GwHistEntFactory *factory,
+                               GwTime tim,
+                               GwNode *n,
+                               const guint8 *vector,
+                               guint len)
 {
     if (!n->curr) {
-        GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *he = gw_hist_ent_factory_alloc(factory);
         he->time = -1;
         he->v.h_vector = NULL;
 
@@ -141,29 +460,36 @@ static void add_histent_vector(GwVcdFile *self, GwTime tim, GwNode *n, guint8 *v
             //              n,
             //              gw_bit_to_char(n->curr->v.h_val),
             //              ch));
-            g_free(n->curr->v.h_vector);
-            n->curr->v.h_vector = vector; /* we have a glitch! */
+            if (n->curr->v.h_vector == NULL) {
+                n->curr->v.h_vector = gw_hist_ent_factory_alloc_vector(factory, len + 1);
+            }
+            memcpy(n->curr->v.h_vector, vector, len + 1); /* we have a glitch! */
 
             if (!(n->curr->flags & GW_HIST_ENT_FLAG_GLITCH)) {
                 n->curr->flags |= GW_HIST_ENT_FLAG_GLITCH; /* set the glitch flag */
             }
         } else {
-            GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            GwHistEnt *he = alloc_histent(self, factory);
             he->time = tim;
-            he->v.h_vector = vector;
+            if (he->v.h_vector == NULL) {
+                he->v.h_vector = gw_hist_ent_factory_alloc_vector(factory, len + 1);
+            }
+            memcpy(he->v.h_vector, vector, len + 1);
 
             n->curr->next = he;
             n->curr = he;
         }
-    } else {
-        g_free(vector);
     }
 }
 
-static void add_histent_scalar(GwVcdFile *self, GwTime tim, GwNode *n, GwBit bit)
+static void add_histent_scalar(GwVcdFile *self,
+                               GwHistEntFactory *factory,
+                               GwTime tim,
+                               GwNode *n,
+                               GwBit bit)
 {
     if (!n->curr) {
-        GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+        GwHistEnt *he = gw_hist_ent_factory_alloc(factory);
         he->time = -1;
         he->v.h_val = GW_BIT_X;
 
@@ -189,7 +515,7 @@ static void add_histent_scalar(GwVcdFile *self, GwTime tim, GwNode *n, GwBit bit
                 n->curr->flags |= GW_HIST_ENT_FLAG_GLITCH; /* set the glitch flag */
             }
         } else {
-            GwHistEnt *he = gw_hist_ent_factory_alloc(self->hist_ent_factory);
+            GwHistEnt *he = alloc_histent(self, factory);
             he->time = tim;
             he->v.h_val = bit;
 
@@ -202,10 +528,13 @@ static void add_histent_scalar(GwVcdFile *self, GwTime tim, GwNode *n, GwBit bit
     }
 }
 
-static void gw_vcd_file_import_trace_scalar(GwVcdFile *self, GwNode *np, GwVlistReader *reader)
+static void gw_vcd_file_import_trace_scalar(GwVcdFile *self,
+                                            GwHistEntFactory *factory,
+                                            GwNode *np,
+                                            GwVlistReader *reader,
+                                            guint time_idx)
 {
     GwTime time_scale = gw_dump_file_get_time_scale(GW_DUMP_FILE(self));
-    unsigned int time_idx = 0;
 
     static const GwBit EXTRA_VALUES[] =
         {GW_BIT_X, GW_BIT_Z, GW_BIT_H, GW_BIT_U, GW_BIT_W, GW_BIT_L, GW_BIT_DASH, GW_BIT_X};
@@ -233,21 +562,19 @@ static void gw_vcd_file_import_trace_scalar(GwVcdFile *self, GwNode *np, GwVlist
         }
 
         GwTime t = *curtime_pnt * time_scale;
-        add_histent_scalar(self, t, np, bit);
+        add_histent_scalar(self, factory, t, np, bit);
     }
-
-    add_histent_scalar(self, GW_TIME_MAX - 1, np, GW_BIT_X);
-    add_histent_scalar(self, GW_TIME_MAX, np, GW_BIT_Z);
 }
 
 static void gw_vcd_file_import_trace_vector(GwVcdFile *self,
+                                            GwHistEntFactory *factory,
                                             GwNode *np,
                                             GwVlistReader *reader,
-                                            guint32 len)
+                                            guint32 len,
+                                            guint time_idx)
 {
     GwTime time_scale = gw_dump_file_get_time_scale(GW_DUMP_FILE(self));
-    unsigned int time_idx = 0;
-    guint8 *sbuf = g_malloc(len + 1);
+    guint8 *vector = g_malloc(len + 1);
 
     while (!gw_vlist_reader_is_done(reader)) {
         guint delta = gw_vlist_reader_read_uv32(reader);
@@ -261,69 +588,43 @@ static void gw_vcd_file_import_trace_vector(GwVcdFile *self,
         }
         GwTime t = *curtime_pnt * time_scale;
 
-        guint32 dst_len = 0;
-        for (;;) {
-            gint c = gw_vlist_reader_next(reader);
-            if (c < 0) {
-                break;
-            }
-            if ((c >> 4) == GW_BIT_MASK) {
-                break;
-            }
-            if (dst_len == len) {
-                if (len != 1)
-                    memmove(sbuf, sbuf + 1, dst_len - 1);
-                dst_len--;
-            }
-            sbuf[dst_len++] = c >> 4;
-            if ((c & GW_BIT_MASK) == GW_BIT_MASK)
-                break;
-            if (dst_len == len) {
-                if (len != 1)
-                    memmove(sbuf, sbuf + 1, dst_len - 1);
-                dst_len--;
-            }
-            sbuf[dst_len++] = c & GW_BIT_MASK;
+        guint32 bits_len = 0;
+        const guint8 *bits = gw_vlist_reader_read_mvl9_string(reader, &bits_len);
+
+        /* values longer than the vector keep their rightmost bits */
+        if (bits_len > len) {
+            bits += bits_len - len;
+            bits_len = len;
         }
 
         if (len == 1) {
-            add_histent_scalar(self, t, np, sbuf[0]);
+            add_histent_scalar(self, factory, t, np, bits_len > 0 ? bits[0] : GW_BIT_X);
         } else {
-            guint8 *vector = g_malloc(len + 1);
-            if (dst_len < len) {
-                GwBit extend = (sbuf[0] == GW_BIT_1) ? GW_BIT_0 : sbuf[0];
-                memset(vector, extend, len - dst_len);
-                memcpy(vector + (len - dst_len), sbuf, dst_len);
+            if (bits_len == 0) {
+                memset(vector, GW_BIT_X, len);
+            } else if (bits_len < len) {
+                GwBit extend = (bits[0] == GW_BIT_1) ? GW_BIT_0 : bits[0];
+                memset(vector, extend, len - bits_len);
+                memcpy(vector + (len - bits_len), bits, bits_len);
             } else {
-                memcpy(vector, sbuf, len);
+                memcpy(vector, bits, len);
             }
 
             vector[len] = 0;
-            add_histent_vector(self, t, np, vector, len);
+            add_histent_vector(self, factory, t, np, vector, len);
         }
     }
 
-    if (len == 1) {
-        add_histent_scalar(self, GW_TIME_MAX - 1, np, GW_BIT_X);
-        add_histent_scalar(self, GW_TIME_MAX, np, GW_BIT_Z);
-    } else {
-        guint8 *x = g_malloc0(len);
-        memset(x, GW_BIT_X, len);
-
-        guint8 *z = g_malloc0(len);
-        memset(z, GW_BIT_Z, len);
-
-        add_histent_vector(self, GW_TIME_MAX - 1, np, x, len);
-        add_histent_vector(self, GW_TIME_MAX, np, z, len);
-    }
-
-    g_free(sbuf);
+    g_free(vector);
 }
 
-static void gw_vcd_file_import_trace_real(GwVcdFile *self, GwNode *np, GwVlistReader *reader)
+static void gw_vcd_file_import_trace_real(GwVcdFile *self,
+                                          GwHistEntFactory *factory,
+                                          GwNode *np,
+                                          GwVlistReader *reader,
+                                          guint time_idx)
 {
     GwTime time_scale = gw_dump_file_get_time_scale(GW_DUMP_FILE(self));
-    unsigned int time_idx = 0;
 
     while (!gw_vlist_reader_is_done(reader)) {
         unsigned int delta;
@@ -344,17 +645,17 @@ static void gw_vcd_file_import_trace_real(GwVcdFile *self, GwNode *np, GwVlistRe
         gdouble value = 0.0;
         sscanf(str, "%lg", &value);
 
-        add_histent_real(self, t, np, value);
+        add_histent_real(self, factory, t, np, value);
     }
-
-    add_histent_real(self, GW_TIME_MAX - 1, np, 1.0);
-    add_histent_real(self, GW_TIME_MAX, np, 0.0);
 }
 
-static void gw_vcd_file_import_trace_string(GwVcdFile *self, GwNode *np, GwVlistReader *reader)
+static void gw_vcd_file_import_trace_string(GwVcdFile *self,
+                                            GwHistEntFactory *factory,
+                                            GwNode *np,
+                                            GwVlistReader *reader,
+                                            guint time_idx)
 {
     GwTime time_scale = gw_dump_file_get_time_scale(GW_DUMP_FILE(self));
-    unsigned int time_idx = 0;
 
     while (!gw_vlist_reader_is_done(reader)) {
         unsigned int delta = gw_vlist_reader_read_uv32(reader);
@@ -369,89 +670,289 @@ static void gw_vcd_file_import_trace_string(GwVcdFile *self, GwNode *np, GwVlist
         GwTime t = *curtime_pnt * time_scale;
 
         const gchar *str = gw_vlist_reader_read_string(reader);
-        add_histent_string(self, t, np, str);
+        add_histent_string(self, factory, t, np, str);
     }
+}
 
-    add_histent_string(self, GW_TIME_MAX - 1, np, "UNDEF");
-    add_histent_string(self, GW_TIME_MAX, np, "");
+static void gw_vcd_file_import_records(GwVcdFile *self,
+                                       GwHistEntFactory *factory,
+                                       GwNode *np,
+                                       GwVlistReader *reader,
+                                       guint32 vlist_type,
+                                       guint32 len,
+                                       guint time_idx)
+{
+    if (vlist_type == '0') {
+        gw_vcd_file_import_trace_scalar(self, factory, np, reader, time_idx);
+    } else if (vlist_type == 'B') {
+        gw_vcd_file_import_trace_vector(self, factory, np, reader, len, time_idx);
+    } else if (vlist_type == 'R') {
+        gw_vcd_file_import_trace_real(self, factory, np, reader, time_idx);
+    } else if (vlist_type == 'S') {
+        gw_vcd_file_import_trace_string(self, factory, np, reader, time_idx);
+    }
+}
+
+/* every history ends with an undefined and a high impedance value after the last change */
+static void gw_vcd_file_add_end_caps(GwVcdFile *self,
+                                     GwHistEntFactory *factory,
+                                     GwNode *np,
+                                     guint32 vlist_type,
+                                     guint32 len)
+{
+    if (vlist_type == 'R') {
+        add_histent_real(self, factory, GW_TIME_MAX - 1, np, 1.0);
+        add_histent_real(self, factory, GW_TIME_MAX, np, 0.0);
+    } else if (vlist_type == 'S') {
+        add_histent_string(self, factory, GW_TIME_MAX - 1, np, "UNDEF");
+        add_histent_string(self, factory, GW_TIME_MAX, np, "");
+    } else if (len == 1) {
+        add_histent_scalar(self, factory, GW_TIME_MAX - 1, np, GW_BIT_X);
+        add_histent_scalar(self, factory, GW_TIME_MAX, np, GW_BIT_Z);
+    } else {
+        guint8 *vector = g_malloc(len + 1);
+        vector[len] = 0;
+
+        memset(vector, GW_BIT_X, len);
+        add_histent_vector(self, factory, GW_TIME_MAX - 1, np, vector, len);
+
+        memset(vector, GW_BIT_Z, len);
+        add_histent_vector(self, factory, GW_TIME_MAX, np, vector, len);
+
+        g_free(vector);
+    }
+}
+
+/*
+ * the value changes that were read by gw_vcd_loader_update() after the file
+ * was loaded.  a chunk is a vlist with the type and length of the signal's
+ * vlist, followed by records that continue at time_idx.
+ */
+static void gw_vcd_file_import_chunk(GwVcdFile *self,
+                                     GwHistEntFactory *factory,
+                                     GwNode *np,
+                                     FollowChunk *chunk,
+                                     gboolean keep,
+                                     guint32 *vlist_type,
+                                     guint32 *len)
+{
+    GwVlist *vlist = NULL;
+    if (keep) {
+        vlist = gw_vlist_flatten_copy(chunk->vlist);
+    } else {
+        vlist = g_steal_pointer(&chunk->vlist);
+        gw_vlist_uncompress(&vlist);
+    }
+
+    GwVlistReader *reader = gw_vlist_reader_new(vlist, self->is_prepacked);
+
+    *vlist_type = gw_vlist_reader_read_uv32(reader);
+    *len = gw_vlist_reader_read_uv32(reader);
+    gw_vcd_file_import_records(self, factory, np, reader, *vlist_type, *len, chunk->time_idx);
+
+    g_clear_object(&reader);
 }
 
-static void gw_vcd_file_import_trace(GwVcdFile *self, GwNode *np)
+static void gw_vcd_file_import_follow_chunks(GwVcdFile *self,
+                                             GwHistEntFactory *factory,
+                                             GwNode *np)
+{
+    GPtrArray *chunks = g_hash_table_lookup(self->follow_chunks, np);
+    if (chunks == NULL) {
+        return;
+    }
+
+    // Unloadable traces import the chunks again after they were unloaded.
+    gboolean keep = gw_dump_file_get_unloadable_traces(GW_DUMP_FILE(self));
+
+    for (guint i = 0; i < chunks->len; i++) {
+        guint32 vlist_type;
+        guint32 len;
+        gw_vcd_file_import_chunk(self,
+                                 factory,
+                                 np,
+                                 g_ptr_array_index(chunks, i),
+                                 keep,
+                                 &vlist_type,
+                                 &len);
+    }
+
+    if (!keep) {
+        g_hash_table_remove(self->follow_chunks, np);
+    }
+}
+
+/* returns FALSE for alias nodes, which share the history of another node */
+static gboolean gw_vcd_file_import_trace_data(GwVcdFile *self,
+                                              GwHistEntFactory *factory,
+                                              GwNode *np)
 {
     guint32 len = 1;
     guint32 vlist_type;
 
     if (np->mv.mvlfac_vlist == NULL) {
-        return;
+        return TRUE;
     }
 
-    gw_vlist_uncompress(&np->mv.mvlfac_vlist);
+    // Unloadable traces hold on to the compressed vlist to import it again,
+    // only a transient uncompressed copy is read.
+    GwVlist *vlist = NULL;
+    if (gw_dump_file_get_unloadable_traces(GW_DUMP_FILE(self))) {
+        vlist = gw_vlist_flatten_copy(np->mv.mvlfac_vlist);
+        np->mv.mvlfac_vlist = NULL;
+    } else {
+        vlist = g_steal_pointer(&np->mv.mvlfac_vlist);
+        gw_vlist_uncompress(&vlist);
+    }
 
-    GwVlistReader *reader =
-        gw_vlist_reader_new(g_steal_pointer(&np->mv.mvlfac_vlist), self->is_prepacked);
+    GwVlistReader *reader = gw_vlist_reader_new(vlist, self->is_prepacked);
 
     if (gw_vlist_reader_is_done(reader)) {
-        len = 1;
-        vlist_type = '!'; /* possible alias */
-    } else {
-        vlist_type = gw_vlist_reader_read_uv32(reader);
-        switch (vlist_type) {
-            case '0': {
-                len = 1;
-                gint c = gw_vlist_reader_next(reader);
-                if (c < 0) {
-                    g_error("Internal error file '%s' line %d", __FILE__, __LINE__);
-                }
-                /* vartype = (unsigned int)(*chp & 0x7f); */ /*scan-build */
-                break;
+        g_clear_object(&reader);
+        return FALSE; /* possible alias */
+    }
+
+    vlist_type = gw_vlist_reader_read_uv32(reader);
+    switch (vlist_type) {
+        case '0': {
+            len = 1;
+            gint c = gw_vlist_reader_next(reader);
+            if (c < 0) {
+                g_error("Internal error file '%s' line %d", __FILE__, __LINE__);
+            }
+            /* vartype = (unsigned int)(*chp & 0x7f); */ /*scan-build */
+            break;
+        }
+
+        case 'B':
+        case 'R':
+        case 'S': {
+            gint c = gw_vlist_reader_next(reader);
+            if (c < 0) {
+                g_error("Internal error file '%s' line %d", __FILE__, __LINE__);
             }
+            /* vartype = (unsigned int)(*chp & 0x7f); */ /* scan-build */
 
-            case 'B':
-            case 'R':
-            case 'S': {
-                gint c = gw_vlist_reader_next(reader);
-                if (c < 0) {
-                    g_error("Internal error file '%s' line %d", __FILE__, __LINE__);
-                }
-                /* vartype = (unsigned int)(*chp & 0x7f); */ /* scan-build */
+            len = gw_vlist_reader_read_uv32(reader);
 
-                len = gw_vlist_reader_read_uv32(reader);
+            break;
+        }
 
-                break;
-            }
+        default:
+            g_error("Unsupported vlist type '%c'", vlist_type);
+            break;
+    }
 
-            default:
-                g_error("Unsupported vlist type '%c'", vlist_type);
-                break;
+    gw_vcd_file_import_records(self, factory, np, reader, vlist_type, len, 0);
+    g_clear_object(&reader);
+
+    if (self->follow_loader != NULL) {
+        gw_vcd_file_import_follow_chunks(self, factory, np);
+
+        // Later updates insert their value changes before the end caps.
+        if (np->curr != NULL) {
+            g_hash_table_replace(self->follow_tails, np, np->curr);
         }
     }
 
-    if (vlist_type == '0') {
-        gw_vcd_file_import_trace_scalar(self, np, reader);
-    } else if (vlist_type == 'B') {
-        gw_vcd_file_import_trace_vector(self, np, reader, len);
-    } else if (vlist_type == 'R') {
-        gw_vcd_file_import_trace_real(self, np, reader);
-    } else if (vlist_type == 'S') {
-        gw_vcd_file_import_trace_string(self, np, reader);
-    } else if (vlist_type == '!') /* error in loading */
-    {
-        GwNode *n2 = (GwNode *)np->curr;
+    gw_vcd_file_add_end_caps(self, factory, np, vlist_type, len);
+
+    return TRUE;
+}
+
+/*
+ * adds value changes that were read in follow mode.  they go into the
+ * history right away if the node is imported and are kept for the import
+ * otherwise.  unloadable traces keep them in both cases.  imported nodes and
+ * their aliases are added to changed_nodes.
+ */
+void gw_vcd_file_append_changes(GwVcdFile *self,
+                                GwNode *np,
+                                GwVlist *vlist,
+                                guint time_idx,
+                                GPtrArray *changed_nodes)
+{
+    FollowChunk *chunk = g_new0(FollowChunk, 1);
+    chunk->vlist = vlist;
+    chunk->time_idx = time_idx;
+
+    UnloadableTrace *trace = g_hash_table_lookup(self->unloadable_traces, np);
+    gboolean imported = np->mv.mvlfac_vlist == NULL;
+
+    if (imported) {
+        // Detach the end caps and add them again after the new value changes,
+        // reusing their histents.
+        GwHistEnt *tail = g_hash_table_lookup(self->follow_tails, np);
+        if (tail == NULL) {
+            tail = np->head.next;
+        }
+        self->spare_hist_ents = tail->next;
+        tail->next = NULL;
+        np->curr = tail;
 
-        if ((n2) &&
-            (n2 != np)) /* keep out any possible infinite recursion from corrupt pointer bugs */
-        {
-            gw_vcd_file_import_trace(self, n2);
+        GwHistEntFactory *factory =
+            trace != NULL ? trace->hist_ent_factory : self->hist_ent_factory;
 
-            g_clear_object(&reader);
+        guint32 vlist_type;
+        guint32 len;
+        gw_vcd_file_import_chunk(self, factory, np, chunk, trace != NULL, &vlist_type, &len);
 
-            np->head = n2->head;
-            np->curr = n2->curr;
-            return;
+        g_hash_table_replace(self->follow_tails, np, np->curr);
+        gw_vcd_file_add_end_caps(self, factory, np, vlist_type, len);
+        self->spare_hist_ents = NULL; /* an unused cap stays in the factory */
+
+        g_ptr_array_add(changed_nodes, np);
+        GPtrArray *aliases = g_hash_table_lookup(self->follow_aliases, np);
+        if (aliases != NULL) {
+            g_ptr_array_extend(changed_nodes, aliases, NULL, NULL);
         }
+    }
 
-        g_error("Error in decompressing vlist for '%s'", np->nname);
+    if (!imported || trace != NULL) {
+        GPtrArray *chunks = g_hash_table_lookup(self->follow_chunks, np);
+        if (chunks == NULL) {
+            chunks = g_ptr_array_new_with_free_func((GDestroyNotify)follow_chunk_free);
+            g_hash_table_insert(self->follow_chunks, np, chunks);
+        }
+        g_ptr_array_add(chunks, chunk);
+    } else {
+        follow_chunk_free(chunk);
     }
+}
 
-    g_clear_object(&reader);
+static void gw_vcd_file_import_trace(GwVcdFile *self, GwHistEntFactory *factory, GwNode *np)
+{
+    if (gw_vcd_file_import_trace_data(self, factory, np)) {
+        return;
+    }
+
+    /* error in loading */
+    GwNode *n2 = (GwNode *)np->curr;
+
+    if ((n2) &&
+        (n2 != np)) /* keep out any possible infinite recursion from corrupt pointer bugs */
+    {
+        gw_vcd_file_import_trace(self, factory, n2);
+
+        np->head = n2->head;
+        np->curr = n2->curr;
+        if (n2->columns != NULL) {
+            // The target was compacted by an earlier import.
+            np->columns = gw_hist_columns_ref(n2->columns);
+            np->numhist = n2->numhist;
+        }
+
+        // Follow mode updates grow the shared history.
+        if (self->follow_loader != NULL) {
+            GPtrArray *aliases = g_hash_table_lookup(self->follow_aliases, n2);
+            if (aliases == NULL) {
+                aliases = g_ptr_array_new();
+                g_hash_table_insert(self->follow_aliases, n2, aliases);
+            }
+            g_ptr_array_add(aliases, np);
+        }
+        return;
+    }
+
+    g_error("Error in decompressing vlist for '%s'", np->nname);
 }
@@ -1,15 +1,24 @@
 #include "gw-vcd-loader.h"
 #include "gw-vcd-file.h"
 #include "gw-vcd-file-private.h"
+#include "gw-vcd-cache.h"
 #include "gw-util.h"
 #include "gw-hash.h"
 #include "vcd-keywords.h"
 #include <stdio.h>
 #include <fstapi.h>
 #include <errno.h>
+#ifndef G_OS_WIN32
+#include <sys/mman.h>
+#endif
 
 #define VCD_BSIZ 32768 /* size of getch() emulation buffer--this val should be ok */
 #define VCD_INDEXSIZ (8 * 1024 * 1024)
+#define VCD_FINALIZE_PARALLEL_MIN 4096 /* fewer symbols aren't worth spinning up threads */
+#define VCD_PARSE_CHUNK_MIN (1024 * 1024) /* smaller value change sections stay on one thread */
+#define VCD_PARSE_CHUNK_MAX (32 * 1024 * 1024) /* bounds the memory of the chunks in flight */
+
+G_STATIC_ASSERT(GW_VCD_LOADER_VLIST_COMPRESSION_LZ4 == GW_VLIST_COMPRESSION_LZ4);
 // TODO: remove VCDNAM_ESCAPE
 #define VCDNAM_ESCAPE 1
 // TODO: remove!
@@ -37,7 +46,12 @@ struct vcdsymbol
     int msi, lsi;
     int size;
 
+    unsigned int last_time_idx; /* time index of the last value change */
+    char vlist_type; /* '0', 'B', 'R' or 'S' once the vlist header is written */
     unsigned char vartype;
+
+    GwVlistWriter *follow_writer; /* value changes of the current follow mode update */
+    unsigned int follow_time_idx; /* last_time_idx when the update started */
 };
 
 #ifdef WAVE_USE_STRUCT_PACKING
@@ -61,6 +75,17 @@ struct _GwVcdLoader
     gboolean is_compressed;
     off_t vcd_fsiz;
 
+    gboolean use_mmap;
+    gboolean is_mapped;
+    gboolean use_cache;
+
+    gboolean follow;
+    gboolean following; /* the file stays open and is only read up to complete lines */
+    gboolean updating; /* value changes go to the follow writers */
+    gsize follow_pending; /* bytes of an incomplete line behind vend */
+    GPtrArray *follow_symbols; /* struct vcdsymbol* with a follow writer */
+    GwTime dumpoff_time; /* start of the current $dumpoff, -1 while dumping */
+
     gboolean header_over;
 
     gboolean vlist_prepack;
@@ -72,6 +97,7 @@ struct _GwVcdLoader
     char *vcdbuf;
     char *vst;
     char *vend;
+    const char *vstop; /* vcd_parse() returns at the first statement from here on */
 
     int error_count;
     gboolean err;
@@ -118,6 +144,7 @@ struct _GwVcdLoader
     GwTreeNode *tree_root;
 
     guint numfacs;
+    GwNamePool *names;
     gchar *prev_hier_uncompressed_name;
 
     GwTreeNode *terminals_chain;
@@ -137,6 +164,9 @@ enum
     PROP_VLIST_PREPACK = 1,
     PROP_VLIST_COMPRESSION_LEVEL,
     PROP_WARNING_FILESIZE,
+    PROP_USE_MMAP,
+    PROP_USE_CACHE,
+    PROP_FOLLOW,
     N_PROPERTIES,
 };
 
@@ -146,7 +176,14 @@ static GParamSpec *properties[N_PROPERTIES];
 
 static void malform_eof_fix(GwVcdLoader *self)
 {
-    if (feof(self->vcd_handle)) {
+    if (self->is_mapped) {
+        /* emulate the buffered reader, which only gives up inside the final buffer */
+        if (self->vend - self->vst < VCD_BSIZ) {
+            self->vst = self->vend;
+        }
+    } else if (self->following) {
+        self->vst = self->vend; /* keep the incomplete line behind vend */
+    } else if (feof(self->vcd_handle)) {
         memset(self->vcdbuf, ' ', VCD_BSIZ);
         self->vst = self->vend;
     }
@@ -403,7 +440,7 @@ static GwSymbol *symadd(GwVcdLoader *self, char *name, int hv)
 {
     GwSymbol *s = g_new0(GwSymbol, 1);
 
-    strcpy(s->name = g_malloc(strlen(name) + 1), name);
+    s->name = gw_name_pool_add(self->names, name);
     s->sym_next = self->sym_hash[hv];
     self->sym_hash[hv] = s;
 
@@ -503,6 +540,15 @@ static void set_vcd_vartype(struct vcdsymbol *v, GwNode *n)
     n->vartype = nvt;
 }
 
+static void vlist_emit_finalize_node(gpointer data, gpointer user_data)
+{
+    GwNode *n = data;
+    GwVlistWriter *writer = n->mv.mvlfac_vlist_writer;
+
+    n->mv.mvlfac_vlist = gw_vlist_writer_finish(writer);
+    g_object_unref(writer);
+}
+
 static unsigned int vlist_emit_finalize(GwVcdLoader *self)
 {
     struct vcdsymbol *v /* , *vprime */; /* scan-build */
@@ -524,6 +570,7 @@ static unsigned int vlist_emit_finalize(GwVcdLoader *self)
             {
                 switch (v->vartype) {
                     case V_REAL:
+                        v->vlist_type = 'R';
                         gw_vlist_writer_append_uv32(writer, 'R');
                         gw_vlist_writer_append_uv32(writer, (unsigned int)v->vartype);
                         gw_vlist_writer_append_uv32(writer, (unsigned int)v->size);
@@ -532,6 +579,7 @@ static unsigned int vlist_emit_finalize(GwVcdLoader *self)
                         break;
 
                     case V_STRINGTYPE:
+                        v->vlist_type = 'S';
                         gw_vlist_writer_append_uv32(writer, 'S');
                         gw_vlist_writer_append_uv32(writer, (unsigned int)v->vartype);
                         gw_vlist_writer_append_uv32(writer, (unsigned int)v->size);
@@ -541,10 +589,12 @@ static unsigned int vlist_emit_finalize(GwVcdLoader *self)
 
                     default:
                         if (v->size == 1) {
+                            v->vlist_type = '0';
                             gw_vlist_writer_append_uv32(writer, (unsigned int)'0');
                             gw_vlist_writer_append_uv32(writer, (unsigned int)v->vartype);
                             gw_vlist_writer_append_uv32(writer, RCV_X);
                         } else {
+                            v->vlist_type = 'B';
                             gw_vlist_writer_append_uv32(writer, 'B');
                             gw_vlist_writer_append_uv32(writer, (unsigned int)v->vartype);
                             gw_vlist_writer_append_uv32(writer, (unsigned int)v->size);
@@ -556,14 +606,29 @@ static unsigned int vlist_emit_finalize(GwVcdLoader *self)
             }
         }
 
-        GwVlistWriter *writer = n->mv.mvlfac_vlist_writer;
-        n->mv.mvlfac_vlist = gw_vlist_writer_finish(writer);
-        g_object_unref(writer);
-
         v = v->next;
         cnt++;
     }
 
+    /* finishing a writer flushes and compresses its last block, which is
+     * independent for every node and can therefore be spread over all cores
+     */
+    if (cnt < VCD_FINALIZE_PARALLEL_MIN || g_get_num_processors() < 2) {
+        for (v = self->vcdsymroot; v != NULL; v = v->next) {
+            vlist_emit_finalize_node(v->narray[0], NULL);
+        }
+    } else {
+        GThreadPool *pool = g_thread_pool_new(vlist_emit_finalize_node,
+                                              NULL,
+                                              g_get_num_processors(),
+                                              FALSE,
+                                              NULL);
+        for (v = self->vcdsymroot; v != NULL; v = v->next) {
+            g_thread_pool_push(pool, v->narray[0], NULL);
+        }
+        g_thread_pool_free(pool, FALSE, TRUE);
+    }
+
     return (cnt);
 }
 
@@ -579,18 +644,98 @@ static void getch_alloc(GwVcdLoader *self)
     self->vend = self->vcdbuf;
 }
 
+/*
+ * maps the whole file so the tokenizer can scan it in place,
+ * only possible for regular uncompressed files
+ */
+static gboolean getch_map(GwVcdLoader *self)
+{
+#ifndef G_OS_WIN32
+    if (self->vcd_fsiz <= 0 || (guint64)self->vcd_fsiz > G_MAXSIZE) {
+        return FALSE;
+    }
+
+    void *map = mmap(NULL, self->vcd_fsiz, PROT_READ, MAP_PRIVATE, fileno(self->vcd_handle), 0);
+    if (map == MAP_FAILED) {
+        return FALSE;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(map, self->vcd_fsiz, MADV_SEQUENTIAL);
+#endif
+
+    self->vcdbuf = map;
+    self->vst = self->vcdbuf;
+    self->vend = self->vcdbuf + self->vcd_fsiz;
+    self->is_mapped = TRUE;
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
 static void getch_free(GwVcdLoader *self)
 {
-    g_free(self->vcdbuf);
+#ifndef G_OS_WIN32
+    if (self->is_mapped) {
+        munmap(self->vcdbuf, self->vend - self->vcdbuf);
+        self->is_mapped = FALSE;
+    } else
+#endif
+    {
+        g_free(self->vcdbuf);
+    }
     self->vcdbuf = NULL;
     self->vst = NULL;
     self->vend = NULL;
 }
 
+/*
+ * follow mode only hands out complete lines, the rest of a line that is
+ * still being written stays behind vend until the next fetch
+ */
+static int getch_fetch_lines(GwVcdLoader *self)
+{
+    gsize pending = self->follow_pending;
+
+    self->vcdbyteno += (self->vend - self->vcdbuf);
+    memmove(self->vcdbuf, self->vend, pending);
+
+    errno = 0;
+    size_t rd = fread(self->vcdbuf + pending, sizeof(char), VCD_BSIZ - pending, self->vcd_handle);
+    gsize avail = pending + rd;
+
+    gsize len = avail;
+    while (len > 0 && self->vcdbuf[len - 1] != '\n') {
+        len--;
+    }
+    if (len == 0 && avail == VCD_BSIZ) {
+        len = avail; /* a line that doesn't fit into the buffer */
+    }
+
+    self->follow_pending = avail - len;
+    self->vend = (self->vst = self->vcdbuf) + len;
+
+    if ((!len) || (errno)) {
+        return (-1);
+    }
+
+    return ((int)(*self->vst));
+}
+
 static int getch_fetch(GwVcdLoader *self)
 {
     size_t rd;
 
+    if (self->is_mapped) {
+        return (-1); /* the whole file is already visible */
+    }
+
+    if (self->following) {
+        return getch_fetch_lines(self);
+    }
+
     errno = 0;
     if (feof(self->vcd_handle)) {
         return (-1);
@@ -619,6 +764,9 @@ static inline signed char getch(GwVcdLoader *self)
     signed char ch;
     if (self->vst == self->vend) {
         ch = getch_fetch(self);
+        if (ch < 0) {
+            return -1; /* never step past the end of a mapped file */
+        }
     } else {
         ch = (signed char)*self->vst;
         if (ch == 0) {
@@ -657,15 +805,35 @@ static int getch_patched(GwVcdLoader *self)
     }
 }
 
+/*
+ * looks up a token that starts with '$'
+ */
+static int vcd_keyword(const char *yytext)
+{
+    const char *yyshadow = yytext;
+    int i;
+
+    do {
+        yyshadow++;
+        for (i = 0; i < NUM_TOKENS; i++) {
+            if (!strcmp(yyshadow, tokens[i])) {
+                return (i);
+            }
+        }
+
+    } while (*yyshadow == '$'); /* fix for RCS ids in version strings */
+
+    return T_UNKNOWN_KEY;
+}
+
 /*
  * simple tokenizer
  */
 static int get_token(GwVcdLoader *self)
 {
     int ch;
-    int i, len = 0;
+    int len = 0;
     int is_string = 0;
-    char *yyshadow;
 
     for (;;) {
         ch = getch(self);
@@ -705,18 +873,7 @@ static int get_token(GwVcdLoader *self)
         return (T_STRING);
     }
 
-    yyshadow = self->yytext;
-    do {
-        yyshadow++;
-        for (i = 0; i < NUM_TOKENS; i++) {
-            if (!strcmp(yyshadow, tokens[i])) {
-                return (i);
-            }
-        }
-
-    } while (*yyshadow == '$'); /* fix for RCS ids in version strings */
-
-    return T_UNKNOWN_KEY;
+    return vcd_keyword(self->yytext);
 }
 
 static int get_vartoken_patched(GwVcdLoader *self, int match_kw)
@@ -937,6 +1094,171 @@ static void version_sync_end(GwVcdLoader *self)
     }
 }
 
+/* encode bits as (time delta<<4) + (enum AnalyzerBits value) */
+static unsigned int vcd_scalar_rcv(char ch, unsigned int time_delta)
+{
+    switch (ch) {
+        case '0':
+        case '1':
+            return ((ch & 1) << 1) | (time_delta << 2); /* pack more delta bits in for 0/1 vchs */
+
+        case 'x':
+        case 'X':
+            return RCV_X | (time_delta << 4);
+        case 'z':
+        case 'Z':
+            return RCV_Z | (time_delta << 4);
+        case 'h':
+        case 'H':
+            return RCV_H | (time_delta << 4);
+        case 'u':
+        case 'U':
+            return RCV_U | (time_delta << 4);
+        case 'w':
+        case 'W':
+            return RCV_W | (time_delta << 4);
+        case 'l':
+        case 'L':
+            return RCV_L | (time_delta << 4);
+        default:
+            return RCV_D | (time_delta << 4);
+    }
+}
+
+/* replaces the time delta of a value that was encoded by vcd_scalar_rcv() */
+static unsigned int vcd_scalar_rcv_rebase(unsigned int rcv, unsigned int time_delta)
+{
+    if (rcv & 1) {
+        return (rcv & 0xf) | (time_delta << 4);
+    }
+
+    return (rcv & 0x3) | (time_delta << 2);
+}
+
+/*
+ * while a followed file is updated, the value changes of each symbol go to a
+ * separate writer, which starts with the type and length of the symbol's vlist
+ */
+static GwVlistWriter *vcd_follow_writer(GwVcdLoader *self, struct vcdsymbol *v)
+{
+    if (v->follow_writer == NULL) {
+        v->follow_writer = gw_vlist_writer_new(self->vlist_compression_level, self->vlist_prepack);
+        gw_vlist_writer_append_uv32(v->follow_writer, (unsigned int)v->vlist_type);
+        gw_vlist_writer_append_uv32(v->follow_writer,
+                                    v->vlist_type == '0' ? 1 : (unsigned int)v->size);
+        v->follow_time_idx = v->last_time_idx;
+        g_ptr_array_add(self->follow_symbols, v);
+    }
+
+    return v->follow_writer;
+}
+
+/*
+ * returns the vlist writer of a symbol, a new vlist starts with its type,
+ * which is '0' for the single bit routine or B/R/S for vectors, reals and strings
+ */
+static GwVlistWriter *vcd_vlist_writer(GwVcdLoader *self, struct vcdsymbol *v, char vlist_type)
+{
+    GwNode *n = v->narray[0];
+
+    if (n->mv.mvlfac_vlist_writer == NULL) {
+        GwVlistWriter *writer =
+            gw_vlist_writer_new(self->vlist_compression_level, self->vlist_prepack);
+
+        gw_vlist_writer_append_uv32(writer, (unsigned int)vlist_type); /* for decompression */
+        gw_vlist_writer_append_uv32(writer, (unsigned int)v->vartype);
+        if (vlist_type != '0') {
+            gw_vlist_writer_append_uv32(writer, (unsigned int)v->size);
+        }
+
+        n->mv.mvlfac_vlist_writer = writer;
+        v->vlist_type = vlist_type;
+    }
+
+    return n->mv.mvlfac_vlist_writer;
+}
+
+/* the vlist type that a vector, real or string value change starts */
+static char vcd_binary_vlist_type(struct vcdsymbol *v, gchar typ)
+{
+    unsigned char typ2 = toupper(typ);
+
+    if (v->vartype != V_REAL && v->vartype != V_STRINGTYPE) {
+        if (typ2 == 'R' || typ2 == 'S') {
+            typ2 = 'B'; /* ok, typical case...fix as 'r' on bits variable causes
+                           recoder crash during trace extraction */
+        }
+    } else {
+        if (typ2 == 'B') {
+            typ2 = 'S'; /* should never be necessary...this is defensive */
+        }
+    }
+
+    return typ2;
+}
+
+static void vcd_emit_scalar(GwVlistWriter *writer,
+                            char vlist_type,
+                            gchar ch,
+                            unsigned int time_delta)
+{
+    if (vlist_type == 'B') {
+        /* the vlist was started by a vector value change */
+        gchar bits[2] = {ch, 0};
+        gw_vlist_writer_append_uv32(writer, time_delta);
+        gw_vlist_writer_append_mvl9_string(writer, bits);
+    } else {
+        gw_vlist_writer_append_uv32(writer, vcd_scalar_rcv(ch, time_delta));
+    }
+}
+
+static void vcd_emit_binary(GwVlistWriter *writer,
+                            struct vcdsymbol *v,
+                            char vlist_type,
+                            gchar typ,
+                            const gchar *vector,
+                            gint vlen,
+                            unsigned int time_delta)
+{
+    if (vlist_type == '0') {
+        /* the vlist was started by a scalar value change, keep the rightmost bit */
+        gsize bits_len = strlen(vector);
+        gchar ch = bits_len > 0 ? vector[bits_len - 1] : 'x';
+        gw_vlist_writer_append_uv32(writer, vcd_scalar_rcv(ch, time_delta));
+        return;
+    }
+
+    gw_vlist_writer_append_uv32(writer, time_delta);
+
+    if (typ == 'b' || typ == 'B') {
+        if (v->vartype != V_REAL && v->vartype != V_STRINGTYPE) {
+            gw_vlist_writer_append_mvl9_string(writer, vector);
+        } else {
+            gw_vlist_writer_append_string(writer, vector);
+        }
+    } else {
+        if (v->vartype == V_REAL || v->vartype == V_STRINGTYPE || typ == 's' || typ == 'S') {
+            gw_vlist_writer_append_string(writer, vector);
+        } else {
+            char *bits = g_alloca(v->size + 1);
+            int i, j, k = 0;
+
+            memset(bits, 0x0, v->size + 1);
+
+            for (i = 0; i < vlen; i++) {
+                for (j = 0; j < 8; j++) {
+                    bits[k++] = ((vector[i] >> (7 - j)) & 1) | '0';
+                    if (k >= v->size)
+                        goto bit_term;
+                }
+            }
+
+        bit_term:
+            gw_vlist_writer_append_mvl9_string(writer, bits);
+        }
+    }
+}
+
 static void parse_valuechange_scalar(GwVcdLoader *self)
 {
     struct vcdsymbol *v;
@@ -950,60 +1272,19 @@ static void parse_valuechange_scalar(GwVcdLoader *self)
                     self->yytext + 1);
             malform_eof_fix(self);
         } else {
-            GwNode *n = v->narray[0];
+            GwVlistWriter *writer;
             unsigned int time_delta;
-            unsigned int rcv;
 
-            if (n->mv.mvlfac_vlist_writer ==
-                NULL) /* overloaded for vlist, numhist = last position used */
-            {
-                n->mv.mvlfac_vlist_writer =
-                    gw_vlist_writer_new(self->vlist_compression_level, self->vlist_prepack);
-                gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer,
-                                            (unsigned int)'0'); /* represents single bit routine
-                                                                 for decompression */
-                gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer, (unsigned int)v->vartype);
+            if (self->updating) {
+                writer = vcd_follow_writer(self, v);
+            } else {
+                writer = vcd_vlist_writer(self, v, '0');
             }
 
-            time_delta = self->time_vlist_count - (unsigned int)n->numhist;
-            n->numhist = self->time_vlist_count;
-
-            switch (self->yytext[0]) {
-                case '0':
-                case '1':
-                    rcv = ((self->yytext[0] & 1) << 1) | (time_delta << 2);
-                    break; /* pack more delta bits in for 0/1 vchs */
-
-                case 'x':
-                case 'X':
-                    rcv = RCV_X | (time_delta << 4);
-                    break;
-                case 'z':
-                case 'Z':
-                    rcv = RCV_Z | (time_delta << 4);
-                    break;
-                case 'h':
-                case 'H':
-                    rcv = RCV_H | (time_delta << 4);
-                    break;
-                case 'u':
-                case 'U':
-                    rcv = RCV_U | (time_delta << 4);
-                    break;
-                case 'w':
-                case 'W':
-                    rcv = RCV_W | (time_delta << 4);
-                    break;
-                case 'l':
-                case 'L':
-                    rcv = RCV_L | (time_delta << 4);
-                    break;
-                default:
-                    rcv = RCV_D | (time_delta << 4);
-                    break;
-            }
+            time_delta = self->time_vlist_count - v->last_time_idx;
+            v->last_time_idx = self->time_vlist_count;
 
-            gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer, rcv);
+            vcd_emit_scalar(writer, v->vlist_type, self->yytext[0], time_delta);
         }
     } else {
         fprintf(stderr,
@@ -1022,66 +1303,22 @@ static void process_binary(GwVcdLoader *self, gchar typ, const gchar *vector, gi
                 (int)(self->vcdbyteno + (self->vst - self->vcdbuf)),
                 self->yytext + 1);
         malform_eof_fix(self);
+        return;
     }
 
-    GwNode *n = v->narray[0];
+    GwVlistWriter *writer;
     unsigned int time_delta;
 
-    if (n->mv.mvlfac_vlist_writer == NULL) /* overloaded for vlist, numhist = last position used */
-    {
-        unsigned char typ2 = toupper(typ);
-        n->mv.mvlfac_vlist_writer =
-            gw_vlist_writer_new(self->vlist_compression_level, self->vlist_prepack);
-
-        if (v->vartype != V_REAL && v->vartype != V_STRINGTYPE) {
-            if (typ2 == 'R' || typ2 == 'S') {
-                typ2 = 'B'; /* ok, typical case...fix as 'r' on bits variable causes
-                               recoder crash during trace extraction */
-            }
-        } else {
-            if (typ2 == 'B') {
-                typ2 = 'S'; /* should never be necessary...this is defensive */
-            }
-        }
-
-        gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer,
-                                    (unsigned int)toupper(typ2)); /* B/R/P/S for decompress */
-        gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer, (unsigned int)v->vartype);
-        gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer, (unsigned int)v->size);
-    }
-
-    time_delta = self->time_vlist_count - (unsigned int)n->numhist;
-    n->numhist = self->time_vlist_count;
-
-    gw_vlist_writer_append_uv32(n->mv.mvlfac_vlist_writer, time_delta);
-
-    if (typ == 'b' || typ == 'B') {
-        if (v->vartype != V_REAL && v->vartype != V_STRINGTYPE) {
-            gw_vlist_writer_append_mvl9_string(n->mv.mvlfac_vlist_writer, vector);
-        } else {
-            gw_vlist_writer_append_string(n->mv.mvlfac_vlist_writer, vector);
-        }
+    if (self->updating) {
+        writer = vcd_follow_writer(self, v);
     } else {
-        if (v->vartype == V_REAL || v->vartype == V_STRINGTYPE || typ == 's' || typ == 'S') {
-            gw_vlist_writer_append_string(n->mv.mvlfac_vlist_writer, vector);
-        } else {
-            char *bits = g_alloca(v->size + 1);
-            int i, j, k = 0;
-
-            memset(bits, 0x0, v->size + 1);
+        writer = vcd_vlist_writer(self, v, vcd_binary_vlist_type(v, typ));
+    }
 
-            for (i = 0; i < vlen; i++) {
-                for (j = 0; j < 8; j++) {
-                    bits[k++] = ((vector[i] >> (7 - j)) & 1) | '0';
-                    if (k >= v->size)
-                        goto bit_term;
-                }
-            }
+    time_delta = self->time_vlist_count - v->last_time_idx;
+    v->last_time_idx = self->time_vlist_count;
 
-        bit_term:
-            gw_vlist_writer_append_mvl9_string(n->mv.mvlfac_vlist_writer, bits);
-        }
-    }
+    vcd_emit_binary(writer, v, v->vlist_type, typ, vector, vlen, time_delta);
 }
 
 static void parse_valuechange(GwVcdLoader *self)
@@ -1829,64 +2066,618 @@ static void vcd_parse_enddefinitions(GwVcdLoader *self, GError **error)
     }
 }
 
-static void vcd_parse_string(GwVcdLoader *self)
+static void vcd_append_time(GwVcdLoader *self, GwTime tim)
 {
-    if (!self->header_over) {
-        self->header_over = TRUE; /* do symbol table management here */
-        create_sorted_table(self);
-        if (self->symbols_sorted == NULL && self->symbols_indexed == NULL) {
-            return;
-        }
-    }
-
-    /* catchall for events when header over */
-    if (self->yytext[0] == '#') {
-        GwTime tim;
-        GwTime *tt;
-
-        tim = atoi_64(self->yytext + 1);
+    GwTime *tt;
 
-        if (self->start_time < 0) {
-            self->start_time = tim;
-        } else {
-            /* backtracking fix */
-            if (tim < self->current_time) {
-                if (!self->already_backtracked) {
-                    self->already_backtracked = TRUE;
-                    fprintf(stderr, "VCDLOAD | Time backtracking detected in VCD file!\n");
-                }
+    if (self->start_time < 0) {
+        self->start_time = tim;
+    } else {
+        /* backtracking fix */
+        if (tim < self->current_time) {
+            if (!self->already_backtracked) {
+                self->already_backtracked = TRUE;
+                fprintf(stderr, "VCDLOAD | Time backtracking detected in VCD file!\n");
             }
+        }
 #if 0
 						if(tim < GLOBALS->current_time_vcd_recoder_c_3) /* avoid backtracking time counts which can happen on malformed files */
 							{
 							tim = GLOBALS->current_time_vcd_recoder_c_3;
 							}
 #endif
-        }
+    }
 
-        self->current_time = tim;
-        if (self->end_time < tim)
-            self->end_time = tim; /* in case of malformed vcd files */
-        // DEBUG(fprintf(stderr, "#%" GW_TIME_FORMAT "\n", tim));
+    self->current_time = tim;
+    if (self->end_time < tim)
+        self->end_time = tim; /* in case of malformed vcd files */
+    // DEBUG(fprintf(stderr, "#%" GW_TIME_FORMAT "\n", tim));
 
-        tt = gw_vlist_alloc(&self->time_vlist, FALSE, self->vlist_compression_level);
-        *tt = tim;
-        self->time_vlist_count++;
-    } else {
-        if (self->time_vlist_count) {
-            /* OK, otherwise fix for System C which doesn't emit time zero... */
-        } else {
-            GwTime tim = GW_TIME_CONSTANT(0);
-            GwTime *tt;
+    tt = gw_vlist_alloc(&self->time_vlist, FALSE, self->vlist_compression_level);
+    *tt = tim;
+    self->time_vlist_count++;
+}
+
+/* fix for System C which doesn't emit time zero... */
+static void vcd_append_time_zero(GwVcdLoader *self)
+{
+    GwTime tim = GW_TIME_CONSTANT(0);
+    GwTime *tt;
 
-            self->start_time = self->current_time = self->end_time = tim;
+    self->start_time = self->current_time = self->end_time = tim;
 
-            tt = gw_vlist_alloc(&self->time_vlist, FALSE, self->vlist_compression_level);
-            *tt = tim;
-            self->time_vlist_count = 1;
-        }
-        parse_valuechange(self);
-    }
+    tt = gw_vlist_alloc(&self->time_vlist, FALSE, self->vlist_compression_level);
+    *tt = tim;
+    self->time_vlist_count = 1;
+}
+
+static void vcd_dump_command(GwVcdLoader *self, int tok)
+{
+    switch (tok) {
+        case T_DUMPOFF:
+        case T_DUMPPORTSOFF:
+            gw_blackout_regions_add_dumpoff(self->blackout_regions, self->current_time);
+            if (self->dumpoff_time < 0) {
+                self->dumpoff_time = self->current_time;
+            }
+            break;
+
+        case T_DUMPON:
+        case T_DUMPPORTSON:
+            gw_blackout_regions_add_dumpon(self->blackout_regions, self->current_time);
+            self->dumpoff_time = -1;
+            break;
+
+        case T_DUMPVARS:
+        case T_DUMPPORTS:
+            if (self->current_time < 0) {
+                self->start_time = self->current_time = self->end_time = 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void vcd_parse_string(GwVcdLoader *self)
+{
+    if (!self->header_over) {
+        self->header_over = TRUE; /* do symbol table management here */
+        create_sorted_table(self);
+        if (self->symbols_sorted == NULL && self->symbols_indexed == NULL) {
+            return;
+        }
+    }
+
+    /* catchall for events when header over */
+    if (self->yytext[0] == '#') {
+        vcd_append_time(self, atoi_64(self->yytext + 1));
+    } else {
+        if (self->time_vlist_count) {
+            /* OK, otherwise fix for System C which doesn't emit time zero... */
+        } else {
+            vcd_append_time_zero(self);
+        }
+        parse_valuechange(self);
+    }
+}
+
+/*******************************************************************************/
+
+/*
+ * the value change section of a mapped file is cut into chunks at lines that
+ * start with a time. every chunk is tokenized on its own thread into partial
+ * vlists per symbol, which count time indices from the start of the chunk.
+ * the first value change of a partial vlist is written with a zero time delta
+ * and gets the real delta when the chunk is stitched to the vlist of the node.
+ */
+typedef struct
+{
+    struct vcdsymbol *v;
+    GwVlistWriter *writer;
+    unsigned int first_time_idx; /* chunk time index of the first value change */
+    unsigned int last_time_idx; /* chunk time index of the last value change */
+    char vlist_type;
+    gboolean first_is_rcv; /* the first value change is encoded by vcd_scalar_rcv() */
+} VcdChunkSymbol;
+
+typedef struct
+{
+    int tok;
+    guint time_count; /* number of chunk times before the dump command */
+} VcdChunkCommand;
+
+typedef struct
+{
+    GwVcdLoader *loader;
+    const char *start;
+    const char *pos;
+    const char *end;
+
+    char *text;
+    int text_len;
+    int text_size;
+
+    gboolean allow_time_zero; /* the chunk starts before the first time of the file */
+    gboolean has_time_zero; /* the first chunk time is the System C time zero fix */
+    GArray *times;
+    GArray *commands;
+    GHashTable *slots; /* struct vcdsymbol* -> 1 + position in symbols */
+    GArray *symbols;
+
+    gboolean failed; /* the serial parser has to take over from the start of the chunk */
+    gboolean done; /* set by the worker under VcdChunkQueue.lock */
+} VcdChunk;
+
+/* the chunks that were handed to the workers, in file order */
+typedef struct
+{
+    GThreadPool *pool;
+    GMutex lock;
+    GCond done_cond;
+    GQueue chunks;
+} VcdChunkQueue;
+
+static inline gboolean vcd_chunk_is_space(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+/*
+ * reads the next token, returns FALSE at the end of the chunk. bytes that the
+ * two serial tokenizers don't treat the same way fail the chunk.
+ */
+static gboolean vcd_chunk_token(VcdChunk *chunk)
+{
+    const char *pos = chunk->pos;
+
+    while (pos < chunk->end && vcd_chunk_is_space(*pos)) {
+        pos++;
+    }
+
+    const char *token = pos;
+    while (pos < chunk->end && (signed char)*pos > ' ') {
+        pos++;
+    }
+
+    if (pos < chunk->end && !vcd_chunk_is_space(*pos)) {
+        chunk->failed = TRUE;
+        return FALSE;
+    }
+
+    chunk->pos = pos;
+    chunk->text_len = pos - token;
+    if (chunk->text_len == 0) {
+        return FALSE;
+    }
+
+    if (chunk->text_len >= chunk->text_size) {
+        chunk->text_size = chunk->text_len * 2;
+        chunk->text = g_realloc(chunk->text, chunk->text_size);
+    }
+    memcpy(chunk->text, token, chunk->text_len);
+    chunk->text[chunk->text_len] = 0;
+
+    return TRUE;
+}
+
+static VcdChunkSymbol *vcd_chunk_symbol(VcdChunk *chunk,
+                                        struct vcdsymbol *v,
+                                        char vlist_type,
+                                        gboolean scalar)
+{
+    guint slot = GPOINTER_TO_UINT(g_hash_table_lookup(chunk->slots, v));
+    if (slot > 0) {
+        return &g_array_index(chunk->symbols, VcdChunkSymbol, slot - 1);
+    }
+
+    VcdChunkSymbol s = {0};
+    s.v = v;
+    s.writer = gw_vlist_writer_new(-1, FALSE); /* uncompressed, it is copied when stitched */
+    s.first_time_idx = chunk->times->len;
+    s.last_time_idx = chunk->times->len;
+    s.vlist_type = v->vlist_type != 0 ? v->vlist_type : vlist_type;
+    /* same choice as vcd_emit_scalar() and vcd_emit_binary() */
+    s.first_is_rcv = scalar ? s.vlist_type != 'B' : s.vlist_type == '0';
+
+    g_array_append_val(chunk->symbols, s);
+    g_hash_table_insert(chunk->slots, v, GUINT_TO_POINTER(chunk->symbols->len));
+
+    return &g_array_index(chunk->symbols, VcdChunkSymbol, chunk->symbols->len - 1);
+}
+
+static void vcd_chunk_scalar(VcdChunk *chunk, gchar ch, char *id, int len)
+{
+    if (len < 1) {
+        chunk->failed = TRUE;
+        return;
+    }
+
+    struct vcdsymbol *v = bsearch_vcd(chunk->loader, id, len);
+    if (v == NULL) {
+        chunk->failed = TRUE;
+        return;
+    }
+
+    VcdChunkSymbol *s = vcd_chunk_symbol(chunk, v, '0', TRUE);
+
+    vcd_emit_scalar(s->writer, s->vlist_type, ch, chunk->times->len - s->last_time_idx);
+    s->last_time_idx = chunk->times->len;
+}
+
+static void vcd_chunk_binary(VcdChunk *chunk, gchar typ, const gchar *vector, gint vlen)
+{
+    if (!vcd_chunk_token(chunk)) {
+        chunk->failed = TRUE;
+        return;
+    }
+
+    struct vcdsymbol *v = bsearch_vcd(chunk->loader, chunk->text, chunk->text_len);
+    if (v == NULL) {
+        chunk->failed = TRUE;
+        return;
+    }
+
+    VcdChunkSymbol *s = vcd_chunk_symbol(chunk, v, vcd_binary_vlist_type(v, typ), FALSE);
+
+    vcd_emit_binary(s->writer,
+                    v,
+                    s->vlist_type,
+                    typ,
+                    vector,
+                    vlen,
+                    chunk->times->len - s->last_time_idx);
+    s->last_time_idx = chunk->times->len;
+}
+
+static void vcd_chunk_valuechange(VcdChunk *chunk)
+{
+    unsigned char typ = chunk->text[0];
+    switch (typ) {
+        case '0':
+        case '1':
+        case 'x':
+        case 'X':
+        case 'z':
+        case 'Z':
+        case 'h':
+        case 'H':
+        case 'u':
+        case 'U':
+        case 'w':
+        case 'W':
+        case 'l':
+        case 'L':
+        case '-':
+            vcd_chunk_scalar(chunk, typ, chunk->text + 1, chunk->text_len - 1);
+            break;
+
+#ifndef STRICT_VCD_ONLY
+        case 's':
+        case 'S': {
+            gchar *vector = g_alloca(chunk->text_len);
+            gint vlen = fstUtilityEscToBin((unsigned char *)vector,
+                                           (unsigned char *)(chunk->text + 1),
+                                           chunk->text_len - 1);
+            vector[vlen] = 0;
+
+            vcd_chunk_binary(chunk, typ, vector, vlen);
+            break;
+        }
+#endif
+
+        case 'b':
+        case 'B':
+        case 'r':
+        case 'R': {
+            gchar *vector = g_alloca(chunk->text_len);
+            strcpy(vector, chunk->text + 1);
+
+            vcd_chunk_binary(chunk, typ, vector, chunk->text_len - 1);
+            break;
+        }
+
+        case 'p':
+        case 'P': {
+            gchar *vector = g_alloca(chunk->text_len);
+            evcd_strcpy(vector, chunk->text + 1);
+            gint vlen = chunk->text_len - 1;
+
+            /* throw away both strength components */
+            if (!vcd_chunk_token(chunk) || !vcd_chunk_token(chunk)) {
+                chunk->failed = TRUE;
+                break;
+            }
+
+            vcd_chunk_binary(chunk, 'b', vector, vlen);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void vcd_chunk_command(VcdChunk *chunk)
+{
+    if (chunk->text_len < 2) {
+        chunk->failed = TRUE; /* "$ end" is glued together by get_token() */
+        return;
+    }
+
+    int tok = vcd_keyword(chunk->text);
+    switch (tok) {
+        case T_END:
+        case T_DUMPALL:
+        case T_DUMPPORTSALL:
+            break;
+
+        case T_DUMPOFF:
+        case T_DUMPPORTSOFF:
+        case T_DUMPON:
+        case T_DUMPPORTSON:
+        case T_DUMPVARS:
+        case T_DUMPPORTS: {
+            VcdChunkCommand command = {tok, chunk->times->len};
+            g_array_append_val(chunk->commands, command);
+            break;
+        }
+
+        case T_COMMENT:
+        case T_DATE:
+        case T_VCDCLOSE:
+        case T_UNKNOWN_KEY:
+            while (vcd_chunk_token(chunk)) {
+                if (chunk->text[0] == '$' && chunk->text_len > 1 &&
+                    vcd_keyword(chunk->text) == T_END) {
+                    return;
+                }
+            }
+            chunk->failed = TRUE; /* the block continues in the next chunk */
+            break;
+
+        default:
+            chunk->failed = TRUE; /* header commands are left to the serial parser */
+            break;
+    }
+}
+
+static void vcd_chunk_parse(gpointer data, gpointer user_data)
+{
+    VcdChunk *chunk = data;
+    VcdChunkQueue *queue = user_data;
+
+    while (vcd_chunk_token(chunk)) {
+        if (chunk->text[0] == '$') {
+            vcd_chunk_command(chunk);
+        } else if (chunk->text[0] == '#') {
+            GwTime tim = atoi_64(chunk->text + 1);
+            g_array_append_val(chunk->times, tim);
+        } else {
+            if (chunk->times->len == 0 && chunk->allow_time_zero) {
+                GwTime tim = GW_TIME_CONSTANT(0);
+                g_array_append_val(chunk->times, tim);
+                chunk->has_time_zero = TRUE;
+            }
+            vcd_chunk_valuechange(chunk);
+        }
+
+        if (chunk->failed) {
+            break;
+        }
+    }
+
+    g_mutex_lock(&queue->lock);
+    chunk->done = TRUE;
+    g_cond_broadcast(&queue->done_cond);
+    g_mutex_unlock(&queue->lock);
+}
+
+/*
+ * appends the times of a chunk and its partial vlists to the vlists of the nodes,
+ * returns FALSE without changing anything if a partial vlist was started with
+ * another type than the vlist of an earlier chunk
+ */
+static gboolean vcd_chunk_stitch(GwVcdLoader *self, VcdChunk *chunk)
+{
+    for (guint i = 0; i < chunk->symbols->len; i++) {
+        VcdChunkSymbol *s = &g_array_index(chunk->symbols, VcdChunkSymbol, i);
+        if (s->v->vlist_type != 0 && s->v->vlist_type != s->vlist_type) {
+            return FALSE;
+        }
+    }
+
+    unsigned int base = self->time_vlist_count;
+    guint time_idx = 0;
+
+    for (guint i = 0; i <= chunk->commands->len; i++) {
+        VcdChunkCommand *command = NULL;
+        guint time_count = chunk->times->len;
+
+        if (i < chunk->commands->len) {
+            command = &g_array_index(chunk->commands, VcdChunkCommand, i);
+            time_count = command->time_count;
+        }
+
+        for (; time_idx < time_count; time_idx++) {
+            if (time_idx == 0 && chunk->has_time_zero) {
+                vcd_append_time_zero(self);
+            } else {
+                vcd_append_time(self, g_array_index(chunk->times, GwTime, time_idx));
+            }
+        }
+
+        if (command != NULL) {
+            vcd_dump_command(self, command->tok);
+        }
+    }
+
+    for (guint i = 0; i < chunk->symbols->len; i++) {
+        VcdChunkSymbol *s = &g_array_index(chunk->symbols, VcdChunkSymbol, i);
+        struct vcdsymbol *v = s->v;
+        GwVlistWriter *writer = vcd_vlist_writer(self, v, s->vlist_type);
+
+        GwVlist *part = gw_vlist_writer_finish(s->writer);
+        g_clear_object(&s->writer);
+        gw_vlist_flatten(&part);
+
+        const guint8 *bytes = gw_vlist_locate(part, 0);
+        guint len = gw_vlist_size(part);
+        unsigned int time_delta = base + s->first_time_idx - v->last_time_idx;
+
+        /* a zero time delta leaves the first value change in a single byte */
+        if (s->first_is_rcv) {
+            gw_vlist_writer_append_uv32(writer, vcd_scalar_rcv_rebase(bytes[0] & 0x7f, time_delta));
+        } else {
+            gw_vlist_writer_append_uv32(writer, time_delta);
+        }
+        gw_vlist_writer_append_bytes(writer, bytes + 1, len - 1);
+
+        v->last_time_idx = base + s->last_time_idx;
+        gw_vlist_destroy(part);
+    }
+
+    return TRUE;
+}
+
+static void vcd_chunk_free(VcdChunk *chunk)
+{
+    for (guint i = 0; i < chunk->symbols->len; i++) {
+        VcdChunkSymbol *s = &g_array_index(chunk->symbols, VcdChunkSymbol, i);
+        if (s->writer != NULL) {
+            gw_vlist_destroy(gw_vlist_writer_finish(s->writer));
+            g_object_unref(s->writer);
+        }
+    }
+
+    g_free(chunk->text);
+    g_array_free(chunk->times, TRUE);
+    g_array_free(chunk->commands, TRUE);
+    g_hash_table_destroy(chunk->slots);
+    g_array_free(chunk->symbols, TRUE);
+    g_free(chunk);
+}
+
+/* chunks start with a time at the beginning of a line */
+static const char *vcd_chunk_boundary(GwVcdLoader *self, const char *pos)
+{
+    while ((pos = memchr(pos, '\n', self->vend - pos)) != NULL) {
+        pos++;
+        if (pos == self->vend || *pos == '#') {
+            return pos;
+        }
+    }
+
+    return self->vend;
+}
+
+static VcdChunk *vcd_chunk_new(GwVcdLoader *self,
+                               const char *start,
+                               const char *end,
+                               gboolean first)
+{
+    VcdChunk *chunk = g_new0(VcdChunk, 1);
+
+    chunk->loader = self;
+    chunk->start = chunk->pos = start;
+    chunk->end = end;
+    chunk->text_size = 256;
+    chunk->text = g_malloc(chunk->text_size);
+    chunk->allow_time_zero = first && self->time_vlist_count == 0;
+    chunk->times = g_array_new(FALSE, FALSE, sizeof(GwTime));
+    chunk->commands = g_array_new(FALSE, FALSE, sizeof(VcdChunkCommand));
+    chunk->slots = g_hash_table_new(g_direct_hash, g_direct_equal);
+    chunk->symbols = g_array_new(FALSE, FALSE, sizeof(VcdChunkSymbol));
+
+    return chunk;
+}
+
+static void vcd_parse(GwVcdLoader *self, GError **error);
+
+/*
+ * parses a chunk on the calling thread from vst on.  returns FALSE if the
+ * serial parser stopped before the end of the chunk, which happens at the
+ * end of the file and on errors.  a block that continues in the next chunk
+ * is read to its end.
+ */
+static gboolean vcd_chunk_parse_serial(GwVcdLoader *self, VcdChunk *chunk, GError **error)
+{
+    self->vstop = chunk->end;
+    vcd_parse(self, error);
+    self->vstop = NULL;
+
+    return *error == NULL && self->vst >= chunk->end;
+}
+
+/*
+ * parses the value change section of a mapped file on a pool of threads.
+ * the section is cut into chunks of a fixed size and at most two chunks per
+ * worker are in flight.  the chunks are stitched in file order as soon as
+ * they are done, so the vlists of the nodes grow and compress as usual.  a
+ * chunk that the workers can't handle is parsed again on this thread, as is
+ * the rest of a chunk that the serial parser ran into.
+ */
+static void vcd_parse_chunked(GwVcdLoader *self, GError **error)
+{
+    if (!self->is_mapped || self->following || self->vstop != NULL) {
+        return;
+    }
+
+    gsize size = self->vend - self->vst;
+    guint num_workers = g_get_num_processors();
+    if (num_workers < 2 || size < 2 * VCD_PARSE_CHUNK_MIN) {
+        return;
+    }
+
+    gsize chunk_size = CLAMP(size / (4 * num_workers), VCD_PARSE_CHUNK_MIN, VCD_PARSE_CHUNK_MAX);
+
+    VcdChunkQueue queue = {0};
+    g_mutex_init(&queue.lock);
+    g_cond_init(&queue.done_cond);
+    g_queue_init(&queue.chunks);
+    queue.pool = g_thread_pool_new(vcd_chunk_parse, &queue, num_workers, FALSE, NULL);
+
+    const char *section = self->vst;
+    const char *next = section;
+    gboolean ok = TRUE;
+
+    while (ok && (next < self->vend || !g_queue_is_empty(&queue.chunks))) {
+        while (next < self->vend && g_queue_get_length(&queue.chunks) < 2 * num_workers) {
+            const char *end = vcd_chunk_boundary(self, MIN(next + chunk_size, self->vend));
+            VcdChunk *chunk = vcd_chunk_new(self, next, end, next == section);
+
+            g_queue_push_tail(&queue.chunks, chunk);
+            g_thread_pool_push(queue.pool, chunk, NULL);
+            next = end;
+        }
+
+        VcdChunk *chunk = g_queue_pop_head(&queue.chunks);
+
+        g_mutex_lock(&queue.lock);
+        while (!chunk->done) {
+            g_cond_wait(&queue.done_cond, &queue.lock);
+        }
+        g_mutex_unlock(&queue.lock);
+
+        // vst is past the start of the chunk if the serial parser ran into it.
+        if (self->vst >= chunk->end) {
+            /* read by the serial parser already */
+        } else if (self->vst == chunk->start && !chunk->failed &&
+                   vcd_chunk_stitch(self, chunk)) {
+            self->vst = (char *)chunk->end;
+        } else {
+            ok = vcd_chunk_parse_serial(self, chunk, error);
+        }
+
+        vcd_chunk_free(chunk);
+    }
+
+    // The chunks that are left are past the end of the parse.
+    g_thread_pool_free(queue.pool, TRUE, TRUE);
+    g_queue_clear_full(&queue.chunks, (GDestroyNotify)vcd_chunk_free);
+    g_cond_clear(&queue.done_cond);
+    g_mutex_clear(&queue.lock);
 }
 
 static void vcd_parse(GwVcdLoader *self, GError **error)
@@ -1894,7 +2685,12 @@ static void vcd_parse(GwVcdLoader *self, GError **error)
     g_assert(error != NULL && *error == NULL);
 
     while (*error == NULL) {
-        switch (get_token(self)) {
+        if (self->vstop != NULL && self->vst >= self->vstop) {
+            return; /* back to vcd_parse_chunked() */
+        }
+
+        int tok = get_token(self);
+        switch (tok) {
             case T_COMMENT:
                 sync_end(self);
                 break;
@@ -1929,6 +2725,9 @@ static void vcd_parse(GwVcdLoader *self, GError **error)
 
             case T_ENDDEFINITIONS:
                 vcd_parse_enddefinitions(self, error);
+                if (*error == NULL) {
+                    vcd_parse_chunked(self, error);
+                }
                 break;
 
             case T_STRING:
@@ -1941,19 +2740,11 @@ static void vcd_parse(GwVcdLoader *self, GError **error)
 
             case T_DUMPOFF:
             case T_DUMPPORTSOFF:
-                gw_blackout_regions_add_dumpoff(self->blackout_regions, self->current_time);
-                break;
-
             case T_DUMPON:
             case T_DUMPPORTSON:
-                gw_blackout_regions_add_dumpon(self->blackout_regions, self->current_time);
-                break;
-
             case T_DUMPVARS:
             case T_DUMPPORTS:
-                if (self->current_time < 0) {
-                    self->start_time = self->current_time = self->end_time = 0;
-                }
+                vcd_dump_command(self, tok);
                 break;
 
             case T_VCDCLOSE:
@@ -2286,6 +3077,7 @@ static void vcd_cleanup(GwVcdLoader *self)
 static GwFacs *vcd_sortfacs(GwVcdLoader *self)
 {
     GwFacs *facs = gw_facs_new(self->numfacs);
+    gw_facs_set_name_pool(facs, self->names);
 
     GSList *iter = self->sym_chain;
     for (guint i = 0; i < self->numfacs; i++) {
@@ -2519,7 +3311,15 @@ static void gw_vcd_loader_finalize(GObject *object)
 {
     GwVcdLoader *self = GW_VCD_LOADER(object);
 
+    // A followed file keeps everything that is needed to parse it alive.
+    if (self->following) {
+        vcd_cleanup(self);
+        getch_free(self);
+    }
+
+    g_clear_pointer(&self->follow_symbols, g_ptr_array_unref);
     g_free(self->sym_hash);
+    g_clear_object(&self->names);
 
     G_OBJECT_CLASS(gw_vcd_loader_parent_class)->finalize(object);
 }
@@ -2531,6 +3331,29 @@ static GwDumpFile *gw_vcd_loader_load(GwLoader *loader, const gchar *fname, GErr
 
     GwVcdLoader *self = GW_VCD_LOADER(loader);
 
+    if (self->following) {
+        g_set_error(error,
+                    GW_DUMP_FILE_ERROR,
+                    GW_DUMP_FILE_ERROR_UNKNOWN,
+                    "The loader is still following another VCD file.");
+        return NULL;
+    }
+
+    gchar delimiter = gw_loader_get_hierarchy_delimiter(loader);
+    gboolean use_cache = self->use_cache && !self->follow && strcmp("-vcd", fname) != 0;
+
+    if (use_cache) {
+        GwVcdFile *cached = gw_vcd_cache_load(fname, delimiter);
+        if (cached != NULL) {
+            fprintf(stderr, "VCDLOAD | Using cache for '%s'.\n", fname);
+
+            cached->preserve_glitches = gw_loader_is_preserve_glitches(loader);
+            cached->preserve_glitches_real = gw_loader_is_preserve_glitches_real(loader);
+
+            return GW_DUMP_FILE(cached);
+        }
+    }
+
     errno = 0; /* reset in case it's set for some reason */
 
     if (g_str_has_suffix(fname, ".gz") || g_str_has_suffix(fname, ".zip")) {
@@ -2593,7 +3416,13 @@ static GwDumpFile *gw_vcd_loader_load(GwLoader *loader, const gchar *fname, GErr
     // TODO: update splash
     // /* SPLASH */ splash_create();
 
-    getch_alloc(self); /* alloc membuff for vcd getch buffer */
+    // Only regular files can be followed, pipes would block the updates.
+    self->following = self->follow && !self->is_compressed && self->vcd_handle != stdin;
+
+    if (!self->use_mmap || self->following || self->is_compressed || self->vcd_handle == stdin ||
+        !getch_map(self)) {
+        getch_alloc(self); /* alloc membuff for vcd getch buffer */
+    }
 
     self->time_vlist = gw_vlist_create(sizeof(GwTime));
 
@@ -2610,7 +3439,10 @@ static GwDumpFile *gw_vcd_loader_load(GwLoader *loader, const gchar *fname, GErr
         self->varsplit = NULL;
     }
 
-    gw_vlist_freeze(&self->time_vlist, self->vlist_compression_level);
+    // The time table of a followed file keeps growing.
+    if (!self->following) {
+        gw_vlist_freeze(&self->time_vlist, self->vlist_compression_level);
+    }
 
     vlist_emit_finalize(self);
 
@@ -2655,9 +3487,13 @@ static GwDumpFile *gw_vcd_loader_load(GwLoader *loader, const gchar *fname, GErr
     self->tree_root = gw_tree_builder_build(self->tree_builder);
     GwTree *tree = vcd_build_tree(self, facs);
 
-    vcd_cleanup(self);
+    if (self->following) {
+        g_clear_object(&self->tree_builder);
+    } else {
+        vcd_cleanup(self);
 
-    getch_free(self); /* free membuff for vcd getch buffer */
+        getch_free(self); /* free membuff for vcd getch buffer */
+    }
 
     gw_blackout_regions_scale(self->blackout_regions, self->time_scale);
 
@@ -2689,12 +3525,102 @@ static GwDumpFile *gw_vcd_loader_load(GwLoader *loader, const gchar *fname, GErr
     dump_file->preserve_glitches = gw_loader_is_preserve_glitches(loader);
     dump_file->preserve_glitches_real = gw_loader_is_preserve_glitches_real(loader);
 
+    if (self->following) {
+        dump_file->follow_loader = g_object_ref(self);
+        self->follow_symbols = g_ptr_array_new();
+    }
+
+    // The cache has to be written before any trace is imported.
+    if (use_cache) {
+        GError *cache_error = NULL;
+        if (!gw_vcd_cache_save(dump_file, fname, delimiter, &cache_error)) {
+            fprintf(stderr, "VCDLOAD | Not writing cache: %s\n", cache_error->message);
+            g_error_free(cache_error);
+        }
+    }
+
     g_object_unref(tree);
     g_object_unref(time_range);
 
     return GW_DUMP_FILE(dump_file);
 }
 
+static void add_blackout_region(GwTime start, GwTime end, gpointer user_data)
+{
+    gw_blackout_regions_add(user_data, start, end);
+}
+
+/*
+ * parses the data that was appended to a followed file since the last
+ * update and hands the value changes over to the file
+ */
+gboolean gw_vcd_loader_update(GwVcdLoader *self,
+                              GwVcdFile *file,
+                              gboolean *changed,
+                              GPtrArray *changed_nodes,
+                              GError **error)
+{
+    g_return_val_if_fail(GW_IS_VCD_LOADER(self), FALSE);
+    g_return_val_if_fail(self->following, FALSE);
+
+    unsigned int time_vlist_count = self->time_vlist_count;
+    GwTime end_time = self->end_time;
+
+    // A $dumpoff from an earlier update that wasn't followed by a $dumpon yet
+    // extends to the new end time.
+    self->blackout_regions = gw_blackout_regions_new();
+    if (self->dumpoff_time >= 0) {
+        gw_blackout_regions_add_dumpoff(self->blackout_regions, self->dumpoff_time);
+    }
+
+    clearerr(self->vcd_handle);
+
+    self->updating = TRUE;
+    GError *error_internal = NULL;
+    vcd_parse(self, &error_internal);
+    self->updating = FALSE;
+
+    // The new value changes refer to the grown time table.
+    file->time_vlist = self->time_vlist;
+    file->end_time = self->end_time;
+
+    for (guint i = 0; i < self->follow_symbols->len; i++) {
+        struct vcdsymbol *v = g_ptr_array_index(self->follow_symbols, i);
+        GwVlist *vlist = gw_vlist_writer_finish(v->follow_writer);
+        g_clear_object(&v->follow_writer);
+
+        gw_vcd_file_append_changes(file, v->narray[0], vlist, v->follow_time_idx, changed_nodes);
+    }
+    gboolean values_changed = self->follow_symbols->len > 0;
+    g_ptr_array_set_size(self->follow_symbols, 0);
+
+    gw_blackout_regions_scale(self->blackout_regions, self->time_scale);
+    gw_blackout_regions_foreach(self->blackout_regions,
+                                add_blackout_region,
+                                gw_dump_file_get_blackout_regions(GW_DUMP_FILE(file)));
+    g_clear_object(&self->blackout_regions);
+
+    if (error_internal != NULL) {
+        g_propagate_error(error, error_internal);
+        return FALSE;
+    }
+
+    if (self->end_time != end_time) {
+        GwDumpFile *dump_file = GW_DUMP_FILE(file);
+        GwTimeRange *time_range =
+            gw_time_range_new(gw_time_range_get_start(gw_dump_file_get_time_range(dump_file)),
+                              self->end_time * self->time_scale);
+        gw_dump_file_set_time_range(dump_file, time_range);
+        g_object_unref(time_range);
+    }
+
+    if (changed != NULL) {
+        *changed = values_changed || self->time_vlist_count != time_vlist_count;
+    }
+
+    return TRUE;
+}
+
 static void gw_vcd_loader_set_property(GObject *object,
                                        guint property_id,
                                        const GValue *value,
@@ -2715,6 +3641,18 @@ static void gw_vcd_loader_set_property(GObject *object,
             gw_vcd_loader_set_warning_filesize(self, g_value_get_uint(value));
             break;
 
+        case PROP_USE_MMAP:
+            gw_vcd_loader_set_use_mmap(self, g_value_get_boolean(value));
+            break;
+
+        case PROP_USE_CACHE:
+            gw_vcd_loader_set_use_cache(self, g_value_get_boolean(value));
+            break;
+
+        case PROP_FOLLOW:
+            gw_vcd_loader_set_follow(self, g_value_get_boolean(value));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -2741,6 +3679,18 @@ static void gw_vcd_loader_get_property(GObject *object,
             g_value_set_uint(value, gw_vcd_loader_get_warning_filesize(self));
             break;
 
+        case PROP_USE_MMAP:
+            g_value_set_boolean(value, gw_vcd_loader_get_use_mmap(self));
+            break;
+
+        case PROP_USE_CACHE:
+            g_value_set_boolean(value, gw_vcd_loader_get_use_cache(self));
+            break;
+
+        case PROP_FOLLOW:
+            g_value_set_boolean(value, gw_vcd_loader_get_follow(self));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -2770,7 +3720,7 @@ static void gw_vcd_loader_class_init(GwVcdLoaderClass *klass)
                          NULL,
                          NULL,
                          Z_DEFAULT_COMPRESSION /* -1 */,
-                         Z_BEST_COMPRESSION /* 9 */,
+                         GW_VCD_LOADER_VLIST_COMPRESSION_LZ4,
                          Z_DEFAULT_COMPRESSION,
                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
@@ -2783,6 +3733,27 @@ static void gw_vcd_loader_class_init(GwVcdLoaderClass *klass)
                           0,
                           G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+    properties[PROP_USE_MMAP] =
+        g_param_spec_boolean("use-mmap",
+                             NULL,
+                             NULL,
+                             TRUE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+    properties[PROP_USE_CACHE] =
+        g_param_spec_boolean("use-cache",
+                             NULL,
+                             NULL,
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+    properties[PROP_FOLLOW] =
+        g_param_spec_boolean("follow",
+                             NULL,
+                             NULL,
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties(object_class, N_PROPERTIES, properties);
 }
 
@@ -2798,12 +3769,15 @@ static void gw_vcd_loader_init(GwVcdLoader *self)
     self->yytext = g_malloc(self->T_MAX_STR + 1);
     self->vcd_minid = G_MAXUINT;
     self->tree_builder = gw_tree_builder_new('.'); // TODO: use hierarchy delimiter property
+    self->names = gw_name_pool_new();
     self->blackout_regions = gw_blackout_regions_new();
 
     self->vlist_compression_level = Z_DEFAULT_COMPRESSION;
 
     self->sym_hash = g_new0(GwSymbol *, GW_HASH_PRIME);
     self->warning_filesize = 256;
+    self->use_mmap = TRUE;
+    self->dumpoff_time = -1;
 }
 
 GwLoader *gw_vcd_loader_new(void)
@@ -2831,11 +3805,23 @@ gboolean gw_vcd_loader_is_vlist_prepack(GwVcdLoader *self)
     return self->vlist_prepack;
 }
 
+/**
+ * gw_vcd_loader_set_vlist_compression_level:
+ * @self: A #GwVcdLoader.
+ * @level: The compression level.
+ *
+ * Sets how the value changes are compressed while the file is parsed. -1
+ * disables compression, 0 to 9 select the zlib compression level and
+ * %GW_VCD_LOADER_VLIST_COMPRESSION_LZ4 selects the faster LZ4 codec.
+ *
+ * Large blocks are compressed by background threads if more than one
+ * processor is available.
+ */
 void gw_vcd_loader_set_vlist_compression_level(GwVcdLoader *self, gint level)
 {
     g_return_if_fail(GW_IS_VCD_LOADER(self));
 
-    level = CLAMP(level, Z_DEFAULT_COMPRESSION, Z_BEST_COMPRESSION);
+    level = CLAMP(level, Z_DEFAULT_COMPRESSION, GW_VCD_LOADER_VLIST_COMPRESSION_LZ4);
 
     if (self->vlist_compression_level != level) {
         self->vlist_compression_level = level;
@@ -2867,4 +3853,91 @@ guint gw_vcd_loader_get_warning_filesize(GwVcdLoader *self)
     g_return_val_if_fail(GW_IS_VCD_LOADER(self), FALSE);
 
     return self->warning_filesize;
-}
\ No newline at end of file
+}
+
+void gw_vcd_loader_set_use_mmap(GwVcdLoader *self, gboolean use_mmap)
+{
+    g_return_if_fail(GW_IS_VCD_LOADER(self));
+
+    use_mmap = !!use_mmap;
+
+    if (self->use_mmap != use_mmap) {
+        self->use_mmap = use_mmap;
+
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_USE_MMAP]);
+    }
+}
+
+gboolean gw_vcd_loader_get_use_mmap(GwVcdLoader *self)
+{
+    g_return_val_if_fail(GW_IS_VCD_LOADER(self), FALSE);
+
+    return self->use_mmap;
+}
+
+/**
+ * gw_vcd_loader_set_use_cache:
+ * @self: A #GwVcdLoader.
+ * @use_cache: Whether to use a cache file.
+ *
+ * Sets whether the loaded state is cached in a file next to the VCD file.
+ * If the VCD file wasn't modified since the cache was written, the next
+ * load restores the signals and their value changes from the cache instead
+ * of parsing the VCD file again.
+ *
+ * The cache is written after a successful parse, files that are read from
+ * stdin are never cached.
+ */
+void gw_vcd_loader_set_use_cache(GwVcdLoader *self, gboolean use_cache)
+{
+    g_return_if_fail(GW_IS_VCD_LOADER(self));
+
+    use_cache = !!use_cache;
+
+    if (self->use_cache != use_cache) {
+        self->use_cache = use_cache;
+
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_USE_CACHE]);
+    }
+}
+
+gboolean gw_vcd_loader_get_use_cache(GwVcdLoader *self)
+{
+    g_return_val_if_fail(GW_IS_VCD_LOADER(self), FALSE);
+
+    return self->use_cache;
+}
+
+/**
+ * gw_vcd_loader_set_follow:
+ * @self: A #GwVcdLoader.
+ * @follow: Whether to follow the file.
+ *
+ * Sets whether the loaded file is followed while it is still being written,
+ * for example by a running simulation. The file is kept open and
+ * gw_dump_file_update() reads the value changes that were appended since the
+ * load or the last update. Only complete lines are parsed, an incomplete
+ * last line is read by a later update.
+ *
+ * Compressed files and stdin can't be followed and are loaded normally.
+ * Followed files are never cached.
+ */
+void gw_vcd_loader_set_follow(GwVcdLoader *self, gboolean follow)
+{
+    g_return_if_fail(GW_IS_VCD_LOADER(self));
+
+    follow = !!follow;
+
+    if (self->follow != follow) {
+        self->follow = follow;
+
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_FOLLOW]);
+    }
+}
+
+gboolean gw_vcd_loader_get_follow(GwVcdLoader *self)
+{
+    g_return_val_if_fail(GW_IS_VCD_LOADER(self), FALSE);
+
+    return self->follow;
+}
@@ -8,6 +8,9 @@ G_BEGIN_DECLS
 #define GW_TYPE_VCD_LOADER (gw_vcd_loader_get_type())
 G_DECLARE_FINAL_TYPE(GwVcdLoader, gw_vcd_loader, GW, VCD_LOADER, GwLoader)
 
+/* vlist compression level that selects LZ4 instead of zlib */
+#define GW_VCD_LOADER_VLIST_COMPRESSION_LZ4 (10)
+
 GwLoader *gw_vcd_loader_new(void);
 
 void gw_vcd_loader_set_vlist_prepack(GwVcdLoader *self, gboolean vlist_prepack);
@@ -16,5 +19,11 @@ void gw_vcd_loader_set_vlist_compression_level(GwVcdLoader *self, gint level);
 gint gw_vcd_loader_get_vlist_compression_level(GwVcdLoader *self);
 void gw_vcd_loader_set_warning_filesize(GwVcdLoader *self, guint warning_filesize);
 guint gw_vcd_loader_get_warning_filesize(GwVcdLoader *self);
+void gw_vcd_loader_set_use_mmap(GwVcdLoader *self, gboolean use_mmap);
+gboolean gw_vcd_loader_get_use_mmap(GwVcdLoader *self);
+void gw_vcd_loader_set_use_cache(GwVcdLoader *self, gboolean use_cache);
+gboolean gw_vcd_loader_get_use_cache(GwVcdLoader *self);
+void gw_vcd_loader_set_follow(GwVcdLoader *self, gboolean follow);
+gboolean gw_vcd_loader_get_follow(GwVcdLoader *self);
 
 G_END_DECLS
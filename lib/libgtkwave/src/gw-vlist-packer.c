@@ -1,4 +1,7 @@
 #include "gw-vlist-packer.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /* experimentation shows that 255 is one of the least common
    bytes found in recoded value change streams */
@@ -9,12 +12,18 @@
 #define WAVE_ZIVSKIP (1) /* number of bytes to skip for alternate rollover searches */
 #define WAVE_ZIVMASK ((WAVE_ZIVWRAP)-1) /* then this becomes an AND mask for wrapping */
 
+#if WAVE_ZIVWRAP != 128 || WAVE_ZIVSKIP != 1
+#error "the match finder expects a 128 byte window and consecutive candidates"
+#endif
+
 struct _GwVlistPacker
 {
     GwVlist *v;
 
     gint compression_level;
 
+    /* the window is filled backwards, so the byte that was added i bytes
+       ago is found at buf[(bufpnt + i) & WAVE_ZIVMASK] */
     unsigned char buf[WAVE_ZIVWRAP];
 
 #ifdef WAVE_VLIST_PACKER_STATS
@@ -76,54 +85,116 @@ static void gw_vlist_packer_emit_uv32rvs(GwVlistPacker *self, unsigned int v)
     }
 }
 
+static inline guint gw_vlist_packer_lowest_bit(guint64 v)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(v);
+#else
+    guint n = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* sets bit i of the 128 bit mask if byt was added i bytes ago.  this
+   replaces a byte by byte scan of the window for every candidate.
+ */
+static void gw_vlist_packer_find(GwVlistPacker *self, unsigned char byt, guint64 candidates[2])
+{
+    guint64 lo = 0;
+    guint64 hi = 0;
+    int i;
+
+#ifdef __SSE2__
+    __m128i needle = _mm_set1_epi8((char)byt);
+
+    for (i = 0; i < 4; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)&self->buf[16 * i]);
+        __m128i b = _mm_loadu_si128((const __m128i *)&self->buf[64 + 16 * i]);
+
+        lo |= (guint64)(guint16)_mm_movemask_epi8(_mm_cmpeq_epi8(a, needle)) << (16 * i);
+        hi |= (guint64)(guint16)_mm_movemask_epi8(_mm_cmpeq_epi8(b, needle)) << (16 * i);
+    }
+#else
+    for (i = 0; i < 64; i++) {
+        lo |= (guint64)(self->buf[i] == byt) << i;
+        hi |= (guint64)(self->buf[64 + i] == byt) << i;
+    }
+#endif
+
+    /* rotate window positions into distances from bufpnt */
+    unsigned int rot = self->bufpnt;
+    if (rot >= 64) {
+        guint64 tmp = lo;
+        lo = hi;
+        hi = tmp;
+        rot -= 64;
+    }
+    if (rot != 0) {
+        guint64 rlo = (lo >> rot) | (hi << (64 - rot));
+        guint64 rhi = (hi >> rot) | (lo << (64 - rot));
+        lo = rlo;
+        hi = rhi;
+    }
+
+    candidates[0] = lo;
+    candidates[1] = hi;
+}
+
+/* pops the closest remaining candidate */
+static gboolean gw_vlist_packer_next_candidate(guint64 candidates[2], guchar *dist)
+{
+    if (candidates[0] != 0) {
+        *dist = gw_vlist_packer_lowest_bit(candidates[0]);
+        candidates[0] &= candidates[0] - 1;
+        return TRUE;
+    }
+    if (candidates[1] != 0) {
+        *dist = 64 + gw_vlist_packer_lowest_bit(candidates[1]);
+        candidates[1] &= candidates[1] - 1;
+        return TRUE;
+    }
+    return FALSE;
+}
+
 void gw_vlist_packer_alloc(GwVlistPacker *self, unsigned char byt)
 {
-    int i, j, k, l;
+    guint64 candidates[2];
 
     self->unpacked_bytes++;
 
     if (!self->repcnt) {
     top:
-        for (i = 0; i < WAVE_ZIVSRCH; i++) {
-            if (self->buf[(self->bufpnt - i) & WAVE_ZIVMASK] == byt) {
-                self->repdist = i;
-                self->repcnt = 1;
-
-                self->repdist2 = self->repdist3 = self->repdist4 = 0;
-
-                for (j = i + WAVE_ZIVSKIP; j < WAVE_ZIVSRCH; j++) {
-                    if (self->buf[(self->bufpnt - j) & WAVE_ZIVMASK] == byt) {
-                        self->repdist2 = j;
-                        self->repcnt2 = 1;
-
-                        for (k = j + WAVE_ZIVSKIP; k < WAVE_ZIVSRCH; k++) {
-                            if (self->buf[(self->bufpnt - k) & WAVE_ZIVMASK] == byt) {
-                                self->repdist3 = k;
-                                self->repcnt3 = 1;
-
-                                for (l = k + WAVE_ZIVSKIP; l < WAVE_ZIVSRCH; l++) {
-                                    if (self->buf[(self->bufpnt - l) & WAVE_ZIVMASK] == byt) {
-                                        self->repdist4 = l;
-                                        self->repcnt4 = 1;
-                                        break;
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                        break;
+        gw_vlist_packer_find(self, byt, candidates);
+
+        if (gw_vlist_packer_next_candidate(candidates, &self->repdist)) {
+            self->repcnt = 1;
+
+            self->repdist2 = self->repdist3 = self->repdist4 = 0;
+
+            if (gw_vlist_packer_next_candidate(candidates, &self->repdist2)) {
+                self->repcnt2 = 1;
+
+                if (gw_vlist_packer_next_candidate(candidates, &self->repdist3)) {
+                    self->repcnt3 = 1;
+
+                    if (gw_vlist_packer_next_candidate(candidates, &self->repdist4)) {
+                        self->repcnt4 = 1;
                     }
                 }
+            }
 
-                self->bufpnt++;
-                self->bufpnt &= WAVE_ZIVMASK;
-                self->buf[self->bufpnt] = byt;
+            self->bufpnt--;
+            self->bufpnt &= WAVE_ZIVMASK;
+            self->buf[self->bufpnt] = byt;
 
-                return;
-            }
+            return;
         }
 
-        self->bufpnt++;
+        self->bufpnt--;
         self->bufpnt &= WAVE_ZIVMASK;
         self->buf[self->bufpnt] = byt;
         gw_vlist_packer_emit_out(self, byt);
@@ -132,26 +203,26 @@ void gw_vlist_packer_alloc(GwVlistPacker *self, unsigned char byt)
         }
     } else {
     attempt2:
-        if (self->buf[(self->bufpnt - self->repdist) & WAVE_ZIVMASK] == byt) {
+        if (self->buf[(self->bufpnt + self->repdist) & WAVE_ZIVMASK] == byt) {
             self->repcnt++;
 
             if (self->repcnt2) {
-                self->repcnt2 = ((self->buf[(self->bufpnt - self->repdist2) & WAVE_ZIVMASK] == byt))
+                self->repcnt2 = ((self->buf[(self->bufpnt + self->repdist2) & WAVE_ZIVMASK] == byt))
                                     ? self->repcnt2 + 1
                                     : 0;
             }
             if (self->repcnt3) {
-                self->repcnt3 = ((self->buf[(self->bufpnt - self->repdist3) & WAVE_ZIVMASK] == byt))
+                self->repcnt3 = ((self->buf[(self->bufpnt + self->repdist3) & WAVE_ZIVMASK] == byt))
                                     ? self->repcnt3 + 1
                                     : 0;
             }
             if (self->repcnt4) {
-                self->repcnt4 = ((self->buf[(self->bufpnt - self->repdist4) & WAVE_ZIVMASK] == byt))
+                self->repcnt4 = ((self->buf[(self->bufpnt + self->repdist4) & WAVE_ZIVMASK] == byt))
                                     ? self->repcnt4 + 1
                                     : 0;
             }
 
-            self->bufpnt++;
+            self->bufpnt--;
             self->bufpnt &= WAVE_ZIVMASK;
             self->buf[self->bufpnt] = byt;
         } else {
@@ -203,8 +274,8 @@ void gw_vlist_packer_alloc(GwVlistPacker *self, unsigned char byt)
                 gw_vlist_packer_emit_uv32(self, self->repdist);
             } else {
                 if (self->repcnt == 2) {
-                    gw_vlist_packer_emit_out(self, self->buf[(self->bufpnt - 1) & WAVE_ZIVMASK]);
-                    if (self->buf[(self->bufpnt - 1) & WAVE_ZIVMASK] == WAVE_ZIVFLAG) {
+                    gw_vlist_packer_emit_out(self, self->buf[(self->bufpnt + 1) & WAVE_ZIVMASK]);
+                    if (self->buf[(self->bufpnt + 1) & WAVE_ZIVMASK] == WAVE_ZIVFLAG) {
                         gw_vlist_packer_emit_uv32(self, 0);
                     }
                 }
@@ -234,8 +305,8 @@ GwVlist *gw_vlist_packer_finalize_and_free(GwVlistPacker *self)
             gw_vlist_packer_emit_uv32(self, self->repdist);
         } else {
             if (self->repcnt == 2) {
-                gw_vlist_packer_emit_out(self, self->buf[(self->bufpnt - 1) & WAVE_ZIVMASK]);
-                if (self->buf[(self->bufpnt - 1) & WAVE_ZIVMASK] == WAVE_ZIVFLAG) {
+                gw_vlist_packer_emit_out(self, self->buf[(self->bufpnt + 1) & WAVE_ZIVMASK]);
+                if (self->buf[(self->bufpnt + 1) & WAVE_ZIVMASK] == WAVE_ZIVFLAG) {
                     gw_vlist_packer_emit_uv32(self, 0);
                 }
             }
@@ -3,6 +3,9 @@
 #include "gw-vlist-packer.h"
 #include "gw-bit.h"
 #include <zlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 struct _GwVlistReader
 {
@@ -16,6 +19,7 @@ struct _GwVlistReader
     guint size;
 
     GString *string_buffer;
+    GByteArray *mvl9_buffer;
 };
 
 G_DEFINE_TYPE(GwVlistReader, gw_vlist_reader, G_TYPE_OBJECT)
@@ -36,6 +40,7 @@ static void gw_vlist_reader_finalize(GObject *object)
     g_clear_pointer(&self->vlist, gw_vlist_destroy);
     g_clear_pointer(&self->depacked, gw_vlist_packer_decompress_destroy);
     g_string_free(self->string_buffer, TRUE);
+    g_byte_array_unref(self->mvl9_buffer);
 
     G_OBJECT_CLASS(gw_vlist_reader_parent_class)->finalize(object);
 }
@@ -46,6 +51,9 @@ static void gw_vlist_reader_constructed(GObject *object)
 
     G_OBJECT_CLASS(gw_vlist_reader_parent_class)->constructed(object);
 
+    // The reader visits every byte, make sure each lookup is a plain index.
+    gw_vlist_flatten(&self->vlist);
+
     if (self->prepacked) {
         self->depacked = gw_vlist_packer_decompress(self->vlist, &self->size);
         g_clear_pointer(&self->vlist, gw_vlist_destroy);
@@ -103,6 +111,7 @@ static void gw_vlist_reader_class_init(GwVlistReaderClass *klass)
 static void gw_vlist_reader_init(GwVlistReader *self)
 {
     self->string_buffer = g_string_new(NULL);
+    self->mvl9_buffer = g_byte_array_new();
 }
 
 GwVlistReader *gw_vlist_reader_new(GwVlist *vlist, gboolean prepacked)
@@ -127,7 +136,7 @@ gint gw_vlist_reader_next(GwVlistReader *self)
     if (self->depacked != NULL) {
         value = self->depacked[self->position];
     } else {
-        value = *(guint *)gw_vlist_locate(self->vlist, self->position);
+        value = *(guint8 *)gw_vlist_locate(self->vlist, self->position);
     }
 
     self->position++;
@@ -181,6 +190,113 @@ const gchar *gw_vlist_reader_read_string(GwVlistReader *self)
     return self->string_buffer->str;
 }
 
+/* returns the remaining bytes if they are stored contiguously */
+static const guint8 *gw_vlist_reader_peek_contiguous(GwVlistReader *self)
+{
+    if (self->depacked != NULL) {
+        return self->depacked + self->position;
+    }
+    if (self->vlist->next == NULL && self->vlist->size == 1) {
+        return (const guint8 *)(self->vlist + 1) + self->position;
+    }
+    return NULL;
+}
+
+static inline guint8 *gw_vlist_reader_reserve_mvl9(GwVlistReader *self, guint32 used, guint32 n)
+{
+    if (G_UNLIKELY(used + n > self->mvl9_buffer->len)) {
+        g_byte_array_set_size(self->mvl9_buffer, MAX(self->mvl9_buffer->len * 2, used + n));
+    }
+    return self->mvl9_buffer->data + used;
+}
+
+/**
+ * gw_vlist_reader_read_mvl9_string:
+ * @self: A #GwVlistReader.
+ * @len: (out): Return location for the number of bits.
+ *
+ * Reads a string that was written with gw_vlist_writer_append_mvl9_string()
+ * and unpacks it into one #GwBit per byte. Runs of bytes without the end
+ * marker are unpacked 16 bytes at a time where SSE2 is available.
+ *
+ * Returns: (transfer none): The bits, which stay valid until the next call.
+ */
+const guint8 *gw_vlist_reader_read_mvl9_string(GwVlistReader *self, guint32 *len)
+{
+    g_return_val_if_fail(GW_IS_VLIST_READER(self), NULL);
+    g_return_val_if_fail(len != NULL, NULL);
+
+    guint32 used = 0;
+
+    const guint8 *src = gw_vlist_reader_peek_contiguous(self);
+    if (src != NULL) {
+        guint32 remaining = self->size - self->position;
+        guint32 i = 0;
+
+#ifdef __SSE2__
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        const __m128i mask = _mm_set1_epi8(GW_BIT_MASK);
+
+        for (; i + 16 <= remaining; i += 16) {
+            __m128i packed = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), nibble);
+            __m128i lo = _mm_and_si128(packed, nibble);
+
+            __m128i end = _mm_or_si128(_mm_cmpeq_epi8(hi, mask), _mm_cmpeq_epi8(lo, mask));
+            if (_mm_movemask_epi8(end) != 0) {
+                break; /* the end marker is handled below */
+            }
+
+            guint8 *dst = gw_vlist_reader_reserve_mvl9(self, used, 32);
+            _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi8(hi, lo));
+            used += 32;
+        }
+#endif
+
+        for (; i < remaining; i++) {
+            guint8 c = src[i];
+            guint8 *dst = gw_vlist_reader_reserve_mvl9(self, used, 2);
+
+            if ((c >> 4) == GW_BIT_MASK) {
+                i++;
+                break;
+            }
+            dst[0] = c >> 4;
+            used++;
+
+            if ((c & GW_BIT_MASK) == GW_BIT_MASK) {
+                i++;
+                break;
+            }
+            dst[1] = c & GW_BIT_MASK;
+            used++;
+        }
+
+        self->position += i;
+    } else {
+        for (;;) {
+            gint c = gw_vlist_reader_next(self);
+            if (c < 0 || (c >> 4) == GW_BIT_MASK) {
+                break;
+            }
+            guint8 *dst = gw_vlist_reader_reserve_mvl9(self, used, 2);
+            dst[0] = c >> 4;
+            used++;
+
+            if ((c & GW_BIT_MASK) == GW_BIT_MASK) {
+                break;
+            }
+            dst[1] = c & GW_BIT_MASK;
+            used++;
+        }
+    }
+
+    *len = used;
+
+    return self->mvl9_buffer->data;
+}
+
 gboolean gw_vlist_reader_is_done(GwVlistReader *self)
 {
     g_return_val_if_fail(GW_IS_VLIST_READER(self), TRUE);
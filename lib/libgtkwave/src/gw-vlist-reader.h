@@ -14,6 +14,7 @@ gboolean gw_vlist_reader_is_done(GwVlistReader *self);
 gint gw_vlist_reader_next(GwVlistReader *self);
 guint32 gw_vlist_reader_read_uv32(GwVlistReader *self);
 const gchar *gw_vlist_reader_read_string(GwVlistReader *self);
+const guint8 *gw_vlist_reader_read_mvl9_string(GwVlistReader *self, guint32 *len);
 
 // void gw_vlist_writer_append_string(GwVlistWriter *self, const gchar *str);
 // void gw_vlist_writer_append_mvl9_string(GwVlistWriter *self, const char *str);
@@ -91,7 +91,7 @@ static void gw_vlist_writer_class_init(GwVlistWriterClass *klass)
                          NULL,
                          NULL,
                          Z_DEFAULT_COMPRESSION /* -1 */,
-                         Z_BEST_COMPRESSION /* 9 */,
+                         GW_VLIST_COMPRESSION_LZ4 /* 10 */,
                          Z_DEFAULT_COMPRESSION,
                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS);
 
@@ -121,6 +121,16 @@ GwVlistWriter *gw_vlist_writer_new(gint compression_level, gboolean prepack)
     // clang-format on
 }
 
+static inline void gw_vlist_writer_emit(GwVlistWriter *self, guint8 byte)
+{
+    if (self->packer != NULL) {
+        gw_vlist_packer_alloc(self->packer, byte);
+    } else {
+        char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
+        *pnt = byte;
+    }
+}
+
 void gw_vlist_writer_append_uv32(GwVlistWriter *self, guint32 value)
 {
     g_return_if_fail(GW_IS_VLIST_WRITER(self));
@@ -131,22 +141,12 @@ void gw_vlist_writer_append_uv32(GwVlistWriter *self, guint32 value)
             break;
         }
 
-        if (self->packer != NULL) {
-            gw_vlist_packer_alloc(self->packer, value & 0x7f);
-        } else {
-            char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-            *pnt = (value & 0x7f);
-        }
+        gw_vlist_writer_emit(self, value & 0x7f);
 
         value = next;
     }
 
-    if (self->packer != NULL) {
-        gw_vlist_packer_alloc(self->packer, (value & 0x7f) | 0x80);
-    } else {
-        char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-        *pnt = (value & 0x7f) | 0x80;
-    }
+    gw_vlist_writer_emit(self, (value & 0x7f) | 0x80);
 }
 
 void gw_vlist_writer_append_string(GwVlistWriter *self, const gchar *str)
@@ -155,20 +155,10 @@ void gw_vlist_writer_append_string(GwVlistWriter *self, const gchar *str)
     g_return_if_fail(str != NULL);
 
     for (const gchar *iter = str; *iter != '\0'; iter++) {
-        if (self->packer != NULL) {
-            gw_vlist_packer_alloc(self->packer, *iter);
-        } else {
-            char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-            *pnt = *iter;
-        }
+        gw_vlist_writer_emit(self, *iter);
     }
 
-    if (self->packer != NULL) {
-        gw_vlist_packer_alloc(self->packer, 0);
-    } else {
-        char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-        *pnt = 0;
-    }
+    gw_vlist_writer_emit(self, 0);
 }
 
 void gw_vlist_writer_append_mvl9_string(GwVlistWriter *self, const char *str)
@@ -223,12 +213,7 @@ void gw_vlist_writer_append_mvl9_string(GwVlistWriter *self, const char *str)
         } else {
             accum |= recoded_bit;
 
-            if (self->packer != NULL) {
-                gw_vlist_packer_alloc(self->packer, accum);
-            } else {
-                char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-                *pnt = accum;
-            }
+            gw_vlist_writer_emit(self, accum);
 
             which = 0;
             accum = 0;
@@ -244,11 +229,17 @@ void gw_vlist_writer_append_mvl9_string(GwVlistWriter *self, const char *str)
         accum |= recoded_bit;
     }
 
-    if (self->packer != NULL) {
-        gw_vlist_packer_alloc(self->packer, accum);
-    } else {
-        char *pnt = gw_vlist_alloc(&self->vlist, TRUE, self->compression_level);
-        *pnt = accum;
+    gw_vlist_writer_emit(self, accum);
+}
+
+// Appends bytes that were already encoded by the other append functions.
+void gw_vlist_writer_append_bytes(GwVlistWriter *self, const guint8 *bytes, gsize len)
+{
+    g_return_if_fail(GW_IS_VLIST_WRITER(self));
+    g_return_if_fail(bytes != NULL || len == 0);
+
+    for (gsize i = 0; i < len; i++) {
+        gw_vlist_writer_emit(self, bytes[i]);
     }
 }
 
@@ -13,6 +13,7 @@ GwVlistWriter *gw_vlist_writer_new(gint compression_level, gboolean prepack);
 void gw_vlist_writer_append_uv32(GwVlistWriter *self, guint32 value);
 void gw_vlist_writer_append_string(GwVlistWriter *self, const gchar *str);
 void gw_vlist_writer_append_mvl9_string(GwVlistWriter *self, const char *str);
+void gw_vlist_writer_append_bytes(GwVlistWriter *self, const guint8 *bytes, gsize len);
 
 GwVlist *gw_vlist_writer_finish(GwVlistWriter *self);
 
@@ -1,5 +1,30 @@
 #include "gw-vlist.h"
 #include <zlib.h>
+#include <lz4.h>
+
+/* the size word in front of compressed data flags the codec in its top bit */
+#define COMPRESSED_LZ4 (0x80000000u)
+#define COMPRESSED_SIZE_MASK (~COMPRESSED_LZ4)
+
+/* smaller blocks are compressed right away, handing them to another thread
+   costs more than compressing them */
+#define BACKGROUND_COMPRESSION_MIN_SIZE (4096)
+
+/* blocks that are compressed by the background threads stay in their list
+   uncompressed until the thread that appends to the list swaps them */
+typedef struct
+{
+    GwVlist *block;
+    GwVlist *compressed;
+    gint compression_level;
+    gboolean done;
+} CompressJob;
+
+static GMutex compress_lock;
+static GCond compress_cond;
+static GHashTable *compress_jobs; /* GwVlist* -> CompressJob* */
+static GThreadPool *compress_pool;
+static gint compress_jobs_pending;
 
 /* create / destroy */
 GwVlist *gw_vlist_create(unsigned int element_size)
@@ -11,8 +36,12 @@ GwVlist *gw_vlist_create(unsigned int element_size)
     return v;
 }
 
+static void gw_vlist_collect(GwVlist **v, gboolean wait);
+
 void gw_vlist_destroy(GwVlist *self)
 {
+    gw_vlist_collect(&self, TRUE);
+
     while (self != NULL) {
         GwVlist *vt = self->next;
         g_free(self);
@@ -20,72 +49,218 @@ void gw_vlist_destroy(GwVlist *self)
     }
 }
 
+/* number of bytes in use behind the header of a block */
+static gsize gw_vlist_block_length(GwVlist *block)
+{
+    if ((int)block->offset < 0) {
+        unsigned int *ipnt = (unsigned int *)(block + 1);
+        return sizeof(unsigned int) + (ipnt[0] & COMPRESSED_SIZE_MASK);
+    }
+
+    return block->offset * block->element_size;
+}
+
 /* realtime compression/decompression of bytewise vlists
  * this can obviously be extended if elem_siz > 1, but
- * the viewer doesn't need that feature
+ * the viewer doesn't need that feature.
+ * levels 0-9 select zlib, GW_VLIST_COMPRESSION_LZ4 selects lz4.
+ * returns NULL if the block doesn't shrink.
  */
-static GwVlist *gw_vlist_compress_block(GwVlist *v, guint *rsize, gint compression_level)
+static GwVlist *gw_vlist_compress_copy(GwVlist *v, gint compression_level)
 {
     if (v->size <= 32) {
-        return v;
+        return NULL;
     }
 
-    GwVlist *vz;
+    GwVlist *vz = NULL;
     unsigned int *ipnt;
-    char *dmem = g_malloc(compressBound(v->size));
-    unsigned long destlen = v->size;
-    int rc;
+    unsigned long destlen;
+    gboolean ok;
+    unsigned int flags = 0;
+    char *dmem;
+
+    if (compression_level == GW_VLIST_COMPRESSION_LZ4) {
+        int bound = LZ4_compressBound(v->size);
+        dmem = g_malloc(bound);
+        int rc = LZ4_compress_default((const char *)(v + 1), dmem, v->size, bound);
+        ok = rc > 0;
+        destlen = rc;
+        flags = COMPRESSED_LZ4;
+    } else {
+        destlen = compressBound(v->size);
+        dmem = g_malloc(destlen);
+        int rc = compress2((unsigned char *)dmem,
+                           &destlen,
+                           (unsigned char *)(v + 1),
+                           v->size,
+                           compression_level);
+        ok = rc == Z_OK;
+    }
 
-    rc = compress2((unsigned char *)dmem,
-                   &destlen,
-                   (unsigned char *)(v + 1),
-                   v->size,
-                   compression_level);
-    if ((rc == Z_OK) && ((destlen + sizeof(int)) < v->size)) {
+    if (ok && ((destlen + sizeof(int)) < v->size)) {
         /* printf("siz: %d, dest: %d rc: %d\n", v->siz, (int)destlen, rc); */
 
-        vz = g_malloc(*rsize = sizeof(GwVlist) + sizeof(int) + destlen);
+        vz = g_malloc(sizeof(GwVlist) + sizeof(int) + destlen);
         memcpy(vz, v, sizeof(GwVlist));
 
         ipnt = (unsigned int *)(vz + 1);
-        ipnt[0] = destlen;
+        ipnt[0] = destlen | flags;
         memcpy(&ipnt[1], dmem, destlen);
         vz->offset = (unsigned int)(-(int)v->offset); /* neg value signified compression */
-        g_free(v);
-        v = vz;
     }
 
     g_free(dmem);
 
-    return (v);
+    return vz;
+}
+
+static GwVlist *gw_vlist_compress_block(GwVlist *v, gint compression_level)
+{
+    GwVlist *vz = gw_vlist_compress_copy(v, compression_level);
+
+    if (vz == NULL) {
+        return v;
+    }
+
+    g_free(v);
+    return vz;
+}
+
+static void gw_vlist_compress_job(gpointer data, gpointer user_data)
+{
+    CompressJob *job = data;
+    (void)user_data;
+
+    GwVlist *compressed = gw_vlist_compress_copy(job->block, job->compression_level);
+
+    g_mutex_lock(&compress_lock);
+    job->compressed = compressed;
+    job->done = TRUE;
+    g_cond_broadcast(&compress_cond);
+    g_mutex_unlock(&compress_lock);
+}
+
+/* returns FALSE if the block has to be compressed by the caller */
+static gboolean gw_vlist_compress_in_background(GwVlist *v, gint compression_level)
+{
+    static gsize init = 0;
+
+    if (v->size < BACKGROUND_COMPRESSION_MIN_SIZE) {
+        return FALSE;
+    }
+
+    if (g_once_init_enter(&init)) {
+        guint n_threads = g_get_num_processors();
+        if (n_threads > 1) {
+            compress_jobs = g_hash_table_new(g_direct_hash, g_direct_equal);
+            compress_pool =
+                g_thread_pool_new(gw_vlist_compress_job, NULL, n_threads - 1, FALSE, NULL);
+        }
+        g_once_init_leave(&init, 1);
+    }
+
+    if (compress_pool == NULL) {
+        return FALSE;
+    }
+
+    CompressJob *job = g_new0(CompressJob, 1);
+    job->block = v;
+    job->compression_level = compression_level;
+
+    g_mutex_lock(&compress_lock);
+    g_hash_table_insert(compress_jobs, v, job);
+    g_atomic_int_inc(&compress_jobs_pending);
+    g_mutex_unlock(&compress_lock);
+
+    g_thread_pool_push(compress_pool, job, NULL);
+
+    return TRUE;
+}
+
+/* swaps the blocks of the list that were compressed in the background.
+   without wait only the blocks that are already done are swapped.
+ */
+static void gw_vlist_collect(GwVlist **v, gboolean wait)
+{
+    if (g_atomic_int_get(&compress_jobs_pending) == 0) {
+        return;
+    }
+
+    g_mutex_lock(&compress_lock);
+
+    GwVlist **link = v;
+    while (*link != NULL) {
+        GwVlist *block = *link;
+        CompressJob *job = g_hash_table_lookup(compress_jobs, block);
+
+        if (job != NULL && wait) {
+            while (!job->done) {
+                g_cond_wait(&compress_cond, &compress_lock);
+            }
+        }
+
+        if (job != NULL && job->done) {
+            g_hash_table_remove(compress_jobs, block);
+            g_atomic_int_add(&compress_jobs_pending, -1);
+
+            if (job->compressed != NULL) {
+                job->compressed->next = block->next;
+                *link = job->compressed;
+                g_free(block);
+            }
+            g_free(job);
+        }
+
+        link = &(*link)->next;
+    }
+
+    g_mutex_unlock(&compress_lock);
+}
+
+/* returns an uncompressed copy of a compressed block */
+static GwVlist *gw_vlist_uncompress_block(GwVlist *vl)
+{
+    GwVlist *vz = g_malloc(sizeof(GwVlist) + vl->size);
+    unsigned int *ipnt;
+    unsigned long sourcelen, destlen;
+    int rc;
+
+    memcpy(vz, vl, sizeof(GwVlist));
+    vz->offset = (unsigned int)(-(int)vl->offset);
+
+    ipnt = (unsigned int *)(vl + 1);
+    sourcelen = (unsigned long)(ipnt[0] & COMPRESSED_SIZE_MASK);
+    destlen = (unsigned long)vl->size;
+
+    if (ipnt[0] & COMPRESSED_LZ4) {
+        int n = LZ4_decompress_safe((const char *)&ipnt[1],
+                                    (char *)(vz + 1),
+                                    sourcelen,
+                                    destlen);
+        rc = n == (int)destlen ? Z_OK : Z_DATA_ERROR;
+    } else {
+        rc = uncompress((unsigned char *)(vz + 1),
+                        &destlen,
+                        (unsigned char *)&ipnt[1],
+                        sourcelen);
+    }
+    if (rc != Z_OK) {
+        g_error("Error in vlist uncompress(), rc=%d/destlen=%d exiting!", rc, (int)destlen);
+    }
+
+    return vz;
 }
 
 void gw_vlist_uncompress(GwVlist **v)
 {
+    gw_vlist_collect(v, TRUE);
+
     GwVlist *vl = *v;
     GwVlist *vprev = NULL;
 
     while (vl != NULL) {
         if ((int)vl->offset < 0) {
-            GwVlist *vz = g_malloc(sizeof(GwVlist) + vl->size);
-            unsigned int *ipnt;
-            unsigned long sourcelen, destlen;
-            int rc;
-
-            memcpy(vz, vl, sizeof(GwVlist));
-            vz->offset = (unsigned int)(-(int)vl->offset);
-
-            ipnt = (unsigned int *)(vl + 1);
-            sourcelen = (unsigned long)ipnt[0];
-            destlen = (unsigned long)vl->size;
-
-            rc = uncompress((unsigned char *)(vz + 1),
-                            &destlen,
-                            (unsigned char *)&ipnt[1],
-                            sourcelen);
-            if (rc != Z_OK) {
-                g_error("Error in vlist uncompress(), rc=%d/destlen=%d exiting!", rc, (int)destlen);
-            }
+            GwVlist *vz = gw_vlist_uncompress_block(vl);
 
             g_free(vl);
             vl = vz;
@@ -102,6 +277,42 @@ void gw_vlist_uncompress(GwVlist **v)
     }
 }
 
+/* returns a flat, uncompressed copy of a bytewise vlist and leaves the list
+   itself as it is, so that it can be read again later.  only one block is
+   inflated at a time on top of the copy.
+ */
+GwVlist *gw_vlist_flatten_copy(GwVlist *self)
+{
+    gw_vlist_collect(&self, TRUE);
+
+    unsigned int offset = self->offset;
+    if ((int)offset < 0) {
+        offset = (unsigned int)(-(int)offset);
+    }
+
+    unsigned int siz = self->size - 1 + offset;
+    GwVlist *flat = g_malloc(sizeof(GwVlist) + (siz * self->element_size));
+    flat->next = NULL;
+    flat->size = 1; /* so that the only block starts at index 0 */
+    flat->offset = siz;
+    flat->element_size = self->element_size;
+
+    char *dst = (char *)(flat + 1);
+    for (GwVlist *iter = self; iter != NULL; iter = iter->next) {
+        unsigned int here = iter->size - 1;
+
+        if ((int)iter->offset < 0) {
+            GwVlist *vz = gw_vlist_uncompress_block(iter);
+            memcpy(dst + (here * self->element_size), vz + 1, vz->offset * self->element_size);
+            g_free(vz);
+        } else {
+            memcpy(dst + (here * self->element_size), iter + 1, iter->offset * self->element_size);
+        }
+    }
+
+    return flat;
+}
+
 /* get pointer to one unit of space
  */
 void *gw_vlist_alloc(GwVlist **v, gboolean compressable, gint compression_level)
@@ -111,16 +322,18 @@ void *gw_vlist_alloc(GwVlist **v, gboolean compressable, gint compression_level)
     GwVlist *v2;
 
     if (vl->offset == vl->size) {
-        unsigned int siz, rsiz;
+        unsigned int siz;
 
         /* 2 times versions are the growable, indexable vlists */
         siz = 2 * vl->size;
 
-        rsiz = sizeof(GwVlist) + (vl->size * vl->element_size);
-
         if (compressable && vl->element_size == 1) {
             if (compression_level >= 0) {
-                vl = gw_vlist_compress_block(vl, &rsiz, compression_level);
+                gw_vlist_collect(&vl->next, FALSE);
+
+                if (!gw_vlist_compress_in_background(vl, compression_level)) {
+                    vl = gw_vlist_compress_block(vl, compression_level);
+                }
             }
         }
 
@@ -169,16 +382,54 @@ void *gw_vlist_locate(GwVlist *self, unsigned int idx)
     return ((void *)(((char *)(self)) + sizeof(GwVlist) + (idx * self->element_size)));
 }
 
+/* copies all blocks of an uncompressed vlist into a single block, which
+   turns vlist_locate() into a plain array index.  no more elements may
+   be added afterwards.
+ */
+void gw_vlist_flatten(GwVlist **v)
+{
+    GwVlist *vl = *v;
+
+    if (vl->next == NULL && vl->size == 1) {
+        return; /* already flat */
+    }
+
+    for (GwVlist *iter = vl; iter != NULL; iter = iter->next) {
+        if ((int)iter->offset < 0) {
+            return; /* compressed blocks have to be uncompressed first */
+        }
+    }
+
+    unsigned int siz = gw_vlist_size(vl);
+    GwVlist *flat = g_malloc(sizeof(GwVlist) + (siz * vl->element_size));
+    flat->next = NULL;
+    flat->size = 1; /* so that the only block starts at index 0 */
+    flat->offset = siz;
+    flat->element_size = vl->element_size;
+
+    char *dst = (char *)(flat + 1);
+    for (GwVlist *iter = vl; iter != NULL; iter = iter->next) {
+        unsigned int here = iter->size - 1;
+        memcpy(dst + (here * vl->element_size), iter + 1, iter->offset * vl->element_size);
+    }
+
+    gw_vlist_destroy(vl);
+    *v = flat;
+}
+
 /* calling this if you don't plan on adding any more elements will free
-   up unused space as well as compress final blocks (if enabled)
+   up unused space as well as compress final blocks (if enabled).
+   vlists of wider elements are flattened for constant time lookups.
  */
 void gw_vlist_freeze(GwVlist **v, gint compression_level)
 {
+    gw_vlist_collect(v, TRUE);
+
     GwVlist *vl = *v;
     unsigned int siz = vl->offset;
     unsigned int rsiz = sizeof(GwVlist) + (siz * vl->element_size);
 
-    if ((vl->element_size == 1) && (siz)) {
+    if ((vl->element_size == 1) && (siz) && (compression_level >= 0)) {
         GwVlist *w, *v2;
 
         if (vl->offset * 2 <= vl->size) /* Electric Fence, change < to <= */
@@ -191,8 +442,10 @@ void gw_vlist_freeze(GwVlist **v, gint compression_level)
             vl = *v;
         }
 
-        w = gw_vlist_compress_block(vl, &rsiz, compression_level);
+        w = gw_vlist_compress_block(vl, compression_level);
         *v = w;
+    } else if (vl->element_size != 1) {
+        gw_vlist_flatten(v);
     } else if (siz != vl->size) {
         GwVlist *w = g_malloc(rsiz);
         memcpy(w, vl, rsiz);
@@ -200,3 +453,86 @@ void gw_vlist_freeze(GwVlist **v, gint compression_level)
         *v = w;
     }
 }
+
+/* writes the used part of every block to a file, compressed blocks stay
+   compressed.  the layout is the block count followed by the header fields
+   and the data of each block, all in host byte order.
+ */
+gboolean gw_vlist_write(GwVlist *self, FILE *handle)
+{
+    gw_vlist_collect(&self, TRUE);
+
+    guint32 count = 0;
+    for (GwVlist *iter = self; iter != NULL; iter = iter->next) {
+        count++;
+    }
+
+    if (fwrite(&count, sizeof(count), 1, handle) != 1) {
+        return FALSE;
+    }
+
+    for (GwVlist *iter = self; iter != NULL; iter = iter->next) {
+        guint32 header[4] = {
+            iter->size,
+            iter->offset,
+            iter->element_size,
+            gw_vlist_block_length(iter),
+        };
+
+        if (fwrite(header, sizeof(header), 1, handle) != 1 ||
+            fwrite(iter + 1, 1, header[3], handle) != header[3]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* reads a vlist that was written by gw_vlist_write() and advances *data past
+   it.  returns NULL if the data ends too early.
+ */
+GwVlist *gw_vlist_read(const guint8 **data, const guint8 *end)
+{
+    const guint8 *pnt = *data;
+    guint32 count;
+
+    if ((gsize)(end - pnt) < sizeof(count)) {
+        return NULL;
+    }
+    memcpy(&count, pnt, sizeof(count));
+    pnt += sizeof(count);
+
+    GwVlist *head = NULL;
+    GwVlist **link = &head;
+
+    for (guint32 i = 0; i < count; i++) {
+        guint32 header[4];
+
+        if ((gsize)(end - pnt) < sizeof(header)) {
+            gw_vlist_destroy(head);
+            return NULL;
+        }
+        memcpy(header, pnt, sizeof(header));
+        pnt += sizeof(header);
+
+        if ((gsize)(end - pnt) < header[3]) {
+            gw_vlist_destroy(head);
+            return NULL;
+        }
+
+        GwVlist *block = g_malloc(sizeof(GwVlist) + header[3]);
+        block->next = NULL;
+        block->size = header[0];
+        block->offset = header[1];
+        block->element_size = header[2];
+        memcpy(block + 1, pnt, header[3]);
+        pnt += header[3];
+
+        *link = block;
+        link = &block->next;
+    }
+
+    *data = pnt;
+
+    return head;
+}
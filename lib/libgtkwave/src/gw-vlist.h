@@ -1,9 +1,13 @@
 #pragma once
 
 #include <glib.h>
+#include <stdio.h>
 
 typedef struct _GwVlist GwVlist;
 
+/* compression levels: -1 disables compression, 0-9 select the zlib level */
+#define GW_VLIST_COMPRESSION_LZ4 (10)
+
 struct _GwVlist
 {
     GwVlist *next;
@@ -17,5 +21,9 @@ void gw_vlist_destroy(GwVlist *v);
 void *gw_vlist_alloc(GwVlist **v, gboolean compressable, gint compression_level);
 guint gw_vlist_size(GwVlist *v);
 void *gw_vlist_locate(GwVlist *v, guint idx);
+void gw_vlist_flatten(GwVlist **v);
+GwVlist *gw_vlist_flatten_copy(GwVlist *v);
 void gw_vlist_freeze(GwVlist **v, gint compression_level);
 void gw_vlist_uncompress(GwVlist **v);
+gboolean gw_vlist_write(GwVlist *v, FILE *handle);
+GwVlist *gw_vlist_read(const guint8 **data, const guint8 *end);
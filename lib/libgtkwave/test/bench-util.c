@@ -0,0 +1,88 @@
+#include "bench-util.h"
+#include <stdio.h>
+
+#define BENCH_SIGNALS 64
+#define BENCH_ID(i) ('%' + (i)) /* skip '#' and '$' */
+
+gchar *bench_write_vcd(gsize target_size)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("bench-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+
+    FILE *f = fdopen(fd, "w");
+    g_assert_nonnull(f);
+
+    fprintf(f, "$timescale 1ns $end\n$scope module top $end\n");
+    for (gint i = 0; i < BENCH_SIGNALS; i++) {
+        if (i % 2 == 0) {
+            fprintf(f, "$var wire 1 %c s%d $end\n", BENCH_ID(i), i);
+        } else {
+            fprintf(f, "$var wire 32 %c v%d [31:0] $end\n", BENCH_ID(i), i);
+        }
+    }
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+    GRand *rand = g_rand_new_with_seed(1);
+    for (guint64 t = 0; (gsize)ftello(f) < target_size; t++) {
+        fprintf(f, "#%" G_GUINT64_FORMAT "\n", t * 10);
+        for (gint i = 0; i < BENCH_SIGNALS; i++) {
+            if (i % 2 == 0) {
+                fprintf(f, "%c%c\n", g_rand_boolean(rand) ? '1' : '0', BENCH_ID(i));
+            } else {
+                fprintf(f, "b");
+                guint32 value = g_rand_int(rand);
+                for (gint b = 31; b >= 0; b--) {
+                    fputc((value >> b) & 1 ? '1' : '0', f);
+                }
+                fprintf(f, " %c\n", BENCH_ID(i));
+            }
+        }
+    }
+    g_rand_free(rand);
+
+    fclose(f);
+
+    return filename;
+}
+
+#define BENCH_BUSES 16
+
+gchar *bench_write_bus_vcd(gsize target_size, guint width)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("bench-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+
+    FILE *f = fdopen(fd, "w");
+    g_assert_nonnull(f);
+
+    fprintf(f, "$timescale 1ns $end\n$scope module top $end\n");
+    for (gint i = 0; i < BENCH_BUSES; i++) {
+        fprintf(f, "$var wire %u %c bus%d [%u:0] $end\n", width, BENCH_ID(i), i, width - 1);
+    }
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+    GRand *rand = g_rand_new_with_seed(1);
+    for (guint64 t = 0; (gsize)ftello(f) < target_size; t++) {
+        fprintf(f, "#%" G_GUINT64_FORMAT "\n", t * 10);
+        for (gint i = 0; i < BENCH_BUSES; i++) {
+            fputc('b', f);
+            if (g_rand_int_range(rand, 0, 8) == 0) {
+                // Short values are extended to the full width by the loader.
+                fprintf(f, "%d", g_rand_int_range(rand, 0, 2));
+            } else {
+                for (guint b = 0; b < width; b++) {
+                    guint32 r = g_rand_int_range(rand, 0, 64);
+                    fputc(r == 0 ? 'x' : r == 1 ? 'z' : r & 1 ? '1' : '0', f);
+                }
+            }
+            fprintf(f, " %c\n", BENCH_ID(i));
+        }
+    }
+    g_rand_free(rand);
+
+    fclose(f);
+
+    return filename;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <glib.h>
+
+#define BENCH_DEFAULT_MB 64
+
+gchar *bench_write_vcd(gsize target_size);
+gchar *bench_write_bus_vcd(gsize target_size, guint width);
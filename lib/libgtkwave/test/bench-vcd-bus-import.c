@@ -0,0 +1,45 @@
+#include <gtkwave.h>
+#include <glib/gstdio.h>
+#include "bench-util.h"
+
+#define BUS_WIDTH 512
+
+int main(int argc, char *argv[])
+{
+    gsize size_mb = argc > 1 ? g_ascii_strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_MB;
+    gchar *filename = bench_write_bus_vcd(size_mb * 1024 * 1024, BUS_WIDTH);
+
+    GwLoader *loader = gw_vcd_loader_new();
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    GTimer *timer = g_timer_new();
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+    gdouble elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    guint64 values = 0;
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwNode *node = gw_facs_get(facs, i)->n;
+        for (GwHistEnt *iter = node->head.next; iter != NULL; iter = iter->next) {
+            values++;
+        }
+    }
+
+    gdouble gbits = (gdouble)values * BUS_WIDTH / 1e9;
+
+    g_print("bus width:   %d bits\n", BUS_WIDTH);
+    g_print("values:      %" G_GUINT64_FORMAT "\n", values);
+    g_print("import:      %.3f s (%.2f Gbit/s)\n", elapsed, gbits / elapsed);
+
+    g_object_unref(file);
+
+    g_unlink(filename);
+    g_free(filename);
+
+    return EXIT_SUCCESS;
+}
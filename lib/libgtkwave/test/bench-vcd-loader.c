@@ -0,0 +1,48 @@
+#include <gtkwave.h>
+#include <glib/gstdio.h>
+#include "bench-util.h"
+
+static gdouble load(const gchar *filename, gboolean use_mmap)
+{
+    GwLoader *loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_use_mmap(GW_VCD_LOADER(loader), use_mmap);
+
+    GTimer *timer = g_timer_new();
+
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+
+    gdouble elapsed = g_timer_elapsed(timer, NULL);
+
+    g_timer_destroy(timer);
+    g_object_unref(file);
+    g_object_unref(loader);
+
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    gsize size_mb = argc > 1 ? g_ascii_strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_MB;
+    gchar *filename = bench_write_vcd(size_mb * 1024 * 1024);
+
+    GStatBuf st;
+    g_assert_cmpint(g_stat(filename, &st), ==, 0);
+    gdouble gb = (gdouble)st.st_size / (1024.0 * 1024.0 * 1024.0);
+
+    // Load once to warm the page cache, so both runs read from memory.
+    load(filename, FALSE);
+
+    gdouble buffered = load(filename, FALSE);
+    gdouble mapped = load(filename, TRUE);
+
+    g_print("VCD size:  %.1f MB\n", gb * 1024.0);
+    g_print("buffered:  %.3f s (%.3f GB/s)\n", buffered, gb / buffered);
+    g_print("mmap:      %.3f s (%.3f GB/s)\n", mapped, gb / mapped);
+
+    g_unlink(filename);
+    g_free(filename);
+
+    return EXIT_SUCCESS;
+}
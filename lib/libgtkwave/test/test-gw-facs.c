@@ -64,12 +64,96 @@ static void test_sort()
     g_assert_cmpstr(gw_facs_get(facs, 4)->name, ==, "c");
 }
 
+static gboolean ends_with_7(GwSymbol *symbol, gpointer user_data)
+{
+    g_atomic_int_inc((gint *)user_data);
+
+    return g_str_has_suffix(symbol->name, "7");
+}
+
+static void test_find()
+{
+    // Enough facs to be searched by several threads.
+    const guint length = 50000;
+
+    GwSymbol *symbols = g_new0(GwSymbol, length);
+    GwFacs *facs = gw_facs_new(length);
+    for (guint i = 0; i < length; i++) {
+        // Every 1000th name is duplicated by the following fac.
+        guint n = i % 1000 == 1 ? i - 1 : i;
+        symbols[i].name = g_strdup_printf("top.sig%05u", n);
+        gw_facs_set(facs, i, &symbols[i]);
+    }
+
+    gint calls = 0;
+    GPtrArray *matches = gw_facs_find(facs, ends_with_7, &calls, 0);
+    g_assert_cmpint(matches->len, ==, length / 10);
+    for (guint i = 0; i < matches->len; i++) {
+        GwSymbol *symbol = g_ptr_array_index(matches, i);
+        g_assert_true(symbol == &symbols[i * 10 + 7]);
+    }
+    g_assert_cmpint(calls, ==, length - length / 1000);
+    g_ptr_array_free(matches, TRUE);
+
+    // A limited search returns the first matches.
+    matches = gw_facs_find(facs, ends_with_7, &calls, 25);
+    g_assert_cmpint(matches->len, ==, 25);
+    for (guint i = 0; i < matches->len; i++) {
+        GwSymbol *symbol = g_ptr_array_index(matches, i);
+        g_assert_true(symbol == &symbols[i * 10 + 7]);
+    }
+    g_ptr_array_free(matches, TRUE);
+
+    g_object_unref(facs);
+    for (guint i = 0; i < length; i++) {
+        g_free(symbols[i].name);
+    }
+    g_free(symbols);
+}
+
+static void test_lookup()
+{
+    GwSymbol *symbols = g_new0(GwSymbol, 4);
+    symbols[0].name = "a";
+    symbols[1].name = "a.b[3:0]";
+    symbols[2].name = "a.c";
+    symbols[3].name = "a.c";
+
+    GwFacs *facs = gw_facs_new(4);
+    for (gint i = 0; i < 4; i++) {
+        gw_facs_set(facs, i, &symbols[i]);
+    }
+
+    g_assert_true(gw_facs_lookup(facs, "a") == &symbols[0]);
+    g_assert_true(gw_facs_lookup(facs, "a.b[3:0]") == &symbols[1]);
+    g_assert_true(gw_facs_lookup(facs, "a.c") == &symbols[2]);
+    g_assert_null(gw_facs_lookup(facs, "a.b"));
+
+    const gchar *names[] = {"a.c", NULL, "x", "a.b[3:0]"};
+    GwSymbol *found[G_N_ELEMENTS(names)];
+    g_assert_cmpuint(gw_facs_lookup_many(facs, names, G_N_ELEMENTS(names), found), ==, 2);
+    g_assert_true(found[0] == &symbols[2]);
+    g_assert_null(found[1]);
+    g_assert_null(found[2]);
+    g_assert_true(found[3] == &symbols[1]);
+
+    // Changing the facs rebuilds the index.
+    gw_facs_set(facs, 0, &symbols[3]);
+    g_assert_null(gw_facs_lookup(facs, "a"));
+    g_assert_true(gw_facs_lookup(facs, "a.c") == &symbols[3]);
+
+    g_object_unref(facs);
+    g_free(symbols);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/facs/order_from_tree", test_order_from_tree);
     g_test_add_func("/facs/sort", test_sort);
+    g_test_add_func("/facs/find", test_find);
+    g_test_add_func("/facs/lookup", test_lookup);
 
     return g_test_run();
 }
\ No newline at end of file
@@ -1,4 +1,15 @@
 #include <gtkwave.h>
+#include <glib/gstdio.h>
+#include <fstapi.h>
+
+#define MULTI_BLOCK_SIGNALS 16
+#define MULTI_BLOCK_STEPS 2000
+
+typedef struct
+{
+    GwTime time;
+    gchar value[9];
+} Change;
 
 static void test_enum()
 {
@@ -39,12 +50,307 @@ static void test_error_file_not_found()
     g_object_unref(loader);
 }
 
+// Writes a file with many value change blocks and records the changes of
+// each signal, with repeated values removed. With repack set, the writer
+// compresses the whole file on close.
+static gchar *write_multi_block_file(GArray **expected, gint *lens, gboolean repack)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("gtkwave-XXXXXX.fst", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+
+    void *writer = fstWriterCreate(filename, 1);
+    g_assert_nonnull(writer);
+    fstWriterSetRepackOnClose(writer, repack);
+    fstWriterSetTimescale(writer, -9);
+    fstWriterSetScope(writer, FST_ST_VCD_MODULE, "top", NULL);
+
+    fstHandle handles[MULTI_BLOCK_SIGNALS];
+
+    for (gint i = 0; i < MULTI_BLOCK_SIGNALS; i++) {
+        gchar *name = g_strdup_printf("s%d", i);
+        lens[i] = i % 4 == 3 ? 8 : 1;
+        handles[i] =
+            fstWriterCreateVar(writer, FST_VT_VCD_WIRE, FST_VD_IMPLICIT, lens[i], name, 0);
+        expected[i] = g_array_new(FALSE, FALSE, sizeof(Change));
+        g_free(name);
+    }
+    fstWriterSetUpscope(writer);
+
+    GRand *rand = g_rand_new_with_seed(1);
+    GwTime time = 0;
+
+    for (gint step = 0; step < MULTI_BLOCK_STEPS; step++) {
+        fstWriterEmitTimeChange(writer, time);
+
+        for (gint i = 0; i < MULTI_BLOCK_SIGNALS; i++) {
+            if (step > 0 && g_rand_int_range(rand, 0, 4) != 0) {
+                continue;
+            }
+
+            Change change = {.time = time};
+            for (gint j = 0; j < lens[i]; j++) {
+                change.value[j] = "01xz"[g_rand_int_range(rand, 0, step % 7 == 0 ? 4 : 2)];
+            }
+            fstWriterEmitValueChange(writer, handles[i], change.value);
+
+            GArray *changes = expected[i];
+            if (changes->len == 0 ||
+                strcmp(g_array_index(changes, Change, changes->len - 1).value, change.value) != 0) {
+                g_array_append_val(changes, change);
+            }
+        }
+
+        if (step % 100 == 99) {
+            fstWriterFlushContext(writer);
+        }
+        time += g_rand_int_range(rand, 1, 4);
+    }
+
+    fstWriterClose(writer);
+    g_rand_free(rand);
+
+    return filename;
+}
+
+static GwDumpFile *load_multi_block_file(const gchar *filename, gboolean use_mmap)
+{
+    GwLoader *loader = gw_fst_loader_new();
+    gw_fst_loader_set_use_mmap(GW_FST_LOADER(loader), use_mmap);
+
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    g_assert_cmpint(gw_facs_get_length(facs), ==, MULTI_BLOCK_SIGNALS);
+
+    return file;
+}
+
+static gint symbol_index(GwSymbol *symbol)
+{
+    g_assert_true(g_str_has_prefix(symbol->name, "top.s"));
+    return atoi(symbol->name + strlen("top.s"));
+}
+
+static void assert_value(GwHistEnt *h, const Change *change, gint len)
+{
+    for (gint j = 0; j < len; j++) {
+        GwBit bit = len > 1 ? h->v.h_vector[j] : h->v.h_val;
+        g_assert_cmpint(bit, ==, gw_bit_from_char(change->value[j]));
+    }
+}
+
+// Checks that the imported history matches the written changes exactly.
+static void assert_all_changes(GwDumpFile *file, GArray **expected, gint *lens)
+{
+    GwFacs *facs = gw_dump_file_get_facs(file);
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwSymbol *symbol = gw_facs_get(facs, i);
+        gint index = symbol_index(symbol);
+        GArray *changes = expected[index];
+
+        guint n = 0;
+        for (GwHistEnt *h = symbol->n->head.next; h != NULL; h = h->next) {
+            if (h->time < 0 || h->time >= GW_TIME_MAX - 1) {
+                continue;
+            }
+
+            g_assert_cmpuint(n, <, changes->len);
+            Change *change = &g_array_index(changes, Change, n);
+            g_assert_cmpint(h->time, ==, change->time);
+            assert_value(h, change, lens[index]);
+            n++;
+        }
+        g_assert_cmpuint(n, ==, changes->len);
+    }
+}
+
+static void free_expected(GArray **expected)
+{
+    for (gint i = 0; i < MULTI_BLOCK_SIGNALS; i++) {
+        g_array_free(expected[i], TRUE);
+    }
+}
+
+// Writes a file with many value change blocks, so the import is spread over
+// several readers, and checks the result against the written changes.
+static void test_multiple_blocks(void)
+{
+    GArray *expected[MULTI_BLOCK_SIGNALS];
+    gint lens[MULTI_BLOCK_SIGNALS];
+    gchar *filename = write_multi_block_file(expected, lens, FALSE);
+
+    GwDumpFile *file = load_multi_block_file(filename, TRUE);
+    g_assert_true(gw_dump_file_import_all(file, NULL));
+    assert_all_changes(file, expected, lens);
+
+    free_expected(expected);
+    g_object_unref(file);
+    g_unlink(filename);
+    g_free(filename);
+}
+
+// The same import has to come out of the stdio reads used without a mapping.
+static void test_multiple_blocks_without_mmap(void)
+{
+    GArray *expected[MULTI_BLOCK_SIGNALS];
+    gint lens[MULTI_BLOCK_SIGNALS];
+    gchar *filename = write_multi_block_file(expected, lens, FALSE);
+
+    GwDumpFile *file = load_multi_block_file(filename, FALSE);
+    g_assert_true(gw_dump_file_import_all(file, NULL));
+    assert_all_changes(file, expected, lens);
+
+    free_expected(expected);
+    g_object_unref(file);
+    g_unlink(filename);
+    g_free(filename);
+}
+
+// A repacked file is read through a seek index instead of being inflated to
+// disk. The index is saved next to the trace and kept for later readers in
+// the same process, so a second open neither rebuilds nor rewrites it.
+static void test_repacked(void)
+{
+    GArray *expected[MULTI_BLOCK_SIGNALS];
+    gint lens[MULTI_BLOCK_SIGNALS];
+    gchar *filename = write_multi_block_file(expected, lens, FALSE);
+
+    GArray *repacked_expected[MULTI_BLOCK_SIGNALS];
+    gint repacked_lens[MULTI_BLOCK_SIGNALS];
+    gchar *repacked_filename = write_multi_block_file(repacked_expected, repacked_lens, TRUE);
+    gchar *index_filename = g_strconcat(repacked_filename, ".zidx", NULL);
+
+    GwDumpFile *file = load_multi_block_file(filename, TRUE);
+    g_assert_true(gw_dump_file_import_all(file, NULL));
+    assert_all_changes(file, expected, lens);
+
+    for (gint pass = 0; pass < 2; pass++) {
+        GwDumpFile *repacked = load_multi_block_file(repacked_filename, TRUE);
+        g_assert_true(gw_dump_file_import_all(repacked, NULL));
+        assert_all_changes(repacked, expected, lens);
+
+        // Both files have to hold the same history.
+        GwFacs *facs = gw_dump_file_get_facs(file);
+        GwFacs *repacked_facs = gw_dump_file_get_facs(repacked);
+        for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+            GwHistEnt *h = gw_facs_get(facs, i)->n->head.next;
+            GwHistEnt *r = gw_facs_get(repacked_facs, i)->n->head.next;
+            gint len = lens[symbol_index(gw_facs_get(facs, i))];
+
+            for (; h != NULL && r != NULL; h = h->next, r = r->next) {
+                g_assert_cmpint(h->time, ==, r->time);
+                if (len > 1) {
+                    g_assert_cmpmem(h->v.h_vector, len, r->v.h_vector, len);
+                } else {
+                    g_assert_cmpint(h->v.h_val, ==, r->v.h_val);
+                }
+            }
+            g_assert_null(h);
+            g_assert_null(r);
+        }
+        g_object_unref(repacked);
+
+        if (pass == 0) {
+            // The second open has to take the index from the process-wide cache.
+            g_assert_true(g_file_test(index_filename, G_FILE_TEST_EXISTS));
+            g_unlink(index_filename);
+        } else {
+            g_assert_false(g_file_test(index_filename, G_FILE_TEST_EXISTS));
+        }
+    }
+
+    free_expected(expected);
+    free_expected(repacked_expected);
+    g_object_unref(file);
+    g_unlink(filename);
+    g_unlink(repacked_filename);
+    g_free(filename);
+    g_free(repacked_filename);
+    g_free(index_filename);
+}
+
+static void test_import_window(void)
+{
+    GArray *expected[MULTI_BLOCK_SIGNALS];
+    gint lens[MULTI_BLOCK_SIGNALS];
+    gchar *filename = write_multi_block_file(expected, lens, FALSE);
+
+    GwDumpFile *file = load_multi_block_file(filename, TRUE);
+    GwFacs *facs = gw_dump_file_get_facs(file);
+
+    GwTimeRange *window = gw_time_range_new(1500, 2500);
+    gw_fst_file_set_import_window(GW_FST_FILE(file), window);
+    g_object_unref(window);
+    g_assert_true(gw_dump_file_import_all(file, NULL));
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwSymbol *symbol = gw_facs_get(facs, i);
+        gint index = symbol_index(symbol);
+        GArray *changes = expected[index];
+
+        GwTime start = 0;
+        GwTime end = 0;
+        g_assert_true(gw_fst_file_get_trace_window(GW_FST_FILE(file), symbol->n, &start, &end));
+        g_assert_cmpint(start, ==, 1500);
+        g_assert_cmpint(end, ==, 2500);
+
+        // The value at any time inside the window has to be right.
+        GwHistEnt *h = symbol->n->head.next;
+        guint n = 0;
+        for (GwTime time = start; time <= end; time++) {
+            while (h->next->time <= time) {
+                h = h->next;
+            }
+            while (n + 1 < changes->len && g_array_index(changes, Change, n + 1).time <= time) {
+                n++;
+            }
+            assert_value(h, &g_array_index(changes, Change, n), lens[index]);
+        }
+
+        // The blocks at the end of the file are skipped.
+        while (h->next->time < GW_TIME_MAX - 1) {
+            h = h->next;
+        }
+        g_assert_cmpint(h->time, <, g_array_index(changes, Change, changes->len - 1).time);
+    }
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwNode *node = gw_facs_get(facs, i)->n;
+        g_assert_true(gw_dump_file_unload_trace(file, node));
+        g_assert_nonnull(node->mv.mvlfac);
+    }
+
+    gw_fst_file_set_import_window(GW_FST_FILE(file), NULL);
+    g_assert_true(gw_dump_file_import_all(file, NULL));
+    assert_all_changes(file, expected, lens);
+
+    GwTime start = 0;
+    GwTime end = 0;
+    GwNode *node = gw_facs_get(facs, 0)->n;
+    g_assert_false(gw_fst_file_get_trace_window(GW_FST_FILE(file), node, &start, &end));
+
+    free_expected(expected);
+    g_object_unref(file);
+    g_unlink(filename);
+    g_free(filename);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/fst_loader/enum", test_enum);
     g_test_add_func("/fst_loader/error_file_not_found", test_error_file_not_found);
+    g_test_add_func("/fst_loader/multiple_blocks", test_multiple_blocks);
+    g_test_add_func("/fst_loader/multiple_blocks_without_mmap", test_multiple_blocks_without_mmap);
+    g_test_add_func("/fst_loader/repacked", test_repacked);
+    g_test_add_func("/fst_loader/import_window", test_import_window);
 
     return g_test_run();
 }
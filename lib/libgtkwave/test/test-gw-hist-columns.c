@@ -0,0 +1,289 @@
+#include <gtkwave.h>
+
+#define NUM_ENTRIES 1000
+
+typedef struct
+{
+    GwNode node;
+    GwHistEnt entries[NUM_ENTRIES];
+    gchar vectors[NUM_ENTRIES][4];
+    GwHistEnt *harray[NUM_ENTRIES + 1];
+} History;
+
+// Builds a history with the usual entries at negative times in front and an
+// end cap, some entries share the same time.
+static History *history_new(gboolean vector)
+{
+    History *history = g_new0(History, 1);
+    GwNode *node = &history->node;
+
+    node->head.time = -2;
+    node->head.v.h_val = GW_BIT_X;
+    if (vector) {
+        node->msi = 3;
+        node->lsi = 0;
+        node->extvals = 1;
+        node->head.v.h_vector = NULL;
+    }
+
+    GwHistEnt *prev = &node->head;
+    GwTime time = -1;
+    for (gint i = 0; i < NUM_ENTRIES; i++) {
+        GwHistEnt *h = &history->entries[i];
+
+        h->time = i == NUM_ENTRIES - 1 ? GW_TIME_MAX : time;
+        h->flags = i % 17 == 0 ? GW_HIST_ENT_FLAG_GLITCH : 0;
+        if (vector) {
+            for (gint b = 0; b < 4; b++) {
+                history->vectors[i][b] = (i * 7 + b) % GW_BIT_DASH;
+            }
+            h->v.h_vector = history->vectors[i];
+        } else {
+            h->v.h_val = (i * 5) % GW_BIT_DASH;
+        }
+
+        prev->next = h;
+        prev = h;
+        time += (i % 10 == 3) ? 0 : 1 + (i * 31) % 1000;
+    }
+
+    gint n = 0;
+    for (GwHistEnt *h = &node->head; h != NULL; h = h->next) {
+        history->harray[n++] = h;
+    }
+    node->harray = history->harray;
+    node->numhist = n;
+
+    return history;
+}
+
+static gint find_last_le(History *history, GwTime key)
+{
+    gint found = -1;
+    for (gint i = 0; i < history->node.numhist; i++) {
+        if (history->harray[i]->time <= key) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+static void assert_same_entry(GwHistIter *iter, History *history)
+{
+    GwHistEnt *h = history->harray[gw_hist_iter_get_index(iter)];
+
+    g_assert_cmpint(gw_hist_iter_get_time(iter), ==, h->time);
+    g_assert_cmpint(gw_hist_iter_get_flags(iter), ==, h->flags);
+    if (h->flags & GW_HIST_ENT_FLAG_STRING) {
+        g_assert_cmpstr(gw_hist_iter_get_string(iter), ==, h->v.h_vector);
+    } else if (h->flags & GW_HIST_ENT_FLAG_REAL) {
+        g_assert_cmpfloat(gw_hist_iter_get_real(iter), ==, h->v.h_double);
+    } else if (h == &history->node.head) {
+        // The head of a vector node has no value.
+    } else if (history->node.extvals) {
+        gchar vector[4];
+        if (h->v.h_vector == NULL) {
+            g_assert_false(gw_hist_iter_get_vector(iter, vector));
+        } else {
+            g_assert_true(gw_hist_iter_get_vector(iter, vector));
+            g_assert_cmpmem(vector, 4, h->v.h_vector, 4);
+        }
+    } else {
+        g_assert_cmpint(gw_hist_iter_get_value(iter), ==, h->v.h_val);
+    }
+}
+
+static void check_iter(History *history)
+{
+    GwHistIter iter;
+    gw_hist_iter_init(&iter, &history->node);
+
+    gint n = 0;
+    do {
+        g_assert_cmpint(gw_hist_iter_get_index(&iter), ==, n);
+        assert_same_entry(&iter, history);
+        n++;
+    } while (gw_hist_iter_next(&iter));
+    g_assert_cmpint(n, ==, history->node.numhist);
+
+    // Seeking moves forward to the entry that is active at the key.
+    gw_hist_iter_init(&iter, &history->node);
+    for (GwTime key = -3; key < 600000; key += 997) {
+        gw_hist_iter_seek(&iter, key);
+        g_assert_cmpint(gw_hist_iter_get_index(&iter), ==, MAX(find_last_le(history, key), 0));
+        assert_same_entry(&iter, history);
+    }
+
+    // Seeking never moves backwards.
+    guint index = gw_hist_iter_get_index(&iter);
+    gw_hist_iter_seek(&iter, 0);
+    g_assert_cmpint(gw_hist_iter_get_index(&iter), ==, index);
+
+    gw_hist_iter_init_at(&iter, &history->node, 500);
+    g_assert_cmpint(gw_hist_iter_get_index(&iter), ==, 500);
+    assert_same_entry(&iter, history);
+
+    GwTime next_time;
+    g_assert_true(gw_hist_iter_get_next_time(&iter, &next_time));
+    g_assert_cmpint(next_time, ==, history->harray[501]->time);
+
+    g_assert_true(gw_hist_iter_prev(&iter));
+    g_assert_cmpint(gw_hist_iter_get_index(&iter), ==, 499);
+    assert_same_entry(&iter, history);
+
+    gw_hist_iter_init_at(&iter, &history->node, history->node.numhist - 1);
+    g_assert_false(gw_hist_iter_get_next_time(&iter, &next_time));
+    g_assert_false(gw_hist_iter_next(&iter));
+
+    gw_hist_iter_init(&iter, &history->node);
+    g_assert_false(gw_hist_iter_prev(&iter));
+}
+
+static void test_scalar(void)
+{
+    History *history = history_new(FALSE);
+
+    // Without columns the histents are read.
+    check_iter(history);
+
+    GwHistColumns *columns = gw_hist_columns_new(&history->node);
+    g_assert_cmpint(gw_hist_columns_get_length(columns), ==, history->node.numhist);
+    g_assert_cmpint(gw_hist_columns_get_width(columns), ==, 0);
+
+    for (gint i = 0; i < history->node.numhist; i++) {
+        g_assert_cmpint(gw_hist_columns_get_time(columns, i), ==, history->harray[i]->time);
+    }
+    for (GwTime key = -5; key < 600000; key += 333) {
+        g_assert_cmpint(gw_hist_columns_find(columns, key), ==, find_last_le(history, key));
+    }
+
+    // The columns are a fraction of the size of the histents and the harray.
+    gsize hist_ent_size = history->node.numhist * (sizeof(GwHistEnt) + sizeof(GwHistEnt *));
+    g_assert_cmpuint(gw_hist_columns_get_memory_size(columns) * 4, <, hist_ent_size);
+
+    history->node.columns = columns;
+    check_iter(history);
+
+    gw_hist_columns_unref(columns);
+    g_free(history);
+}
+
+static void test_vector(void)
+{
+    History *history = history_new(TRUE);
+
+    check_iter(history);
+
+    GwHistColumns *columns = gw_hist_columns_new(&history->node);
+    g_assert_cmpint(gw_hist_columns_get_width(columns), ==, 4);
+
+    history->node.columns = columns;
+    check_iter(history);
+
+    // The head has no value that the loaders set.
+    GwHistIter iter;
+    gchar vector[4];
+    gw_hist_iter_init(&iter, &history->node);
+    g_assert_true(gw_hist_iter_get_vector(&iter, vector));
+    g_assert_cmpint(vector[0], ==, GW_BIT_X);
+
+    gw_hist_columns_unref(columns);
+    g_free(history);
+}
+
+static void test_real(void)
+{
+    History *history = history_new(FALSE);
+
+    // The head keeps its bit value like in the loaders.
+    for (gint i = 0; i < NUM_ENTRIES; i++) {
+        history->entries[i].flags |= GW_HIST_ENT_FLAG_REAL;
+        history->entries[i].v.h_double = i * 0.25 - 3.0;
+    }
+
+    GwHistColumns *columns = gw_hist_columns_new(&history->node);
+    history->node.columns = columns;
+    check_iter(history);
+
+    GwHistIter iter;
+    gw_hist_iter_init(&iter, &history->node);
+    g_assert_cmpint(gw_hist_iter_get_value(&iter), ==, GW_BIT_X);
+
+    gw_hist_columns_unref(columns);
+    g_free(history);
+}
+
+static void test_string(void)
+{
+    static const gchar *STRINGS[] = {"IDLE", "READ", "WRITE", ""};
+    History *history = history_new(FALSE);
+
+    for (gint i = 0; i < NUM_ENTRIES; i++) {
+        history->entries[i].flags |= GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING;
+        history->entries[i].v.h_vector = i == 0 ? NULL : (gchar *)STRINGS[i % 4];
+    }
+
+    GwHistColumns *columns = gw_hist_columns_new(&history->node);
+    history->node.columns = columns;
+    check_iter(history);
+
+    // Every distinct string is stored once.
+    g_assert_cmpuint(gw_hist_columns_get_memory_size(columns),
+                     <,
+                     history->node.numhist * (sizeof(guint32) + 8) + 1024);
+
+    gw_hist_columns_unref(columns);
+    g_free(history);
+}
+
+static void test_compact_nodes(void)
+{
+    History *history = history_new(TRUE);
+    History *expected = history_new(TRUE);
+
+    // An alias has a copy of the head of its target.
+    GwNode alias = history->node;
+    alias.harray = NULL;
+    history->node.harray = NULL;
+
+    GPtrArray *nodes = g_ptr_array_new();
+    g_ptr_array_add(nodes, &history->node);
+    g_ptr_array_add(nodes, &alias);
+    gw_hist_columns_compact_nodes(nodes);
+
+    g_assert_null(history->node.head.next);
+    g_assert_null(alias.head.next);
+    g_assert_nonnull(history->node.columns);
+    g_assert_true(alias.columns == history->node.columns);
+    g_assert_cmpint(history->node.numhist, ==, expected->node.numhist);
+
+    // The histents aren't needed anymore.
+    memset(history->entries, 0, sizeof(history->entries));
+
+    expected->node.columns = history->node.columns;
+    check_iter(expected);
+
+    // Compacting again leaves the columns alone.
+    GwHistColumns *columns = history->node.columns;
+    gw_hist_columns_compact_nodes(nodes);
+    g_assert_true(history->node.columns == columns);
+
+    gw_hist_columns_unref(alias.columns);
+    gw_hist_columns_unref(history->node.columns);
+    g_ptr_array_free(nodes, TRUE);
+    g_free(expected);
+    g_free(history);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/hist_columns/scalar", test_scalar);
+    g_test_add_func("/hist_columns/vector", test_vector);
+    g_test_add_func("/hist_columns/real", test_real);
+    g_test_add_func("/hist_columns/string", test_string);
+    g_test_add_func("/hist_columns/compact_nodes", test_compact_nodes);
+
+    return g_test_run();
+}
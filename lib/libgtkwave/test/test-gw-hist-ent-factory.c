@@ -0,0 +1,167 @@
+#include <gtkwave.h>
+
+static void test_alloc_vector(void)
+{
+    GwHistEntFactory *factory = gw_hist_ent_factory_new();
+
+    gchar *a = gw_hist_ent_factory_alloc_vector(factory, 5);
+    gchar *b = gw_hist_ent_factory_alloc_vector(factory, 7);
+    memcpy(a, "abcde", 5);
+    memcpy(b, "fghijkl", 7);
+
+    // Small vectors are packed back to back.
+    g_assert_true(b == a + 5);
+    g_assert_cmpmem(a, 12, "abcdefghijkl", 12);
+
+    g_object_unref(factory);
+}
+
+static void test_alloc_vector_large(void)
+{
+    GwHistEntFactory *factory = gw_hist_ent_factory_new();
+
+    for (gint i = 0; i < 64; i++) {
+        gsize len = 1000 + i * 1000;
+        gchar *v = gw_hist_ent_factory_alloc_vector(factory, len);
+        memset(v, 'x', len);
+    }
+
+    gchar *huge = gw_hist_ent_factory_alloc_vector(factory, 1024 * 1024);
+    memset(huge, 'z', 1024 * 1024);
+
+    g_object_unref(factory);
+}
+
+static void test_alloc_n(void)
+{
+    GwHistEntFactory *factory = gw_hist_ent_factory_new();
+
+    GwHistEnt *single = gw_hist_ent_factory_alloc(factory);
+    GwHistEnt *bulk = gw_hist_ent_factory_alloc_n(factory, 3);
+    GwHistEnt *next = gw_hist_ent_factory_alloc(factory);
+
+    // Bulk allocations are contiguous and taken from the same block.
+    g_assert_true(bulk == single + 1);
+    g_assert_true(next == bulk + 3);
+    for (gint i = 0; i < 3; i++) {
+        g_assert_cmpint(bulk[i].time, ==, 0);
+        g_assert_null(bulk[i].next);
+    }
+
+    // Large bulk allocations get their own block.
+    GwHistEnt *large = gw_hist_ent_factory_alloc_n(factory, 100000);
+    for (gint i = 0; i < 100000; i++) {
+        g_assert_cmpint(large[i].time, ==, 0);
+        large[i].time = i;
+    }
+
+    g_object_unref(factory);
+}
+
+static void test_get_size(void)
+{
+    GwHistEntFactory *factory = gw_hist_ent_factory_new();
+    g_assert_cmpuint(gw_hist_ent_factory_get_size(factory), ==, 0);
+
+    // Whole blocks are accounted, not the individual allocations.
+    gw_hist_ent_factory_alloc(factory);
+    gsize size = gw_hist_ent_factory_get_size(factory);
+    g_assert_cmpuint(size, >=, sizeof(GwHistEnt));
+
+    gw_hist_ent_factory_alloc(factory);
+    g_assert_cmpuint(gw_hist_ent_factory_get_size(factory), ==, size);
+
+    gw_hist_ent_factory_alloc_vector(factory, 1024 * 1024);
+    g_assert_cmpuint(gw_hist_ent_factory_get_size(factory), ==, size + 1024 * 1024);
+
+    g_object_unref(factory);
+}
+
+static void test_alternate_factories(void)
+{
+    GwHistEntFactory *factories[2] = {gw_hist_ent_factory_new(), gw_hist_ent_factory_new()};
+    GwHistEnt *last_hist_ent[2] = {NULL, NULL};
+    gchar *last_vector[2] = {NULL, NULL};
+    guint new_blocks = 0;
+
+    // Allocations that alternate between two factories keep using the blocks
+    // of each factory instead of starting a new block on every switch. A new
+    // block shows up as a gap to the previous allocation.
+    for (gint i = 0; i < 100000; i++) {
+        gint f = i % 2;
+
+        GwHistEnt *h = gw_hist_ent_factory_alloc(factories[f]);
+        if (last_hist_ent[f] != NULL && h != last_hist_ent[f] + 1) {
+            new_blocks++;
+        }
+        last_hist_ent[f] = h;
+
+        gchar *v = gw_hist_ent_factory_alloc_vector(factories[f], 8);
+        if (last_vector[f] != NULL && v != last_vector[f] + 8) {
+            new_blocks++;
+        }
+        last_vector[f] = v;
+    }
+
+    // 50000 histents and 400000 vector bytes per factory fit into a few dozen
+    // blocks, starting a new block on every switch would take 200000.
+    g_assert_cmpuint(new_blocks, <, 1000);
+
+    g_object_unref(factories[0]);
+    g_object_unref(factories[1]);
+}
+
+#define THREAD_ALLOCATIONS 100000
+
+static gint next_thread = 0;
+
+static gpointer alloc_thread(gpointer data)
+{
+    GwHistEntFactory *factory = data;
+    GwTime id = (GwTime)g_atomic_int_add(&next_thread, 1) * THREAD_ALLOCATIONS;
+
+    GwHistEnt **hist_ents = g_new(GwHistEnt *, THREAD_ALLOCATIONS);
+    for (gint i = 0; i < THREAD_ALLOCATIONS; i++) {
+        hist_ents[i] = i % 10 == 0 ? gw_hist_ent_factory_alloc_n(factory, 10)
+                                   : gw_hist_ent_factory_alloc(factory);
+        hist_ents[i]->time = id + i;
+    }
+
+    // No other thread got the same histents.
+    for (gint i = 0; i < THREAD_ALLOCATIONS; i++) {
+        g_assert_cmpint(hist_ents[i]->time, ==, id + i);
+    }
+
+    g_free(hist_ents);
+
+    return NULL;
+}
+
+static void test_alloc_threads(void)
+{
+    GwHistEntFactory *factory = gw_hist_ent_factory_new();
+
+    GThread *threads[8];
+    for (guint i = 0; i < G_N_ELEMENTS(threads); i++) {
+        threads[i] = g_thread_new("alloc", alloc_thread, factory);
+    }
+    for (guint i = 0; i < G_N_ELEMENTS(threads); i++) {
+        g_thread_join(threads[i]);
+    }
+
+    g_object_unref(factory);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/hist_ent_factory/alloc_vector", test_alloc_vector);
+    g_test_add_func("/hist_ent_factory/alloc_vector_large", test_alloc_vector_large);
+    g_test_add_func("/hist_ent_factory/alloc_n", test_alloc_n);
+    g_test_add_func("/hist_ent_factory/get_size", test_get_size);
+    g_test_add_func("/hist_ent_factory/alternate_factories", test_alternate_factories);
+    g_test_add_func("/hist_ent_factory/alloc_threads", test_alloc_threads);
+
+    return g_test_run();
+}
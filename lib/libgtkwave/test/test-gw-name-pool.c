@@ -0,0 +1,53 @@
+#include <gtkwave.h>
+
+static void test_add(void)
+{
+    GwNamePool *names = gw_name_pool_new();
+
+    gchar *name1 = gw_name_pool_add(names, "top.sig1");
+    gchar *name2 = gw_name_pool_add_len(names, "top.sig2[3:0]", 8);
+
+    g_assert_cmpstr(name1, ==, "top.sig1");
+    g_assert_cmpstr(name2, ==, "top.sig2");
+
+    // Names are copies, also of equal strings.
+
+    gchar *name3 = gw_name_pool_add(names, "top.sig1");
+    g_assert_true(name3 != name1);
+    g_assert_cmpstr(name3, ==, "top.sig1");
+
+    g_object_unref(names);
+}
+
+static void test_many(void)
+{
+    GwNamePool *names = gw_name_pool_new();
+    GPtrArray *added = g_ptr_array_new();
+
+    // Enough names to fill several blocks.
+
+    for (guint i = 0; i < 20000; i++) {
+        gchar *name = g_strdup_printf("top.sub%u.sig%u", i / 100, i);
+        g_ptr_array_add(added, gw_name_pool_add(names, name));
+        g_free(name);
+    }
+
+    for (guint i = 0; i < added->len; i++) {
+        gchar *name = g_strdup_printf("top.sub%u.sig%u", i / 100, i);
+        g_assert_cmpstr(g_ptr_array_index(added, i), ==, name);
+        g_free(name);
+    }
+
+    g_ptr_array_free(added, TRUE);
+    g_object_unref(names);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/name-pool/add", test_add);
+    g_test_add_func("/name-pool/many", test_many);
+
+    return g_test_run();
+}
@@ -1,4 +1,5 @@
 #include <gtkwave.h>
+#include <glib/gstdio.h>
 
 static void test_error_common(const gchar *filename, GQuark error_domain, gint error_code)
 {
@@ -32,6 +33,650 @@ static void test_error_no_transitions()
     test_error_common("files/error_no_transitions.vcd", GW_DUMP_FILE_ERROR, GW_DUMP_FILE_ERROR_NO_TRANSITIONS);
 }
 
+static GwDumpFile *load_with_mmap(const gchar *filename, gboolean use_mmap)
+{
+    GwLoader *loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_use_mmap(GW_VCD_LOADER(loader), use_mmap);
+
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_assert_nonnull(file);
+
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+
+    g_object_unref(loader);
+
+    return file;
+}
+
+static void test_mmap_matches_buffered(void)
+{
+    GwDumpFile *mapped = load_with_mmap("files/basic.vcd", TRUE);
+    GwDumpFile *buffered = load_with_mmap("files/basic.vcd", FALSE);
+
+    GwFacs *mapped_facs = gw_dump_file_get_facs(mapped);
+    GwFacs *buffered_facs = gw_dump_file_get_facs(buffered);
+    g_assert_cmpint(gw_facs_get_length(mapped_facs), ==, gw_facs_get_length(buffered_facs));
+
+    for (guint i = 0; i < gw_facs_get_length(mapped_facs); i++) {
+        GwNode *a = gw_facs_get(mapped_facs, i)->n;
+        GwNode *b = gw_facs_get(buffered_facs, i)->n;
+
+        g_assert_cmpstr(a->nname, ==, b->nname);
+        g_assert_cmpint(a->numhist, ==, b->numhist);
+
+        GwHistEnt *ha = &a->head;
+        GwHistEnt *hb = &b->head;
+        while (ha != NULL && hb != NULL) {
+            g_assert_cmpint(ha->time, ==, hb->time);
+            ha = ha->next;
+            hb = hb->next;
+        }
+        g_assert_null(ha);
+        g_assert_null(hb);
+    }
+
+    g_object_unref(mapped);
+    g_object_unref(buffered);
+}
+
+static GString *wide_vcd_contents(void)
+{
+    GString *vcd = g_string_new("$timescale 1ns $end\n$scope module top $end\n");
+    for (gint i = 0; i < 64; i++) {
+        g_string_append_printf(vcd, "$var wire 1 s%d sig%d $end\n", i, i);
+        g_string_append_printf(vcd, "$var wire 4 v%d vec%d [3:0] $end\n", i, i);
+    }
+    g_string_append(vcd, "$var wire 1 s0 alias0 $end\n");
+    g_string_append(vcd, "$upscope $end\n$enddefinitions $end\n");
+    for (gint t = 0; t < 100; t++) {
+        g_string_append_printf(vcd, "#%d\n", t * 10);
+        for (gint i = 0; i < 64; i++) {
+            if ((t + i) % 3 == 0) {
+                g_string_append_printf(vcd, "%ds%d\n", (t / 3 + i) & 1, i);
+            }
+            if ((t + i) % 5 == 0) {
+                g_string_append_printf(vcd, "b%d%d%d%d v%d\n", t & 1, i & 1, (t >> 1) & 1, 1, i);
+            }
+        }
+    }
+
+    return vcd;
+}
+
+static gchar *write_wide_vcd(void)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("test-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+
+    GString *vcd = wide_vcd_contents();
+    g_assert_true(g_file_set_contents(filename, vcd->str, vcd->len, NULL));
+    g_string_free(vcd, TRUE);
+    g_close(fd, NULL);
+
+    return filename;
+}
+
+static void assert_same_history(GwNode *a, GwNode *b)
+{
+    g_assert_cmpstr(a->nname, ==, b->nname);
+
+    GwHistEnt *ha = a->head.next;
+    GwHistEnt *hb = b->head.next;
+    while (ha != NULL && hb != NULL) {
+        g_assert_cmpint(ha->time, ==, hb->time);
+        if (a->msi == a->lsi) {
+            g_assert_cmpint(ha->v.h_val, ==, hb->v.h_val);
+        } else if (ha->time >= 0) {
+            g_assert_cmpmem(ha->v.h_vector, 4, hb->v.h_vector, 4);
+        }
+        ha = ha->next;
+        hb = hb->next;
+    }
+    g_assert_null(ha);
+    g_assert_null(hb);
+}
+
+static void test_parallel_import_matches_serial(void)
+{
+    gchar *filename = write_wide_vcd();
+
+    GError *error = NULL;
+
+    GwLoader *parallel_loader = gw_vcd_loader_new();
+    GwDumpFile *parallel = gw_loader_load(parallel_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(parallel_loader);
+
+    GwLoader *serial_loader = gw_vcd_loader_new();
+    GwDumpFile *serial = gw_loader_load(serial_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(serial_loader);
+
+    // Importing all traces at once takes the threaded path ...
+    g_assert_true(gw_dump_file_import_all(parallel, &error));
+    g_assert_no_error(error);
+
+    // ... while importing them one by one stays on this thread.
+    GwFacs *serial_facs = gw_dump_file_get_facs(serial);
+    for (guint i = 0; i < gw_facs_get_length(serial_facs); i++) {
+        GwNode *nodes[] = {gw_facs_get(serial_facs, i)->n, NULL};
+        g_assert_true(gw_dump_file_import_traces(serial, nodes, &error));
+        g_assert_no_error(error);
+    }
+
+    GwFacs *parallel_facs = gw_dump_file_get_facs(parallel);
+    g_assert_cmpint(gw_facs_get_length(parallel_facs), ==, gw_facs_get_length(serial_facs));
+    for (guint i = 0; i < gw_facs_get_length(parallel_facs); i++) {
+        assert_same_history(gw_facs_get(parallel_facs, i)->n, gw_facs_get(serial_facs, i)->n);
+    }
+
+    g_object_unref(parallel);
+    g_object_unref(serial);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+static gboolean vlist_has_lz4_block(GwVlist *vlist)
+{
+    for (GwVlist *block = vlist; block != NULL; block = block->next) {
+        // Compressed blocks have a negative offset and flag LZ4 in the top bit of the size word.
+        guint size_word = *(guint *)(block + 1);
+        if ((gint)block->offset < 0 && (size_word & 0x80000000u) != 0) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void test_lz4_vlists(void)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("test-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+
+    // A clock has enough regular changes to fill vlist blocks that compress well.
+    GString *vcd = g_string_new("$timescale 1ns $end\n$scope module top $end\n");
+    g_string_append(vcd, "$var wire 1 c clk $end\n$var wire 8 d data [7:0] $end\n");
+    g_string_append(vcd, "$upscope $end\n$enddefinitions $end\n");
+    for (gint t = 0; t < 4000; t++) {
+        g_string_append_printf(vcd, "#%d\n%dc\n", t * 5, t & 1);
+        if (t % 4 == 0) {
+            g_string_append_printf(vcd, "b%d%d%d%d0101 d\n", (t >> 2) & 1, 0, (t >> 3) & 1, 1);
+        }
+    }
+    g_assert_true(g_file_set_contents(filename, vcd->str, vcd->len, NULL));
+    g_string_free(vcd, TRUE);
+
+    // Warnings are fatal in tests, an out of range level for the vlist writers would abort here.
+    GwLoader *loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_vlist_compression_level(GW_VCD_LOADER(loader),
+                                              GW_VCD_LOADER_VLIST_COMPRESSION_LZ4);
+    g_assert_cmpint(gw_vcd_loader_get_vlist_compression_level(GW_VCD_LOADER(loader)),
+                    ==,
+                    GW_VCD_LOADER_VLIST_COMPRESSION_LZ4);
+
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    guint lz4_nodes = 0;
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwNode *node = gw_facs_get(facs, i)->n;
+        if (node->mv.mvlfac_vlist != NULL && vlist_has_lz4_block(node->mv.mvlfac_vlist)) {
+            lz4_nodes++;
+        }
+    }
+    g_assert_cmpuint(lz4_nodes, >, 0);
+
+    GwLoader *reference_loader = gw_vcd_loader_new();
+    GwDumpFile *reference = gw_loader_load(reference_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(reference_loader);
+
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+    g_assert_true(gw_dump_file_import_all(reference, &error));
+    g_assert_no_error(error);
+
+    GwFacs *reference_facs = gw_dump_file_get_facs(reference);
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        assert_same_history(gw_facs_get(facs, i)->n, gw_facs_get(reference_facs, i)->n);
+    }
+
+    g_object_unref(file);
+    g_object_unref(reference);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+static void test_unload_and_reimport(void)
+{
+    gchar *filename = write_wide_vcd();
+
+    GError *error = NULL;
+    GwLoader *reference_loader = gw_vcd_loader_new();
+    GwDumpFile *reference = gw_loader_load(reference_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(reference_loader);
+
+    GwLoader *loader = gw_vcd_loader_new();
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    g_assert_true(gw_dump_file_import_all(reference, &error));
+    g_assert_no_error(error);
+
+    gw_dump_file_set_unloadable_traces(file, TRUE);
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    GwFacs *reference_facs = gw_dump_file_get_facs(reference);
+
+    GPtrArray *nodes = gw_dump_file_get_unloadable_nodes(file);
+    g_assert_cmpint(nodes->len, ==, gw_facs_get_length(facs));
+    g_ptr_array_free(nodes, TRUE);
+
+    // Traces that were imported together share the memory of one factory.
+    GwHistEntFactory *factory = gw_dump_file_get_trace_factory(file, gw_facs_get(facs, 0)->n);
+    g_assert_nonnull(factory);
+    g_assert_cmpuint(gw_hist_ent_factory_get_size(factory), >, 0);
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwNode *node = gw_facs_get(facs, i)->n;
+        g_assert_true(gw_dump_file_get_trace_factory(file, node) == factory);
+        g_assert_true(gw_dump_file_unload_trace(file, node));
+        g_assert_null(gw_dump_file_get_trace_factory(file, node));
+        g_assert_nonnull(node->mv.mvlfac_vlist);
+        g_assert_null(node->head.next);
+    }
+
+    nodes = gw_dump_file_get_unloadable_nodes(file);
+    g_assert_cmpint(nodes->len, ==, 0);
+    g_ptr_array_free(nodes, TRUE);
+
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        assert_same_history(gw_facs_get(facs, i)->n, gw_facs_get(reference_facs, i)->n);
+    }
+
+    // Traces of a file that doesn't keep them unloadable stay in memory.
+    g_assert_false(gw_dump_file_unload_trace(reference, gw_facs_get(reference_facs, 0)->n));
+
+    g_object_unref(file);
+    g_object_unref(reference);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+static void test_compact_histories(void)
+{
+    gchar *filename = write_wide_vcd();
+
+    GError *error = NULL;
+    GwLoader *reference_loader = gw_vcd_loader_new();
+    GwDumpFile *reference = gw_loader_load(reference_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(reference_loader);
+
+    GwLoader *loader = gw_vcd_loader_new();
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    g_assert_true(gw_dump_file_import_all(reference, &error));
+    g_assert_no_error(error);
+
+    gw_dump_file_set_compact_histories(file, TRUE);
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    GwFacs *reference_facs = gw_dump_file_get_facs(reference);
+
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        GwNode *node = gw_facs_get(facs, i)->n;
+        GwNode *reference_node = gw_facs_get(reference_facs, i)->n;
+
+        // The histents are freed after the import, only the columns are left.
+        g_assert_null(node->head.next);
+        g_assert_nonnull(node->columns);
+        g_assert_null(gw_dump_file_get_trace_factory(file, node));
+        g_assert_cmpint(node->numhist, ==, gw_hist_columns_get_length(node->columns));
+
+        GwHistIter iter;
+        gw_hist_iter_init(&iter, node);
+        GwHistEnt *h = &reference_node->head;
+        gchar vector[4];
+
+        while (TRUE) {
+            g_assert_cmpint(gw_hist_iter_get_time(&iter), ==, h->time);
+            if (node->msi == node->lsi) {
+                g_assert_cmpint(gw_hist_iter_get_value(&iter), ==, h->v.h_val);
+            } else if (h->time >= 0) {
+                g_assert_true(gw_hist_iter_get_vector(&iter, vector));
+                g_assert_cmpmem(vector, 4, h->v.h_vector, 4);
+            }
+
+            h = h->next;
+            if (!gw_hist_iter_next(&iter)) {
+                break;
+            }
+            g_assert_nonnull(h);
+        }
+        g_assert_null(h);
+    }
+
+    g_object_unref(file);
+    g_object_unref(reference);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+static GwDumpFile *load_with_cache(const gchar *filename)
+{
+    GwLoader *loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_use_cache(GW_VCD_LOADER(loader), TRUE);
+
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_assert_nonnull(file);
+
+    g_object_unref(loader);
+
+    return file;
+}
+
+static void assert_same_file(GwDumpFile *a, GwDumpFile *b)
+{
+    GwTimeRange *range_a = gw_dump_file_get_time_range(a);
+    GwTimeRange *range_b = gw_dump_file_get_time_range(b);
+    g_assert_cmpint(gw_time_range_get_start(range_a), ==, gw_time_range_get_start(range_b));
+    g_assert_cmpint(gw_time_range_get_end(range_a), ==, gw_time_range_get_end(range_b));
+    g_assert_cmpint(gw_dump_file_get_time_scale(a), ==, gw_dump_file_get_time_scale(b));
+
+    GError *error = NULL;
+    g_assert_true(gw_dump_file_import_all(a, &error));
+    g_assert_no_error(error);
+    g_assert_true(gw_dump_file_import_all(b, &error));
+    g_assert_no_error(error);
+
+    GwFacs *facs_a = gw_dump_file_get_facs(a);
+    GwFacs *facs_b = gw_dump_file_get_facs(b);
+    g_assert_cmpint(gw_facs_get_length(facs_a), ==, gw_facs_get_length(facs_b));
+    for (guint i = 0; i < gw_facs_get_length(facs_a); i++) {
+        GwNode *na = gw_facs_get(facs_a, i)->n;
+        GwNode *nb = gw_facs_get(facs_b, i)->n;
+        g_assert_cmpint(na->msi, ==, nb->msi);
+        g_assert_cmpint(na->lsi, ==, nb->lsi);
+        g_assert_cmpint(na->vartype, ==, nb->vartype);
+        assert_same_history(na, nb);
+    }
+
+    const GwTreeNode *root_a = gw_tree_get_root_const(gw_dump_file_get_tree(a));
+    const GwTreeNode *root_b = gw_tree_get_root_const(gw_dump_file_get_tree(b));
+    g_assert_cmpstr(root_a->name, ==, root_b->name);
+    g_assert_nonnull(root_a->child);
+    g_assert_nonnull(root_b->child);
+    for (const GwTreeNode *ta = root_a->child, *tb = root_b->child; ta != NULL || tb != NULL;
+         ta = ta->next, tb = tb->next) {
+        g_assert_nonnull(ta);
+        g_assert_nonnull(tb);
+        g_assert_cmpstr(ta->name, ==, tb->name);
+        g_assert_cmpint(ta->t_which, ==, tb->t_which);
+    }
+}
+
+static void test_cache(void)
+{
+    gchar *filename = write_wide_vcd();
+    gchar *cache_filename = g_strconcat(filename, ".gwcache", NULL);
+
+    // The first load parses the file and writes the cache ...
+    GwDumpFile *parsed = load_with_cache(filename);
+    g_assert_true(g_file_test(cache_filename, G_FILE_TEST_EXISTS));
+
+    // ... which the second load is restored from.
+    GwDumpFile *cached = load_with_cache(filename);
+    assert_same_file(cached, parsed);
+
+    g_object_unref(parsed);
+    g_object_unref(cached);
+
+    // A modified file doesn't use the stale cache.
+    gchar *contents = NULL;
+    g_assert_true(g_file_get_contents(filename, &contents, NULL, NULL));
+    gchar *modified = g_strconcat(contents, "#5000\n1s0\n", NULL);
+    g_assert_true(g_file_set_contents(filename, modified, -1, NULL));
+
+    GwDumpFile *reparsed = load_with_cache(filename);
+    GwTimeRange *range = gw_dump_file_get_time_range(reparsed);
+    g_assert_cmpint(gw_time_range_get_end(range), ==, 5000);
+
+    GwDumpFile *recached = load_with_cache(filename);
+    assert_same_file(recached, reparsed);
+
+    g_object_unref(reparsed);
+    g_object_unref(recached);
+
+    // Rewriting it with the same size, usually within the same second, doesn't
+    // use the stale cache either.
+    gchar *rewritten = g_strconcat(contents, "#6000\n1s0\n", NULL);
+    g_assert_true(g_file_set_contents(filename, rewritten, -1, NULL));
+
+    GwDumpFile *rewritten_file = load_with_cache(filename);
+    range = gw_dump_file_get_time_range(rewritten_file);
+    g_assert_cmpint(gw_time_range_get_end(range), ==, 6000);
+    g_object_unref(rewritten_file);
+
+    g_free(contents);
+    g_free(modified);
+    g_free(rewritten);
+
+    g_unlink(cache_filename);
+    g_unlink(filename);
+    g_free(cache_filename);
+    g_free(filename);
+}
+
+// Large enough to be cut into chunks that are parsed on several threads.
+static gchar *write_long_vcd(void)
+{
+    GString *vcd = g_string_new("$timescale 1ns $end\n$scope module top $end\n");
+    for (gint i = 0; i < 64; i++) {
+        g_string_append_printf(vcd, "$var wire 1 s%d sig%d $end\n", i, i);
+        g_string_append_printf(vcd, "$var wire 4 v%d vec%d [3:0] $end\n", i, i);
+    }
+    g_string_append(vcd, "$var wire 1 m mixed $end\n");
+    g_string_append(vcd, "$var wire 1 n late $end\n");
+    g_string_append(vcd, "$upscope $end\n$enddefinitions $end\n");
+
+    // No time zero in front of the initial values.
+    g_string_append(vcd, "$dumpvars\n0m\n$end\n");
+
+    gint steps = 16000;
+    for (gint t = 0; t < steps; t++) {
+        g_string_append_printf(vcd, "#%d\n", t * 10 + 10);
+        for (gint i = 0; i < 64; i++) {
+            if ((t + i) % 3 == 0) {
+                g_string_append_printf(vcd, "%ds%d\n", (t / 3 + i) & 1, i);
+            }
+            if ((t + i) % 5 == 0) {
+                g_string_append_printf(vcd, "b%d%d%d%d v%d\n", t & 1, i & 1, (t >> 1) & 1, 1, i);
+            }
+        }
+
+        // Scalar and vector changes on the same bits.
+        if (t % 7 == 0) {
+            g_string_append_printf(vcd, t % 2 ? "b%d m\n" : "%dm\n", (t / 7) & 1);
+        }
+        if (t >= steps / 2 && t % 11 == 0) {
+            g_string_append_printf(vcd, t % 2 ? "%dn\n" : "b%d n\n", (t / 11) & 1);
+        }
+
+        if (t == steps / 3) {
+            g_string_append(vcd, "$comment\nsplit here\n$end\n$dumpoff\n");
+        } else if (t == steps / 3 + 100) {
+            g_string_append(vcd, "$dumpon\n");
+        } else if (t == steps / 2 + 50) {
+            // Longer than a chunk, with lines that look like times.
+            g_string_append(vcd, "$comment\n");
+            for (gint i = 0; i < 250000; i++) {
+                g_string_append(vcd, "#1 x\n");
+            }
+            g_string_append(vcd, "$end\n");
+        } else if (t == steps * 3 / 4) {
+            // A control character is whitespace to the serial tokenizer
+            // only, this chunk is parsed again on its own.
+            g_string_append(vcd, "\x01\n");
+        }
+    }
+
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("test-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_assert_true(g_file_set_contents(filename, vcd->str, vcd->len, NULL));
+    g_string_free(vcd, TRUE);
+    g_close(fd, NULL);
+
+    return filename;
+}
+
+static void test_chunked_parse_matches_serial(void)
+{
+    gchar *filename = write_long_vcd();
+
+    GError *error = NULL;
+
+    // Mapped files are parsed in chunks, buffered files on one thread.
+    GwLoader *chunked_loader = gw_vcd_loader_new();
+    GwDumpFile *chunked = gw_loader_load(chunked_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(chunked_loader);
+
+    GwLoader *serial_loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_use_mmap(GW_VCD_LOADER(serial_loader), FALSE);
+    GwDumpFile *serial = gw_loader_load(serial_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(serial_loader);
+
+    assert_same_file(chunked, serial);
+
+    GwBlackoutRegions *regions_chunked = gw_dump_file_get_blackout_regions(chunked);
+    GwBlackoutRegions *regions_serial = gw_dump_file_get_blackout_regions(serial);
+    g_assert_cmpuint(gw_blackout_regions_length(regions_chunked), ==, 1);
+    g_assert_cmpuint(gw_blackout_regions_length(regions_serial), ==, 1);
+    g_assert_true(gw_blackout_regions_contains(regions_chunked, (16000 / 3) * 10 + 50));
+    g_assert_true(gw_blackout_regions_contains(regions_serial, (16000 / 3) * 10 + 50));
+
+    g_object_unref(chunked);
+    g_object_unref(serial);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+static void test_follow(void)
+{
+    gchar *filename = NULL;
+    gint fd = g_file_open_tmp("test-XXXXXX.vcd", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_close(fd, NULL);
+
+    // The simulator has written half of the file and is in the middle of a line.
+    GString *vcd = wide_vcd_contents();
+    gsize split = strstr(vcd->str, "#500\n") - vcd->str + 8;
+    g_assert_true(g_file_set_contents(filename, vcd->str, split, NULL));
+
+    GwLoader *loader = gw_vcd_loader_new();
+    gw_vcd_loader_set_follow(GW_VCD_LOADER(loader), TRUE);
+    GError *error = NULL;
+    GwDumpFile *file = gw_loader_load(loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(loader);
+
+    GwTimeRange *range = gw_dump_file_get_time_range(file);
+    g_assert_cmpint(gw_time_range_get_end(range), ==, 500);
+
+    // Nothing was appended yet.
+    gboolean changed = TRUE;
+    GPtrArray *changed_nodes = NULL;
+    g_assert_true(gw_dump_file_update(file, &changed, &changed_nodes, &error));
+    g_assert_no_error(error);
+    g_assert_false(changed);
+    g_assert_cmpuint(changed_nodes->len, ==, 0);
+    g_ptr_array_free(changed_nodes, TRUE);
+
+    // Import some of the traces before the rest of the file is written.
+    GwFacs *facs = gw_dump_file_get_facs(file);
+    for (guint i = 0; i < gw_facs_get_length(facs); i += 2) {
+        GwNode *nodes[] = {gw_facs_get(facs, i)->n, NULL};
+        g_assert_true(gw_dump_file_import_traces(file, nodes, &error));
+        g_assert_no_error(error);
+    }
+
+    FILE *handle = g_fopen(filename, "ab");
+    g_assert_nonnull(handle);
+    g_assert_cmpint(fwrite(vcd->str + split, 1, vcd->len - split, handle), ==, vcd->len - split);
+    fclose(handle);
+
+    g_assert_true(gw_dump_file_update(file, &changed, &changed_nodes, &error));
+    g_assert_no_error(error);
+    g_assert_true(changed);
+
+    // Only the imported traces have a history that grew.
+    g_assert_cmpuint(changed_nodes->len, >, 0);
+    for (guint i = 0; i < changed_nodes->len; i++) {
+        GwNode *node = g_ptr_array_index(changed_nodes, i);
+        g_assert_null(node->mv.mvlfac_vlist);
+    }
+    g_ptr_array_free(changed_nodes, TRUE);
+
+    range = gw_dump_file_get_time_range(file);
+    g_assert_cmpint(gw_time_range_get_end(range), ==, 990);
+
+    g_assert_true(gw_dump_file_import_all(file, &error));
+    g_assert_no_error(error);
+
+    // The followed file matches a file that was loaded once it was complete.
+    GwLoader *reference_loader = gw_vcd_loader_new();
+    GwDumpFile *reference = gw_loader_load(reference_loader, filename, &error);
+    g_assert_no_error(error);
+    g_object_unref(reference_loader);
+
+    g_assert_true(gw_dump_file_import_all(reference, &error));
+    g_assert_no_error(error);
+
+    GwFacs *reference_facs = gw_dump_file_get_facs(reference);
+    g_assert_cmpint(gw_facs_get_length(facs), ==, gw_facs_get_length(reference_facs));
+    for (guint i = 0; i < gw_facs_get_length(facs); i++) {
+        assert_same_history(gw_facs_get(facs, i)->n, gw_facs_get(reference_facs, i)->n);
+    }
+
+    g_object_unref(file);
+    g_object_unref(reference);
+    g_string_free(vcd, TRUE);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
@@ -40,6 +685,16 @@ int main(int argc, char *argv[])
     g_test_add_func("/vcd_loader/error_empty", test_error_empty);
     g_test_add_func("/vcd_loader/error_no_symbols", test_error_no_symbols);
     g_test_add_func("/vcd_loader/error_no_transitions", test_error_no_transitions);
+    g_test_add_func("/vcd_loader/mmap_matches_buffered", test_mmap_matches_buffered);
+    g_test_add_func("/vcd_loader/parallel_import_matches_serial",
+                    test_parallel_import_matches_serial);
+    g_test_add_func("/vcd_loader/lz4_vlists", test_lz4_vlists);
+    g_test_add_func("/vcd_loader/unload_and_reimport", test_unload_and_reimport);
+    g_test_add_func("/vcd_loader/compact_histories", test_compact_histories);
+    g_test_add_func("/vcd_loader/cache", test_cache);
+    g_test_add_func("/vcd_loader/chunked_parse_matches_serial",
+                    test_chunked_parse_matches_serial);
+    g_test_add_func("/vcd_loader/follow", test_follow);
 
     return g_test_run();
 }
@@ -26,11 +26,49 @@ static void test_basic(void)
     gw_vlist_destroy(packed_vlist);
 }
 
+static void test_roundtrip(void)
+{
+    static const gint DATA_SIZE = 100000;
+    guint8 *data = g_malloc(DATA_SIZE);
+
+    GRand *rand = g_rand_new_with_seed(1);
+
+    // Periodic data with occasional noise and escape bytes, long enough to
+    // wrap around the match window many times.
+    for (gint i = 0; i < DATA_SIZE; i++) {
+        if (g_rand_int_range(rand, 0, 50) == 0) {
+            data[i] = g_rand_boolean(rand) ? 0xff : g_rand_int_range(rand, 0, 256);
+        } else {
+            data[i] = (i / 3) % 37;
+        }
+    }
+
+    GwVlistPacker *packer = gw_vlist_packer_new(-1);
+    for (gint i = 0; i < DATA_SIZE; i++) {
+        gw_vlist_packer_alloc(packer, data[i]);
+    }
+
+    GwVlist *packed_vlist = gw_vlist_packer_finalize_and_free(packer);
+    g_assert_cmpint(gw_vlist_size(packed_vlist), <, DATA_SIZE / 2);
+
+    guint decompressed_size = 0;
+    guchar *decompressed_data = gw_vlist_packer_decompress(packed_vlist, &decompressed_size);
+
+    g_assert_cmpint(decompressed_size, ==, DATA_SIZE);
+    g_assert_cmpmem(decompressed_data, decompressed_size, data, DATA_SIZE);
+
+    gw_vlist_packer_decompress_destroy(decompressed_data);
+    gw_vlist_destroy(packed_vlist);
+    g_rand_free(rand);
+    g_free(data);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/vlist_packer/basic", test_basic);
+    g_test_add_func("/vlist_packer/roundtrip", test_roundtrip);
 
     return g_test_run();
 }
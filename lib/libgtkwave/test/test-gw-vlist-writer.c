@@ -1,4 +1,5 @@
 #include <gtkwave.h>
+#include "gw-vlist-reader.h"
 
 static gint write_test_data(GwVlistWriter *writer)
 {
@@ -91,12 +92,67 @@ static void test_packed(void)
     // TODO: free data
 }
 
+static void read_mvl9_strings_common(gboolean prepack)
+{
+    static const guint lengths[] = {0, 1, 2, 31, 32, 33, 64, 200, 513};
+    const gchar chars[] = "01xzhuwl-";
+
+    GwVlistWriter *writer = gw_vlist_writer_new(-1, prepack);
+    GPtrArray *strings = g_ptr_array_new_with_free_func(g_free);
+
+    for (guint i = 0; i < G_N_ELEMENTS(lengths); i++) {
+        gchar *str = g_malloc(lengths[i] + 1);
+        for (guint j = 0; j < lengths[i]; j++) {
+            str[j] = chars[(i + j * 7) % strlen(chars)];
+        }
+        str[lengths[i]] = '\0';
+
+        gw_vlist_writer_append_mvl9_string(writer, str);
+        gw_vlist_writer_append_uv32(writer, i);
+        g_ptr_array_add(strings, str);
+    }
+
+    GwVlist *vlist = gw_vlist_writer_finish(writer);
+    g_object_unref(writer);
+
+    GwVlistReader *reader = gw_vlist_reader_new(vlist, prepack);
+
+    for (guint i = 0; i < strings->len; i++) {
+        const gchar *str = g_ptr_array_index(strings, i);
+
+        guint32 len = 0;
+        const guint8 *bits = gw_vlist_reader_read_mvl9_string(reader, &len);
+        g_assert_cmpint(len, ==, strlen(str));
+        for (guint j = 0; j < len; j++) {
+            g_assert_cmpint(bits[j], ==, gw_bit_from_char(str[j]));
+        }
+
+        g_assert_cmpint(gw_vlist_reader_read_uv32(reader), ==, i);
+    }
+    g_assert_true(gw_vlist_reader_is_done(reader));
+
+    g_object_unref(reader);
+    g_ptr_array_free(strings, TRUE);
+}
+
+static void test_read_mvl9_string(void)
+{
+    read_mvl9_strings_common(FALSE);
+}
+
+static void test_read_mvl9_string_packed(void)
+{
+    read_mvl9_strings_common(TRUE);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/vlist_writer/not_packed", test_not_packed);
     g_test_add_func("/vlist_writer/packed", test_packed);
+    g_test_add_func("/vlist_writer/read_mvl9_string", test_read_mvl9_string);
+    g_test_add_func("/vlist_writer/read_mvl9_string_packed", test_read_mvl9_string_packed);
 
     return g_test_run();
 }
@@ -35,12 +35,131 @@ static void test_compressed(void)
     test_common(9);
 }
 
+static void test_frozen_wide_elements(void)
+{
+    GwVlist *vlist = gw_vlist_create(sizeof(GwTime));
+
+    for (gint i = 0; i < 1000; i++) {
+        GwTime *t = gw_vlist_alloc(&vlist, FALSE, 0);
+        *t = i * 10;
+    }
+
+    gw_vlist_freeze(&vlist, 0);
+
+    // Frozen vlists of wide elements are stored in a single block.
+    g_assert_null(vlist->next);
+    g_assert_cmpint(gw_vlist_size(vlist), ==, 1000);
+
+    for (gint i = 0; i < 1000; i++) {
+        GwTime *t = gw_vlist_locate(vlist, i);
+        g_assert_cmpint(*t, ==, i * 10);
+    }
+    g_assert_null(gw_vlist_locate(vlist, 1000));
+
+    gw_vlist_destroy(vlist);
+}
+
+static void test_flatten(void)
+{
+    GwVlist *vlist = gw_vlist_create(1);
+
+    for (gint i = 0; i < 300; i++) {
+        char *t = gw_vlist_alloc(&vlist, FALSE, -1);
+        *t = i;
+    }
+
+    gw_vlist_flatten(&vlist);
+    g_assert_null(vlist->next);
+    g_assert_cmpint(gw_vlist_size(vlist), ==, 300);
+
+    for (gint i = 0; i < 300; i++) {
+        char *t = gw_vlist_locate(vlist, i);
+        g_assert_cmpint(*t, ==, (char)i);
+    }
+
+    gw_vlist_destroy(vlist);
+}
+
+static void test_flatten_copy(void)
+{
+    GwVlist *vlist = gw_vlist_create(1);
+
+    for (gint i = 0; i < 1000; i++) {
+        char *t = gw_vlist_alloc(&vlist, TRUE, 9);
+        *t = i / 100;
+    }
+    gw_vlist_freeze(&vlist, 9);
+
+    // The copy is flat and uncompressed, the list itself stays compressed
+    // and can be copied again.
+    for (gint pass = 0; pass < 2; pass++) {
+        GwVlist *copy = gw_vlist_flatten_copy(vlist);
+        g_assert_null(copy->next);
+        g_assert_cmpint(gw_vlist_size(copy), ==, 1000);
+
+        for (gint i = 0; i < 1000; i++) {
+            char *t = gw_vlist_locate(copy, i);
+            g_assert_cmpint(*t, ==, i / 100);
+        }
+
+        gw_vlist_destroy(copy);
+    }
+    g_assert_cmpint((gint)vlist->offset, <, 0);
+
+    gw_vlist_destroy(vlist);
+}
+
+static void compressed_blocks_common(gint compression_level)
+{
+    static const gint N = 200000;
+
+    // Large enough for blocks that are compressed in the background.
+    GwVlist *vlist = gw_vlist_create(1);
+    for (gint i = 0; i < N; i++) {
+        char *t = gw_vlist_alloc(&vlist, TRUE, compression_level);
+        *t = (i / 7) % 13;
+    }
+    gw_vlist_freeze(&vlist, compression_level);
+
+    // Only tiny blocks are left uncompressed.
+    for (GwVlist *iter = vlist; iter != NULL; iter = iter->next) {
+        if (iter->size > 32) {
+            g_assert_cmpint((gint)iter->offset, <, 0);
+        }
+    }
+
+    gw_vlist_uncompress(&vlist);
+    g_assert_cmpint(gw_vlist_size(vlist), ==, N);
+
+    for (gint i = 0; i < N; i++) {
+        char *t = gw_vlist_locate(vlist, i);
+        g_assert_cmpint(*t, ==, (i / 7) % 13);
+    }
+
+    gw_vlist_destroy(vlist);
+}
+
+static void test_compressed_blocks_zlib(void)
+{
+    compressed_blocks_common(4);
+}
+
+static void test_compressed_blocks_lz4(void)
+{
+    compressed_blocks_common(GW_VLIST_COMPRESSION_LZ4);
+}
+
 int main(int argc, char *argv[])
 {
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/vlist/uncompressed", test_uncompressed);
     g_test_add_func("/vlist/compressed", test_compressed);
+    g_test_add_func("/vlist/frozen_wide_elements", test_frozen_wide_elements);
+    g_test_add_func("/vlist/flatten", test_flatten);
+    g_test_add_func("/vlist/flatten_copy", test_flatten_copy);
+    g_test_add_func("/vlist/compressed_blocks_zlib", test_compressed_blocks_zlib);
+    g_test_add_func("/vlist/compressed_blocks_lz4", test_compressed_blocks_lz4);
 
     return g_test_run();
 }
@@ -451,7 +451,7 @@ int AddNodeTraceReturn(GwNode *nd, char *aliasname, GwTrace **tret)
         return (0);
     }
 
-    if (!nd->harray) /* make quick array lookup for aet display */
+    if (!nd->harray && !nd->columns) /* make quick array lookup for aet display */
     {
         histpnt = &(nd->head);
         histcount = 0;
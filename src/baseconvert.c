@@ -1690,6 +1690,34 @@ char *convert_ascii_vec(GwTrace *t, char *vec)
     return (s);
 }
 
+/*
+ * convert the value of an extvals node at a history iterator into an ascii string
+ */
+char *convert_ascii_hist(GwTrace *t, const GwHistIter *iter)
+{
+    unsigned char flags = gw_hist_iter_get_flags(iter);
+    GwNode *n = t->n.nd;
+    char *vec;
+    char *s;
+
+    if (flags & GW_HIST_ENT_FLAG_REAL) {
+        if (!(flags & GW_HIST_ENT_FLAG_STRING)) {
+            double d = gw_hist_iter_get_real(iter);
+
+            return convert_ascii_real(t, &d);
+        }
+
+        return convert_ascii_string((char *)gw_hist_iter_get_string(iter));
+    }
+
+    /* convert_ascii_vec() converts the bits in place, so it gets a copy */
+    vec = malloc_2(ABS(n->msi - n->lsi) + 1);
+    s = convert_ascii_vec(t, gw_hist_iter_get_vector(iter, vec) ? vec : NULL);
+    free_2(vec);
+
+    return (s);
+}
+
 char *convert_ascii(GwTrace *t, GwVectorEnt *v)
 {
     char *s;
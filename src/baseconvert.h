@@ -14,6 +14,7 @@ char *convert_ascii(GwTrace *t, GwVectorEnt *v);
 char *convert_ascii_vec(GwTrace *t, char *vec);
 char *convert_ascii_real(GwTrace *t, double *d);
 char *convert_ascii_string(char *s);
+char *convert_ascii_hist(GwTrace *t, const GwHistIter *iter);
 char *convert_ascii_vec_2(GwTrace *t, char *vec);
 double convert_real_vec(GwTrace *t, char *vec);
 double convert_real(GwTrace *t, GwVectorEnt *v);
@@ -19,6 +19,7 @@
 #include "lx2.h"
 #include "debug.h"
 #include "bsearch.h"
+#include "hist_lod.h"
 #include "strace.h"
 #include "translate.h"
 #include "ptranslate.h"
@@ -202,7 +203,9 @@ GwBitVector *bits2vector(GwBits *b)
     int i;
     int regions = 0;
     GwNode *n;
-    GwHistEnt **h;
+    GwHistIter *h;
+    GwHistIter next;
+    const char *str;
     GwVectorEnt *vhead = NULL;
     GwVectorEnt *vcurr = NULL;
     GwVectorEnt *vadd;
@@ -216,17 +219,16 @@ GwBitVector *bits2vector(GwBits *b)
     if (!b)
         return (NULL);
 
-    h = calloc_2(b->nnbits, sizeof(GwHistEnt *));
+    h = calloc_2(b->nnbits, sizeof(GwHistIter));
 
     numextrabytes = b->nnbits;
 
     for (i = 0; i < b->nnbits; i++) {
         n = b->nodes[i];
-        h[i] = &(n->head);
+        gw_hist_iter_init(&h[i], n);
     }
 
-    while (h[0]) /* should never exit through this point the way we set up histents with trailers
-                    now */
+    for (;;) /* exits through the end caps, the way we set up histents with trailers now */
     {
         mintime = MAX_HISTENT_TIME;
 
@@ -236,16 +238,16 @@ GwBitVector *bits2vector(GwBits *b)
         {
             tshift = (b->attribs) ? b->attribs[i].shift : 0;
 
-            if (h[i]->next) {
-                if ((h[i]->next->time >= 0) && (h[i]->next->time < MAX_HISTENT_TIME - 2)) {
-                    tmod = h[i]->next->time + tshift;
+            next = h[i];
+            if (gw_hist_iter_next(&next)) {
+                tmod = gw_hist_iter_get_time(&next);
+                if ((tmod >= 0) && (tmod < MAX_HISTENT_TIME - 2)) {
+                    tmod += tshift;
                     if (tmod < 0)
                         tmod = 0;
                     if (tmod > MAX_HISTENT_TIME - 2)
                         tmod = MAX_HISTENT_TIME - 2;
-                } else {
-                    tmod = h[i]->next->time; /* don't timeshift endcaps */
-                }
+                } /* don't timeshift endcaps */
 
                 if (tmod < mintime) {
                     mintime = tmod;
@@ -261,15 +263,14 @@ GwBitVector *bits2vector(GwBits *b)
         is_string = 1;
         string_len = 0;
         for (i = 0; i < b->nnbits; i++) {
-            if ((h[i]->flags & GW_HIST_ENT_FLAG_STRING)) {
-                if (h[i]->time >= 0) {
-                    if (h[i]->v.h_vector) {
-                        if ((GLOBALS->loaded_file_type == GHW_FILE) &&
-                            (h[i]->v.h_vector[0] == '\'') && (h[i]->v.h_vector[1]) &&
-                            (h[i]->v.h_vector[2] == '\'')) {
+            if ((gw_hist_iter_get_flags(&h[i]) & GW_HIST_ENT_FLAG_STRING)) {
+                if (gw_hist_iter_get_time(&h[i]) >= 0) {
+                    if ((str = gw_hist_iter_get_string(&h[i]))) {
+                        if ((GLOBALS->loaded_file_type == GHW_FILE) && (str[0] == '\'') &&
+                            (str[1]) && (str[2] == '\'')) {
                             string_len++;
                         } else {
-                            string_len += strlen(h[i]->v.h_vector);
+                            string_len += strlen(str);
                         }
                     }
                 }
@@ -292,7 +293,7 @@ GwBitVector *bits2vector(GwBits *b)
 
             if (!is_string) {
                 if ((b->attribs) && (b->attribs[i].flags & TR_INVERT)) {
-                    enc = ((unsigned char)(h[i]->v.h_val));
+                    enc = gw_hist_iter_get_value(&h[i]);
                     switch (enc) /* don't remember if it's preconverted in all cases; being
                                     conservative is OK */
                     {
@@ -343,44 +344,43 @@ GwBitVector *bits2vector(GwBits *b)
                             break;
                     }
                 } else {
-                    enc = ((unsigned char)(h[i]->v.h_val)) & GW_BIT_MASK;
+                    enc = gw_hist_iter_get_value(&h[i]) & GW_BIT_MASK;
                 }
 
                 vadd->v[i] = enc;
             } else {
-                if (h[i]->time >= 0) {
-                    if (h[i]->v.h_vector) {
-                        if ((GLOBALS->loaded_file_type == GHW_FILE) &&
-                            (h[i]->v.h_vector[0] == '\'') && (h[i]->v.h_vector[1]) &&
-                            (h[i]->v.h_vector[2] == '\'')) {
+                if (gw_hist_iter_get_time(&h[i]) >= 0) {
+                    if ((str = gw_hist_iter_get_string(&h[i]))) {
+                        if ((GLOBALS->loaded_file_type == GHW_FILE) && (str[0] == '\'') &&
+                            (str[1]) && (str[2] == '\'')) {
                             char ghw_str[2];
-                            ghw_str[0] = h[i]->v.h_vector[1];
+                            ghw_str[0] = str[1];
                             ghw_str[1] = 0;
                             strcat((char *)vadd->v, ghw_str);
                         } else {
-                            strcat((char *)vadd->v, h[i]->v.h_vector);
+                            strcat((char *)vadd->v, str);
                         }
                     }
                 }
             }
 
-            if (h[i]->next) {
-                if ((h[i]->next->time >= 0) && (h[i]->next->time < MAX_HISTENT_TIME - 2)) {
-                    tmod = h[i]->next->time + tshift;
+            next = h[i];
+            if (gw_hist_iter_next(&next)) {
+                tmod = gw_hist_iter_get_time(&next);
+                if ((tmod >= 0) && (tmod < MAX_HISTENT_TIME - 2)) {
+                    tmod += tshift;
                     if (tmod < 0)
                         tmod = 0;
                     if (tmod > MAX_HISTENT_TIME - 2)
                         tmod = MAX_HISTENT_TIME - 2;
-                } else {
-                    tmod = h[i]->next->time; /* don't timeshift endcaps */
-                }
+                } /* don't timeshift endcaps */
 
                 if (tmod < mintime) {
                     mintime = tmod;
                 }
 
                 if (tmod == mintime) {
-                    h[i] = h[i]->next;
+                    h[i] = next;
                 }
             }
         }
@@ -419,6 +419,8 @@ GwBitVector *bits2vector(GwBits *b)
         } /* scan-build */
     }
 
+    free_2(h);
+
     return (bitvec);
 }
 
@@ -1620,8 +1622,9 @@ eptr ExpandNode(GwNode *n)
     int width;
     int msb, lsb, delta;
     int actual;
-    GwHistEnt *h;
+    GwHistIter h;
     GwHistEnt *htemp;
+    char *vec;
     int i, j;
     GwNode **narray;
     char *nam;
@@ -1707,8 +1710,8 @@ eptr ExpandNode(GwNode *n)
         nam = (char *)g_alloca(offset + 20 + 30);
         memcpy(nam, namex, offset);
 
-        if (!n->harray) /* make quick array lookup for aet display--normally this is done in addnode
-                         */
+        if (!n->harray && !n->columns) /* make quick array lookup for aet display--normally this
+                                          is done in addnode */
         {
             GwHistEnt *histpnt;
             int histcount;
@@ -1737,12 +1740,11 @@ eptr ExpandNode(GwNode *n)
             }
         }
 
-        h = &(n->head);
-        while (h) {
-            if (h->flags & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))
+        gw_hist_iter_init(&h, n);
+        do {
+            if (gw_hist_iter_get_flags(&h) & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))
                 return (NULL);
-            h = h->next;
-        }
+        } while (gw_hist_iter_next(&h));
 
         DEBUG(fprintf(stderr,
                       "Expanding: (%d to %d) for %d bits over %d entries.\n",
@@ -1784,27 +1786,31 @@ eptr ExpandNode(GwNode *n)
 
         GwTimeRange *time_range = gw_dump_file_get_time_range(GLOBALS->dump_file);
 
-        for (i = 0; i < n->numhist; i++) {
-            h = n->harray[i];
-            if (!gw_time_range_contains(time_range, h->time)) {
+        vec = malloc_2(width);
+        gw_hist_iter_init(&h, n);
+        for (i = 0; i < n->numhist; i++, gw_hist_iter_next(&h)) {
+            if (!gw_time_range_contains(time_range, gw_hist_iter_get_time(&h))) {
                 for (j = 0; j < width; j++) {
                     if (narray[j]->curr) {
                         htemp = calloc_2(1, sizeof(GwHistEnt));
                         htemp->v.h_val = GW_BIT_X; /* 'x' */
-                        htemp->time = h->time;
+                        htemp->time = gw_hist_iter_get_time(&h);
                         narray[j]->curr->next = htemp;
                         narray[j]->curr = htemp;
                     } else {
                         narray[j]->head.v.h_val = GW_BIT_X; /* 'x' */
-                        narray[j]->head.time = h->time;
+                        narray[j]->head.time = gw_hist_iter_get_time(&h);
                         narray[j]->curr = &(narray[j]->head);
                     }
 
                     narray[j]->numhist++;
                 }
             } else {
+                if (!gw_hist_iter_get_vector(&h, vec)) {
+                    memset(vec, GW_BIT_X, width);
+                }
                 for (j = 0; j < width; j++) {
-                    unsigned char val = h->v.h_vector[j];
+                    unsigned char val = vec[j];
                     switch (val) {
                         case '0':
                             val = GW_BIT_0;
@@ -1848,7 +1854,7 @@ eptr ExpandNode(GwNode *n)
                     {
                         htemp = calloc_2(1, sizeof(GwHistEnt));
                         htemp->v.h_val = val;
-                        htemp->time = h->time;
+                        htemp->time = gw_hist_iter_get_time(&h);
                         narray[j]->curr->next = htemp;
                         narray[j]->curr = htemp;
                         narray[j]->numhist++;
@@ -1857,6 +1863,8 @@ eptr ExpandNode(GwNode *n)
             }
         }
 
+        free_2(vec);
+
         for (i = 0; i < width; i++) {
             narray[i]->harray = calloc_2(narray[i]->numhist, sizeof(GwHistEnt *));
             htemp = &(narray[i]->head);
@@ -1875,8 +1883,9 @@ eptr ExpandNode(GwNode *n)
 GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
 {
     int lft, rgh;
-    GwHistEnt *h;
+    GwHistIter h;
     GwHistEnt *htemp;
+    char *vec;
     int i, j;
     int actual;
     GwNode *np;
@@ -1962,8 +1971,8 @@ GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
         nam = (char *)g_alloca(offset + 20);
         memcpy(nam, namex, offset);
 
-        if (!n->harray) /* make quick array lookup for aet display--normally this is done in addnode
-                         */
+        if (!n->harray && !n->columns) /* make quick array lookup for aet display--normally this
+                                          is done in addnode */
         {
             GwHistEnt *histpnt;
             int histcount;
@@ -1992,12 +2001,11 @@ GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
             }
         }
 
-        h = &(n->head);
-        while (h) {
-            if (h->flags & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))
+        gw_hist_iter_init(&h, n);
+        do {
+            if (gw_hist_iter_get_flags(&h) & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))
                 return (NULL);
-            h = h->next;
-        }
+        } while (gw_hist_iter_next(&h));
 
         DEBUG(fprintf(stderr,
                       "Extracting: (%d to %d) for offset #%d over %d entries.\n",
@@ -2041,24 +2049,26 @@ GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
 
         GwTimeRange *time_range = gw_dump_file_get_time_range(GLOBALS->dump_file);
 
-        for (i = 0; i < n->numhist; i++) {
-            h = n->harray[i];
-            if (!gw_time_range_contains(time_range, h->time)) {
+        vec = malloc_2(width);
+        gw_hist_iter_init(&h, n);
+        for (i = 0; i < n->numhist; i++, gw_hist_iter_next(&h)) {
+            if (!gw_time_range_contains(time_range, gw_hist_iter_get_time(&h))) {
                 if (np->curr) {
                     htemp = calloc_2(1, sizeof(GwHistEnt));
                     htemp->v.h_val = GW_BIT_X; /* 'x' */
-                    htemp->time = h->time;
+                    htemp->time = gw_hist_iter_get_time(&h);
                     np->curr->next = htemp;
                     np->curr = htemp;
                 } else {
                     np->head.v.h_val = GW_BIT_X; /* 'x' */
-                    np->head.time = h->time;
+                    np->head.time = gw_hist_iter_get_time(&h);
                     np->curr = &(np->head);
                 }
 
                 np->numhist++;
             } else {
-                unsigned char val = h->v.h_vector[bit];
+                unsigned char val =
+                    gw_hist_iter_get_vector(&h, vec) ? (unsigned char)vec[bit] : GW_BIT_X;
                 switch (val) {
                     case '0':
                         val = GW_BIT_0;
@@ -2102,7 +2112,7 @@ GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
                 {
                     htemp = calloc_2(1, sizeof(GwHistEnt));
                     htemp->v.h_val = val;
-                    htemp->time = h->time;
+                    htemp->time = gw_hist_iter_get_time(&h);
                     np->curr->next = htemp;
                     np->curr = htemp;
                     np->numhist++;
@@ -2110,6 +2120,8 @@ GwNode *ExtractNodeSingleBit(GwNode *n, int bit)
             }
         }
 
+        free_2(vec);
+
         np->harray = calloc_2(np->numhist, sizeof(GwHistEnt *));
         htemp = &(np->head);
         for (j = 0; j < np->numhist; j++) {
@@ -2137,6 +2149,7 @@ void DeleteNode(GwNode *n)
                 free_2(n->harray[i]);
             }
             free_2(n->harray);
+            hist_lod_free(n->lod);
             free_2(n->expansion);
             free_2(n->nname);
             free_2(n);
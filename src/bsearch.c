@@ -68,118 +68,137 @@ int bsearch_timechain(GwTime key)
 
 /*****************************************************************************************/
 
-static int compar_histent(const void *s1, const void *s2)
-{
-    GwTime key, obj, delta;
-    GwHistEnt *cpos;
-    int rv;
+/*
+ * Stores the index of the last element whose time is <= key in result, or -1
+ * if there is none. Unlike libc bsearch() there is no comparator callback and
+ * the loop body compiles to a conditional move instead of a branch.
+ */
+#define BSEARCH_LAST_LE(array, count, key, result) \
+    do { \
+        int base_ = 0; \
+        int len_ = (count); \
+        while (len_ > 1) { \
+            int half_ = len_ / 2; \
+            base_ = ((array)[base_ + half_]->time <= (key)) ? base_ + half_ : base_; \
+            len_ -= half_; \
+        } \
+        (result) = ((count) > 0 && (array)[base_]->time <= (key)) ? base_ : -1; \
+    } while (0)
 
-    key = *((GwTime *)s1);
-    obj = (cpos = (*((GwHistEnt **)s2)))->time;
+/*
+ * Gallops forward from a previous result. Scrolling and rendering mostly move
+ * forward by a few entries, which makes repeated lookups amortized O(1).
+ */
+#define BSEARCH_LAST_LE_HINT(array, count, key, hint, result) \
+    do { \
+        int lo_ = (hint); \
+        int step_ = 1; \
+        while (lo_ + step_ < (count) && (array)[lo_ + step_]->time <= (key)) { \
+            lo_ += step_; \
+            step_ <<= 1; \
+        } \
+        int hi_ = MIN(lo_ + step_, (count)); \
+        int found_; \
+        BSEARCH_LAST_LE((array) + lo_, hi_ - lo_, (key), found_); \
+        (result) = lo_ + found_; \
+    } while (0)
 
-    if ((obj <= key) && (obj > GLOBALS->max_compare_time_bsearch_c_1)) {
-        GLOBALS->max_compare_time_bsearch_c_1 = obj;
-        GLOBALS->max_compare_pos_bsearch_c_1 = cpos;
-        GLOBALS->max_compare_index = (GwHistEnt **)s2;
+/*
+ * reentrant version of bsearch_node(), safe to call from worker threads as
+ * long as the node is not modified. If pos is not NULL, it may hold the
+ * index returned by a previous call (or -1) as a starting point and it
+ * receives the index of the returned entry. Nodes with columns are searched
+ * through their time column, all other nodes through their harray.
+ */
+void bsearch_node_hint(GwNode *n, GwTime key, int *pos, GwHistIter *iter)
+{
+    GwTime next;
+    int i;
+
+    if (n->columns != NULL) {
+        i = gw_hist_columns_find(n->columns, key);
+    } else if (pos != NULL && *pos >= 0 && *pos < n->numhist && n->harray[*pos]->time <= key) {
+        BSEARCH_LAST_LE_HINT(n->harray, n->numhist, key, *pos, i);
+    } else {
+        BSEARCH_LAST_LE(n->harray, n->numhist, key, i);
     }
 
-    delta = key - obj;
-    if (delta < 0)
-        rv = -1;
-    else if (delta > 0)
-        rv = 1;
-    else
-        rv = 0;
+    gw_hist_iter_init_at(iter, n, MAX(i, 0));
+    if (i < 0 || gw_hist_iter_get_time(iter) < GW_TIME_CONSTANT(0)) {
+        /* nothing at or before key, start with the first real entry */
+        gw_hist_iter_init_at(iter, n, 1);
+        while (gw_hist_iter_get_next_time(iter, &next) && next == gw_hist_iter_get_time(iter)) {
+            gw_hist_iter_next(iter);
+        }
+    }
 
-    return (rv);
+    if (pos != NULL) {
+        *pos = gw_hist_iter_get_index(iter);
+    }
 }
 
-GwHistEnt *bsearch_node(GwNode *n, GwTime key)
+void bsearch_node(GwNode *n, GwTime key, GwHistIter *iter)
 {
-    GLOBALS->max_compare_time_bsearch_c_1 = -2;
-    GLOBALS->max_compare_pos_bsearch_c_1 = NULL;
-    GLOBALS->max_compare_index = NULL;
+    GwHistIter prev;
+    int i = -1;
 
-    if (bsearch(&key, n->harray, n->numhist, sizeof(GwHistEnt *), compar_histent)) {
-        /* nothing, all side effects are in bsearch */
-    }
+    bsearch_node_hint(n, key, &i, iter);
 
-    if ((!GLOBALS->max_compare_pos_bsearch_c_1) ||
-        (GLOBALS->max_compare_time_bsearch_c_1 < GW_TIME_CONSTANT(0))) {
-        GLOBALS->max_compare_pos_bsearch_c_1 = n->harray[1]; /* aix bsearch fix */
-        GLOBALS->max_compare_index = &(n->harray[1]);
+    /* callers step backwards from max_compare_index, so point it at the first of equal times */
+    prev = *iter;
+    while (i > 1 && gw_hist_iter_prev(&prev) &&
+           gw_hist_iter_get_time(&prev) == gw_hist_iter_get_time(iter)) {
+        i--;
     }
 
-    while (GLOBALS->max_compare_pos_bsearch_c_1->next) /* non-RoSync dumper deglitching fix */
-    {
-        if (GLOBALS->max_compare_pos_bsearch_c_1->time !=
-            GLOBALS->max_compare_pos_bsearch_c_1->next->time)
-            break;
-        GLOBALS->max_compare_pos_bsearch_c_1 = GLOBALS->max_compare_pos_bsearch_c_1->next;
-    }
-
-    return (GLOBALS->max_compare_pos_bsearch_c_1);
+    GLOBALS->max_compare_time_bsearch_c_1 = gw_hist_iter_get_time(iter);
+    GLOBALS->max_compare_index = i;
 }
 
 /*****************************************************************************************/
 
-static int compar_vectorent(const void *s1, const void *s2)
+/*
+ * reentrant version of bsearch_vector(), see bsearch_node_hint()
+ */
+GwVectorEnt *bsearch_vector_hint(GwBitVector *b, GwTime key, int *pos)
 {
-    GwTime key, obj, delta;
-    GwVectorEnt *cpos;
-    int rv;
-
-    key = *((GwTime *)s1);
-    /* obj=(cpos=(*((GwVectorEnt **)s2)))->time+GLOBALS->shift_timebase; */
+    int i;
 
-    obj = (cpos = (*((GwVectorEnt **)s2)))->time;
+    if (pos != NULL && *pos >= 0 && *pos < b->numregions && b->vectors[*pos]->time <= key) {
+        BSEARCH_LAST_LE_HINT(b->vectors, b->numregions, key, *pos, i);
+    } else {
+        BSEARCH_LAST_LE(b->vectors, b->numregions, key, i);
+    }
 
-    if ((obj <= key) && (obj > GLOBALS->vmax_compare_time_bsearch_c_1)) {
-        GLOBALS->vmax_compare_time_bsearch_c_1 = obj;
-        GLOBALS->vmax_compare_pos_bsearch_c_1 = cpos;
-        GLOBALS->vmax_compare_index = (GwVectorEnt **)s2;
+    if (i < 0 || b->vectors[i]->time < GW_TIME_CONSTANT(0)) {
+        /* vectors is allocated past its declared size, so index 1 always exists */
+        i = 1;
+        while (i + 1 < b->numregions && b->vectors[i + 1]->time == b->vectors[i]->time) {
+            i++;
+        }
     }
 
-    delta = key - obj;
-    if (delta < 0)
-        rv = -1;
-    else if (delta > 0)
-        rv = 1;
-    else
-        rv = 0;
+    if (pos != NULL) {
+        *pos = i;
+    }
 
-    return (rv);
+    return b->vectors[i];
 }
 
 GwVectorEnt *bsearch_vector(GwBitVector *b, GwTime key)
 {
-    GLOBALS->vmax_compare_time_bsearch_c_1 = -2;
-    GLOBALS->vmax_compare_pos_bsearch_c_1 = NULL;
-    GLOBALS->vmax_compare_index = NULL;
-
-    if (bsearch(&key, b->vectors, b->numregions, sizeof(GwVectorEnt *), compar_vectorent)) {
-        /* nothing, all side effects are in bsearch */
-    }
+    int i = -1;
+    GwVectorEnt *v = bsearch_vector_hint(b, key, &i);
 
-    if ((!GLOBALS->vmax_compare_pos_bsearch_c_1) ||
-        (GLOBALS->vmax_compare_time_bsearch_c_1 < GW_TIME_CONSTANT(0))) {
-        /* ignore warning: array index of '1' indexes past the end of an array (that contains 1
-         * elements) [-Warray-bounds] */
-        /* because this array is allocated with size > that declared in the structure definition via
-         * end of structure malloc padding */
-        GLOBALS->vmax_compare_pos_bsearch_c_1 = b->vectors[1]; /* aix bsearch fix */
-        GLOBALS->vmax_compare_index = &(b->vectors[1]);
+    while (i > 1 && b->vectors[i - 1]->time == v->time) {
+        i--;
     }
 
-    while (GLOBALS->vmax_compare_pos_bsearch_c_1->next) /* non-RoSync dumper deglitching fix */
-    {
-        if (GLOBALS->vmax_compare_pos_bsearch_c_1->time !=
-            GLOBALS->vmax_compare_pos_bsearch_c_1->next->time)
-            break;
-        GLOBALS->vmax_compare_pos_bsearch_c_1 = GLOBALS->vmax_compare_pos_bsearch_c_1->next;
-    }
+    GLOBALS->vmax_compare_time_bsearch_c_1 = v->time;
+    GLOBALS->vmax_compare_pos_bsearch_c_1 = v;
+    GLOBALS->vmax_compare_index = &(b->vectors[i]);
 
-    return (GLOBALS->vmax_compare_pos_bsearch_c_1);
+    return v;
 }
 
 /*****************************************************************************************/
@@ -263,25 +282,13 @@ char *bsearch_trunc_print(char *ascii, int maxlen)
 
 /*****************************************************************************************/
 
-static int compar_facs(const void *key, const void *v2)
-{
-    GwSymbol *s2;
-    int rc;
-    char *s3;
-
-    s2 = *((GwSymbol **)v2);
-    s3 = s2->name;
-    rc = sigcmp((char *)key, s3);
-
-    /* if(was_packed) free_2(s3); ...not needed with HIER_DEPACK_STATIC */
-
-    return (rc);
-}
-
-// TODO: move to GwFacs
+/*
+ * exact name lookup through the hash index of the facs, also resolves the
+ * name{row} syntax of array rows
+ */
 GwSymbol *bsearch_facs(char *ascii, unsigned int *rows_return)
 {
-    GwSymbol **rc;
+    GwSymbol *rc;
     int len;
 
     if ((!ascii) || (!(len = strlen(ascii))))
@@ -291,8 +298,6 @@ GwSymbol *bsearch_facs(char *ascii, unsigned int *rows_return)
     }
 
     GwFacs *facs = gw_dump_file_get_facs(GLOBALS->dump_file);
-    GwSymbol **facs_array = gw_facs_get_array(facs);
-    guint numfacs = gw_facs_get_length(facs);
 
     if (ascii[len - 1] == '}') {
         int i;
@@ -305,18 +310,17 @@ GwSymbol *bsearch_facs(char *ascii, unsigned int *rows_return)
                 memcpy(tsc, ascii, i + 1);
                 tsc[i] = 0;
 
-                rc =
-                    (GwSymbol **)bsearch(tsc, facs_array, numfacs, sizeof(GwSymbol *), compar_facs);
+                rc = gw_facs_lookup(facs, tsc);
                 if (rc) {
                     unsigned int whichrow = atoi(&ascii[i + 1]);
                     if (rows_return)
                         *rows_return = whichrow;
 
 #ifdef WAVE_ARRAY_SUPPORT
-                    if (whichrow <= (*rc)->n->array_height)
+                    if (whichrow <= rc->n->array_height)
 #endif
                     {
-                        return (*rc);
+                        return (rc);
                     }
                 }
             }
@@ -324,9 +328,5 @@ GwSymbol *bsearch_facs(char *ascii, unsigned int *rows_return)
         }
     }
 
-    rc = (GwSymbol **)bsearch(ascii, facs_array, numfacs, sizeof(GwSymbol *), compar_facs);
-    if (rc)
-        return (*rc);
-    else
-        return (NULL);
+    return (gw_facs_lookup(facs, ascii));
 }
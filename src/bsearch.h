@@ -13,8 +13,10 @@
 #define BSEARCH_NODES_VECTORS_H
 
 int bsearch_timechain(GwTime key);
-GwHistEnt *bsearch_node(GwNode *n, GwTime key);
+void bsearch_node(GwNode *n, GwTime key, GwHistIter *iter);
+void bsearch_node_hint(GwNode *n, GwTime key, int *pos, GwHistIter *iter);
 GwVectorEnt *bsearch_vector(GwBitVector *b, GwTime key);
+GwVectorEnt *bsearch_vector_hint(GwBitVector *b, GwTime key, int *pos);
 char *bsearch_trunc(char *ascii, int maxlen);
 char *bsearch_trunc_print(char *ascii, int maxlen);
 GwSymbol *bsearch_facs(char *ascii, unsigned int *rows_return);
@@ -34,6 +34,12 @@ static GwDumpFile *load(GwLoader *loader, const gchar *fname)
         exit(EXIT_FAILURE);
     }
 
+    // Keep the traces unloadable, so they can be dropped to stay within the budget.
+    if (GLOBALS->settings.mem_budget > 0) {
+        gw_dump_file_set_unloadable_traces(file, TRUE);
+    }
+    gw_dump_file_set_compact_histories(file, GLOBALS->settings.compact_histories);
+
     return file;
 }
 
@@ -49,6 +55,8 @@ GwDumpFile *vcd_recoder_main(char *fname)
                                               global_settings->vlist_compression_level);
     gw_vcd_loader_set_warning_filesize(GW_VCD_LOADER(loader),
                                        global_settings->vcd_warning_filesize);
+    gw_vcd_loader_set_use_cache(GW_VCD_LOADER(loader), global_settings->vcd_cache);
+    gw_vcd_loader_set_follow(GW_VCD_LOADER(loader), global_settings->vcd_follow);
 
     GwDumpFile *file = load(loader, fname);
 
@@ -85,6 +93,14 @@ GwDumpFile *fst_main(char *fname, char *skip_start, char *skip_end)
 
     g_object_unref(loader);
 
+    if (GLOBALS->settings.fst_lazy_import) {
+        // Start with an empty window, the first redraw imports the visible range.
+        GwTime start = gw_time_range_get_start(gw_dump_file_get_time_range(file));
+        GwTimeRange *window = gw_time_range_new(start, start);
+        gw_fst_file_set_import_window(GW_FST_FILE(file), window);
+        g_object_unref(window);
+    }
+
     GLOBALS->is_lx2 = LXT2_IS_FST;
 
     return file;
@@ -108,20 +108,17 @@ static void edge_search_2(int direction, int is_last_iteration)
                 t = s->trace;
                 GLOBALS->shift_timebase = t->shift;
                 if (!(t->vector)) {
-                    GwHistEnt *h;
-                    GwHistEnt **hp;
+                    GwHistIter *h = &s->his.h;
                     GwUTime utt;
                     GwTime tt;
 
-                    /* h= */ bsearch_node(t->n.nd, basetime - t->shift); /* scan-build */
-                    hp = GLOBALS->max_compare_index;
-                    if ((hp == &(t->n.nd->harray[1])) || (hp == &(t->n.nd->harray[0])))
+                    bsearch_node(t->n.nd, basetime - t->shift, h);
+                    if (GLOBALS->max_compare_index <= 1)
                         return;
-                    if (basetime == ((*hp)->time + GLOBALS->shift_timebase))
-                        hp--;
-                    h = *hp;
-                    s->his.h = h;
-                    utt = strace_adjust(h->time, GLOBALS->shift_timebase);
+                    gw_hist_iter_init_at(h, t->n.nd, GLOBALS->max_compare_index);
+                    if (basetime == (gw_hist_iter_get_time(h) + GLOBALS->shift_timebase))
+                        gw_hist_iter_prev(h);
+                    utt = strace_adjust(gw_hist_iter_get_time(h), GLOBALS->shift_timebase);
                     tt = utt;
                     if (tt > maxbase)
                         maxbase = tt;
@@ -155,19 +152,19 @@ static void edge_search_2(int direction, int is_last_iteration)
                 t = s->trace;
                 GLOBALS->shift_timebase = t->shift;
                 if (!(t->vector)) {
-                    GwHistEnt *h;
+                    GwHistIter *h = &s->his.h;
+                    GwTime next_time;
                     GwUTime utt;
                     GwTime tt;
 
-                    h = bsearch_node(t->n.nd, basetime - t->shift);
-                    while (h->next && h->time == h->next->time)
-                        h = h->next;
-                    if ((whichpass) || gw_marker_is_enabled(primary_marker))
-                        h = h->next;
-                    if (!h)
+                    bsearch_node(t->n.nd, basetime - t->shift, h);
+                    while (gw_hist_iter_get_next_time(h, &next_time) &&
+                           gw_hist_iter_get_time(h) == next_time)
+                        gw_hist_iter_next(h);
+                    if (((whichpass) || gw_marker_is_enabled(primary_marker)) &&
+                        !gw_hist_iter_next(h))
                         return;
-                    s->his.h = h;
-                    utt = strace_adjust(h->time, GLOBALS->shift_timebase);
+                    utt = strace_adjust(gw_hist_iter_get_time(h), GLOBALS->shift_timebase);
                     tt = utt;
                     if (tt < maxbase)
                         maxbase = tt;
@@ -207,21 +204,25 @@ static void edge_search_2(int direction, int is_last_iteration)
             GLOBALS->shift_timebase = t->shift;
 
             if ((!t->vector) && (!(t->n.nd->extvals))) {
-                if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                    s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                    while (s->his.h->next && s->his.h->time == s->his.h->next->time)
-                        s->his.h = s->his.h->next;
+                if (strace_adjust(gw_hist_iter_get_time(&s->his.h), GLOBALS->shift_timebase) !=
+                    maxbase) {
+                    GwTime next_time;
+
+                    bsearch_node(t->n.nd, maxbase - t->shift, &s->his.h);
+                    while (gw_hist_iter_get_next_time(&s->his.h, &next_time) &&
+                           gw_hist_iter_get_time(&s->his.h) == next_time)
+                        gw_hist_iter_next(&s->his.h);
                 }
 /* commented out, maybe will have possible future expansion later,
  * this was cut and pasted from strace.c */
 #if 0
 		if(t->flags&TR_INVERT)
                 	{
-                        str[0]=AN_STR_INV[s->his.h->v.h_val];
+                        str[0]=AN_STR_INV[gw_hist_iter_get_value(&s->his.h)];
                         }
                         else
                         {
-                        str[0]=AN_STR[s->his.h->v.h_val];
+                        str[0]=AN_STR[gw_hist_iter_get_value(&s->his.h)];
                         }
 		str[1]=0x00;
 #endif
@@ -283,6 +284,7 @@ static void edge_search_2(int direction, int is_last_iteration)
 
             } else {
                 char *chval, *chval2;
+                unsigned char flags;
                 char ch;
 
                 if (t->vector) {
@@ -293,27 +295,26 @@ static void edge_search_2(int direction, int is_last_iteration)
                     }
                     chval = convert_ascii(t, s->his.v);
                 } else {
-                    if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                        s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                        while (s->his.h->next && s->his.h->time == s->his.h->next->time)
-                            s->his.h = s->his.h->next;
+                    if (strace_adjust(gw_hist_iter_get_time(&s->his.h), GLOBALS->shift_timebase) !=
+                        maxbase) {
+                        GwTime next_time;
+
+                        bsearch_node(t->n.nd, maxbase - t->shift, &s->his.h);
+                        while (gw_hist_iter_get_next_time(&s->his.h, &next_time) &&
+                               gw_hist_iter_get_time(&s->his.h) == next_time)
+                            gw_hist_iter_next(&s->his.h);
                     }
-                    if (s->his.h->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(s->his.h->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            chval = convert_ascii_real(t, &s->his.h->v.h_double);
-                        } else {
-                            chval = convert_ascii_string((char *)s->his.h->v.h_vector);
-                            chval2 = chval;
-                            while ((ch = *chval2)) /* toupper() the string */
-                            {
-                                if ((ch >= 'a') && (ch <= 'z')) {
-                                    *chval2 = ch - ('a' - 'A');
-                                }
-                                chval2++;
+                    flags = gw_hist_iter_get_flags(&s->his.h);
+                    chval = convert_ascii_hist(t, &s->his.h);
+                    if ((flags & GW_HIST_ENT_FLAG_REAL) && (flags & GW_HIST_ENT_FLAG_STRING)) {
+                        chval2 = chval;
+                        while ((ch = *chval2)) /* toupper() the string */
+                        {
+                            if ((ch >= 'a') && (ch <= 'z')) {
+                                *chval2 = ch - ('a' - 'A');
                             }
+                            chval2++;
                         }
-                    } else {
-                        chval = convert_ascii_vec(t, s->his.h->v.h_vector);
                     }
                 }
 
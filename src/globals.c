@@ -85,7 +85,6 @@ static const struct Global globals_base_values = {
     0, /* max_compare_time_tc_bsearch_c_1 12 */
     0, /* max_compare_pos_tc_bsearch_c_1 13 */
     0, /* max_compare_time_bsearch_c_1 14 */
-    0, /* max_compare_pos_bsearch_c_1 15 */
     0, /* max_compare_index 16 */
     0, /* vmax_compare_time_bsearch_c_1 17 */
     0, /* vmax_compare_pos_bsearch_c_1 18 */
@@ -482,11 +481,6 @@ static const struct Global globals_base_values = {
     0, /* strace_current_window */
     1, /* strace_repeat_count */
 
-    /*
-     * symbol.c
-     */
-    0, /* facs_have_symbols_state_machine */
-
     /*
      * tcl_commands.c
      */
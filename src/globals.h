@@ -77,7 +77,13 @@ typedef struct
     gboolean preserve_glitches;
     gboolean preserve_glitches_real;
 
+    gboolean fst_lazy_import;
+    gsize mem_budget;
+    gboolean compact_histories;
+
     gsize vcd_warning_filesize;
+    gboolean vcd_cache;
+    gboolean vcd_follow;
 } Settings;
 
 struct Global
@@ -114,8 +120,7 @@ struct Global
     GwTime max_compare_time_tc_bsearch_c_1; /* from bsearch.c 12 */
     GwTime *max_compare_pos_tc_bsearch_c_1; /* from bsearch.c 13 */
     GwTime max_compare_time_bsearch_c_1; /* from bsearch.c 14 */
-    GwHistEnt *max_compare_pos_bsearch_c_1; /* from bsearch.c 15 */
-    GwHistEnt **max_compare_index; /* from bsearch.c 16 */
+    int max_compare_index; /* from bsearch.c 16 */
     GwTime vmax_compare_time_bsearch_c_1; /* from bsearch.c 17 */
     GwVectorEnt *vmax_compare_pos_bsearch_c_1; /* from bsearch.c 18 */
     GwVectorEnt **vmax_compare_index; /* from bsearch.c 19 */
@@ -476,11 +481,6 @@ struct Global
     int strace_current_window;
     int strace_repeat_count;
 
-/*
- * symbol.c
- */
-    char facs_have_symbols_state_machine; /* from symbol.c */
-
     /*
      * tcl_commands.c
      */
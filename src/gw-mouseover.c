@@ -119,41 +119,32 @@ static gchar *local_trace_asciival(GwTrace *t, GwTime tim)
             return convert_ascii(t, v);
         } else {
             char *str;
-            GwHistEnt *h_ptr;
-            if ((h_ptr = bsearch_node(t->n.nd, tim - t->shift))) {
-                if (!t->n.nd->extvals) {
-                    GwMarker *primary_marker = gw_project_get_primary_marker(GLOBALS->project);
-                    GwTime primary_pos = gw_marker_get_position(primary_marker);
-
-                    unsigned char h_val = h_ptr->v.h_val;
-                    if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
-                        h_val = (h_ptr->time >= GLOBALS->tims.first) &&
-                                        ((primary_pos - GLOBALS->shift_timebase) == h_ptr->time)
-                                    ? GW_BIT_1
-                                    : GW_BIT_0; /* generate impulse */
-                    }
-
-                    if (t->flags & TR_INVERT) {
-                        h_val = gw_bit_invert(h_val);
-                    }
-
-                    str = (char *)calloc_2(1, 2 * sizeof(char));
-                    str[0] = gw_bit_to_char(h_val);
-
-                    return str;
-                } else {
-                    if (h_ptr->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(h_ptr->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            str = convert_ascii_real(t, &h_ptr->v.h_double);
-                        } else {
-                            str = convert_ascii_string((char *)h_ptr->v.h_vector);
-                        }
-                    } else {
-                        str = convert_ascii_vec(t, h_ptr->v.h_vector);
-                    }
-
-                    return str;
+            GwHistIter h_iter;
+
+            bsearch_node(t->n.nd, tim - t->shift, &h_iter);
+            if (!t->n.nd->extvals) {
+                GwMarker *primary_marker = gw_project_get_primary_marker(GLOBALS->project);
+                GwTime primary_pos = gw_marker_get_position(primary_marker);
+                GwTime h_time = gw_hist_iter_get_time(&h_iter);
+
+                unsigned char h_val = gw_hist_iter_get_value(&h_iter);
+                if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
+                    h_val = (h_time >= GLOBALS->tims.first) &&
+                                    ((primary_pos - GLOBALS->shift_timebase) == h_time)
+                                ? GW_BIT_1
+                                : GW_BIT_0; /* generate impulse */
                 }
+
+                if (t->flags & TR_INVERT) {
+                    h_val = gw_bit_invert(h_val);
+                }
+
+                str = (char *)calloc_2(1, 2 * sizeof(char));
+                str[0] = gw_bit_to_char(h_val);
+
+                return str;
+            } else {
+                return convert_ascii_hist(t, &h_iter);
             }
         }
     }
@@ -6,6 +6,8 @@
 #include "globals.h"
 #include "signal_list.h"
 #include "wavewindow.h"
+#include "hist_lod.h"
+#include "lx2.h"
 
 static GwColor XXX_get_gc_from_name(const char *str)
 {
@@ -116,7 +118,7 @@ static void draw_hptr_trace(GwWaveView *self,
                             cairo_t *cr,
                             GwWaveformColors *colors,
                             GwTrace *t,
-                            GwHistEnt *h,
+                            const GwHistIter *h,
                             int which,
                             int dodraw,
                             int kill_grid);
@@ -124,7 +126,7 @@ static void draw_hptr_trace_vector(GwWaveView *self,
                                    cairo_t *cr,
                                    GwWaveformColors *colors,
                                    GwTrace *t,
-                                   GwHistEnt *h,
+                                   const GwHistIter *h,
                                    int which);
 static void draw_vptr_trace(GwWaveView *self,
                             cairo_t *cr,
@@ -135,10 +137,13 @@ static void draw_vptr_trace(GwWaveView *self,
 
 void gw_wave_view_render_traces(GwWaveView *self, cairo_t *cr)
 {
+    lx2_import_visible_window();
+    lx2_enforce_mem_budget();
+
     GwTrace *t = gw_signal_list_get_trace(GW_SIGNAL_LIST(GLOBALS->signalarea), 0);
     if (t) {
         GwTrace *tback = t;
-        GwHistEnt *h;
+        GwHistIter h;
         GwVectorEnt *v;
         int i = 0, num_traces_displayable;
         int iback = 0;
@@ -181,17 +186,17 @@ void gw_wave_view_render_traces(GwWaveView *self, cairo_t *cr)
             if (!(t->flags & (TR_EXCLUDE | TR_BLANK | TR_ANALOG_BLANK_STRETCH))) {
                 GLOBALS->shift_timebase = t->shift;
                 if (!t->vector) {
-                    h = bsearch_node(t->n.nd, GLOBALS->tims.start - t->shift);
+                    bsearch_node(t->n.nd, GLOBALS->tims.start - t->shift, &h);
                     DEBUG(printf("Start time: %" GW_TIME_FORMAT ", Histent time: %" GW_TIME_FORMAT
                                  "\n",
                                  GLOBALS->tims.start,
-                                 (h->time + GLOBALS->shift_timebase)));
+                                 (gw_hist_iter_get_time(&h) + GLOBALS->shift_timebase)));
 
                     if (i >= 0) {
                         if (!t->n.nd->extvals) {
-                            draw_hptr_trace(self, cr, colors, t, h, i, 1, 0);
+                            draw_hptr_trace(self, cr, colors, t, &h, i, 1, 0);
                         } else {
-                            draw_hptr_trace_vector(self, cr, colors, t, h, i);
+                            draw_hptr_trace_vector(self, cr, colors, t, &h, i);
                         }
                     }
                 } else {
@@ -271,16 +276,16 @@ static void draw_hptr_trace(GwWaveView *self,
                             cairo_t *cr,
                             GwWaveformColors *colors,
                             GwTrace *t,
-                            GwHistEnt *h,
+                            const GwHistIter *h,
                             int which,
                             int dodraw,
                             int kill_grid)
 {
     GwTime _x0, _x1, newtime;
+    int pos = -1; /* search hint, the skips below only move forward */
     int _y0, _y1, yu, liney, ytext;
     GwTime tim, h2tim;
-    GwHistEnt *h2;
-    GwHistEnt *h3;
+    GwHistIter iter, next, skip;
     char hval, h2val, invert;
     LineColor c;
     GwColor gcx, gcxf;
@@ -327,9 +332,10 @@ static void draw_hptr_trace(GwWaveView *self,
                           liney);
     }
 
-    if ((h) && (GLOBALS->tims.start == h->time))
-        if (h->v.h_val != GW_BIT_Z) {
-            switch (h->v.h_val) {
+    if ((h) && (GLOBALS->tims.start == gw_hist_iter_get_time(h))) {
+        hval = gw_hist_iter_get_value(h);
+        if (hval != GW_BIT_Z) {
+            switch (hval) {
                 case GW_BIT_X:
                     c = LINE_COLOR_X;
                     break;
@@ -343,16 +349,17 @@ static void draw_hptr_trace(GwWaveView *self,
                     c = LINE_COLOR_DASH;
                     break;
                 default:
-                    c = (h->v.h_val == GW_BIT_X) ? LINE_COLOR_X : LINE_COLOR_TRANS;
+                    c = (hval == GW_BIT_X) ? LINE_COLOR_X : LINE_COLOR_TRANS;
             }
             line_buffer_add(lines, c, 0, _y0, 0, _y1);
         }
+    }
+
+    if (dodraw && t && h) {
+        iter = *h;
 
-    if (dodraw && t)
         for (;;) {
-            if (!h)
-                break;
-            tim = (h->time);
+            tim = gw_hist_iter_get_time(&iter);
 
             if ((tim > GLOBALS->tims.end) || (tim > GLOBALS->tims.last))
                 break;
@@ -364,10 +371,10 @@ static void draw_hptr_trace(GwWaveView *self,
                 break;
             }
 
-            h2 = h->next;
-            if (!h2)
+            next = iter;
+            if (!gw_hist_iter_next(&next))
                 break;
-            h2tim = tim = (h2->time);
+            h2tim = tim = gw_hist_iter_get_time(&next);
             if (tim > GLOBALS->tims.last)
                 tim = GLOBALS->tims.last;
             else if (tim > GLOBALS->tims.end + 1)
@@ -381,17 +388,17 @@ static void draw_hptr_trace(GwWaveView *self,
 
             if (_x0 != _x1) {
                 if (is_event) {
-                    if (h->time >= GLOBALS->tims.first) {
+                    if (gw_hist_iter_get_time(&iter) >= GLOBALS->tims.first) {
                         line_buffer_add(lines, LINE_COLOR_W, _x0, _y0, _x0, _y1);
                         line_buffer_add(lines, LINE_COLOR_W, _x0, _y1, _x0 + 2, _y1 + 2);
                         line_buffer_add(lines, LINE_COLOR_W, _x0, _y1, _x0 - 2, _y1 + 2);
                     }
-                    h = h->next;
+                    iter = next;
                     continue;
                 }
 
-                hval = h->v.h_val;
-                h2val = h2->v.h_val;
+                hval = gw_hist_iter_get_value(&iter);
+                h2val = gw_hist_iter_get_value(&next);
 
                 switch (h2val) {
                     case GW_BIT_X:
@@ -601,7 +608,19 @@ static void draw_hptr_trace(GwWaveView *self,
                 }
             } else {
                 if (!is_event) {
-                    line_buffer_add(lines, LINE_COLOR_TRANS, _x1, _y0, _x1, _y1);
+                    HistLod *lod = hist_lod_for_node(t->n.nd);
+
+                    c = LINE_COLOR_TRANS;
+                    if (lod != NULL) {
+                        /* show x-like values that are hidden inside a dense pixel */
+                        GwTime pixel_start = _x1 * GLOBALS->nspx + GLOBALS->tims.start;
+                        GwTime pixel_end = (_x1 + 1) * GLOBALS->nspx + GLOBALS->tims.start;
+                        if (hist_lod_get_classes(lod, pixel_start, pixel_end) &
+                            HIST_LOD_CLASS_X) {
+                            c = LINE_COLOR_X;
+                        }
+                    }
+                    line_buffer_add(lines, c, _x1, _y0, _x1, _y1);
                 } else {
                     line_buffer_add(lines, LINE_COLOR_W, _x1, _y0, _x1, _y1);
                     line_buffer_add(lines, LINE_COLOR_W, _x0, _y1, _x0 + 2, _y1 + 2);
@@ -609,19 +628,22 @@ static void draw_hptr_trace(GwWaveView *self,
                 }
                 newtime = (((gdouble)(_x1 + WAVE_OPT_SKIP)) * GLOBALS->nspx) +
                           GLOBALS->tims.start /*+GLOBALS->shift_timebase*/; /* skip to next pixel */
-                h3 = bsearch_node(t->n.nd, newtime);
-                if (h3->time > h->time) {
-                    h = h3;
+                skip = iter;
+                hist_lod_seek(t->n.nd, &skip, newtime, &pos);
+                if (gw_hist_iter_get_time(&skip) > gw_hist_iter_get_time(&iter)) {
+                    iter = skip;
                     continue;
                 }
             }
 
-            if ((h->flags & GW_HIST_ENT_FLAG_GLITCH) && (GLOBALS->settings.preserve_glitches)) {
+            if ((gw_hist_iter_get_flags(&iter) & GW_HIST_ENT_FLAG_GLITCH) &&
+                (GLOBALS->settings.preserve_glitches)) {
                 XXX_gdk_draw_rectangle(cr, colors->stroke_z, TRUE, _x1 - 1, yu - 1, 3, 3);
             }
 
-            h = h->next;
+            iter = next;
         }
+    }
 
     line_buffer_draw(lines, cr);
     line_buffer_free(lines);
@@ -632,19 +654,39 @@ static void draw_hptr_trace(GwWaveView *self,
 
 /********************************************************************************************************/
 
+/*
+ * the value of an analog entry, strings and vectors after the last time are NaN.
+ * vec is scratch space for the bits of the node.
+ */
+static double hist_iter_analog_value(GwTrace *t, const GwHistIter *h, char *vec)
+{
+    unsigned char flags = gw_hist_iter_get_flags(h);
+
+    if (flags & GW_HIST_ENT_FLAG_REAL) {
+        if (!(flags & GW_HIST_ENT_FLAG_STRING))
+            return gw_hist_iter_get_real(h);
+    } else {
+        if (gw_hist_iter_get_time(h) <= GLOBALS->tims.last)
+            return convert_real_vec(t, gw_hist_iter_get_vector(h, vec) ? vec : NULL);
+    }
+
+    return strtod("NaN", NULL);
+}
+
 static void draw_hptr_trace_vector_analog(GwWaveView *self,
                                           cairo_t *cr,
                                           GwWaveformColors *colors,
                                           GwTrace *t,
-                                          GwHistEnt *h,
+                                          const GwHistIter *hist,
                                           int which,
                                           int num_extension)
 {
     GwTime _x0, _x1, newtime;
+    int pos = -1; /* search hint, the skips below only move forward */
     int _y0, _y1, yu, liney, yt0, yt1;
     GwTime tim, h2tim;
-    GwHistEnt *h2;
-    GwHistEnt *h3;
+    GwHistIter h, h2, h3;
+    char *vec;
     int endcnt = 0;
     int type;
     /* int lasttype=-1; */ /* scan-build */
@@ -668,23 +710,16 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
     _y0 = liney - 2;
     yu = (_y0 + _y1) / 2;
 
+    vec = malloc_2(ABS(t->n.nd->msi - t->n.nd->lsi) + 1);
+
     if (t->flags & TR_ANALOG_FULLSCALE) /* otherwise use dynamic */
     {
         if ((!t->minmax_valid) || (t->d_num_ext != num_extension)) {
-            h3 = &t->n.nd->head;
-            for (;;) {
-                if (!h3)
-                    break;
-
-                if ((h3->time >= GLOBALS->tims.first) && (h3->time <= GLOBALS->tims.last)) {
-                    tv = mynan;
-                    if (h3->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(h3->flags & GW_HIST_ENT_FLAG_STRING))
-                            tv = h3->v.h_double;
-                    } else {
-                        if (h3->time <= GLOBALS->tims.last)
-                            tv = convert_real_vec(t, h3->v.h_vector);
-                    }
+            gw_hist_iter_init(&h3, t->n.nd);
+            do {
+                tim = gw_hist_iter_get_time(&h3);
+                if ((tim >= GLOBALS->tims.first) && (tim <= GLOBALS->tims.last)) {
+                    tv = hist_iter_analog_value(t, &h3, vec);
 
                     if (!isnan(tv) && !isinf(tv)) {
                         if (isnan(tmin) || tv < tmin)
@@ -701,8 +736,7 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
                         }
                     }
                 }
-                h3 = h3->next;
-            }
+            } while (gw_hist_iter_next(&h3));
 
             if (isnan(tmin) || isnan(tmax)) {
                 tmin = tmax = 0;
@@ -733,11 +767,9 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
             tmax = t->d_maxval;
         }
     } else {
-        h3 = h;
+        h3 = *hist;
         for (;;) {
-            if (!h3)
-                break;
-            tim = (h3->time);
+            tim = gw_hist_iter_get_time(&h3);
             if (tim > GLOBALS->tims.end) {
                 endcnt++;
                 if (endcnt == 2)
@@ -751,14 +783,7 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
                 break;
             }
 
-            tv = mynan;
-            if (h3->flags & GW_HIST_ENT_FLAG_REAL) {
-                if (!(h3->flags & GW_HIST_ENT_FLAG_STRING))
-                    tv = h3->v.h_double;
-            } else {
-                if (h3->time <= GLOBALS->tims.last)
-                    tv = convert_real_vec(t, h3->v.h_vector);
-            }
+            tv = hist_iter_analog_value(t, &h3, vec);
 
             if (!isnan(tv) && !isinf(tv)) {
                 if (isnan(tmin) || tv < tmin)
@@ -774,7 +799,8 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
                 }
             }
 
-            h3 = h3->next;
+            if (!gw_hist_iter_next(&h3))
+                break;
         }
 
         if (isnan(tmin) || isnan(tmax))
@@ -804,11 +830,9 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
     }
 
     /* now do the actual drawing */
-    h3 = NULL;
+    h = *hist;
     for (;;) {
-        if (!h)
-            break;
-        tim = (h->time);
+        tim = gw_hist_iter_get_time(&h);
         if ((tim > GLOBALS->tims.end) || (tim > GLOBALS->tims.last))
             break;
 
@@ -826,10 +850,10 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
                 }
         */
 
-        h2 = h->next;
-        if (!h2)
+        h2 = h;
+        if (!gw_hist_iter_next(&h2))
             break;
-        h2tim = tim = (h2->time);
+        h2tim = tim = gw_hist_iter_get_time(&h2);
         if (tim > GLOBALS->tims.last)
             tim = GLOBALS->tims.last;
         /*	else if(tim>GLOBALS->tims.end+1) tim=GLOBALS->tims.end+1; */
@@ -848,26 +872,11 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
         */
 
         /* draw trans */
-        type = (!(h->flags & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING)))
-                   ? vtype(t, h->v.h_vector)
+        type = (!(gw_hist_iter_get_flags(&h) & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING)))
+                   ? vtype(t, gw_hist_iter_get_vector(&h, vec) ? vec : NULL)
                    : GW_BIT_COUNT;
-        tv = tv2 = mynan;
-
-        if (h->flags & GW_HIST_ENT_FLAG_REAL) {
-            if (!(h->flags & GW_HIST_ENT_FLAG_STRING))
-                tv = h->v.h_double;
-        } else {
-            if (h->time <= GLOBALS->tims.last)
-                tv = convert_real_vec(t, h->v.h_vector);
-        }
-
-        if (h2->flags & GW_HIST_ENT_FLAG_REAL) {
-            if (!(h2->flags & GW_HIST_ENT_FLAG_STRING))
-                tv2 = h2->v.h_double;
-        } else {
-            if (h2->time <= GLOBALS->tims.last)
-                tv2 = convert_real_vec(t, h2->v.h_vector);
-        }
+        tv = hist_iter_analog_value(t, &h, vec);
+        tv2 = hist_iter_analog_value(t, &h2, vec);
 
         if ((is_inf = isinf(tv))) {
             if (tv < 0) {
@@ -908,10 +917,8 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
                 c = colors->stroke_x;
             }
 
-            if (h->next) {
-                if (h->next->time > max_time) {
-                    yt1 = yt0;
-                }
+            if (h2tim > max_time) {
+                yt1 = yt0;
             }
 
             cfixed = is_inf ? cinf : c;
@@ -1054,17 +1061,19 @@ static void draw_hptr_trace_vector_analog(GwWaveView *self,
         } else {
             newtime = (((gdouble)(_x1 + WAVE_OPT_SKIP)) * GLOBALS->nspx) +
                       GLOBALS->tims.start /*+GLOBALS->shift_timebase*/; /* skip to next pixel */
-            h3 = bsearch_node(t->n.nd, newtime);
-            if (h3->time > h->time) {
+            hist_lod_bsearch_node(t->n.nd, newtime, &pos, &h3);
+            if (gw_hist_iter_get_time(&h3) > gw_hist_iter_get_time(&h)) {
                 h = h3;
                 /* lasttype=type; */ /* scan-build */
                 continue;
             }
         }
 
-        h = h->next;
+        h = h2;
         /* lasttype=type; */ /* scan-build */
     }
+
+    free_2(vec);
 }
 
 /*
@@ -1074,14 +1083,16 @@ static void draw_hptr_trace_vector(GwWaveView *self,
                                    cairo_t *cr,
                                    GwWaveformColors *colors,
                                    GwTrace *t,
-                                   GwHistEnt *h,
+                                   const GwHistIter *hist,
                                    int which)
 {
     GwTime _x0, _x1, newtime;
+    int pos = -1; /* search hint, the skips below only move forward */
     int _y0, _y1, yu, liney, ytext;
     GwTime tim /* , h2tim */; /* scan-build */
-    GwHistEnt *h2;
-    GwHistEnt *h3;
+    GwHistIter h, h2, h3;
+    const char *str;
+    char *vec;
     char *ascii = NULL;
     int type;
 
@@ -1132,7 +1143,8 @@ static void draw_hptr_trace_vector(GwWaveView *self,
     }
 
     if ((t->flags & TR_ANALOGMASK) &&
-        (!(h->flags & GW_HIST_ENT_FLAG_STRING) || !(h->flags & GW_HIST_ENT_FLAG_REAL))) {
+        (!(gw_hist_iter_get_flags(hist) & GW_HIST_ENT_FLAG_STRING) ||
+         !(gw_hist_iter_get_flags(hist) & GW_HIST_ENT_FLAG_REAL))) {
         GwTrace *te = GiveNextTrace(t);
         int ext = 0;
 
@@ -1156,7 +1168,7 @@ static void draw_hptr_trace_vector(GwWaveView *self,
                                    GLOBALS->fontheight * ext);
         }
 
-        draw_hptr_trace_vector_analog(self, cr, colors, t, h, which, ext);
+        draw_hptr_trace_vector_analog(self, cr, colors, t, hist, which, ext);
         GLOBALS->tims.start += GLOBALS->shift_timebase;
         GLOBALS->tims.end += GLOBALS->shift_timebase;
         return;
@@ -1164,10 +1176,10 @@ static void draw_hptr_trace_vector(GwWaveView *self,
 
     GLOBALS->color_active_in_filter = 1;
 
+    vec = malloc_2(ABS(t->n.nd->msi - t->n.nd->lsi) + 1);
+    h = *hist;
     for (;;) {
-        if (!h)
-            break;
-        tim = (h->time);
+        tim = gw_hist_iter_get_time(&h);
         if ((tim > GLOBALS->tims.end) || (tim > GLOBALS->tims.last))
             break;
 
@@ -1178,10 +1190,10 @@ static void draw_hptr_trace_vector(GwWaveView *self,
             break;
         }
 
-        h2 = h->next;
-        if (!h2)
+        h2 = h;
+        if (!gw_hist_iter_next(&h2))
             break;
-        /* h2tim= */ tim = (h2->time); /* scan-build */
+        /* h2tim= */ tim = gw_hist_iter_get_time(&h2); /* scan-build */
         if (tim > GLOBALS->tims.last)
             tim = GLOBALS->tims.last;
         else if (tim > GLOBALS->tims.end + 1)
@@ -1194,18 +1206,18 @@ static void draw_hptr_trace_vector(GwWaveView *self,
         }
 
         /* draw trans */
-        if (!(h->flags & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))) {
-            type = vtype(t, h->v.h_vector);
+        if (!(gw_hist_iter_get_flags(&h) & (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING))) {
+            type = vtype(t, gw_hist_iter_get_vector(&h, vec) ? vec : NULL);
         } else {
             /* s\000 ID is special "z" case */
             type = GW_BIT_COUNT;
 
-            if (h->flags & GW_HIST_ENT_FLAG_STRING) {
-                if (h->v.h_vector) {
-                    if (!h->v.h_vector[0]) {
+            if (gw_hist_iter_get_flags(&h) & GW_HIST_ENT_FLAG_STRING) {
+                if ((str = gw_hist_iter_get_string(&h))) {
+                    if (!str[0]) {
                         type = GW_BIT_Z;
                     } else {
-                        if (!strcmp(h->v.h_vector, "UNDEF")) {
+                        if (!strcmp(str, "UNDEF")) {
                             type = GW_BIT_X;
                         }
                     }
@@ -1308,15 +1320,7 @@ static void draw_hptr_trace_vector(GwWaveView *self,
                 if ((width = _x1 - _x0) > GLOBALS->vector_padding) {
                     char *ascii2;
 
-                    if (h->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(h->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            ascii = convert_ascii_real(t, &h->v.h_double);
-                        } else {
-                            ascii = convert_ascii_string((char *)h->v.h_vector);
-                        }
-                    } else {
-                        ascii = convert_ascii_vec(t, h->v.h_vector);
-                    }
+                    ascii = convert_ascii_hist(t, &h);
 
                     ascii2 = ascii;
                     if (*ascii == '?') {
@@ -1373,15 +1377,7 @@ static void draw_hptr_trace_vector(GwWaveView *self,
                 } else if (GLOBALS->fill_in_smaller_rgb_areas_wavewindow_c_1) {
                     /* char *ascii2; */ /* scan-build */
 
-                    if (h->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(h->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            ascii = convert_ascii_real(t, &h->v.h_double);
-                        } else {
-                            ascii = convert_ascii_string((char *)h->v.h_vector);
-                        }
-                    } else {
-                        ascii = convert_ascii_vec(t, h->v.h_vector);
-                    }
+                    ascii = convert_ascii_hist(t, &h);
 
                     /* ascii2 = ascii; */ /* scan-build */
                     if (*ascii == '?') {
@@ -1412,8 +1408,8 @@ static void draw_hptr_trace_vector(GwWaveView *self,
         } else {
             newtime = (((gdouble)(_x1 + WAVE_OPT_SKIP)) * GLOBALS->nspx) +
                       GLOBALS->tims.start /*+GLOBALS->shift_timebase*/; /* skip to next pixel */
-            h3 = bsearch_node(t->n.nd, newtime);
-            if (h3->time > h->time) {
+            hist_lod_bsearch_node(t->n.nd, newtime, &pos, &h3);
+            if (gw_hist_iter_get_time(&h3) > gw_hist_iter_get_time(&h)) {
                 h = h3;
                 continue;
             }
@@ -1423,9 +1419,10 @@ static void draw_hptr_trace_vector(GwWaveView *self,
             free_2(ascii);
             ascii = NULL;
         }
-        h = h->next;
+        h = h2;
     }
 
+    free_2(vec);
     GLOBALS->color_active_in_filter = 0;
 
     GLOBALS->tims.start += GLOBALS->shift_timebase;
@@ -1443,6 +1440,7 @@ static void draw_vptr_trace_analog(GwWaveView *self,
                                    int num_extension)
 {
     GwTime _x0, _x1, newtime;
+    int pos = -1; /* search hint, the skips below only move forward */
     int _y0, _y1, yu, liney, yt0, yt1;
     GwTime tim, h2tim;
     GwVectorEnt *h;
@@ -1825,7 +1823,7 @@ static void draw_vptr_trace_analog(GwWaveView *self,
         } else {
             newtime = (((gdouble)(_x1 + WAVE_OPT_SKIP)) * GLOBALS->nspx) +
                       GLOBALS->tims.start /*+GLOBALS->shift_timebase*/; /* skip to next pixel */
-            h3 = bsearch_vector(t->n.vec, newtime);
+            h3 = bsearch_vector_hint(t->n.vec, newtime, &pos);
             if (h3->time > h->time) {
                 h = h3;
                 /* lasttype=type; */
@@ -1852,6 +1850,7 @@ static void draw_vptr_trace(GwWaveView *self,
                             int which)
 {
     GwTime _x0, _x1, newtime, width;
+    int pos = -1; /* search hint, the skips below only move forward */
     int _y0, _y1, yu, liney, ytext;
     GwTime tim /* , h2tim */; /* scan-build */
     GwVectorEnt *h;
@@ -2162,7 +2161,7 @@ static void draw_vptr_trace(GwWaveView *self,
         } else {
             newtime = (((gdouble)(_x1 + WAVE_OPT_SKIP)) * GLOBALS->nspx) +
                       GLOBALS->tims.start /*+GLOBALS->shift_timebase*/; /* skip to next pixel */
-            h3 = bsearch_vector(t->n.vec, newtime);
+            h3 = bsearch_vector_hint(t->n.vec, newtime, &pos);
             if (h3->time > h->time) {
                 h = h3;
                 lasttype = type;
@@ -30,6 +30,18 @@
 #include "wave_locale.h"
 
 #define FST_VCD_WRITE_BUF_SIZ (2 * 1024 * 1024)
+#define FST_VCD_MAX_JOBS (64)
+
+static int default_jobs(void)
+{
+    long n = 1;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return ((n < 1) ? 1 : ((n > FST_VCD_MAX_JOBS) ? FST_VCD_MAX_JOBS : (int)n));
+}
 
 void print_help(char *nam)
 {
@@ -38,8 +50,10 @@ void print_help(char *nam)
            "  -f, --fstname=FILE         specify FST input filename\n"
            "  -o, --output=FILE          specify output filename\n"
            "  -e, --extensions           emit FST extensions to VCD\n"
+           "  -j, --jobs=N               use N threads to format VCD (default: cpus)\n"
            "  -h, --help                 display this help then exit\n\n"
-           "VCD is emitted to stdout if output filename is unspecified.\n\n"
+           "VCD is emitted to stdout if output filename is unspecified or '-',\n"
+           "an output filename of '|COMMAND' pipes the VCD into COMMAND.\n\n"
            "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
            nam);
 #else
@@ -47,8 +61,10 @@ void print_help(char *nam)
            "  -f                         specify FST input filename\n"
            "  -o                         specify output filename\n"
            "  -e                         emit FST extensions to VCD\n"
+           "  -j N                       use N threads to format VCD (default: cpus)\n"
            "  -h                         display this help then exit\n\n"
-           "VCD is emitted to stdout if output filename is unspecified.\n\n"
+           "VCD is emitted to stdout if output filename is unspecified or '-',\n"
+           "an output filename of '|COMMAND' pipes the VCD into COMMAND.\n\n"
            "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
            nam);
 #endif
@@ -66,6 +82,8 @@ int main(int argc, char **argv)
     struct fstReaderContext *xc;
     FILE *fv;
     int use_extensions = 0;
+    int is_popen = 0;
+    int jobs = 0;
 
     WAVE_LOCALE_FIX
 
@@ -76,12 +94,13 @@ int main(int argc, char **argv)
         static struct option long_options[] = {{"extensions", 0, 0, 'e'},
                                                {"fstname", 1, 0, 'f'},
                                                {"output", 1, 0, 'o'},
+                                               {"jobs", 1, 0, 'j'},
                                                {"help", 0, 0, 'h'},
                                                {0, 0, 0, 0}};
 
-        c = getopt_long(argc, argv, "ef:o:h", long_options, &option_index);
+        c = getopt_long(argc, argv, "ef:o:j:h", long_options, &option_index);
 #else
-        c = getopt(argc, argv, "ef:o:h");
+        c = getopt(argc, argv, "ef:o:j:h");
 #endif
 
         if (c == -1)
@@ -106,6 +125,15 @@ int main(int argc, char **argv)
                 strcpy(outname, optarg);
                 break;
 
+            case 'j':
+                jobs = atoi(optarg);
+                if (jobs < 1) {
+                    jobs = 1;
+                } else if (jobs > FST_VCD_MAX_JOBS) {
+                    jobs = FST_VCD_MAX_JOBS;
+                }
+                break;
+
             case 'h':
                 print_help(argv[0]);
                 break;
@@ -145,9 +173,21 @@ int main(int argc, char **argv)
         fprintf(stderr, "Could not open '%s', exiting.\n", fstname);
         exit(255);
     }
+    fstReaderSetMmapMode(xc, 1); /* stays on stdio if the file can't be mapped */
+    fstReaderSetVcdThreads(xc, jobs ? jobs : default_jobs());
+
+    if (outname && !strcmp(outname, "-")) {
+        free(outname);
+        outname = NULL;
+    }
 
     if (outname) {
-        fv = fopen(outname, "wb");
+        if (outname[0] == '|') {
+            fv = popen(outname + 1, "w");
+            is_popen = 1;
+        } else {
+            fv = fopen(outname, "wb");
+        }
         if (!fv) {
             fprintf(stderr, "Could not open '%s', exiting.\n", outname);
             perror("Why");
@@ -173,7 +213,14 @@ int main(int argc, char **argv)
 
     if (outname) {
         free(outname);
-        fclose(fv);
+        if (is_popen) {
+            if (pclose(fv)) {
+                fprintf(stderr, "Output command failed, exiting.\n");
+                exit(255);
+            }
+        } else {
+            fclose(fv);
+        }
     }
 
     free(fvbuf);
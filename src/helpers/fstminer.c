@@ -171,6 +171,7 @@ int process_fst(char *fname)
     if (lt) {
         int numfacs;
 
+        fstReaderSetMmapMode(lt, 1); /* stays on stdio if the file can't be mapped */
         numfacs = fstReaderGetVarCount(lt) + 1;
         killed_list = calloc(numfacs, sizeof(char));
 
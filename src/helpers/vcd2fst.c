@@ -26,6 +26,10 @@
 #include <getopt.h>
 #endif
 
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
 #include <fstapi.h>
 #include "../../contrib/rtlbrowse/jrb.h"
 #include "wave_locale.h"
@@ -383,8 +387,6 @@ static inline int getline_replace(char **wbuf, char **buf, size_t *len, FILE *f)
     }
 }
 
-JRB vcd_ids = NULL;
-
 static unsigned int vcdid_hash(char *s, int len)
 {
     unsigned int val = 0;
@@ -400,10 +402,700 @@ static unsigned int vcdid_hash(char *s, int len)
     return (val);
 }
 
+/*
+ * vcd id -> fst handle table: open addressing while the header is parsed,
+ * turned into a direct array afterwards when the ids are (mostly) dense
+ */
+typedef struct
+{
+    unsigned int hash; /* 0 marks an empty slot */
+    fstHandle handle;
+    int len;
+} VcdId;
+
+typedef struct
+{
+    VcdId *slots;
+    unsigned int mask;
+    unsigned int count;
+    unsigned int hash_max;
+    VcdId *dense; /* indexed by hash once vcd_id_freeze() accepted the id range */
+} VcdIdTable;
+
+static inline unsigned int vcd_id_slot(unsigned int hash, unsigned int mask)
+{
+    return ((hash * 2654435761U) & mask);
+}
+
+static inline const VcdId *vcd_id_find(const VcdIdTable *t, unsigned int hash)
+{
+    unsigned int i;
+
+    if (t->dense) {
+        return (((hash <= t->hash_max) && t->dense[hash].hash) ? &t->dense[hash] : NULL);
+    }
+
+    if (t->slots) {
+        i = vcd_id_slot(hash, t->mask);
+        while (t->slots[i].hash) {
+            if (t->slots[i].hash == hash) {
+                return (&t->slots[i]);
+            }
+            i = (i + 1) & t->mask;
+        }
+    }
+
+    return (NULL);
+}
+
+static void vcd_id_insert(VcdIdTable *t, unsigned int hash, fstHandle handle, int len)
+{
+    unsigned int i;
+
+    if (!hash) {
+        return; /* empty id, unreachable from the value changes anyhow */
+    }
+
+    if (!t->slots || ((t->count + 1) * 2 > t->mask + 1)) {
+        unsigned int old_cap = t->slots ? t->mask + 1 : 0;
+        unsigned int new_cap = old_cap ? old_cap * 2 : 1024;
+        VcdId *old_slots = t->slots;
+        unsigned int j;
+
+        t->slots = calloc(new_cap, sizeof(VcdId));
+        if (!t->slots) {
+            fprintf(stderr, "ERROR: Out of memory in calloc(), exiting!\n");
+            exit(255);
+        }
+        t->mask = new_cap - 1;
+
+        for (j = 0; j < old_cap; j++) {
+            if (old_slots[j].hash) {
+                i = vcd_id_slot(old_slots[j].hash, t->mask);
+                while (t->slots[i].hash) {
+                    i = (i + 1) & t->mask;
+                }
+                t->slots[i] = old_slots[j];
+            }
+        }
+        free(old_slots);
+    }
+
+    i = vcd_id_slot(hash, t->mask);
+    while (t->slots[i].hash) {
+        i = (i + 1) & t->mask;
+    }
+    t->slots[i].hash = hash;
+    t->slots[i].handle = handle;
+    t->slots[i].len = len;
+    t->count++;
+
+    if (hash > t->hash_max) {
+        t->hash_max = hash;
+    }
+}
+
+static void vcd_id_freeze(VcdIdTable *t)
+{
+    unsigned int i;
+
+    /* simulators hand out ids sequentially, so this is the common case */
+    if (t->count && ((size_t)t->hash_max <= 4 * (size_t)t->count + 1024)) {
+        t->dense = calloc((size_t)t->hash_max + 1, sizeof(VcdId));
+        if (t->dense) {
+            for (i = 0; i <= t->mask; i++) {
+                if (t->slots[i].hash) {
+                    t->dense[t->slots[i].hash] = t->slots[i];
+                }
+            }
+            free(t->slots);
+            t->slots = NULL;
+        }
+    }
+}
+
+static void vcd_id_free(VcdIdTable *t)
+{
+    free(t->slots);
+    free(t->dense);
+    memset(t, 0, sizeof(VcdIdTable));
+}
+
+/*
+ * value change section pipeline: a reader cuts the input into chunks of whole
+ * lines, tokenizer threads turn each chunk into a list of resolved changes and
+ * the calling thread emits the lists in input order (the fst writer is single
+ * threaded)
+ */
+#define VCD2FST_CHUNK_SIZE (1024 * 1024)
+#define VCD2FST_MAX_JOBS (64)
+
+enum VcdChangeKind
+{
+    VCD_CHG_VALUE, /* value points into the chunk text */
+    VCD_CHG_FIXED, /* value rebuilt into the chunk fixup buffer (padded vectors, ports) */
+    VCD_CHG_VARLEN,
+    VCD_CHG_REAL,
+    VCD_CHG_TIME,
+    VCD_CHG_DUMPON,
+    VCD_CHG_DUMPOFF
+};
+
+typedef struct
+{
+    unsigned char kind;
+    fstHandle handle;
+    uint32_t len; /* VCD_CHG_VARLEN only */
+    union
+    {
+        const char *value;
+        size_t fixed; /* offset into fix[], which may move while tokenizing */
+        double real;
+        uint64_t time;
+    } u;
+} VcdChange;
+
+typedef struct
+{
+    char *buf; /* whole lines, nul terminated */
+    size_t len;
+    size_t size;
+
+    VcdChange *chg;
+    size_t chg_count;
+    size_t chg_size;
+
+    char *fix;
+    size_t fix_len;
+    size_t fix_size;
+
+    int state;
+} VcdChunk;
+
+typedef struct
+{
+    char *buf;
+    size_t len;
+    size_t size;
+} VcdCarry;
+
+/* reads whole lines into c, the partial line at the end is carried to the next chunk */
+static int vcd_chunk_fill(VcdChunk *c, FILE *f, VcdCarry *carry)
+{
+    size_t scan = 0;
+
+    if (!c->buf) {
+        c->size = VCD2FST_CHUNK_SIZE;
+        c->buf = realloc_2(NULL, c->size);
+    }
+
+    c->len = 0;
+    c->chg_count = 0;
+    c->fix_len = 0;
+
+    if (carry->len) {
+        if (carry->len + VCD2FST_CHUNK_SIZE / 2 > c->size) {
+            c->size = carry->len + VCD2FST_CHUNK_SIZE;
+            c->buf = realloc_2(c->buf, c->size);
+        }
+        memcpy(c->buf, carry->buf, carry->len);
+        c->len = carry->len;
+        carry->len = 0;
+    }
+
+    for (;;) {
+        size_t rd;
+        size_t i;
+
+        if (c->size - c->len < VCD2FST_CHUNK_SIZE / 2) {
+            c->size *= 2; /* a line longer than a chunk */
+            c->buf = realloc_2(c->buf, c->size);
+        }
+
+        rd = fread(c->buf + c->len, 1, c->size - c->len - 1, f);
+        if (!rd) {
+            break; /* end of file: the last line may be unterminated */
+        }
+        c->len += rd;
+
+        for (i = c->len; i > scan; i--) {
+            if (c->buf[i - 1] == '\n') {
+                break;
+            }
+        }
+
+        if (i > scan) {
+            carry->len = c->len - i;
+            if (carry->len > carry->size) {
+                carry->size = carry->len;
+                carry->buf = realloc_2(carry->buf, carry->size);
+            }
+            memcpy(carry->buf, c->buf + i, carry->len);
+            c->len = i;
+            break;
+        }
+
+        scan = c->len;
+    }
+
+    c->buf[c->len] = 0;
+    return (c->len != 0);
+}
+
+static VcdChange *vcd_chunk_add(VcdChunk *c, int kind, fstHandle handle)
+{
+    VcdChange *chg;
+
+    if (c->chg_count == c->chg_size) {
+        c->chg_size = c->chg_size ? c->chg_size * 2 : 16384;
+        c->chg = realloc_2(c->chg, c->chg_size * sizeof(VcdChange));
+    }
+
+    chg = &c->chg[c->chg_count++];
+    chg->kind = kind;
+    chg->handle = handle;
+    return (chg);
+}
+
+/* reserves len + 1 bytes of fixup space, valid until the next call */
+static char *vcd_chunk_fix(VcdChunk *c, fstHandle handle, size_t len)
+{
+    VcdChange *chg = vcd_chunk_add(c, VCD_CHG_FIXED, handle);
+    char *pnt;
+
+    if (c->fix_len + len + 1 > c->fix_size) {
+        c->fix_size = (c->fix_len + len + 1) * 2;
+        c->fix = realloc_2(c->fix, c->fix_size);
+    }
+
+    chg->u.fixed = c->fix_len;
+    pnt = c->fix + c->fix_len;
+    c->fix_len += len + 1;
+    pnt[len] = 0;
+    return (pnt);
+}
+
+/* pads a vector shorter than its declaration, in the same way as the original VCD reader */
+static void vcd_chunk_pad(VcdChunk *c, const VcdId *id, const char *val, int val_len)
+{
+    int delta = id->len - val_len;
+    char *pnt = vcd_chunk_fix(c, id->handle, id->len);
+
+    memset(pnt, val[0] != '1' ? val[0] : '0', delta);
+    memcpy(pnt + delta, val, val_len);
+}
+
+static void vcd_chunk_tokenize(VcdChunk *c, const VcdIdTable *ids)
+{
+    char *pnt = c->buf;
+    char *end = c->buf + c->len;
+
+    while (pnt < end) {
+        char *buf = pnt;
+        char *nl = memchr(pnt, '\n', end - pnt);
+        char *sp;
+        const VcdId *id;
+        VcdChange *chg;
+
+        if (nl) {
+            pnt = nl + 1;
+            *nl = 0;
+        } else {
+            nl = pnt = end;
+        }
+
+        while (*buf == ' ') {
+            buf++;
+        } /* verilator leading spaces fix */
+
+        sp = memchr(buf, '\r', nl - buf);
+        if (sp) {
+            *sp = 0;
+            nl = sp;
+        }
+
+        switch (buf[0]) {
+            case '0':
+            case '1':
+            case 'x':
+            case 'z':
+            case 'h':
+            case 'u':
+            case 'w':
+            case 'l':
+            case '-':
+                id = vcd_id_find(ids, vcdid_hash(buf + 1, nl - (buf + 1)));
+                if (id) {
+                    if (id->len <= nl - buf) {
+                        vcd_chunk_add(c, VCD_CHG_VALUE, id->handle)->u.value = buf;
+                    } else {
+                        vcd_chunk_pad(c, id, buf, 1); /* scalar change on a vector */
+                    }
+                }
+                break;
+
+            case 'b': { /* the VCD ID will be small compared to the vector length */
+                char *sp_scan = nl;
+                int bin_len;
+
+                sp = NULL;
+                while (buf != --sp_scan) {
+                    if (*sp_scan == ' ') {
+                        sp = sp_scan;
+                        break;
+                    }
+                }
+
+                if (!sp)
+                    break;
+                *sp = 0;
+                id = vcd_id_find(ids, vcdid_hash(sp + 1, nl - (sp + 1)));
+                if (!id)
+                    break;
+
+                bin_len = sp - (buf + 1); /* strlen(buf+1) */
+                if (bin_len >= id->len) {
+                    vcd_chunk_add(c, VCD_CHG_VALUE, id->handle)->u.value = buf + 1;
+                } else {
+                    vcd_chunk_pad(c, id, buf + 1, bin_len);
+                }
+            } break;
+
+            case 's':
+                sp = strchr(buf, ' ');
+                if (!sp)
+                    break;
+                *sp = 0;
+                id = vcd_id_find(ids, vcdid_hash(sp + 1, nl - (sp + 1)));
+                if (id) {
+                    int bin_len = sp - (buf + 1); /* strlen(buf+1) */
+
+                    chg = vcd_chunk_add(c, VCD_CHG_VARLEN, id->handle);
+                    chg->len = fstUtilityEscToBin(NULL, (unsigned char *)(buf + 1), bin_len);
+                    chg->u.value = buf + 1;
+                }
+                break;
+
+            case 'p': {
+                /* collapse the whitespace in place, the result is never longer */
+                char *src = buf + 1;
+                char *dst = buf + 1;
+                int pchar = 0;
+
+                for (;;) {
+                    if (!*src)
+                        break;
+                    if (isspace((int)(unsigned char)*src)) {
+                        if (pchar != ' ') {
+                            *(dst++) = pchar = ' ';
+                        }
+                        src++;
+                        continue;
+                    }
+                    *(dst++) = pchar = *(src++);
+                }
+                *dst = 0;
+
+                sp = strchr(buf + 1, ' ');
+                if (!sp)
+                    break;
+                sp = strchr(sp + 1, ' ');
+                if (!sp)
+                    break;
+                sp = strchr(sp + 1, ' ');
+                if (!sp)
+                    break;
+                *sp = 0;
+
+                id = vcd_id_find(ids, vcdid_hash(sp + 1, strlen(sp + 1)));
+                if (id) {
+                    int p_len = sp - (buf + 1);
+
+                    if (p_len >= id->len) {
+                        vcd_chunk_add(c, VCD_CHG_VALUE, id->handle)->u.value = buf + 1;
+                    } else {
+                        char *fix = vcd_chunk_fix(c, id->handle, id->len);
+
+                        memcpy(fix, buf + 1, p_len);
+                        memset(fix + p_len, 0, id->len - p_len);
+                    }
+                }
+            } break;
+
+            case 'r':
+                sp = strchr(buf, ' ');
+                if (!sp)
+                    break;
+                id = vcd_id_find(ids, vcdid_hash(sp + 1, nl - (sp + 1)));
+                if (id) {
+                    chg = vcd_chunk_add(c, VCD_CHG_REAL, id->handle);
+                    chg->u.real = 0.0;
+                    sscanf(buf + 1, "%lg", &chg->u.real);
+                }
+                break;
+
+            case '#':
+                vcd_chunk_add(c, VCD_CHG_TIME, 0)->u.time = atoi_2((unsigned char *)(buf + 1));
+                break;
+
+            default:
+                if (!strncmp(buf, "$dumpon", 7)) {
+                    vcd_chunk_add(c, VCD_CHG_DUMPON, 0);
+                } else if (!strncmp(buf, "$dumpoff", 8)) {
+                    vcd_chunk_add(c, VCD_CHG_DUMPOFF, 0);
+                } else if (!strncmp(buf, "$dumpvars", 9)) {
+                    /* nothing */
+                } else {
+                    /* printf("FST '%s'\n", buf); */
+                }
+                break;
+        }
+    }
+}
+
+static void vcd_chunk_emit(VcdChunk *c, void *ctx, uint64_t *prev_tim)
+{
+    size_t i;
+
+    for (i = 0; i < c->chg_count; i++) {
+        VcdChange *chg = &c->chg[i];
+
+        switch (chg->kind) {
+            case VCD_CHG_VALUE:
+                fstWriterEmitValueChange(ctx, chg->handle, chg->u.value);
+                break;
+            case VCD_CHG_FIXED:
+                fstWriterEmitValueChange(ctx, chg->handle, c->fix + chg->u.fixed);
+                break;
+            case VCD_CHG_VARLEN:
+                fstWriterEmitVariableLengthValueChange(ctx, chg->handle, chg->u.value, chg->len);
+                break;
+            case VCD_CHG_REAL:
+                fstWriterEmitValueChange(ctx, chg->handle, &chg->u.real);
+                break;
+            case VCD_CHG_TIME:
+                if ((chg->u.time >= *prev_tim) || (!*prev_tim)) {
+                    *prev_tim = chg->u.time;
+                    fstWriterEmitTimeChange(ctx, chg->u.time);
+                }
+                break;
+            case VCD_CHG_DUMPON:
+                fstWriterEmitDumpActive(ctx, 1);
+                break;
+            case VCD_CHG_DUMPOFF:
+                fstWriterEmitDumpActive(ctx, 0);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void vcd_chunk_free(VcdChunk *c)
+{
+    free(c->buf);
+    free(c->chg);
+    free(c->fix);
+    memset(c, 0, sizeof(VcdChunk));
+}
+
+#ifdef HAVE_LIBPTHREAD
+
+enum VcdChunkState
+{
+    VCD_CHUNK_FREE,
+    VCD_CHUNK_READ,
+    VCD_CHUNK_PARSED
+};
+
+/* chunk seq lives in ring slot seq % num_chunks, one mutex/cond guards the counters */
+typedef struct
+{
+    FILE *f;
+    const VcdIdTable *ids;
+    VcdChunk *chunks;
+    unsigned int num_chunks;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint64_t read_seq; /* chunks filled by the reader */
+    uint64_t parse_seq; /* chunks claimed by the tokenizers */
+    uint64_t emit_seq; /* chunks written out */
+    int eof;
+} VcdPipeline;
+
+static void *vcd_reader_thread(void *arg)
+{
+    VcdPipeline *p = arg;
+    VcdCarry carry;
+
+    memset(&carry, 0, sizeof(VcdCarry));
+
+    for (;;) {
+        VcdChunk *c;
+        int filled;
+
+        pthread_mutex_lock(&p->mutex);
+        while (p->read_seq - p->emit_seq >= p->num_chunks) {
+            pthread_cond_wait(&p->cond, &p->mutex);
+        }
+        c = &p->chunks[p->read_seq % p->num_chunks];
+        pthread_mutex_unlock(&p->mutex);
+
+        filled = vcd_chunk_fill(c, p->f, &carry);
+
+        pthread_mutex_lock(&p->mutex);
+        if (filled) {
+            c->state = VCD_CHUNK_READ;
+            p->read_seq++;
+        } else {
+            p->eof = 1;
+        }
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->mutex);
+
+        if (!filled) {
+            break;
+        }
+    }
+
+    free(carry.buf);
+    return (NULL);
+}
+
+static void *vcd_tokenizer_thread(void *arg)
+{
+    VcdPipeline *p = arg;
+
+    for (;;) {
+        VcdChunk *c;
+
+        pthread_mutex_lock(&p->mutex);
+        while ((p->parse_seq == p->read_seq) && !p->eof) {
+            pthread_cond_wait(&p->cond, &p->mutex);
+        }
+        if (p->parse_seq == p->read_seq) {
+            pthread_mutex_unlock(&p->mutex);
+            break;
+        }
+        c = &p->chunks[p->parse_seq++ % p->num_chunks];
+        pthread_mutex_unlock(&p->mutex);
+
+        vcd_chunk_tokenize(c, p->ids);
+
+        pthread_mutex_lock(&p->mutex);
+        c->state = VCD_CHUNK_PARSED;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->mutex);
+    }
+
+    return (NULL);
+}
+
+static void vcd_convert_value_changes(void *ctx, FILE *f, const VcdIdTable *ids, int jobs)
+{
+    VcdPipeline p;
+    pthread_t reader;
+    pthread_t *tokenizers;
+    uint64_t prev_tim = 0;
+    unsigned int i;
+
+    memset(&p, 0, sizeof(VcdPipeline));
+    p.f = f;
+    p.ids = ids;
+    p.num_chunks = 2 * jobs + 2;
+    p.chunks = calloc(p.num_chunks, sizeof(VcdChunk));
+    tokenizers = calloc(jobs, sizeof(pthread_t));
+    pthread_mutex_init(&p.mutex, NULL);
+    pthread_cond_init(&p.cond, NULL);
+
+    pthread_create(&reader, NULL, vcd_reader_thread, &p);
+    for (i = 0; i < (unsigned int)jobs; i++) {
+        pthread_create(&tokenizers[i], NULL, vcd_tokenizer_thread, &p);
+    }
+
+    for (;;) {
+        VcdChunk *c;
+
+        pthread_mutex_lock(&p.mutex);
+        for (;;) {
+            c = &p.chunks[p.emit_seq % p.num_chunks];
+            if ((p.emit_seq < p.read_seq) && (c->state == VCD_CHUNK_PARSED)) {
+                break;
+            }
+            if (p.eof && (p.emit_seq == p.read_seq)) {
+                c = NULL;
+                break;
+            }
+            pthread_cond_wait(&p.cond, &p.mutex);
+        }
+        pthread_mutex_unlock(&p.mutex);
+
+        if (!c) {
+            break;
+        }
+
+        vcd_chunk_emit(c, ctx, &prev_tim);
+
+        pthread_mutex_lock(&p.mutex);
+        c->state = VCD_CHUNK_FREE;
+        p.emit_seq++;
+        pthread_cond_broadcast(&p.cond);
+        pthread_mutex_unlock(&p.mutex);
+    }
+
+    pthread_join(reader, NULL);
+    for (i = 0; i < (unsigned int)jobs; i++) {
+        pthread_join(tokenizers[i], NULL);
+    }
+
+    pthread_cond_destroy(&p.cond);
+    pthread_mutex_destroy(&p.mutex);
+    for (i = 0; i < p.num_chunks; i++) {
+        vcd_chunk_free(&p.chunks[i]);
+    }
+    free(p.chunks);
+    free(tokenizers);
+}
+
+#else
+
+static void vcd_convert_value_changes(void *ctx, FILE *f, const VcdIdTable *ids, int jobs)
+{
+    VcdChunk c;
+    VcdCarry carry;
+    uint64_t prev_tim = 0;
+
+    (void)jobs;
+    memset(&c, 0, sizeof(VcdChunk));
+    memset(&carry, 0, sizeof(VcdCarry));
+
+    while (vcd_chunk_fill(&c, f, &carry)) {
+        vcd_chunk_tokenize(&c, ids);
+        vcd_chunk_emit(&c, ctx, &prev_tim);
+    }
+
+    vcd_chunk_free(&c);
+    free(carry.buf);
+}
+
+#endif
+
+static int default_jobs(void)
+{
+    long n = 1;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return ((n < 1) ? 1 : ((n > VCD2FST_MAX_JOBS) ? VCD2FST_MAX_JOBS : (int)n));
+}
+
 int pack_type = FST_WR_PT_LZ4; /* set to fstWriterPackType */
 int compression_explicitly_set = 0;
 int repack_all = 0; /* 0 is normal, 1 does the repack (via fstapi) at end */
 int parallel_mode = 0; /* 0 is is single threaded, 1 is multi-threaded */
+int jobs = 0; /* tokenizer and value chain packing threads, 0 is one per cpu */
 
 #ifdef VCD2FST_EXTLOADERS_CONV
 static int suffix_check(const char *s, const char *sfx)
@@ -422,13 +1114,9 @@ int fst_main(char *vname, char *fstname)
     int line = 0;
     int ss;
     fstHandle returnedhandle;
-    JRB node;
-    uint64_t prev_tim = 0;
+    VcdIdTable vcd_ids;
     ssize_t bin_fixbuff_len = 65537;
     char *bin_fixbuff = NULL;
-    int hash_kill = 0;
-    unsigned int hash_max = 0;
-    int *node_len_array = NULL;
     int is_popen = 0;
 #ifdef VCD2FST_EXTLOAD_CONV
     int is_extload = 0;
@@ -503,8 +1191,9 @@ int fst_main(char *vname, char *fstname)
     }
 #endif
 
-    vcd_ids = make_jrb();
+    memset(&vcd_ids, 0, sizeof(VcdIdTable));
     fstWriterSetPackType(ctx, pack_type);
+    fstWriterSetPackThreads(ctx, jobs);
     fstWriterSetRepackOnClose(ctx, repack_all);
     fstWriterSetParallelMode(ctx, parallel_mode);
 
@@ -527,6 +1216,7 @@ int fst_main(char *vname, char *fstname)
             int len;
             char *nam;
             unsigned int hash;
+            const VcdId *node;
 
             if (!st) {
                 continue; /* variable declaration not on a single line */
@@ -672,14 +1362,6 @@ int fst_main(char *vname, char *fstname)
             st = strtok(NULL, " \t"); /* vcdid */
             hash = vcdid_hash(st, strlen(st));
 
-            if (hash == (hash_max + 1)) {
-                hash_max = hash;
-            } else if ((hash > 0) && (hash <= hash_max)) {
-                /* general case with aliases */
-            } else {
-                hash_kill = 1;
-            }
-
             nam = strtok(NULL, " \t"); /* name */
             st = strtok(NULL, " \t"); /* $end */
 
@@ -688,9 +1370,8 @@ int fst_main(char *vname, char *fstname)
                     *(st - 1) = ' ';
                 }
 
-                node = jrb_find_int(vcd_ids, hash);
+                node = vcd_id_find(&vcd_ids, hash);
                 if (!node) {
-                    Jval val;
                     returnedhandle = fstWriterCreateVar(
                         ctx,
                         vartype,
@@ -698,16 +1379,15 @@ int fst_main(char *vname, char *fstname)
                         len,
                         nam,
                         0);
-                    val.i = returnedhandle;
-                    jrb_insert_int(vcd_ids, hash, val)->val2.i = len;
+                    vcd_id_insert(&vcd_ids, hash, returnedhandle, len);
                 } else {
                     fstWriterCreateVar(ctx,
                                        vartype,
                                        !var_direction ? FST_VD_IMPLICIT
                                                       : var_direction[var_direction_idx++],
-                                       node->val2.i,
+                                       node->len,
                                        nam,
-                                       node->val.i);
+                                       node->handle);
                 }
 
 #if defined(VCD2FST_EXTLOAD_CONV)
@@ -1084,254 +1764,8 @@ int fst_main(char *vname, char *fstname)
         }
     }
 
-    if ((!hash_kill) && (vcd_ids)) {
-        unsigned int hash;
-
-        node_len_array = calloc(hash_max + 1, sizeof(int));
-
-        for (hash = 1; hash <= hash_max; hash++) {
-            node = jrb_find_int(vcd_ids, hash);
-            if (node) {
-                node_len_array[hash] = node->val2.i;
-            } else {
-                node_len_array[hash] = 1; /* should never happen */
-            }
-        }
-
-        jrb_free_tree(vcd_ids);
-        vcd_ids = NULL;
-    } else {
-        hash_kill = 1; /* scan-build */
-    }
-
-    for (;;) /* was while(!feof(f)) */
-    {
-        unsigned int hash;
-        uint64_t tim;
-        char *nl, *sp;
-        double doub;
-
-        ss = getline_replace(&wbuf, &buf, &glen, f);
-        if (!ss) {
-            break;
-        }
-
-        nl = buf;
-        while (*nl) {
-            if ((*nl == '\n') || (*nl == '\r')) {
-                *nl = 0;
-                break;
-            }
-            nl++;
-        }
-
-        switch (buf[0]) {
-            case '0':
-            case '1':
-            case 'x':
-            case 'z':
-                hash = vcdid_hash(buf + 1, nl - (buf + 1));
-                if (!hash_kill) {
-                    fstWriterEmitValueChange(ctx, hash, buf);
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        fstWriterEmitValueChange(ctx, node->val.i, buf);
-                    } else {
-                    }
-                }
-                break;
-
-            case 'b': { /* this block replaces the single statement sp = strchr(buf, ' ');        */
-                /* as the odds are the VCD ID will be small compared to the vector length */
-                char *sp_scan = nl;
-                sp = NULL;
-
-                /* if(buf != sp_scan) [can't happen or switch() wouldn't get here] */
-                {
-                    while (buf != --sp_scan) {
-                        if (*sp_scan == ' ') {
-                            sp = sp_scan;
-                            break;
-                        }
-                    }
-                }
-            }
-
-                if (!sp)
-                    break;
-                *sp = 0;
-                hash = vcdid_hash(sp + 1, nl - (sp + 1));
-                if (!hash_kill) {
-                    int bin_len = sp - (buf + 1); /* strlen(buf+1) */
-                    int node_len = node_len_array[hash];
-
-                    if (bin_len >= node_len) {
-                        fstWriterEmitValueChange(ctx, hash, buf + 1);
-                    } else {
-                        int delta = node_len - bin_len;
-
-                        if (node_len >= bin_fixbuff_len) {
-                            bin_fixbuff_len = node_len + 1;
-                            bin_fixbuff = realloc_2(bin_fixbuff, bin_fixbuff_len);
-                        }
-
-                        memset(bin_fixbuff, buf[1] != '1' ? buf[1] : '0', delta);
-                        memcpy(bin_fixbuff + delta, buf + 1, bin_len);
-                        fstWriterEmitValueChange(ctx, hash, bin_fixbuff);
-                    }
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        int bin_len = sp - (buf + 1); /* strlen(buf+1) */
-                        int node_len = node->val2.i;
-                        if (bin_len >= node_len) {
-                            fstWriterEmitValueChange(ctx, node->val.i, buf + 1);
-                        } else {
-                            int delta = node_len - bin_len;
-
-                            if (node_len >= bin_fixbuff_len) {
-                                bin_fixbuff_len = node_len + 1;
-                                bin_fixbuff = realloc_2(bin_fixbuff, bin_fixbuff_len);
-                            }
-
-                            memset(bin_fixbuff, buf[1] != '1' ? buf[1] : '0', delta);
-                            memcpy(bin_fixbuff + delta, buf + 1, bin_len);
-                            fstWriterEmitValueChange(ctx, node->val.i, bin_fixbuff);
-                        }
-                    } else {
-                    }
-                }
-                break;
-
-            case 's':
-                sp = strchr(buf, ' ');
-                if (!sp)
-                    break;
-                *sp = 0;
-                hash = vcdid_hash(sp + 1, nl - (sp + 1));
-                if (!hash_kill) {
-                    int bin_len = sp - (buf + 1); /* strlen(buf+1) */
-
-                    bin_len = fstUtilityEscToBin(NULL, (unsigned char *)(buf + 1), bin_len);
-                    fstWriterEmitVariableLengthValueChange(ctx, hash, buf + 1, bin_len);
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        int bin_len = sp - (buf + 1); /* strlen(buf+1) */
-
-                        bin_len = fstUtilityEscToBin(NULL, (unsigned char *)(buf + 1), bin_len);
-                        fstWriterEmitVariableLengthValueChange(ctx, node->val.i, buf + 1, bin_len);
-                    } else {
-                    }
-                }
-                break;
-
-            case 'p': {
-                char *src = buf + 1;
-                char *pnt;
-                int pchar = 0;
-                int p_len = strlen(src);
-
-                if (p_len >= bin_fixbuff_len) {
-                    bin_fixbuff_len = p_len + 1;
-                    bin_fixbuff = realloc_2(bin_fixbuff, bin_fixbuff_len);
-                }
-                pnt = bin_fixbuff;
-
-                for (;;) {
-                    if (!*src)
-                        break;
-                    if (isspace((int)(unsigned char)*src)) {
-                        if (pchar != ' ') {
-                            *(pnt++) = pchar = ' ';
-                        }
-                        src++;
-                        continue;
-                    }
-                    *(pnt++) = pchar = *(src++);
-                }
-                *pnt = 0;
-
-                sp = strchr(bin_fixbuff, ' ');
-                if (!sp)
-                    break;
-                sp = strchr(sp + 1, ' ');
-                if (!sp)
-                    break;
-                sp = strchr(sp + 1, ' ');
-                if (!sp)
-                    break;
-                *sp = 0;
-
-                hash = vcdid_hash(sp + 1, strlen(sp + 1)); /* nl is no longer good here */
-                if (!hash_kill) {
-                    fstWriterEmitValueChange(ctx, hash, bin_fixbuff);
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        fstWriterEmitValueChange(ctx, node->val.i, bin_fixbuff);
-                    } else {
-                    }
-                }
-            } break;
-
-            case 'r':
-                sp = strchr(buf, ' ');
-                if (!sp)
-                    break;
-                hash = vcdid_hash(sp + 1, nl - (sp + 1));
-                if (!hash_kill) {
-                    sscanf(buf + 1, "%lg", &doub);
-                    fstWriterEmitValueChange(ctx, hash, &doub);
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        sscanf(buf + 1, "%lg", &doub);
-                        fstWriterEmitValueChange(ctx, node->val.i, &doub);
-                    } else {
-                    }
-                }
-                break;
-
-            case 'h': /* same as 01xz above but moved down here as it's less common */
-            case 'u':
-            case 'w':
-            case 'l':
-            case '-':
-                hash = vcdid_hash(buf + 1, nl - (buf + 1));
-                if (!hash_kill) {
-                    fstWriterEmitValueChange(ctx, hash, buf);
-                } else {
-                    node = jrb_find_int(vcd_ids, hash);
-                    if (node) {
-                        fstWriterEmitValueChange(ctx, node->val.i, buf);
-                    } else {
-                    }
-                }
-                break;
-
-            case '#':
-                tim = atoi_2((unsigned char *)(buf + 1));
-                if ((tim >= prev_tim) || (!prev_tim)) {
-                    prev_tim = tim;
-                    fstWriterEmitTimeChange(ctx, tim);
-                }
-                break;
-
-            default:
-                if (!strncmp(buf, "$dumpon", 7)) {
-                    fstWriterEmitDumpActive(ctx, 1);
-                } else if (!strncmp(buf, "$dumpoff", 8)) {
-                    fstWriterEmitDumpActive(ctx, 0);
-                } else if (!strncmp(buf, "$dumpvars", 9)) {
-                    /* nothing */
-                } else {
-                    /* printf("FST '%s'\n", buf); */
-                }
-                break;
-        }
-    }
+    vcd_id_freeze(&vcd_ids);
+    vcd_convert_value_changes(ctx, f, &vcd_ids, jobs);
 
     fstWriterClose(ctx);
 
@@ -1341,17 +1775,12 @@ int fst_main(char *vname, char *fstname)
     }
 #endif
 
-    if (vcd_ids) {
-        jrb_free_tree(vcd_ids);
-        vcd_ids = NULL;
-    }
+    vcd_id_free(&vcd_ids);
 
     free(bin_fixbuff);
     bin_fixbuff = NULL;
     free(wbuf);
     wbuf = NULL;
-    free(node_len_array);
-    node_len_array = NULL;
 
     if (f != stdin) {
         if (is_popen) {
@@ -1410,6 +1839,7 @@ void print_help(char *nam)
            "  -Z, --zlibpack             use zlib algorithm for size\n"
            "  -c, --compress             zlib compress entire file on close\n"
            "  -p, --parallel             enable parallel mode\n"
+           "  -j, --jobs=N               use N threads to parse and compress (default: cpus)\n"
            "  -h, --help                 display this help then exit\n\n"
 
            "Note that VCDFILE and FSTFILE are optional provided the\n"
@@ -1434,6 +1864,7 @@ void print_help(char *nam)
            "  -Z                         use zlib algorithm for size\n"
            "  -c                         zlib compress entire file on close\n"
            "  -p                         enable parallel mode\n"
+           "  -j N                       use N threads to parse and compress (default: cpus)\n"
            "  -h                         display this help then exit\n\n"
 
            "Note that VCDFILE and FSTFILE are optional provided the\n"
@@ -1473,12 +1904,13 @@ int main(int argc, char **argv)
                                                {"zlibpack", 0, 0, 'Z'},
                                                {"compress", 0, 0, 'c'},
                                                {"parallel", 0, 0, 'p'},
+                                               {"jobs", 1, 0, 'j'},
                                                {"help", 0, 0, 'h'},
                                                {0, 0, 0, 0}};
 
-        c = getopt_long(argc, argv, "v:f:ZF4cph", long_options, &option_index);
+        c = getopt_long(argc, argv, "v:f:ZF4cpj:h", long_options, &option_index);
 #else
-        c = getopt(argc, argv, "v:f:ZF4cph");
+        c = getopt(argc, argv, "v:f:ZF4cpj:h");
 #endif
 
         if (c == -1)
@@ -1522,6 +1954,15 @@ int main(int argc, char **argv)
                 parallel_mode = 1;
                 break;
 
+            case 'j':
+                jobs = atoi(optarg);
+                if (jobs < 1) {
+                    jobs = 1;
+                } else if (jobs > VCD2FST_MAX_JOBS) {
+                    jobs = VCD2FST_MAX_JOBS;
+                }
+                break;
+
             case 'h':
                 print_help(argv[0]);
                 break;
@@ -1558,6 +1999,10 @@ int main(int argc, char **argv)
         print_help(argv[0]);
     }
 
+    if (!jobs) {
+        jobs = default_jobs();
+    }
+
     fst_main(vname, lxname);
 
     free(vname);
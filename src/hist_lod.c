@@ -0,0 +1,267 @@
+#include "hist_lod.h"
+#include "bsearch.h"
+
+/*
+ * Level-of-detail summaries for a node's history. Level 0 splits the time span
+ * of the node into equally sized buckets and remembers, for each bucket, the
+ * index of the history entry that is active at the start of the bucket. This
+ * turns the "skip to the next pixel" lookup of the renderer into an O(1)
+ * bucket lookup followed by a search over the few entries inside the bucket.
+ *
+ * Every level also records which value classes (0/1/X/Z) occurred in each
+ * bucket. Each level halves the number of buckets of the previous one, so the
+ * classes covering any pixel can be read from a handful of buckets.
+ */
+
+#define HIST_LOD_MIN_ENTRIES (4096)
+#define HIST_LOD_ENTRIES_PER_BUCKET (4)
+#define HIST_LOD_MAX_BUCKETS (1 << 22)
+
+struct _HistLod
+{
+    GwTime start; /* start time of the first bucket */
+    GwTime width; /* width of a level 0 bucket */
+
+    gint num_levels;
+    gint *num_buckets; /* number of buckets per level */
+    gint *first; /* level 0: last entry with time <= bucket start */
+    guint8 **classes; /* per level: value classes seen in each bucket */
+};
+
+static guint8 hist_lod_class(guint8 h_val)
+{
+    switch (h_val) {
+        case GW_BIT_0:
+        case GW_BIT_L:
+            return HIST_LOD_CLASS_0;
+        case GW_BIT_1:
+        case GW_BIT_H:
+            return HIST_LOD_CLASS_1;
+        case GW_BIT_Z:
+            return HIST_LOD_CLASS_Z;
+        default:
+            return HIST_LOD_CLASS_X;
+    }
+}
+
+static HistLod *hist_lod_new(GwNode *n)
+{
+    GwHistIter iter;
+    GwTime first_time = 0;
+    GwTime last_time = 0;
+    GwTime next_time;
+    gint lo = -1;
+    gint hi = -1;
+
+    /* skip the entries at negative times and the x/z end caps */
+    gw_hist_iter_init(&iter, n);
+    do {
+        GwTime time = gw_hist_iter_get_time(&iter);
+
+        if (time >= 0 && time < GW_TIME_MAX - 1) {
+            if (lo < 0) {
+                lo = gw_hist_iter_get_index(&iter);
+                first_time = time;
+            }
+            hi = gw_hist_iter_get_index(&iter);
+            last_time = time;
+        }
+    } while (gw_hist_iter_next(&iter));
+
+    if (lo < 0 || hi - lo < HIST_LOD_MIN_ENTRIES) {
+        return NULL;
+    }
+
+    HistLod *lod = g_new0(HistLod, 1);
+    GwTime span = last_time - first_time;
+
+    gint buckets = 1;
+    while (buckets < HIST_LOD_MAX_BUCKETS &&
+           buckets < (hi - lo + 1) / HIST_LOD_ENTRIES_PER_BUCKET) {
+        buckets <<= 1;
+    }
+
+    lod->start = first_time;
+    lod->width = span / buckets + 1;
+    buckets = span / lod->width + 1;
+
+    for (gint b = buckets; b > 1; b = (b + 1) / 2) {
+        lod->num_levels++;
+    }
+    lod->num_levels++;
+
+    lod->num_buckets = g_new(gint, lod->num_levels);
+    lod->classes = g_new(guint8 *, lod->num_levels);
+    lod->first = g_new(gint, buckets);
+
+    lod->num_buckets[0] = buckets;
+    lod->classes[0] = g_new0(guint8, buckets);
+
+    gw_hist_iter_init_at(&iter, n, lo);
+    for (gint b = 0; b < buckets; b++) {
+        GwTime bucket_start = lod->start + b * lod->width;
+
+        while (gw_hist_iter_get_next_time(&iter, &next_time) && next_time <= bucket_start) {
+            gw_hist_iter_next(&iter);
+        }
+        lod->first[b] = gw_hist_iter_get_index(&iter);
+    }
+
+    if (!n->extvals) {
+        gw_hist_iter_init_at(&iter, n, lo);
+        for (gint i = lo; i <= hi; i++, gw_hist_iter_next(&iter)) {
+            gint b = (gw_hist_iter_get_time(&iter) - lod->start) / lod->width;
+            lod->classes[0][b] |= hist_lod_class(gw_hist_iter_get_value(&iter));
+        }
+    }
+
+    for (gint level = 1; level < lod->num_levels; level++) {
+        gint prev_buckets = lod->num_buckets[level - 1];
+        guint8 *prev = lod->classes[level - 1];
+
+        buckets = (prev_buckets + 1) / 2;
+        lod->num_buckets[level] = buckets;
+        lod->classes[level] = g_new(guint8, buckets);
+
+        for (gint b = 0; b < buckets; b++) {
+            guint8 c = prev[2 * b];
+            if (2 * b + 1 < prev_buckets) {
+                c |= prev[2 * b + 1];
+            }
+            lod->classes[level][b] = c;
+        }
+    }
+
+    return lod;
+}
+
+void hist_lod_free(HistLod *lod)
+{
+    if (lod == NULL) {
+        return;
+    }
+
+    for (gint level = 0; level < lod->num_levels; level++) {
+        g_free(lod->classes[level]);
+    }
+    g_free(lod->classes);
+    g_free(lod->num_buckets);
+    g_free(lod->first);
+    g_free(lod);
+}
+
+/*
+ * returns the summary for a node, building it on first use. Nodes with too
+ * few transitions for a summary to pay off return NULL.
+ */
+HistLod *hist_lod_for_node(GwNode *n)
+{
+    if (n->lod == NULL && (n->harray != NULL || n->columns != NULL) &&
+        n->numhist > HIST_LOD_MIN_ENTRIES) {
+        n->lod = hist_lod_new(n);
+    }
+
+    return n->lod;
+}
+
+/*
+ * drop-in replacement for bsearch_node_hint() that narrows the search down to
+ * a single level 0 bucket when a summary is available
+ */
+void hist_lod_bsearch_node(GwNode *n, GwTime key, int *pos, GwHistIter *iter)
+{
+    HistLod *lod = hist_lod_for_node(n);
+
+    if (lod == NULL || key < lod->start) {
+        bsearch_node_hint(n, key, pos, iter);
+        return;
+    }
+
+    gint64 b = (key - lod->start) / lod->width;
+    gint lo, hi;
+
+    if (b >= lod->num_buckets[0] - 1) {
+        lo = lod->first[lod->num_buckets[0] - 1];
+        hi = n->numhist - 1;
+    } else {
+        lo = lod->first[b];
+        hi = lod->first[b + 1];
+    }
+
+    if (n->columns != NULL) {
+        /* the entries of the bucket are decoded from its first one */
+        gw_hist_iter_init_at(iter, n, lo);
+        gw_hist_iter_seek(iter, key);
+        lo = gw_hist_iter_get_index(iter);
+    } else {
+        /* find the last entry with time <= key, harray[lo] always qualifies */
+        while (lo < hi) {
+            gint mid = lo + (hi - lo + 1) / 2;
+
+            if (n->harray[mid]->time <= key) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+
+        gw_hist_iter_init_at(iter, n, lo);
+    }
+
+    if (pos != NULL) {
+        *pos = lo;
+    }
+}
+
+/*
+ * moves iter forward to the last entry with time <= key. Histories without
+ * columns or a harray are walked entry by entry.
+ */
+void hist_lod_seek(GwNode *n, GwHistIter *iter, GwTime key, int *pos)
+{
+    GwHistIter found;
+
+    if (n->columns == NULL && n->harray == NULL) {
+        gw_hist_iter_seek(iter, key);
+        return;
+    }
+
+    hist_lod_bsearch_node(n, key, pos, &found);
+    if (*pos > (int)gw_hist_iter_get_index(iter)) {
+        *iter = found;
+    }
+}
+
+/*
+ * returns the value classes of all transitions in [start, end). The result is
+ * read from the coarsest level whose buckets are at most half the range wide,
+ * so it can include transitions up to half the range outside of it.
+ */
+guint hist_lod_get_classes(HistLod *lod, GwTime start, GwTime end)
+{
+    if (start < lod->start) {
+        start = lod->start;
+    }
+    if (end <= start) {
+        return 0;
+    }
+
+    gint level = 0;
+    while (level + 1 < lod->num_levels && (lod->width << (level + 1)) * 2 <= end - start) {
+        level++;
+    }
+
+    GwTime width = lod->width << level;
+    gint64 first = (start - lod->start) / width;
+    gint64 last = (end - 1 - lod->start) / width;
+    guint classes = 0;
+
+    if (last >= lod->num_buckets[level]) {
+        last = lod->num_buckets[level] - 1;
+    }
+    for (gint64 b = first; b <= last; b++) {
+        classes |= lod->classes[level][b];
+    }
+
+    return classes;
+}
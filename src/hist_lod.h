@@ -0,0 +1,22 @@
+#pragma once
+
+#include <gtkwave.h>
+
+G_BEGIN_DECLS
+
+/* value classes recorded per bucket */
+#define HIST_LOD_CLASS_0 (1 << 0)
+#define HIST_LOD_CLASS_1 (1 << 1)
+#define HIST_LOD_CLASS_X (1 << 2)
+#define HIST_LOD_CLASS_Z (1 << 3)
+
+typedef struct _HistLod HistLod;
+
+HistLod *hist_lod_for_node(GwNode *n);
+void hist_lod_free(HistLod *lod);
+
+void hist_lod_bsearch_node(GwNode *n, GwTime key, int *pos, GwHistIter *iter);
+void hist_lod_seek(GwNode *n, GwHistIter *iter, GwTime key, int *pos);
+guint hist_lod_get_classes(HistLod *lod, GwTime start, GwTime end);
+
+G_END_DECLS
@@ -20,6 +20,10 @@
 #include "symbol.h"
 #include "vcd.h"
 #include "busy.h"
+#include "hist_lod.h"
+#include "currenttime.h"
+#include "timeentry.h"
+#include "signalwindow.h"
 
 // TODO: remove
 static GPtrArray *import_nodes;
@@ -61,3 +65,352 @@ void lx2_import_masked(void)
 
     g_ptr_array_set_size(import_nodes, 0);
 }
+
+static gboolean lx2_window_covers(GwNode *nd, GwTime start, GwTime end)
+{
+    GwTime window_start;
+    GwTime window_end;
+
+    if (!gw_fst_file_get_trace_window(GW_FST_FILE(GLOBALS->dump_file),
+                                      nd,
+                                      &window_start,
+                                      &window_end)) {
+        return TRUE; /* not windowed */
+    }
+
+    return window_start <= start && end <= window_end;
+}
+
+/* per dump file record of when each imported node was last displayed */
+#define LX2_USAGE_KEY "lx2-usage"
+
+typedef struct
+{
+    GHashTable *nodes; /* GwNode* -> Lx2NodeUsage* */
+    guint64 frame;
+} Lx2Usage;
+
+typedef struct
+{
+    guint64 frame;
+} Lx2NodeUsage;
+
+/* the unloadable nodes that share a histent factory, they are dropped together */
+typedef struct
+{
+    GPtrArray *nodes;
+    gsize size;
+    guint64 frame; /* the last time any of the nodes was displayed */
+} Lx2Batch;
+
+static void lx2_usage_free(Lx2Usage *usage)
+{
+    g_hash_table_destroy(usage->nodes);
+    g_free(usage);
+}
+
+static Lx2Usage *lx2_get_usage(void)
+{
+    GObject *dump_file = G_OBJECT(GLOBALS->dump_file);
+    Lx2Usage *usage = g_object_get_data(dump_file, LX2_USAGE_KEY);
+
+    if (usage == NULL) {
+        usage = g_new0(Lx2Usage, 1);
+        usage->nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+        g_object_set_data_full(dump_file, LX2_USAGE_KEY, usage, (GDestroyNotify)lx2_usage_free);
+    }
+
+    return usage;
+}
+
+static Lx2NodeUsage *lx2_get_node_usage(Lx2Usage *usage, GwNode *nd)
+{
+    Lx2NodeUsage *node_usage = g_hash_table_lookup(usage->nodes, nd);
+
+    if (node_usage == NULL) {
+        node_usage = g_new0(Lx2NodeUsage, 1);
+        g_hash_table_insert(usage->nodes, nd, node_usage);
+    }
+
+    return node_usage;
+}
+
+static void lx2_unload_node(GwNode *nd)
+{
+    if (nd->harray) {
+        free_2(nd->harray);
+    }
+    hist_lod_free(nd->lod);
+    nd->lod = NULL;
+    g_clear_pointer(&nd->columns, gw_hist_columns_unref);
+
+    g_hash_table_remove(lx2_get_usage()->nodes, nd);
+    gw_dump_file_unload_trace(GLOBALS->dump_file, nd);
+}
+
+static void lx2_build_harray(GwNode *nd)
+{
+    GwHistEnt *histpnt;
+    int histcount = 0;
+
+    if (nd->columns != NULL) {
+        return; /* compacted histories are read through GwHistIter */
+    }
+
+    for (histpnt = &nd->head; histpnt; histpnt = histpnt->next) {
+        histcount++;
+    }
+
+    nd->numhist = histcount;
+    nd->harray = malloc_2(histcount * sizeof(GwHistEnt *));
+
+    histpnt = &nd->head;
+    for (int i = 0; i < histcount; i++) {
+        nd->harray[i] = histpnt;
+        histpnt = histpnt->next;
+    }
+}
+
+/*
+ * lazy fst import: reimports the displayed traces whose history doesn't
+ * cover the visible time range (and the primary marker), with a margin of
+ * one screen width on either side so that scrolling doesn't refault at once
+ */
+void lx2_import_visible_window(void)
+{
+    if (GLOBALS->is_lx2 != LXT2_IS_FST || !GLOBALS->settings.fst_lazy_import) {
+        return;
+    }
+
+    GwTime start = GLOBALS->tims.start;
+    GwTime end = GLOBALS->tims.end;
+
+    GwMarker *primary_marker = gw_project_get_primary_marker(GLOBALS->project);
+    if (gw_marker_is_enabled(primary_marker)) {
+        GwTime marker = gw_marker_get_position(primary_marker);
+        start = MIN(start, marker);
+        end = MAX(end, marker);
+    }
+
+    GPtrArray *nodes = g_ptr_array_new();
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GwTime min_shift = 0;
+    GwTime max_shift = 0;
+
+    for (GwTrace *t = GLOBALS->traces.first; t; t = t->t_next) {
+        if (t->vector || (t->flags & (TR_BLANK | TR_ANALOG_BLANK_STRETCH))) {
+            continue;
+        }
+
+        GwNode *nd = t->n.nd;
+        if (g_hash_table_contains(seen, nd) ||
+            lx2_window_covers(nd, start - t->shift, end - t->shift)) {
+            continue;
+        }
+
+        g_hash_table_add(seen, nd);
+        g_ptr_array_add(nodes, nd);
+        min_shift = MIN(min_shift, t->shift);
+        max_shift = MAX(max_shift, t->shift);
+    }
+
+    if (nodes->len > 0) {
+        GwTime margin = end - start + 1;
+        GwTimeRange *window =
+            gw_time_range_new(start - max_shift - margin, end - min_shift + margin);
+
+        for (guint i = 0; i < nodes->len; i++) {
+            lx2_unload_node(g_ptr_array_index(nodes, i));
+        }
+
+        gw_fst_file_set_import_window(GW_FST_FILE(GLOBALS->dump_file), window);
+        g_ptr_array_add(nodes, NULL);
+        // TODO: report errors
+        g_assert_true(
+            gw_dump_file_import_traces(GLOBALS->dump_file, (GwNode **)nodes->pdata, NULL));
+
+        for (guint i = 0; nodes->pdata[i] != NULL; i++) {
+            lx2_build_harray(g_ptr_array_index(nodes, i));
+        }
+
+        g_object_unref(window);
+    }
+
+    g_hash_table_destroy(seen);
+    g_ptr_array_free(nodes, TRUE);
+}
+
+static void lx2_touch_traces(Lx2Usage *usage, GwTrace *t)
+{
+    for (; t; t = t->t_next) {
+        if (t->vector) {
+            GwBits *bits = t->n.vec->bits;
+            for (int i = 0; bits && i < bits->nnbits; i++) {
+                lx2_get_node_usage(usage, bits->nodes[i])->frame = usage->frame;
+            }
+        } else if (!(t->flags & (TR_BLANK | TR_ANALOG_BLANK_STRETCH))) {
+            GwNode *nd = t->n.nd;
+            lx2_get_node_usage(usage, nd)->frame = usage->frame;
+            if (nd->expansion) {
+                lx2_get_node_usage(usage, nd->expansion->parent)->frame = usage->frame;
+            }
+        }
+    }
+}
+
+static void lx2_batch_free(Lx2Batch *batch)
+{
+    g_ptr_array_free(batch->nodes, TRUE);
+    g_free(batch);
+}
+
+static gint lx2_compare_last_displayed(gconstpointer a, gconstpointer b)
+{
+    guint64 frame_a = (*(Lx2Batch **)a)->frame;
+    guint64 frame_b = (*(Lx2Batch **)b)->frame;
+
+    return frame_a < frame_b ? -1 : frame_a > frame_b;
+}
+
+/*
+ * drops the least recently displayed traces until the imported traces fit
+ * into the memory budget.  the histents of a trace live in the factory of
+ * the import it came from, which is only freed once all of its traces are
+ * unloaded, so memory is accounted and dropped per factory.  traces that
+ * are still in the trace list or the cut buffer are never dropped, they get
+ * imported again when they are used
+ */
+void lx2_enforce_mem_budget(void)
+{
+    if (!GLOBALS->is_lx2 || GLOBALS->settings.mem_budget == 0) {
+        return;
+    }
+
+    Lx2Usage *usage = lx2_get_usage();
+    usage->frame++;
+    lx2_touch_traces(usage, GLOBALS->traces.first);
+    lx2_touch_traces(usage, GLOBALS->traces.buffer);
+
+    GHashTable *batches = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GPtrArray *order = g_ptr_array_new_with_free_func((GDestroyNotify)lx2_batch_free);
+    GPtrArray *nodes = gw_dump_file_get_unloadable_nodes(GLOBALS->dump_file);
+    gsize total = 0;
+
+    for (guint i = 0; i < nodes->len; i++) {
+        GwNode *nd = g_ptr_array_index(nodes, i);
+        GwHistEntFactory *factory = gw_dump_file_get_trace_factory(GLOBALS->dump_file, nd);
+
+        /* compacted nodes have no factory, aliases that share columns form a batch */
+        gpointer key = factory != NULL ? (gpointer)factory : (gpointer)nd->columns;
+
+        Lx2Batch *batch = key != NULL ? g_hash_table_lookup(batches, key) : NULL;
+        if (batch == NULL) {
+            batch = g_new0(Lx2Batch, 1);
+            batch->nodes = g_ptr_array_new();
+            if (factory != NULL) {
+                batch->size = gw_hist_ent_factory_get_size(factory);
+            } else if (nd->columns != NULL) {
+                batch->size = gw_hist_columns_get_memory_size(nd->columns);
+            }
+            if (key != NULL) {
+                g_hash_table_insert(batches, key, batch);
+            }
+            g_ptr_array_add(order, batch);
+            total += batch->size;
+        }
+
+        g_ptr_array_add(batch->nodes, nd);
+        batch->frame = MAX(batch->frame, lx2_get_node_usage(usage, nd)->frame);
+        if (nd->harray) {
+            batch->size += nd->numhist * sizeof(GwHistEnt *);
+            total += nd->numhist * sizeof(GwHistEnt *);
+        }
+    }
+
+    if (total > GLOBALS->settings.mem_budget) {
+        g_ptr_array_sort(order, lx2_compare_last_displayed);
+
+        for (guint i = 0; i < order->len && total > GLOBALS->settings.mem_budget; i++) {
+            Lx2Batch *batch = g_ptr_array_index(order, i);
+            if (batch->frame == usage->frame) {
+                break; /* everything else is in use */
+            }
+
+            total -= batch->size;
+            for (guint j = 0; j < batch->nodes->len; j++) {
+                lx2_unload_node(g_ptr_array_index(batch->nodes, j));
+            }
+        }
+    }
+
+    g_ptr_array_free(order, TRUE);
+    g_hash_table_destroy(batches);
+    g_ptr_array_free(nodes, TRUE);
+}
+
+/*
+ * vcd follow mode: reads the value changes that were appended to the dump
+ * file since the last call, at most once a second.  the histories of
+ * imported nodes grow in place, so the harrays of the nodes that the update
+ * reports as changed are rebuilt.  vectors that are already displayed keep
+ * the history they were created with.
+ */
+void lx2_follow_dump_file(void)
+{
+    static gint64 last_update = 0;
+
+    if (!GLOBALS->settings.vcd_follow || GLOBALS->dump_file == NULL) {
+        return;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    if (now - last_update < G_USEC_PER_SEC) {
+        return;
+    }
+    last_update = now;
+
+    GwTime old_end = gw_time_range_get_end(gw_dump_file_get_time_range(GLOBALS->dump_file));
+
+    gboolean changed = FALSE;
+    GPtrArray *changed_nodes = NULL;
+    GError *error = NULL;
+    if (!gw_dump_file_update(GLOBALS->dump_file, &changed, &changed_nodes, &error)) {
+        fprintf(stderr, "GTKWAVE | Stopped following the dump file: %s\n", error->message);
+        g_error_free(error);
+        GLOBALS->settings.vcd_follow = FALSE;
+        g_ptr_array_free(changed_nodes, TRUE);
+        return;
+    }
+
+    for (guint i = 0; i < changed_nodes->len; i++) {
+        GwNode *nd = g_ptr_array_index(changed_nodes, i);
+        if (nd->harray == NULL) {
+            continue;
+        }
+
+        free_2(nd->harray);
+        nd->harray = NULL;
+        hist_lod_free(nd->lod);
+        nd->lod = NULL;
+        lx2_build_harray(nd);
+    }
+    g_ptr_array_free(changed_nodes, TRUE);
+
+    if (!changed) {
+        return;
+    }
+
+    GwTime end = gw_time_range_get_end(gw_dump_file_get_time_range(GLOBALS->dump_file));
+
+    // Only grow the fetched range if it reached the end of the file.
+    if (end != old_end && GLOBALS->tims.last == old_end) {
+        char tostr[32];
+        reformat_time(tostr, end, gw_dump_file_get_time_dimension(GLOBALS->dump_file));
+        gtk_entry_set_text(GTK_ENTRY(GLOBALS->to_entry), tostr);
+
+        GLOBALS->tims.last = end;
+        time_update();
+    } else {
+        redraw_signals_and_waves();
+    }
+}
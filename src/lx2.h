@@ -28,5 +28,8 @@ enum LXT2_Loader_Type_Encodings
 void import_lx2_trace(GwNode *np);
 void lx2_set_fac_process_mask(GwNode *np);
 void lx2_import_masked(void);
+void lx2_import_visible_window(void);
+void lx2_enforce_mem_budget(void);
+void lx2_follow_dump_file(void);
 
 #endif
@@ -90,6 +90,13 @@ int f_autocoalesce_reversal(const char *str)
     return (0);
 }
 
+int f_compact_histories(const char *str)
+{
+    DEBUG(printf("f_compact_histories(\"%s\")\n", str));
+    GLOBALS->settings.compact_histories = atoi_64(str) ? 1 : 0;
+    return (0);
+}
+
 int f_constant_marker_update(const char *str)
 {
     DEBUG(printf("f_constant_marker_update(\"%s\")\n", str));
@@ -285,6 +292,13 @@ int f_fontname_waves(const char *str)
     return (0);
 }
 
+int f_fst_lazy_import(const char *str)
+{
+    DEBUG(printf("f_fst_lazy_import(\"%s\")\n", str));
+    GLOBALS->settings.fst_lazy_import = atoi_64(str) ? 1 : 0;
+    return (0);
+}
+
 int f_hier_ignore_escapes(const char *str)
 {
     DEBUG(printf("f_hier_ignore_escapes(\"%s\")\n", str));
@@ -440,6 +454,13 @@ int f_left_justify_sigs(const char *str)
     return (0);
 }
 
+int f_mem_budget(const char *str)
+{
+    DEBUG(printf("f_mem_budget(\"%s\")\n", str));
+    GLOBALS->settings.mem_budget = MAX(atoi_64(str), 0) * 1024 * 1024;
+    return (0);
+}
+
 int f_page_divisor(const char *str)
 {
     DEBUG(printf("f_page_divisor(\"%s\")\n", str));
@@ -594,6 +615,20 @@ int f_ruler_step(const char *str)
     return (0);
 }
 
+int f_vcd_cache(const char *str)
+{
+    DEBUG(printf("f_vcd_cache(\"%s\")\n", str));
+    GLOBALS->settings.vcd_cache = atoi_64(str) ? 1 : 0;
+    return (0);
+}
+
+int f_vcd_follow(const char *str)
+{
+    DEBUG(printf("f_vcd_follow(\"%s\")\n", str));
+    GLOBALS->settings.vcd_follow = atoi_64(str) ? 1 : 0;
+    return (0);
+}
+
 int f_vcd_preserve_glitches(const char *str)
 {
     DEBUG(printf("f_vcd_preserve_glitches(\"%s\")\n", str));
@@ -629,9 +664,13 @@ int f_vector_padding(const char *str)
 int f_vlist_compression(const char *str)
 {
     DEBUG(printf("f_vlist_compression(\"%s\")\n", str));
-    GLOBALS->settings.vlist_compression_level = atoi_64(str);
-    GLOBALS->settings.vlist_compression_level =
-        CLAMP(GLOBALS->settings.vlist_compression_level, -1, 9);
+    if (g_ascii_strcasecmp(str, "lz4") == 0) {
+        GLOBALS->settings.vlist_compression_level = GW_VCD_LOADER_VLIST_COMPRESSION_LZ4;
+    } else {
+        GLOBALS->settings.vlist_compression_level = atoi_64(str);
+        GLOBALS->settings.vlist_compression_level =
+            CLAMP(GLOBALS->settings.vlist_compression_level, -1, 9);
+    }
     return (0);
 }
 
@@ -800,6 +839,7 @@ static struct rc_entry rcitems[] = {{"accel", f_accel},
                                     {"color_white", f_color_white},
                                     {"color_x", f_color_x},
                                     {"color_xfill", f_color_xfill},
+                                    {"compact_histories", f_compact_histories},
                                     {"constant_marker_update", f_constant_marker_update},
                                     {"context_tabposition", f_context_tabposition},
                                     {"convert_to_reals", f_convert_to_reals},
@@ -820,6 +860,7 @@ static struct rc_entry rcitems[] = {{"accel", f_accel},
                                     {"enable_vert_grid", f_enable_vert_grid},
                                     {"fill_waveform", f_fill_waveform},
                                     {"fontname_logfile", f_fontname_logfile},
+                                    {"fst_lazy_import", f_fst_lazy_import},
                                     {"fontname_signals", f_fontname_signals},
                                     {"fontname_waves", f_fontname_waves},
                                     {"hier_delimeter", f_hier_delimeter},
@@ -837,6 +878,7 @@ static struct rc_entry rcitems[] = {{"accel", f_accel},
                                     {"keep_xz_colors", f_keep_xz_colors},
                                     {"left_justify_sigs", f_left_justify_sigs},
                                     {"lz_removal", f_lz_removal},
+                                    {"mem_budget", f_mem_budget},
                                     {"page_divisor", f_page_divisor},
                                     {"ps_maxveclen", f_ps_maxveclen},
                                     {"ruler_origin", f_ruler_origin},
@@ -858,6 +900,8 @@ static struct rc_entry rcitems[] = {{"accel", f_accel},
                                     {"use_nonprop_fonts", f_use_nonprop_fonts},
                                     {"use_pango_fonts", f_use_pango_fonts},
                                     {"use_roundcaps", f_use_roundcaps},
+                                    {"vcd_cache", f_vcd_cache},
+                                    {"vcd_follow", f_vcd_follow},
                                     {"vcd_preserve_glitches", f_vcd_preserve_glitches},
                                     {"vcd_preserve_glitches_real", f_vcd_preserve_glitches_real},
                                     {"vcd_warning_filesize", f_vcd_warning_filesize},
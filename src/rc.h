@@ -67,6 +67,7 @@ int f_color_wfill(const char *str);
 int f_color_white(const char *str);
 int f_color_x(const char *str);
 int f_color_xfill(const char *str);
+int f_compact_histories(const char *str);
 int f_constant_marker_update(const char *str);
 int f_convert_to_reals(const char *str);
 int f_cursor_snap(const char *str);
@@ -83,6 +84,7 @@ int f_fill_waveform(const char *str);
 int f_fontname_logfile(const char *str);
 int f_fontname_signals(const char *str);
 int f_fontname_waves(const char *str);
+int f_fst_lazy_import(const char *str);
 int f_hier_delimeter(const char *str);
 int f_hier_max_level(const char *str);
 int f_ignore_savefile_pos(const char *str);
@@ -93,6 +95,7 @@ int f_initial_window_y(const char *str);
 int f_initial_window_ypos(const char *str);
 int f_left_justify_sigs(const char *str);
 int f_lxt_clock_compress_to_z(const char *str);
+int f_mem_budget(const char *str);
 int f_page_divisor(const char *str);
 int f_ps_maxveclen(const char *str);
 int f_show_base_symbols(const char *str);
@@ -105,6 +108,8 @@ int f_use_full_precision(const char *str);
 int f_use_maxtime_display(const char *str);
 int f_use_nonprop_fonts(const char *str);
 int f_use_roundcaps(const char *str);
+int f_vcd_cache(const char *str);
+int f_vcd_follow(const char *str);
 int f_vcd_preserve_glitches(const char *str);
 int f_vcd_warning_filesize(const char *str);
 int f_vector_padding(const char *str);
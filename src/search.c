@@ -676,14 +676,66 @@ static void ok_callback(GtkWidget *widget, GtkWidget *nothing)
     GLOBALS->is_append_running_search_c_1 = 0;
 }
 
+typedef struct
+{
+    const char *regex;
+    guint generation;
+    gboolean is_ghw;
+} SearchMatchData;
+
+typedef struct
+{
+    guint generation;
+    regex_t preg;
+    gboolean ok;
+} SearchThreadRegex;
+
+static void search_thread_regex_free(gpointer data)
+{
+    SearchThreadRegex *thread_regex = data;
+
+    if (thread_regex->ok) {
+        regfree(&thread_regex->preg);
+    }
+    g_free(thread_regex);
+}
+
+static GPrivate search_thread_regex = G_PRIVATE_INIT(search_thread_regex_free);
+
+/*
+ * called by several threads at once.  regexec() serializes its callers on
+ * the same regex_t, so every thread compiles its own copy of the search
+ * regex, with the same flags as wave_regex_compile().
+ */
+static gboolean search_match_fac(GwSymbol *fac, gpointer user_data)
+{
+    SearchMatchData *data = user_data;
+
+    if (fac->vec_root != NULL && GLOBALS->autocoalesce && fac->vec_root != fac) {
+        return FALSE; /* listed once through its vector root */
+    }
+
+    if (data->is_ghw && strcmp(WAVE_GHW_DUMMYFACNAME, fac->name) == 0) {
+        return FALSE;
+    }
+
+    SearchThreadRegex *thread_regex = g_private_get(&search_thread_regex);
+    if (thread_regex == NULL || thread_regex->generation != data->generation) {
+        thread_regex = g_new0(SearchThreadRegex, 1);
+        thread_regex->generation = data->generation;
+        thread_regex->ok = regcomp(&thread_regex->preg, data->regex, REG_ICASE | REG_NOSUB) == 0;
+        g_private_replace(&search_thread_regex, thread_regex);
+    }
+
+    return thread_regex->ok && regexec(&thread_regex->preg, fac->name, 0, NULL, 0) == 0;
+}
+
 void search_enter_callback(GtkWidget *widget, GtkWidget *do_warning)
 {
     const gchar *entry_text;
     char *entry_suffixed;
     int i;
     char *s, *tmp2;
-    gfloat interval;
-    char *duplicate_row_buffer = NULL;
 
     if (GLOBALS->is_searching_running_search_c_1)
         return;
@@ -722,89 +774,63 @@ void search_enter_callback(GtkWidget *widget, GtkWidget *do_warning)
         set_s_selected(fac, 0);
     }
 
-    GLOBALS->pdata->oldvalue = -1.0;
-    interval = (gfloat)(numfacs / 100.0);
-
-    // TODO: use GString for duplicate_row_buffer
-    duplicate_row_buffer = (char *)calloc_2(1, 65536);
-
-    gtk_list_store_clear(GTK_LIST_STORE(GLOBALS->sig_store_search));
-
-    for (i = 0; i < numfacs; i++) {
-        char *hfacname = NULL;
-        int skiprow;
-
-        GLOBALS->pdata->value = i;
-        if (((int)(GLOBALS->pdata->value / interval)) !=
-            ((int)(GLOBALS->pdata->oldvalue / interval))) {
-            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(GLOBALS->pdata->pbar),
-                                          i / (gfloat)((numfacs > 1) ? numfacs - 1 : 1));
-            gtkwave_main_iteration();
-        }
-        GLOBALS->pdata->oldvalue = i;
-
-        GwSymbol *fac = gw_facs_get(facs, i);
-
-        hfacname = fac->name;
-        if (!strcmp(hfacname, duplicate_row_buffer)) {
-            skiprow = 1;
+    static guint generation = 0;
+    SearchMatchData match_data = {
+        .regex = entry_suffixed,
+        .generation = ++generation,
+        .is_ghw = GW_IS_GHW_FILE(GLOBALS->dump_file),
+    };
+    GPtrArray *matches =
+        gw_facs_find(facs, search_match_fac, &match_data, WAVE_MAX_CLIST_LENGTH);
+
+    /* fill the store while it is detached, the view would update for every row otherwise */
+    GtkListStore *store = g_object_ref(GLOBALS->sig_store_search);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(GLOBALS->sig_view_search), NULL);
+    gtk_list_store_clear(store);
+
+    for (i = 0; i < matches->len; i++) {
+        GwSymbol *fac = g_ptr_array_index(matches, i);
+
+        if (!fac->vec_root) {
+            gtk_list_store_insert_with_values(store,
+                                              NULL,
+                                              -1,
+                                              NAME_COLUMN,
+                                              fac->name,
+                                              PTR_COLUMN,
+                                              fac,
+                                              -1);
         } else {
-            skiprow = 0;
-            strcpy(duplicate_row_buffer, hfacname);
-        }
-
-        if ((!skiprow) && wave_regex_match(hfacname, WAVE_REGEX_SEARCH))
-            if (!GW_IS_GHW_FILE(GLOBALS->dump_file) || (strcmp(WAVE_GHW_DUMMYFACNAME, hfacname))) {
-                GtkTreeIter iter;
-
-                if (!fac->vec_root) {
-                    gtk_list_store_append(GTK_LIST_STORE(GLOBALS->sig_store_search), &iter);
-                    gtk_list_store_set(GTK_LIST_STORE(GLOBALS->sig_store_search),
-                                       &iter,
-                                       NAME_COLUMN,
-                                       hfacname,
-                                       PTR_COLUMN,
-                                       fac,
-                                       -1);
-                } else {
-                    if (GLOBALS->autocoalesce) {
-                        if (fac->vec_root != fac)
-                            continue;
-
-                        tmp2 = makename_chain(fac);
-                        s = (char *)malloc_2(strlen(tmp2) + 4);
-                        strcpy(s, "[] ");
-                        strcpy(s + 3, tmp2);
-                        free_2(tmp2);
-                    } else {
-                        s = (char *)malloc_2(strlen(hfacname) + 4);
-                        strcpy(s, "[] ");
-                        strcpy(s + 3, hfacname);
-                    }
-
-                    gtk_list_store_append(GTK_LIST_STORE(GLOBALS->sig_store_search), &iter);
-                    gtk_list_store_set(GTK_LIST_STORE(GLOBALS->sig_store_search),
-                                       &iter,
-                                       NAME_COLUMN,
-                                       s,
-                                       PTR_COLUMN,
-                                       fac,
-                                       -1);
-                    free_2(s);
-                }
-
-                GLOBALS->num_rows_search_c_2++;
-                if (GLOBALS->num_rows_search_c_2 == WAVE_MAX_CLIST_LENGTH) {
-                    /* if(was_packed) { free_2(hfacname); } ...not needed with HIER_DEPACK_STATIC */
-                    break;
-                }
+            if (GLOBALS->autocoalesce) {
+                tmp2 = makename_chain(fac);
+                s = (char *)malloc_2(strlen(tmp2) + 4);
+                strcpy(s, "[] ");
+                strcpy(s + 3, tmp2);
+                free_2(tmp2);
+            } else {
+                s = (char *)malloc_2(strlen(fac->name) + 4);
+                strcpy(s, "[] ");
+                strcpy(s + 3, fac->name);
             }
+
+            gtk_list_store_insert_with_values(store,
+                                              NULL,
+                                              -1,
+                                              NAME_COLUMN,
+                                              s,
+                                              PTR_COLUMN,
+                                              fac,
+                                              -1);
+            free_2(s);
+        }
     }
 
-    free_2(duplicate_row_buffer);
+    GLOBALS->num_rows_search_c_2 = matches->len;
+    g_ptr_array_free(matches, TRUE);
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(GLOBALS->sig_view_search), GTK_TREE_MODEL(store));
+    g_object_unref(store);
 
-    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(GLOBALS->pdata->pbar), 0.0);
-    GLOBALS->pdata->oldvalue = -1.0;
     wave_gtk_grab_remove(widget);
     GLOBALS->is_searching_running_search_c_1 = 0;
 
@@ -17,6 +17,7 @@
 #include "debug.h"
 #include "signal_list.h"
 #include "gw-wave-view.h"
+#include "lx2.h"
 
 /* GDK_KEY_equal defined from gtk2 2.22 onwards. */
 #ifndef GDK_KEY_equal
@@ -114,6 +115,8 @@ static gboolean mouseover_timer(gpointer dummy)
         return (TRUE);
     }
 
+    lx2_follow_dump_file();
+
     if ((!GLOBALS->signalarea) || (!gtk_widget_get_window(GLOBALS->signalarea))) {
         return (TRUE);
     }
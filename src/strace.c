@@ -574,373 +574,503 @@ void tracesearchbox(const char *title, GCallback func, gpointer data)
 }
 
 /*
- * strace backward or forward..
+ * compiled pattern search: every pattern trace gets a cursor that walks its
+ * history in time order.  the value predicate of a trace is only evaluated
+ * again when that trace changes, instead of looking up and converting every
+ * trace at every time step.
  */
-static void strace_search_2(int direction, int is_last_iteration)
+struct strace_cursor
 {
-    struct strace *s;
-    GwTime basetime, maxbase, sttim, fintim;
+    struct strace *s; /* s->his is the value in effect */
     GwTrace *t;
-    int totaltraces, passcount;
-    int whichpass;
-    GwTime middle = 0, width;
+    GwTime time; /* shifted time of the value in effect */
+    GwTime next_time; /* shifted time of the next change */
+    char has_next;
+    char is_scalar;
+    char counts; /* not don't care */
+    char edge; /* only passes when the trace changes at the search time */
+    char level; /* predicate result for the value in effect */
+    char bit_match[GW_BIT_COUNT]; /* predicate result by value for scalars */
+};
+
+static char strace_bit_match(struct strace *s, GwBit bit)
+{
+    char str[2];
 
-    GwMarker *primary_marker = gw_project_get_primary_marker(GLOBALS->project);
-    if (gw_marker_is_enabled(primary_marker)) {
-        basetime = gw_marker_get_position(primary_marker);
-    } else {
-        if (direction == STRACE_BACKWARD) {
-            basetime = MAX_HISTENT_TIME;
-        } else {
-            basetime = GLOBALS->tims.first;
-        }
+    str[0] = gw_bit_to_char(bit);
+    str[1] = 0x00;
+
+    switch (s->value) {
+        case ST_HIGH:
+        case ST_RISE:
+            return (str[0] == '1' || str[0] == 'h' || str[0] == 'H');
+
+        case ST_LOW:
+        case ST_FALL:
+            return (str[0] == '0' || str[0] == 'l' || str[0] == 'L');
+
+        case ST_MID:
+            return (str[0] == 'z' || str[0] == 'Z');
+
+        case ST_X:
+            return (str[0] == 'x' || str[0] == 'X');
+
+        case ST_ANY:
+            return (1);
+
+        case ST_STRING:
+            return (s->string != NULL && strstr_i(s->string, str) != NULL);
+
+        default:
+            return (0);
     }
+}
 
-    sttim = GLOBALS->tims.first;
-    fintim = GLOBALS->tims.last;
-
-    for (whichpass = 0;; whichpass++) {
-        if (direction == STRACE_BACKWARD) /* backwards */
-        {
-            maxbase = -1;
-            s = GLOBALS->strace_ctx->straces;
-            while (s) {
-                t = s->trace;
-                GLOBALS->shift_timebase = t->shift;
-                if (!(t->vector)) {
-                    GwHistEnt *h;
-                    GwHistEnt **hp;
-                    GwUTime utt;
-                    GwTime tt;
-
-                    /* h= */ bsearch_node(t->n.nd, basetime - t->shift); /* scan-build */
-                    hp = GLOBALS->max_compare_index;
-                    if ((hp == &(t->n.nd->harray[1])) || (hp == &(t->n.nd->harray[0])))
-                        return;
-                    if (basetime == ((*hp)->time + GLOBALS->shift_timebase))
-                        hp--;
-                    h = *hp;
-                    s->his.h = h;
-                    utt = strace_adjust(h->time, GLOBALS->shift_timebase);
-                    tt = utt;
-                    if (tt > maxbase)
-                        maxbase = tt;
-                } else {
-                    GwVectorEnt *v;
-                    GwVectorEnt **vp;
-                    GwUTime utt;
-                    GwTime tt;
-
-                    /* v= */ bsearch_vector(t->n.vec, basetime - t->shift); /* scan-build */
-                    vp = GLOBALS->vmax_compare_index;
-                    if ((vp == &(t->n.vec->vectors[1])) || (vp == &(t->n.vec->vectors[0])))
-                        return;
-                    if (basetime == ((*vp)->time + GLOBALS->shift_timebase))
-                        vp--;
-                    v = *vp;
-                    s->his.v = v;
-                    utt = strace_adjust(v->time, GLOBALS->shift_timebase);
-                    tt = utt;
-                    if (tt > maxbase)
-                        maxbase = tt;
+static char strace_vector_match(struct strace *s, char *chval)
+{
+    char *chval2;
+    char ch;
+
+    if (!chval) {
+        return (0);
+    }
+
+    switch (s->value) {
+        case ST_HIGH:
+            for (chval2 = chval; (ch = *chval2); chval2++) {
+                if ((ch >= '1' && ch <= '9') || ch == 'h' || ch == 'H' || (ch >= 'A' && ch <= 'F')) {
+                    return (1);
                 }
+            }
+            return (0);
 
-                s = s->next;
+        case ST_LOW:
+            for (chval2 = chval; (ch = *chval2); chval2++) {
+                if (ch != '0' && ch != 'l' && ch != 'L') {
+                    return (0);
+                }
             }
-        } else /* go forward */
-        {
-            maxbase = MAX_HISTENT_TIME;
-            s = GLOBALS->strace_ctx->straces;
-            while (s) {
-                t = s->trace;
-                GLOBALS->shift_timebase = t->shift;
-                if (!(t->vector)) {
-                    GwHistEnt *h;
-                    GwUTime utt;
-                    GwTime tt;
-
-                    h = bsearch_node(t->n.nd, basetime - t->shift);
-                    while (h->next && h->time == h->next->time)
-                        h = h->next;
-                    if ((whichpass) || gw_marker_is_enabled(primary_marker))
-                        h = h->next;
-                    if (!h)
-                        return;
-                    s->his.h = h;
-                    utt = strace_adjust(h->time, GLOBALS->shift_timebase);
-                    tt = utt;
-                    if (tt < maxbase)
-                        maxbase = tt;
-                } else {
-                    GwVectorEnt *v;
-                    GwUTime utt;
-                    GwTime tt;
-
-                    v = bsearch_vector(t->n.vec, basetime - t->shift);
-                    while (v->next && v->time == v->next->time)
-                        v = v->next;
-                    if ((whichpass) || gw_marker_is_enabled(primary_marker))
-                        v = v->next;
-                    if (!v)
-                        return;
-                    s->his.v = v;
-                    utt = strace_adjust(v->time, GLOBALS->shift_timebase);
-                    tt = utt;
-                    if (tt < maxbase)
-                        maxbase = tt;
+            return (1);
+
+        case ST_MID:
+            for (chval2 = chval; (ch = *chval2); chval2++) {
+                if (ch != 'z' && ch != 'Z') {
+                    return (0);
                 }
+            }
+            return (1);
 
-                s = s->next;
+        case ST_X:
+            for (chval2 = chval; (ch = *chval2); chval2++) {
+                if (ch != 'x' && ch != 'w' && ch != 'X' && ch != 'W') {
+                    return (0);
+                }
             }
+            return (1);
+
+        case ST_STRING:
+            return (s->string != NULL && strstr_i(chval, s->string) != NULL);
+
+        default:
+            return (0);
+    }
+}
+
+static void strace_cursor_eval(struct strace_cursor *c)
+{
+    struct strace *s = c->s;
+    GwTrace *t = c->t;
+    char *chval, *chval2;
+    char ch;
+
+    if (c->is_scalar) {
+        GwBit h_val = gw_hist_iter_get_value(&s->his.h);
+        if (t->flags & TR_INVERT) {
+            h_val = gw_bit_invert(h_val);
         }
 
-        s = GLOBALS->strace_ctx->straces;
-        totaltraces = 0; /* increment when not don't care */
-        while (s) {
-            char str[2];
-            t = s->trace;
-            s->search_result = 0; /* explicitly must set this */
-            GLOBALS->shift_timebase = t->shift;
+        c->level = c->bit_match[h_val & GW_BIT_MASK];
+        return;
+    }
 
-            if ((!t->vector) && (!(t->n.nd->extvals))) {
-                if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                    s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                    while (s->his.h->next && s->his.h->time == s->his.h->next->time)
-                        s->his.h = s->his.h->next;
-                }
+    switch (s->value) {
+        case ST_HIGH:
+        case ST_LOW:
+        case ST_MID:
+        case ST_X:
+        case ST_STRING:
+            break;
+
+        case ST_ANY:
+            c->level = 1;
+            return;
 
-                GwBit h_val = s->his.h->v.h_val;
-                if (t->flags & TR_INVERT) {
-                    h_val = gw_bit_invert(h_val);
+        default: /* don't care, edges of vectors never pass */
+            c->level = 0;
+            return;
+    }
+
+    GLOBALS->shift_timebase = t->shift;
+    if (t->vector) {
+        chval = convert_ascii(t, s->his.v);
+    } else {
+        unsigned char flags = gw_hist_iter_get_flags(&s->his.h);
+
+        chval = convert_ascii_hist(t, &s->his.h);
+        if ((flags & GW_HIST_ENT_FLAG_REAL) && (flags & GW_HIST_ENT_FLAG_STRING)) {
+            chval2 = chval;
+            while ((ch = *chval2)) { /* toupper() the string */
+                if ((ch >= 'a') && (ch <= 'z')) {
+                    *chval2 = ch - ('a' - 'A');
                 }
+                chval2++;
+            }
+        }
+    }
 
-                str[0] = gw_bit_to_char(h_val);
-                str[1] = 0x00;
+    c->level = strace_vector_match(s, chval);
+    free_2(chval);
+}
 
-                switch (s->value) {
-                    case ST_DC:
-                        break;
+static void strace_cursor_update(struct strace_cursor *c)
+{
+    GwTime time, next_time;
+    int has_next;
 
-                    case ST_HIGH:
-                        totaltraces++;
-                        if (str[0] == '1' || str[0] == 'h' || str[0] == 'H') {
-                            s->search_result = 1;
-                        }
-                        break;
+    if (c->t->vector) {
+        GwVectorEnt *v = c->s->his.v;
+        while (v->next && v->time == v->next->time) {
+            v = v->next;
+        }
+        c->s->his.v = v;
+        time = v->time;
+        has_next = v->next != NULL;
+        next_time = has_next ? v->next->time : 0;
+    } else {
+        GwHistIter *h = &c->s->his.h;
+        time = gw_hist_iter_get_time(h);
+        while (gw_hist_iter_get_next_time(h, &next_time) && next_time == time) {
+            gw_hist_iter_next(h);
+        }
+        has_next = gw_hist_iter_get_next_time(h, &next_time);
+        if (!has_next) {
+            next_time = 0;
+        }
+    }
 
-                    case ST_RISE:
-                        totaltraces++;
-                        if (str[0] == '1' || str[0] == 'h' || str[0] == 'H') {
-                            s->search_result = 1;
-                        }
-                        break;
+    c->time = strace_adjust(time, c->t->shift);
+    c->has_next = has_next;
+    c->next_time = has_next ? strace_adjust(next_time, c->t->shift) : MAX_HISTENT_TIME;
 
-                    case ST_LOW:
-                        totaltraces++;
-                        if (str[0] == '0' || str[0] == 'l' || str[0] == 'L') {
-                            s->search_result = 1;
-                        }
-                        break;
+    strace_cursor_eval(c);
+}
 
-                    case ST_FALL:
-                        totaltraces++;
-                        if (str[0] == '0' || str[0] == 'l' || str[0] == 'L') {
-                            s->search_result = 1;
-                        }
-                        break;
+/* moves the cursor to the value in effect at the given (shifted) time */
+static void strace_cursor_seek(struct strace_cursor *c, GwTime time)
+{
+    GwTrace *t = c->t;
 
-                    case ST_MID:
-                        totaltraces++;
-                        if (str[0] == 'z' || str[0] == 'Z') {
-                            s->search_result = 1;
-                        }
-                        break;
+    if (t->vector) {
+        c->s->his.v = bsearch_vector_hint(t->n.vec, time - t->shift, NULL);
+    } else {
+        bsearch_node_hint(t->n.nd, time - t->shift, NULL, &c->s->his.h);
+    }
 
-                    case ST_X:
-                        totaltraces++;
-                        if (str[0] == 'x' || str[0] == 'X') {
-                            s->search_result = 1;
-                        }
-                        break;
+    strace_cursor_update(c);
+}
 
-                    case ST_ANY:
-                        totaltraces++;
-                        s->search_result = 1;
-                        break;
+static void strace_cursor_advance(struct strace_cursor *c)
+{
+    if (c->t->vector) {
+        c->s->his.v = c->s->his.v->next;
+    } else {
+        gw_hist_iter_next(&c->s->his.h);
+    }
 
-                    case ST_STRING:
-                        totaltraces++;
-                        if (s->string != NULL && strstr_i(s->string, str) != NULL) {
-                            s->search_result = 1;
-                        }
-                        break;
+    strace_cursor_update(c);
+}
 
-                    default:
-                        fprintf(stderr, "Internal error: st_type of %d\n", s->value);
-                        exit(255);
-                }
+/*
+ * compiles the pattern of the current strace context.  with edges the rising,
+ * falling and any edge types only pass at the times the trace changes, as
+ * marking requires.  without them they are level checks, as single searches
+ * have always done.
+ */
+static struct strace_cursor *strace_compile(int edges, int *count)
+{
+    struct strace *s;
+    struct strace_cursor *cursors;
+    int i;
 
-            } else {
-                char *chval, *chval2;
-                char ch;
+    *count = 0;
+    for (s = GLOBALS->strace_ctx->straces; s; s = s->next) {
+        (*count)++;
+    }
 
-                if (t->vector) {
-                    if (strace_adjust(s->his.v->time, GLOBALS->shift_timebase) != maxbase) {
-                        s->his.v = bsearch_vector(t->n.vec, maxbase - t->shift);
-                        while (s->his.v->next && s->his.v->time == s->his.v->next->time) {
-                            s->his.v = s->his.v->next;
-                        }
-                    }
-                    chval = convert_ascii(t, s->his.v);
-                } else {
-                    if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                        s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                        while (s->his.h->next && s->his.h->time == s->his.h->next->time) {
-                            s->his.h = s->his.h->next;
-                        }
-                    }
-                    if (s->his.h->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(s->his.h->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            chval = convert_ascii_real(t, &s->his.h->v.h_double);
-                        } else {
-                            chval = convert_ascii_string((char *)s->his.h->v.h_vector);
-                            chval2 = chval;
-                            while ((ch = *chval2)) { /* toupper() the string */
-                                if ((ch >= 'a') && (ch <= 'z')) {
-                                    *chval2 = ch - ('a' - 'A');
-                                }
-                                chval2++;
-                            }
-                        }
-                    } else {
-                        chval = convert_ascii_vec(t, s->his.h->v.h_vector);
-                    }
-                }
+    cursors = calloc_2(*count ? *count : 1, sizeof(struct strace_cursor));
 
-                switch (s->value) {
-                    case ST_DC:
-                        break;
-
-                    case ST_RISE:
-                    case ST_FALL:
-                        totaltraces++;
-                        break;
-
-                    case ST_HIGH:
-                        totaltraces++;
-                        if ((chval2 = chval))
-                            while ((ch = *(chval2++))) {
-                                if (((ch >= '1') && (ch <= '9')) || (ch == 'h') || (ch == 'H') ||
-                                    ((ch >= 'A') && (ch <= 'F'))) {
-                                    s->search_result = 1;
-                                    break;
-                                }
-                            }
-                        break;
-
-                    case ST_LOW:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if ((ch != '0') && (ch != 'l') && (ch != 'L')) {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_MID:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if ((ch != 'z') && (ch != 'Z')) {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_X:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if ((ch != 'x') && (ch != 'w') && (ch != 'X') && (ch != 'W')) {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_ANY:
-                        totaltraces++;
-                        s->search_result = 1;
-                        break;
-
-                    case ST_STRING:
-                        totaltraces++;
-                        if (s->string)
-                            if (strstr_i(chval, s->string))
-                                s->search_result = 1;
-                        break;
-
-                    default:
-                        fprintf(stderr, "Internal error: st_type of %d\n", s->value);
-                        exit(255);
-                }
+    for (s = GLOBALS->strace_ctx->straces, i = 0; s; s = s->next, i++) {
+        struct strace_cursor *c = &cursors[i];
+        GwTrace *t = s->trace;
 
-                free_2(chval);
+        if ((unsigned char)s->value >= WAVE_STYPE_COUNT) {
+            fprintf(stderr, "Internal error: st_type of %d\n", s->value);
+            exit(255);
+        }
+
+        c->s = s;
+        c->t = t;
+        c->is_scalar = (!t->vector) && (!(t->n.nd->extvals));
+        c->counts = s->value != ST_DC;
+        c->edge = edges && (s->value == ST_RISE || s->value == ST_FALL || s->value == ST_ANY);
+
+        if (c->is_scalar) {
+            int bit;
+            for (bit = 0; bit < GW_BIT_COUNT; bit++) {
+                c->bit_match[bit] = strace_bit_match(s, bit);
             }
-            s = s->next;
         }
+    }
 
-        if ((maxbase < sttim) || (maxbase > fintim))
-            return;
+    return (cursors);
+}
+
+static int strace_logical_match(int totaltraces, int passcount)
+{
+    if (!totaltraces) {
+        return (0);
+    }
+
+    if (GLOBALS->strace_ctx->logical_mutex[0]) { /* and */
+        return (totaltraces == passcount);
+    } else if (GLOBALS->strace_ctx->logical_mutex[1]) { /* or */
+        return (passcount != 0);
+    } else if (GLOBALS->strace_ctx->logical_mutex[2]) { /* xor */
+        return ((passcount & 1) != 0);
+    } else if (GLOBALS->strace_ctx->logical_mutex[3]) { /* nand */
+        return (totaltraces != passcount);
+    } else if (GLOBALS->strace_ctx->logical_mutex[4]) { /* nor */
+        return (passcount == 0);
+    } else if (GLOBALS->strace_ctx->logical_mutex[5]) { /* xnor */
+        return ((passcount & 1) == 0);
+    }
+
+    return (0);
+}
+
+/* checks the pattern against the values the cursors are on */
+static int strace_cursors_match(struct strace_cursor *cursors, int count, GwTime time)
+{
+    int totaltraces = 0; /* increment when not don't care */
+    int passcount = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        struct strace_cursor *c = &cursors[i];
 
-        DEBUG(printf("Maxbase: %" GW_TIME_FORMAT ", total traces: %d\n", maxbase, totaltraces));
-        s = GLOBALS->strace_ctx->straces;
-        passcount = 0;
-        while (s) {
-            DEBUG(printf("\tPass: %d, Name: %s\n", s->search_result, s->trace->name));
-            if (s->search_result)
-                passcount++;
-            s = s->next;
+        c->s->search_result = c->counts && c->level && (!c->edge || c->time == time);
+        if (c->counts) {
+            totaltraces++;
+            passcount += c->s->search_result;
         }
+    }
 
-        if (totaltraces) {
-            if (GLOBALS->strace_ctx->logical_mutex[0]) { /* and */
-                if (totaltraces == passcount)
-                    break;
-            } else if (GLOBALS->strace_ctx->logical_mutex[1]) { /* or */
-                if (passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[2]) { /* xor */
-                if (passcount & 1) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[3]) { /* nand */
-                if (totaltraces != passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[4]) { /* nor */
-                if (!passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[5]) { /* xnor */
-                if (!(passcount & 1)) {
-                    break;
-                }
+    DEBUG(printf("Time: %" GW_TIME_FORMAT ", total traces: %d, passed: %d\n",
+                 time,
+                 totaltraces,
+                 passcount));
+
+    return (strace_logical_match(totaltraces, passcount));
+}
+
+/* steps all cursors to the next change of any trace, fails when a trace has no changes left */
+static int strace_cursors_next(struct strace_cursor *cursors, int count, GwTime *time)
+{
+    GwTime next = MAX_HISTENT_TIME;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (!cursors[i].has_next) {
+            return (0);
+        }
+        if (cursors[i].next_time < next) {
+            next = cursors[i].next_time;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (cursors[i].next_time == next) {
+            strace_cursor_advance(&cursors[i]);
+        }
+    }
+
+    *time = next;
+    return (1);
+}
+
+/*
+ * positions the cursors for a forward search from basetime.  the first time is
+ * the next change after basetime, or the earliest value in effect at basetime.
+ */
+static int strace_cursors_start(struct strace_cursor *cursors,
+                                int count,
+                                GwTime basetime,
+                                int after,
+                                GwTime *time)
+{
+    GwTime first = MAX_HISTENT_TIME;
+    int i;
+
+    if (!count) {
+        return (0);
+    }
+
+    for (i = 0; i < count; i++) {
+        strace_cursor_seek(&cursors[i], basetime);
+    }
+
+    if (after) {
+        return (strace_cursors_next(cursors, count, time));
+    }
+
+    for (i = 0; i < count; i++) {
+        if (cursors[i].time < first) {
+            first = cursors[i].time;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (cursors[i].time > first) {
+            strace_cursor_seek(&cursors[i], first);
+        }
+    }
+
+    *time = first;
+    return (1);
+}
+
+static int strace_search_forward(struct strace_cursor *cursors,
+                                 int count,
+                                 GwTime basetime,
+                                 int after,
+                                 GwTime *found)
+{
+    GwTime sttim = GLOBALS->tims.first;
+    GwTime fintim = GLOBALS->tims.last;
+    GwTime time;
+    int ok;
+
+    for (ok = strace_cursors_start(cursors, count, basetime, after, &time); ok;
+         ok = strace_cursors_next(cursors, count, &time)) {
+        if ((time < sttim) || (time > fintim)) {
+            return (0);
+        }
+
+        if (strace_cursors_match(cursors, count, time)) {
+            *found = time;
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
+static int strace_search_backward(struct strace_cursor *cursors,
+                                  int count,
+                                  GwTime basetime,
+                                  GwTime *found)
+{
+    GwTime maxbase;
+    GwTime sttim = GLOBALS->tims.first;
+    GwTime fintim = GLOBALS->tims.last;
+    int i;
+
+    for (;;) {
+        maxbase = -1;
+        for (i = 0; i < count; i++) {
+            GwTrace *t = cursors[i].t;
+            GwUTime utt;
+            GwTime tt;
+
+            GLOBALS->shift_timebase = t->shift;
+            if (!(t->vector)) {
+                GwHistIter h;
+
+                bsearch_node(t->n.nd, basetime - t->shift, &h);
+                if (GLOBALS->max_compare_index <= 1)
+                    return (0);
+                gw_hist_iter_init_at(&h, t->n.nd, GLOBALS->max_compare_index);
+                if (basetime == (gw_hist_iter_get_time(&h) + GLOBALS->shift_timebase))
+                    gw_hist_iter_prev(&h);
+                utt = strace_adjust(gw_hist_iter_get_time(&h), GLOBALS->shift_timebase);
+            } else {
+                GwVectorEnt **vp;
+
+                /* v= */ bsearch_vector(t->n.vec, basetime - t->shift); /* scan-build */
+                vp = GLOBALS->vmax_compare_index;
+                if ((vp == &(t->n.vec->vectors[1])) || (vp == &(t->n.vec->vectors[0])))
+                    return (0);
+                if (basetime == ((*vp)->time + GLOBALS->shift_timebase))
+                    vp--;
+                utt = strace_adjust((*vp)->time, GLOBALS->shift_timebase);
             }
+
+            tt = utt;
+            if (tt > maxbase)
+                maxbase = tt;
+        }
+
+        for (i = 0; i < count; i++) {
+            strace_cursor_seek(&cursors[i], maxbase);
+        }
+
+        if ((maxbase < sttim) || (maxbase > fintim))
+            return (0);
+
+        if (strace_cursors_match(cursors, count, maxbase)) {
+            *found = maxbase;
+            return (1);
         }
 
         basetime = maxbase;
     }
+}
+
+/*
+ * strace backward or forward..
+ */
+static void strace_search_2(int direction, int is_last_iteration)
+{
+    struct strace_cursor *cursors;
+    int count, found;
+    GwTime basetime, maxbase = 0;
+    GwTime middle = 0, width;
+
+    GwMarker *primary_marker = gw_project_get_primary_marker(GLOBALS->project);
+    if (gw_marker_is_enabled(primary_marker)) {
+        basetime = gw_marker_get_position(primary_marker);
+    } else {
+        if (direction == STRACE_BACKWARD) {
+            basetime = MAX_HISTENT_TIME;
+        } else {
+            basetime = GLOBALS->tims.first;
+        }
+    }
+
+    cursors = strace_compile(0, &count);
+    if (direction == STRACE_BACKWARD) {
+        found = strace_search_backward(cursors, count, basetime, &maxbase);
+    } else {
+        found = strace_search_forward(cursors,
+                                      count,
+                                      basetime,
+                                      gw_marker_is_enabled(primary_marker),
+                                      &maxbase);
+    }
+    free_2(cursors);
+
+    if (!found)
+        return;
 
     // TODO: don't use sentinel values for disabled values
     gw_marker_set_position(primary_marker, maxbase);
@@ -990,335 +1120,15 @@ void strace_search(int direction)
 
 /*********************************************/
 
-/*
- * strace forward to make the timetrace
- */
-GwTime strace_timetrace(GwTime basetime, int notfirst)
-{
-    struct strace *s;
-    GwTime maxbase, fintim;
-    GwTrace *t;
-    int totaltraces, passcount;
-    int whichpass;
-
-    fintim = GLOBALS->tims.last;
-
-    for (whichpass = 0;; whichpass++) {
-        maxbase = MAX_HISTENT_TIME;
-        s = GLOBALS->strace_ctx->straces;
-        while (s) {
-            t = s->trace;
-            GLOBALS->shift_timebase = t->shift;
-            if (!(t->vector)) {
-                GwHistEnt *h;
-                GwUTime utt;
-                GwTime tt;
-
-                h = bsearch_node(t->n.nd, basetime - t->shift);
-                s->his.h = h;
-                while (h->time == h->next->time) {
-                    h = h->next;
-                }
-                if ((whichpass) || (notfirst)) {
-                    h = h->next;
-                }
-                if (h == NULL) {
-                    return MAX_HISTENT_TIME;
-                }
-                utt = strace_adjust(h->time, GLOBALS->shift_timebase);
-                tt = utt;
-                if (tt < maxbase)
-                    maxbase = tt;
-            } else {
-                GwVectorEnt *v;
-                GwUTime utt;
-                GwTime tt;
-
-                v = bsearch_vector(t->n.vec, basetime - t->shift);
-                if ((whichpass) || (notfirst)) {
-                    v = v->next;
-                }
-                if (v == NULL) {
-                    return MAX_HISTENT_TIME;
-                }
-                s->his.v = v;
-                utt = strace_adjust(v->time, GLOBALS->shift_timebase);
-                tt = utt;
-                if (tt < maxbase)
-                    maxbase = tt;
-            }
-
-            s = s->next;
-        }
-
-        s = GLOBALS->strace_ctx->straces;
-        totaltraces = 0; /* increment when not don't care */
-        while (s) {
-            char str[2];
-            t = s->trace;
-            s->search_result = 0; /* explicitly must set this */
-            GLOBALS->shift_timebase = t->shift;
-
-            if ((!t->vector) && (!(t->n.nd->extvals))) {
-                if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                    s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                    while (s->his.h->next && s->his.h->time == s->his.h->next->time) {
-                        s->his.h = s->his.h->next;
-                    }
-                }
-
-                GwBit h_val = s->his.h->v.h_val;
-                if (t->flags & TR_INVERT) {
-                    h_val = gw_bit_invert(h_val);
-                }
-
-                str[0] = gw_bit_to_char(s->his.h->v.h_val);
-                str[1] = 0x00;
-
-                switch (s->value) {
-                    case ST_DC:
-                        break;
-
-                    case ST_HIGH:
-                        totaltraces++;
-                        if (str[0] == '1' || str[0] == 'h' || str[0] == 'H') {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_RISE:
-                        totaltraces++;
-                        if ((str[0] == '1' || str[0] == 'h' || str[0] == 'H') &&
-                            strace_adjust(s->his.h->time, GLOBALS->shift_timebase) == maxbase) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_LOW:
-                        totaltraces++;
-                        if (str[0] == '0' || str[0] == 'l' || str[0] == 'L') {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_FALL:
-                        totaltraces++;
-                        if ((str[0] == '0' || str[0] == 'l' || str[0] == 'L') &&
-                            strace_adjust(s->his.h->time, GLOBALS->shift_timebase) == maxbase) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_MID:
-                        totaltraces++;
-                        if ((str[0] == 'z') || (str[0] == 'Z'))
-                            s->search_result = 1;
-                        break;
-
-                    case ST_X:
-                        totaltraces++;
-                        if (str[0] == 'x' || str[0] == 'X') {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_ANY:
-                        totaltraces++;
-                        if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) == maxbase) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_STRING:
-                        totaltraces++;
-                        if (s->string != NULL && strstr_i(s->string, str) != NULL) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    default:
-                        fprintf(stderr, "Internal error: st_type of %d\n", s->value);
-                        exit(255);
-                }
-
-            } else {
-                char *chval, *chval2;
-                char ch;
-
-                if (t->vector) {
-                    if (strace_adjust(s->his.v->time, GLOBALS->shift_timebase) != maxbase) {
-                        s->his.v = bsearch_vector(t->n.vec, maxbase - t->shift);
-                        while (s->his.v->next && s->his.v->time == s->his.v->next->time) {
-                            s->his.v = s->his.v->next;
-                        }
-                    }
-                    chval = convert_ascii(t, s->his.v);
-                } else {
-                    if (strace_adjust(s->his.h->time, GLOBALS->shift_timebase) != maxbase) {
-                        s->his.h = bsearch_node(t->n.nd, maxbase - t->shift);
-                        while (s->his.h->next && s->his.h->time == s->his.h->next->time) {
-                            s->his.h = s->his.h->next;
-                        }
-                    }
-                    if (s->his.h->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(s->his.h->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            chval = convert_ascii_real(t, &s->his.h->v.h_double);
-                        } else {
-                            chval = convert_ascii_string((char *)s->his.h->v.h_vector);
-                            chval2 = chval;
-                            while ((ch = *chval2)) { /* toupper() the string */
-                                if ((ch >= 'a') && (ch <= 'z')) {
-                                    *chval2 = ch - ('a' - 'A');
-                                }
-                                chval2++;
-                            }
-                        }
-                    } else {
-                        chval = convert_ascii_vec(t, s->his.h->v.h_vector);
-                    }
-                }
-
-                switch (s->value) {
-                    case ST_DC:
-                        break;
-
-                    case ST_RISE:
-                    case ST_FALL:
-                        totaltraces++;
-                        break;
-
-                    case ST_HIGH:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            while ((ch = *(chval2++))) {
-                                if ((ch >= '1' && ch <= '9') || ch == 'h' || ch == 'H' ||
-                                    (ch >= 'A' && ch <= 'F')) {
-                                    s->search_result = 1;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_LOW:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if (ch != '0' && ch != 'l' && ch != 'L') {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_MID:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if (ch != 'z' && ch != 'Z') {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_X:
-                        totaltraces++;
-                        if ((chval2 = chval)) {
-                            s->search_result = 1;
-                            while ((ch = *(chval2++))) {
-                                if (ch != 'x' && ch != 'w' && ch != 'X' && ch != 'W') {
-                                    s->search_result = 0;
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case ST_ANY:
-                        totaltraces++;
-                        if (strace_adjust(s->his.v->time, GLOBALS->shift_timebase) == maxbase) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    case ST_STRING:
-                        totaltraces++;
-                        if (s->string != NULL && strstr_i(chval, s->string) != NULL) {
-                            s->search_result = 1;
-                        }
-                        break;
-
-                    default:
-                        fprintf(stderr, "Internal error: st_type of %d\n", s->value);
-                        exit(255);
-                }
-
-                free_2(chval);
-            }
-            s = s->next;
-        }
-
-        if (maxbase > fintim)
-            return (MAX_HISTENT_TIME);
-
-        DEBUG(printf("Maxbase: %" GW_TIME_FORMAT ", total traces: %d\n", maxbase, totaltraces));
-        s = GLOBALS->strace_ctx->straces;
-        passcount = 0;
-        while (s) {
-            DEBUG(printf("\tPass: %d, Name: %s\n", s->search_result, s->trace->name));
-            if (s->search_result) {
-                passcount++;
-            }
-            s = s->next;
-        }
-
-        if (totaltraces) {
-            if (GLOBALS->strace_ctx->logical_mutex[0]) { /* and */
-                if (totaltraces == passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[1]) { /* or */
-                if (passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[2]) { /* xor */
-                if (passcount & 1) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[3]) { /* nand */
-                if (totaltraces != passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[4]) { /* nor */
-                if (!passcount) {
-                    break;
-                }
-            } else if (GLOBALS->strace_ctx->logical_mutex[5]) { /* xnor */
-                if (!(passcount & 1)) {
-                    break;
-                }
-            }
-        }
-
-        basetime = maxbase;
-    }
-
-    return (maxbase);
-}
-
 void strace_maketimetrace(int mode)
 {
     GwTime basetime = GLOBALS->tims.first;
     GwTime endtime = MAX_HISTENT_TIME;
-    int notfirst = 0;
+    struct strace_cursor *cursors;
+    int count, ok;
+    GwTime time;
     GwTime *t;
     int t_allocated;
-    GwTime orig_basetime;
 
     if (GLOBALS->strace_ctx->timearray) {
         free_2(GLOBALS->strace_ctx->timearray);
@@ -1369,22 +1179,16 @@ void strace_maketimetrace(int mode)
     t_allocated = 1;
     t = malloc_2(sizeof(GwTime) * t_allocated);
 
-    orig_basetime = basetime;
-    while (1) {
-        basetime = strace_timetrace(basetime, notfirst);
-        notfirst = 1;
-
-        if (endtime == MAX_HISTENT_TIME) {
-            if (basetime == MAX_HISTENT_TIME)
-                break;
-        } else {
-            if (basetime > endtime)
-                break; /* formerly was >= which didn't mark the endpoint if true which is incorrect
-                        */
-        } /* i.e., if start is markable, end should be also */
+    /* one sweep over the changes of all pattern traces, in time order */
+    cursors = strace_compile(1, &count);
+    for (ok = strace_cursors_start(cursors, count, basetime, 0, &time); ok;
+         ok = strace_cursors_next(cursors, count, &time)) {
+        /* not >= endtime: if start is markable, end should be also */
+        if ((time > GLOBALS->tims.last) || (time > endtime))
+            break;
 
-        if (basetime >= orig_basetime) {
-            t[GLOBALS->strace_ctx->timearray_size] = basetime;
+        if ((time >= basetime) && strace_cursors_match(cursors, count, time)) {
+            t[GLOBALS->strace_ctx->timearray_size] = time;
             GLOBALS->strace_ctx->timearray_size++;
             if (GLOBALS->strace_ctx->timearray_size == t_allocated) {
                 t_allocated *= 2;
@@ -1392,6 +1196,7 @@ void strace_maketimetrace(int mode)
             }
         }
     }
+    free_2(cursors);
 
     if (GLOBALS->strace_ctx->timearray_size) {
         GLOBALS->strace_ctx->timearray =
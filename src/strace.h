@@ -61,7 +61,7 @@ struct strace
 
     union
     {
-        GwHistEnt *h; /* what makes up this trace */
+        GwHistIter h; /* what makes up this trace */
         GwVectorEnt *v;
     } his;
 };
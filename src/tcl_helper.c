@@ -900,9 +900,11 @@ int process_tcl_list(const char *sl, gboolean prepend)
     int c, i, ii;
     char **list;
     char **s_new_list;
+    char **unescaped_list;
     char **most_recent_lbrack_list;
     char **most_recent_colon_list;
-    int *match_idx_list;
+    GwSymbol **exact_list;
+    GwSymbol **match_list;
     int *match_type_list;
     GwTrace *t = NULL;
     int found = 0;
@@ -910,7 +912,7 @@ int process_tcl_list(const char *sl, gboolean prepend)
     int net_processing_is_off = 0;
     int unesc_len;
     int curr_srch_idx = 0;
-    char *unescaped_str = NULL;
+    char *unescaped_str;
 
     if (!sl) {
         return (0);
@@ -925,7 +927,9 @@ int process_tcl_list(const char *sl, gboolean prepend)
                                              no need for relative processing */
 
     s_new_list = calloc_2(c, sizeof(char *));
-    match_idx_list = calloc_2(c, sizeof(int *));
+    unescaped_list = calloc_2(c, sizeof(char *));
+    exact_list = calloc_2(c, sizeof(GwSymbol *));
+    match_list = calloc_2(c, sizeof(GwSymbol *));
     match_type_list = calloc_2(c, sizeof(int *));
     most_recent_lbrack_list = calloc_2(c, sizeof(char *));
     most_recent_colon_list = calloc_2(c, sizeof(char *));
@@ -933,6 +937,12 @@ int process_tcl_list(const char *sl, gboolean prepend)
     GwFacs *facs = gw_dump_file_get_facs(GLOBALS->dump_file);
     guint numfacs = gw_facs_get_length(facs);
 
+    /* resolve the exact names of all nets in one go, only the others need the scans below */
+    for (ii = 0; ii < c; ii++) {
+        s_new_list[ii] = make_net_name_from_tcl_list(list[ii], &unescaped_list[ii]);
+    }
+    gw_facs_lookup_many(facs, (const gchar *const *)unescaped_list, c, exact_list);
+
     GLOBALS->default_flags = TR_RJUSTIFY;
     GLOBALS->default_fpshift = 0;
 
@@ -940,7 +950,7 @@ int process_tcl_list(const char *sl, gboolean prepend)
         0; /* in case there are shadow traces; in reality this should never happen */
 
     for (ii = 0; ii < c; ii++) {
-        s_new = make_net_name_from_tcl_list(list[ii], &unescaped_str);
+        s_new = s_new_list[ii];
         if (s_new) {
             if (net_processing_is_off)
                 continue;
@@ -1025,7 +1035,6 @@ int process_tcl_list(const char *sl, gboolean prepend)
 
             continue;
         }
-        s_new_list[ii] = s_new;
 
         lbrack_adj = 0;
         most_recent_lbrack_list[ii] = strrchr(s_new, '[');
@@ -1039,6 +1048,14 @@ int process_tcl_list(const char *sl, gboolean prepend)
             most_recent_colon_list[ii] = strchr(most_recent_lbrack_list[ii], ':');
         }
 
+        if (exact_list[ii]) {
+            found++;
+            match_list[ii] = exact_list[ii];
+            match_type_list[ii] = 1; /* match was on normal search */
+            goto import;
+        }
+
+        unescaped_str = unescaped_list[ii];
         unesc_len = strlen(unescaped_str);
         for (i = 0; i < numfacs; i++) {
             char *hfacname = NULL;
@@ -1052,11 +1069,8 @@ int process_tcl_list(const char *sl, gboolean prepend)
                 if ((unesc_len == hfacname_len) ||
                     ((hfacname_len > unesc_len) && (hfacname[unesc_len] == '['))) {
                     found++;
-                    match_idx_list[ii] = curr_srch_idx;
+                    match_list[ii] = fac;
                     match_type_list[ii] = 1; /* match was on normal search */
-                    if (s_new != unescaped_str) {
-                        free_2(unescaped_str);
-                    }
                     goto import;
                 }
             }
@@ -1066,10 +1080,6 @@ int process_tcl_list(const char *sl, gboolean prepend)
                 curr_srch_idx = 0; /* optimization for rtlbrowse as names should be in order */
         }
 
-        if (s_new != unescaped_str) {
-            free_2(unescaped_str);
-        }
-
         entry_suffixed = g_alloca(2 + strlen(s_new) + strlen(this_regex) + 1);
         *entry_suffixed = 0x00;
         strcpy(entry_suffixed, "\\<");
@@ -1086,7 +1096,7 @@ int process_tcl_list(const char *sl, gboolean prepend)
 
             if (wave_regex_match(hfacname, WAVE_REGEX_DND)) {
                 found++;
-                match_idx_list[ii] = i;
+                match_list[ii] = fac;
                 match_type_list[ii] = 1; /* match was on normal search */
                 goto import;
             }
@@ -1111,14 +1121,14 @@ int process_tcl_list(const char *sl, gboolean prepend)
 
                 if (wave_regex_match(hfacname, WAVE_REGEX_DND)) {
                     found++;
-                    match_idx_list[ii] = i;
+                    match_list[ii] = fac;
                     match_type_list[ii] = 2 + lbrack_adj; /* match was on lbrack removal */
                     goto import;
                 }
             }
         }
 
-        import : if (match_type_list[ii]) { GwSymbol *s = gw_facs_get(facs, match_idx_list[ii]);
+        import : if (match_type_list[ii]) { GwSymbol *s = match_list[ii];
         GwSymbol *schain = s->vec_root;
 
         if (GLOBALS->is_lx2) {
@@ -1147,7 +1157,7 @@ GLOBALS->traces.first = GLOBALS->traces.last = NULL;
 
 for (ii = 0; ii < c; ii++) {
     if (match_type_list[ii]) {
-        GwSymbol *s = gw_facs_get(facs, match_idx_list[ii]);
+        GwSymbol *s = match_list[ii];
 
         if ((match_type_list[ii] >= 2) && (s->n->extvals)) {
             GwNode *nexp;
@@ -1244,11 +1254,15 @@ GLOBALS->traces.bufferlast = GLOBALS->tcache_treesearch_gtk2_c_2.bufferlast;
 
 cleanup : for (ii = 0; ii < c; ii++)
 {
+    if (unescaped_list[ii] != s_new_list[ii])
+        free_2(unescaped_list[ii]);
     if (s_new_list[ii])
         free_2(s_new_list[ii]);
 }
 free_2(s_new_list);
-free_2(match_idx_list);
+free_2(unescaped_list);
+free_2(exact_list);
+free_2(match_list);
 free_2(match_type_list);
 free_2(most_recent_colon_list);
 free_2(most_recent_lbrack_list);
@@ -1453,23 +1467,14 @@ static char *give_value_string(GwTrace *t)
                     bsearch_vector(t->n.vec, gw_marker_get_position(primary_marker) - t->shift);
                 rc = convert_ascii(t, v);
             } else {
-                GwHistEnt *h_ptr =
-                    bsearch_node(t->n.nd, gw_marker_get_position(primary_marker) - t->shift);
-                if (h_ptr) {
-                    if (!t->n.nd->extvals) {
-                        rc = (char *)calloc_2(2, 2 * sizeof(char));
-                        rc[0] = gw_bit_to_char(h_ptr->v.h_val);
-                    } else {
-                        if (h_ptr->flags & GW_HIST_ENT_FLAG_REAL) {
-                            if (!(h_ptr->flags & GW_HIST_ENT_FLAG_STRING)) {
-                                rc = convert_ascii_real(t, &h_ptr->v.h_double);
-                            } else {
-                                rc = convert_ascii_string((char *)h_ptr->v.h_vector);
-                            }
-                        } else {
-                            rc = convert_ascii_vec(t, h_ptr->v.h_vector);
-                        }
-                    }
+                GwHistIter h_iter;
+
+                bsearch_node(t->n.nd, gw_marker_get_position(primary_marker) - t->shift, &h_iter);
+                if (!t->n.nd->extvals) {
+                    rc = (char *)calloc_2(2, 2 * sizeof(char));
+                    rc[0] = gw_bit_to_char(gw_hist_iter_get_value(&h_iter));
+                } else {
+                    rc = convert_ascii_hist(t, &h_iter);
                 }
             }
         }
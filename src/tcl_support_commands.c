@@ -305,7 +305,7 @@ GwTrace *Node_to_Trptr(GwNode *nd)
         return (0);
     }
 
-    if (!nd->harray) { /* make quick array lookup for aet display */
+    if (!nd->harray && !nd->columns) { /* make quick array lookup for aet display */
         histpnt = &(nd->head);
         histcount = 0;
 
@@ -459,7 +459,6 @@ llist_p *signal_change_list(char *sig_name,
     llist_p *l0_head = NULL, *l0_tail = NULL, *l1_head = NULL, *l_elem, *lp;
     llist_p *l1_tail = NULL;
     char *s, s1[1024];
-    GwHistEnt *h_ptr;
     GwTrace *t = NULL;
     GwTrace *t_created = NULL;
     if (!sig_name) {
@@ -478,20 +477,20 @@ llist_p *signal_change_list(char *sig_name,
             max_elements++;
         }
         if (!t->vector) {
-            GwHistEnt *h;
-            GwHistEnt *h1;
+            GwHistIter h;
             int len = 0;
             /* scan-build :
             if(t->n.nd->extvals) {
               bw = abs(t->n.nd->msi - t->n.nd->lsi) + 1 ;
             }
             */
-            h = bsearch_node(t->n.nd, tstart - t->shift);
-            for (h1 = h; h1; h1 = h1->next) {
-                if (h1->time <= tend) {
+            /* the list holds the indices of the entries, the histents may be compacted */
+            bsearch_node(t->n.nd, tstart - t->shift, &h);
+            do {
+                if (gw_hist_iter_get_time(&h) <= tend) {
                     if (len++ < max_elements) {
                         llist_u llp;
-                        llp.p = h1;
+                        llp.p = GINT_TO_POINTER(gw_hist_iter_get_index(&h));
                         l_elem = llist_new(llp, LL_VOID_P, -1);
                         l0_head = llist_append(l0_head, l_elem, &l0_tail);
                         if (!l0_tail)
@@ -503,7 +502,7 @@ llist_p *signal_change_list(char *sig_name,
                             if (!l0_head) /* null pointer deref found by scan-build */
                             {
                                 llist_u llp;
-                                llp.p = h1;
+                                llp.p = GINT_TO_POINTER(gw_hist_iter_get_index(&h));
                                 l_elem = llist_new(llp, LL_VOID_P, -1);
                                 l0_head = llist_append(l0_head, l_elem, &l0_tail);
                                 if (!l0_tail)
@@ -512,7 +511,7 @@ llist_p *signal_change_list(char *sig_name,
                             l_elem = l0_head;
                             l0_head = l0_head->next; /* what scan-build flagged as null */
                             l0_head->prev = NULL;
-                            l_elem->u.p = (void *)h1;
+                            l_elem->u.p = GINT_TO_POINTER(gw_hist_iter_get_index(&h));
                             l_elem->next = NULL;
                             l_elem->prev = l0_tail;
                             l0_tail->next = l_elem;
@@ -520,7 +519,7 @@ llist_p *signal_change_list(char *sig_name,
                         }
                     }
                 }
-            }
+            } while (gw_hist_iter_next(&h));
         } else {
             GwVectorEnt *v;
             GwVectorEnt *v1;
@@ -540,14 +539,19 @@ llist_p *signal_change_list(char *sig_name,
         /* now create a linked list of time,value.. */
         while (lp && (nelem++ < max_elements)) {
             llist_u llp;
-            llp.tt = ((t->vector) ? ((GwVectorEnt *)lp->u.p)->time : ((GwHistEnt *)lp->u.p)->time);
+            GwHistIter h_iter;
+            if (!t->vector) {
+                gw_hist_iter_init_at(&h_iter, t->n.nd, GPOINTER_TO_INT(lp->u.p));
+            }
+            llp.tt =
+                ((t->vector) ? ((GwVectorEnt *)lp->u.p)->time : gw_hist_iter_get_time(&h_iter));
             l_elem = llist_new(llp, LL_TIMETYPE, -1);
             l1_head = llist_append(l1_head, l_elem, &l1_tail);
             if (!l1_tail)
                 l1_tail = l1_head;
             if (t->vector == 0) {
                 if (!t->n.nd->extvals) { /* really single bit */
-                    switch (((GwHistEnt *)lp->u.p)->v.h_val) {
+                    switch (gw_hist_iter_get_value(&h_iter)) {
                         case '0':
                         case GW_BIT_0:
                             llp.str = (char *)"0";
@@ -614,16 +618,7 @@ llist_p *signal_change_list(char *sig_name,
                             break; /* ...added for GHW */
                     }
                 } else { /* this is still an array */
-                    h_ptr = (GwHistEnt *)lp->u.p;
-                    if (h_ptr->flags & GW_HIST_ENT_FLAG_REAL) {
-                        if (!(h_ptr->flags & GW_HIST_ENT_FLAG_STRING)) {
-                            s = convert_ascii_real(t, &h_ptr->v.h_double);
-                        } else {
-                            s = convert_ascii_string((char *)h_ptr->v.h_vector);
-                        }
-                    } else {
-                        s = convert_ascii_vec(t, h_ptr->v.h_vector);
-                    }
+                    s = convert_ascii_hist(t, &h_iter);
                     if (s) {
                         sprintf(s1, "%s%s", signal_value_prefix(t->flags), s);
                         llp.str = s1;
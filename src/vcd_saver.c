@@ -126,7 +126,8 @@ struct vcdsav_tree_node
     vcdsav_Tree *left, *right;
     GwNode *item;
     int val;
-    GwHistEnt *hist;
+    GwHistIter hist;
+    int has_hist; /* cleared after the last entry was written */
     int len;
 
     union
@@ -198,11 +199,7 @@ static vcdsav_Tree *vcdsav_splay(void *i, vcdsav_Tree *t)
     return t;
 }
 
-static vcdsav_Tree *vcdsav_insert(void *i,
-                                  vcdsav_Tree *t,
-                                  int val,
-                                  unsigned char flags,
-                                  GwHistEnt *h)
+static vcdsav_Tree *vcdsav_insert(GwNode *i, vcdsav_Tree *t, int val, unsigned char flags)
 {
     /* Insert i into the tree t, unless it's already there.    */
     /* Return a pointer to the resulting tree.                 */
@@ -217,7 +214,8 @@ static vcdsav_Tree *vcdsav_insert(void *i,
     n->item = i;
     n->val = val;
     n->flags = flags;
-    n->hist = h;
+    gw_hist_iter_init(&n->hist, i);
+    n->has_hist = 1;
     if (t == NULL) {
         n->left = n->right = NULL;
         return n;
@@ -245,16 +243,14 @@ static vcdsav_Tree *vcdsav_insert(void *i,
 
 static int hpcmp(vcdsav_Tree *hp1, vcdsav_Tree *hp2)
 {
-    GwHistEnt *n1 = hp1->hist;
-    GwHistEnt *n2 = hp2->hist;
     GwTime t1, t2;
 
-    if (n1)
-        t1 = n1->time;
+    if (hp1->has_hist)
+        t1 = gw_hist_iter_get_time(&hp1->hist);
     else
         t1 = MAX_HISTENT_TIME;
-    if (n2)
-        t2 = n2->time;
+    if (hp2->has_hist)
+        t2 = gw_hist_iter_get_time(&hp2->hist);
     else
         t2 = MAX_HISTENT_TIME;
 
@@ -267,6 +263,16 @@ static int hpcmp(vcdsav_Tree *hp1, vcdsav_Tree *hp2)
     }
 }
 
+/* the flags of the first value change after the initial entries */
+static unsigned char vcdsav_flags(GwNode *n)
+{
+    GwHistIter h;
+
+    gw_hist_iter_init_at(&h, n, 2);
+
+    return (gw_hist_iter_get_index(&h) == 2) ? gw_hist_iter_get_flags(&h) : 0;
+}
+
 static void recurse_build(vcdsav_Tree *vt, vcdsav_Tree ***hp)
 {
     if (vt->left)
@@ -372,14 +378,7 @@ int save_nodes_to_export_generic(FILE *trans_file,
                     n = n->expansion->parent;
                 vt = vcdsav_splay(n, vt);
                 if (!vt || vt->item != n) {
-                    unsigned char flags = 0;
-
-                    if (n->head.next)
-                        if (n->head.next->next) {
-                            flags = n->head.next->next->flags;
-                        }
-
-                    vt = vcdsav_insert(n, vt, ++nodecnt, flags, &n->head);
+                    vt = vcdsav_insert(n, vt, ++nodecnt, vcdsav_flags(n));
                 }
             }
         } else {
@@ -395,14 +394,7 @@ int save_nodes_to_export_generic(FILE *trans_file,
                                 n = n->expansion->parent;
                             vt = vcdsav_splay(n, vt);
                             if (!vt || vt->item != n) {
-                                unsigned char flags = 0;
-
-                                if (n->head.next)
-                                    if (n->head.next->next) {
-                                        flags = n->head.next->next->flags;
-                                    }
-
-                                vt = vcdsav_insert(n, vt, ++nodecnt, flags, &n->head);
+                                vt = vcdsav_insert(n, vt, ++nodecnt, vcdsav_flags(n));
                             }
                         }
                     }
@@ -606,16 +598,19 @@ int save_nodes_to_export_generic(FILE *trans_file,
     GwTimeRange *time_range = gw_dump_file_get_time_range(GLOBALS->dump_file);
 
     for (;;) {
+        GwHistIter *hist;
+
         heapify(0, nodecnt);
 
-        if (!GLOBALS->hp_vcd_saver_c_1[0]->hist)
+        if (!GLOBALS->hp_vcd_saver_c_1[0]->has_hist)
             break;
-        if (GLOBALS->hp_vcd_saver_c_1[0]->hist->time > gw_time_range_get_end(time_range))
+        hist = &GLOBALS->hp_vcd_saver_c_1[0]->hist;
+        if (gw_hist_iter_get_time(hist) > gw_time_range_get_end(time_range))
             break;
 
-        if ((GLOBALS->hp_vcd_saver_c_1[0]->hist->time != prevtime) &&
-            (GLOBALS->hp_vcd_saver_c_1[0]->hist->time >= GW_TIME_CONSTANT(0))) {
-            GwTime tnorm = GLOBALS->hp_vcd_saver_c_1[0]->hist->time;
+        if ((gw_hist_iter_get_time(hist) != prevtime) &&
+            (gw_hist_iter_get_time(hist) >= GW_TIME_CONSTANT(0))) {
+            GwTime tnorm = gw_hist_iter_get_time(hist);
             if (time_scale != 1) {
                 tnorm /= time_scale;
             }
@@ -632,16 +627,18 @@ int save_nodes_to_export_generic(FILE *trans_file,
                 w32redirect_fprintf(is_trans, GLOBALS->f_vcd_saver_c_1, "$dumpvars\n");
                 dumpvars_state = 1;
             }
-            prevtime = GLOBALS->hp_vcd_saver_c_1[0]->hist->time;
+            prevtime = gw_hist_iter_get_time(hist);
         }
 
-        if (GLOBALS->hp_vcd_saver_c_1[0]->hist->time >= GW_TIME_CONSTANT(0)) {
+        if (gw_hist_iter_get_time(hist) >= GW_TIME_CONSTANT(0)) {
             if (GLOBALS->hp_vcd_saver_c_1[0]->flags &
                 (GW_HIST_ENT_FLAG_REAL | GW_HIST_ENT_FLAG_STRING)) {
                 if (GLOBALS->hp_vcd_saver_c_1[0]->flags & GW_HIST_ENT_FLAG_STRING) {
-                    char *vec = GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_vector
-                                    ? GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_vector
-                                    : "UNDEF";
+                    const char *vec = gw_hist_iter_get_string(hist);
+
+                    if (!vec) {
+                        vec = "UNDEF";
+                    }
 
                     int vec_slen = strlen(vec);
                     char *vec_escaped = malloc_2(vec_slen * 4 + 1); /* worst case */
@@ -664,14 +661,7 @@ int save_nodes_to_export_generic(FILE *trans_file,
                     }
                     free_2(vec_escaped);
                 } else {
-                    double *d = &GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_double;
-                    double value;
-
-                    if (!d) {
-                        sscanf("NaN", "%lg", &value);
-                    } else {
-                        value = *d;
-                    }
+                    double value = gw_hist_iter_get_real(hist);
 
                     w32redirect_fprintf(is_trans,
                                         GLOBALS->f_vcd_saver_c_1,
@@ -680,10 +670,9 @@ int save_nodes_to_export_generic(FILE *trans_file,
                                         vcdid(GLOBALS->hp_vcd_saver_c_1[0]->val, export_typ));
                 }
             } else if (GLOBALS->hp_vcd_saver_c_1[0]->len) {
-                if (GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_vector) {
+                if (gw_hist_iter_get_vector(hist, row_data)) {
                     for (i = 0; i < GLOBALS->hp_vcd_saver_c_1[0]->len; i++) {
-                        row_data[i] =
-                            analyzer_demang(0, GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_vector[i]);
+                        row_data[i] = analyzer_demang(0, row_data[i]);
                     }
                 } else {
                     for (i = 0; i < GLOBALS->hp_vcd_saver_c_1[0]->len; i++) {
@@ -701,12 +690,14 @@ int save_nodes_to_export_generic(FILE *trans_file,
                 w32redirect_fprintf(is_trans,
                                     GLOBALS->f_vcd_saver_c_1,
                                     "%c%s\n",
-                                    analyzer_demang(0, GLOBALS->hp_vcd_saver_c_1[0]->hist->v.h_val),
+                                    analyzer_demang(0, gw_hist_iter_get_value(hist)),
                                     vcdid(GLOBALS->hp_vcd_saver_c_1[0]->val, export_typ));
             }
         }
 
-        GLOBALS->hp_vcd_saver_c_1[0]->hist = GLOBALS->hp_vcd_saver_c_1[0]->hist->next;
+        if (!gw_hist_iter_next(hist)) {
+            GLOBALS->hp_vcd_saver_c_1[0]->has_hist = 0;
+        }
     }
 
     if (prevtime < gw_time_range_get_end(time_range)) {
@@ -938,7 +929,7 @@ char *output_hier(int is_trans, const char *name)
 static void write_hptr_trace(GwTrace *t, int *whichptr, GwTime tmin, GwTime tmax)
 {
     GwNode *n = t->n.nd;
-    GwHistEnt **ha = n->harray;
+    GwHistIter h;
     int numhist = n->numhist;
     int i;
     unsigned char h_val = GW_BIT_X;
@@ -947,12 +938,13 @@ static void write_hptr_trace(GwTrace *t, int *whichptr, GwTime tmin, GwTime tmax
     int edges = 0;
 
     first = TRUE;
-    for (i = 0; i < numhist; i++) {
-        if (ha[i]->time < tmin) {
-        } else if (ha[i]->time > tmax) {
+    gw_hist_iter_init(&h, n);
+    for (i = 0; i < numhist; i++, gw_hist_iter_next(&h)) {
+        if (gw_hist_iter_get_time(&h) < tmin) {
+        } else if (gw_hist_iter_get_time(&h) > tmax) {
             break;
         } else {
-            if ((ha[i]->time != tmin) || (!first)) {
+            if ((gw_hist_iter_get_time(&h) != tmin) || (!first)) {
                 edges++;
             }
 
@@ -961,17 +953,20 @@ static void write_hptr_trace(GwTrace *t, int *whichptr, GwTime tmin, GwTime tmax
     }
 
     first = TRUE;
-    for (i = 0; i < numhist; i++) {
-        if (ha[i]->time < tmin) {
-            h_val = invert ? AN_USTR_INV[ha[i]->v.h_val] : AN_USTR[ha[i]->v.h_val];
-        } else if (ha[i]->time > tmax) {
+    gw_hist_iter_init(&h, n);
+    for (i = 0; i < numhist; i++, gw_hist_iter_next(&h)) {
+        if (gw_hist_iter_get_time(&h) < tmin) {
+            h_val = invert ? AN_USTR_INV[gw_hist_iter_get_value(&h)]
+                           : AN_USTR[gw_hist_iter_get_value(&h)];
+        } else if (gw_hist_iter_get_time(&h) > tmax) {
             break;
         } else {
             if (first) {
-                gboolean skip_this = (ha[i]->time == tmin);
+                gboolean skip_this = (gw_hist_iter_get_time(&h) == tmin);
 
                 if (skip_this) {
-                    h_val = invert ? AN_USTR_INV[ha[i]->v.h_val] : AN_USTR[ha[i]->v.h_val];
+                    h_val = invert ? AN_USTR_INV[gw_hist_iter_get_value(&h)]
+                                   : AN_USTR[gw_hist_iter_get_value(&h)];
                 }
 
                 w32redirect_fprintf(0,
@@ -996,11 +991,12 @@ static void write_hptr_trace(GwTrace *t, int *whichptr, GwTime tmin, GwTime tmax
                 }
             }
 
-            h_val = invert ? AN_USTR_INV[ha[i]->v.h_val] : AN_USTR[ha[i]->v.h_val];
+            h_val = invert ? AN_USTR_INV[gw_hist_iter_get_value(&h)]
+                           : AN_USTR[gw_hist_iter_get_value(&h)];
             w32redirect_fprintf(0,
                                 GLOBALS->f_vcd_saver_c_1,
                                 "          Edge:               %" GW_TIME_FORMAT ".0 %c\n",
-                                ha[i]->time,
+                                gw_hist_iter_get_time(&h),
                                 h_val);
         }
     }
@@ -1059,20 +1055,14 @@ static void format_value_string(char *s)
     }
 }
 
-static char *get_hptr_vector_val(GwTrace *t, GwHistEnt *h)
+static char *get_hptr_vector_val(GwTrace *t, const GwHistIter *h)
 {
     char *ascii = NULL;
 
-    if (h->time < GW_TIME_CONSTANT(0)) {
+    if (gw_hist_iter_get_time(h) < GW_TIME_CONSTANT(0)) {
         ascii = strdup_2("X");
-    } else if (h->flags & GW_HIST_ENT_FLAG_REAL) {
-        if (!(h->flags & GW_HIST_ENT_FLAG_STRING)) {
-            ascii = convert_ascii_real(t, &h->v.h_double);
-        } else {
-            ascii = convert_ascii_string((char *)h->v.h_vector);
-        }
     } else {
-        ascii = convert_ascii_vec(t, h->v.h_vector);
+        ascii = convert_ascii_hist(t, h);
     }
 
     format_value_string(ascii);
@@ -1107,7 +1097,7 @@ static int determine_trace_data_type(char *s, int curtype)
 static void write_hptr_trace_vector(GwTrace *t, int *whichptr, GwTime tmin, GwTime tmax)
 {
     GwNode *n = t->n.nd;
-    GwHistEnt **ha = n->harray;
+    GwHistIter h;
     int numhist = n->numhist;
     int i;
     char *h_val = NULL;
@@ -1116,18 +1106,19 @@ static void write_hptr_trace_vector(GwTrace *t, int *whichptr, GwTime tmin, GwTi
     int curtype = VCDSAV_IS_BIN;
 
     first = TRUE;
-    for (i = 0; i < numhist; i++) {
-        if (ha[i]->time < tmin) {
-        } else if (ha[i]->time > tmax) {
+    gw_hist_iter_init(&h, n);
+    for (i = 0; i < numhist; i++, gw_hist_iter_next(&h)) {
+        if (gw_hist_iter_get_time(&h) < tmin) {
+        } else if (gw_hist_iter_get_time(&h) > tmax) {
             break;
         } else {
-            char *s = get_hptr_vector_val(t, ha[i]);
+            char *s = get_hptr_vector_val(t, &h);
             if (s) {
                 curtype = determine_trace_data_type(s, curtype);
                 free_2(s);
             }
 
-            if ((ha[i]->time != tmin) || (!first)) {
+            if ((gw_hist_iter_get_time(&h) != tmin) || (!first)) {
                 edges++;
             }
 
@@ -1136,21 +1127,22 @@ static void write_hptr_trace_vector(GwTrace *t, int *whichptr, GwTime tmin, GwTi
     }
 
     first = TRUE;
-    for (i = 0; i < numhist; i++) {
-        if (ha[i]->time < tmin) {
+    gw_hist_iter_init(&h, n);
+    for (i = 0; i < numhist; i++, gw_hist_iter_next(&h)) {
+        if (gw_hist_iter_get_time(&h) < tmin) {
             if (h_val)
                 free_2(h_val);
-            h_val = get_hptr_vector_val(t, ha[i]);
-        } else if (ha[i]->time > tmax) {
+            h_val = get_hptr_vector_val(t, &h);
+        } else if (gw_hist_iter_get_time(&h) > tmax) {
             break;
         } else {
             if (first) {
-                gboolean skip_this = (ha[i]->time == tmin);
+                gboolean skip_this = (gw_hist_iter_get_time(&h) == tmin);
 
                 if (skip_this) {
                     if (h_val)
                         free_2(h_val);
-                    h_val = get_hptr_vector_val(t, ha[i]);
+                    h_val = get_hptr_vector_val(t, &h);
                 }
 
                 w32redirect_fprintf(0,
@@ -1179,11 +1171,11 @@ static void write_hptr_trace_vector(GwTrace *t, int *whichptr, GwTime tmin, GwTi
 
             if (h_val)
                 free_2(h_val);
-            h_val = get_hptr_vector_val(t, ha[i]);
+            h_val = get_hptr_vector_val(t, &h);
             w32redirect_fprintf(0,
                                 GLOBALS->f_vcd_saver_c_1,
                                 "          Edge:               %" GW_TIME_FORMAT ".0 %s\n",
-                                ha[i]->time,
+                                gw_hist_iter_get_time(&h),
                                 h_val);
         }
     }
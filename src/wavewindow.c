@@ -206,14 +206,13 @@ process_trace:
         lft = v->time;
         rgh = v2->time;
     } else {
-        GwHistEnt *h = bsearch_node(t->n.nd, marker - t->shift);
-        GwHistEnt *h2 = h ? h->next : NULL;
+        GwHistIter h;
 
-        if ((!h) || (!h2))
+        bsearch_node(t->n.nd, marker - t->shift, &h);
+        if (!gw_hist_iter_get_next_time(&h, &rgh))
             goto bot; /* should never happen */
 
-        lft = h->time;
-        rgh = h2->time;
+        lft = gw_hist_iter_get_time(&h);
     }
 
     lftinv = (lft < (GLOBALS->tims.start - t->shift)) || (lft >= (GLOBALS->tims.end - t->shift)) ||
@@ -1962,60 +1961,52 @@ void MaxSignalLength(void)
                     }
                 } else {
                     char *str;
-                    GwHistEnt *h_ptr;
-                    if ((h_ptr = bsearch_node(t->n.nd,
-                                              gw_marker_get_position(primary_marker) - t->shift))) {
-                        if (!t->n.nd->extvals) {
-                            unsigned char h_val = h_ptr->v.h_val;
-
-                            str = (char *)calloc_2(1, 3 * sizeof(char));
-                            str[0] = '=';
-                            if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
-                                h_val = (h_ptr->time >= GLOBALS->tims.first) &&
-                                                ((gw_marker_get_position(primary_marker) -
-                                                  GLOBALS->shift_timebase) == h_ptr->time)
-                                            ? GW_BIT_1
-                                            : GW_BIT_0; /* generate impulse */
-                            }
-
-                            if (t->flags & TR_INVERT) {
-                                h_val = gw_bit_invert(h_val);
-                            }
-
-                            str[1] = gw_bit_to_char(h_val);
-
-                            t->asciivalue = str;
-                            vlen = font_engine_string_measure(GLOBALS->signalfont, str);
-                        } else {
-                            char *str2;
-
-                            if (h_ptr->flags & GW_HIST_ENT_FLAG_REAL) {
-                                if (!(h_ptr->flags & GW_HIST_ENT_FLAG_STRING)) {
-                                    str = convert_ascii_real(t, &h_ptr->v.h_double);
-                                } else {
-                                    str = convert_ascii_string((char *)h_ptr->v.h_vector);
-                                }
-                            } else {
-                                str = convert_ascii_vec(t, h_ptr->v.h_vector);
-                            }
-
-                            if (str) {
-                                str2 = (char *)malloc_2(strlen(str) + 2);
-                                *str2 = '=';
-                                strcpy(str2 + 1, str);
-
-                                free_2(str);
-
-                                vlen = font_engine_string_measure(GLOBALS->signalfont, str2);
-                                t->asciivalue = str2;
-                            } else {
-                                vlen = 0;
-                                t->asciivalue = NULL;
-                            }
+                    GwHistIter h_iter;
+                    GwTime h_time;
+
+                    bsearch_node(t->n.nd,
+                                 gw_marker_get_position(primary_marker) - t->shift,
+                                 &h_iter);
+                    h_time = gw_hist_iter_get_time(&h_iter);
+                    if (!t->n.nd->extvals) {
+                        unsigned char h_val = gw_hist_iter_get_value(&h_iter);
+
+                        str = (char *)calloc_2(1, 3 * sizeof(char));
+                        str[0] = '=';
+                        if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
+                            h_val = (h_time >= GLOBALS->tims.first) &&
+                                            ((gw_marker_get_position(primary_marker) -
+                                              GLOBALS->shift_timebase) == h_time)
+                                        ? GW_BIT_1
+                                        : GW_BIT_0; /* generate impulse */
                         }
+
+                        if (t->flags & TR_INVERT) {
+                            h_val = gw_bit_invert(h_val);
+                        }
+
+                        str[1] = gw_bit_to_char(h_val);
+
+                        t->asciivalue = str;
+                        vlen = font_engine_string_measure(GLOBALS->signalfont, str);
                     } else {
-                        vlen = 0;
-                        t->asciivalue = NULL;
+                        char *str2;
+
+                        str = convert_ascii_hist(t, &h_iter);
+
+                        if (str) {
+                            str2 = (char *)malloc_2(strlen(str) + 2);
+                            *str2 = '=';
+                            strcpy(str2 + 1, str);
+
+                            free_2(str);
+
+                            vlen = font_engine_string_measure(GLOBALS->signalfont, str2);
+                            t->asciivalue = str2;
+                        } else {
+                            vlen = 0;
+                            t->asciivalue = NULL;
+                        }
                     }
                 }
 
@@ -2192,54 +2183,45 @@ void UpdateSigValue(GwTrace *t)
                 }
             } else {
                 char *str;
-                GwHistEnt *h_ptr;
-                if ((h_ptr = bsearch_node(t->n.nd,
-                                          gw_marker_get_position(primary_marker) - t->shift))) {
-                    if (!t->n.nd->extvals) {
-                        unsigned char h_val = h_ptr->v.h_val;
-                        if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
-                            h_val = (h_ptr->time >= GLOBALS->tims.first) &&
-                                            ((gw_marker_get_position(primary_marker) -
-                                              GLOBALS->shift_timebase) == h_ptr->time)
-                                        ? GW_BIT_1
-                                        : GW_BIT_0; /* generate impulse */
-                        }
+                GwHistIter h_iter;
+                GwTime h_time;
+
+                bsearch_node(t->n.nd, gw_marker_get_position(primary_marker) - t->shift, &h_iter);
+                h_time = gw_hist_iter_get_time(&h_iter);
+                if (!t->n.nd->extvals) {
+                    unsigned char h_val = gw_hist_iter_get_value(&h_iter);
+                    if (t->n.nd->vartype == GW_VAR_TYPE_VCD_EVENT) {
+                        h_val = (h_time >= GLOBALS->tims.first) &&
+                                        ((gw_marker_get_position(primary_marker) -
+                                          GLOBALS->shift_timebase) == h_time)
+                                    ? GW_BIT_1
+                                    : GW_BIT_0; /* generate impulse */
+                    }
 
-                        if (t->flags & TR_INVERT) {
-                            h_val = gw_bit_invert(h_val);
-                        }
+                    if (t->flags & TR_INVERT) {
+                        h_val = gw_bit_invert(h_val);
+                    }
 
-                        str = (char *)calloc_2(1, 3 * sizeof(char));
-                        str[0] = '=';
-                        str[1] = gw_bit_to_char(h_val);
+                    str = (char *)calloc_2(1, 3 * sizeof(char));
+                    str[0] = '=';
+                    str[1] = gw_bit_to_char(h_val);
 
-                        t->asciivalue = str;
-                    } else {
-                        char *str2;
+                    t->asciivalue = str;
+                } else {
+                    char *str2;
 
-                        if (h_ptr->flags & GW_HIST_ENT_FLAG_REAL) {
-                            if (!(h_ptr->flags & GW_HIST_ENT_FLAG_STRING)) {
-                                str = convert_ascii_real(t, &h_ptr->v.h_double);
-                            } else {
-                                str = convert_ascii_string((char *)h_ptr->v.h_vector);
-                            }
-                        } else {
-                            str = convert_ascii_vec(t, h_ptr->v.h_vector);
-                        }
+                    str = convert_ascii_hist(t, &h_iter);
 
-                        if (str) {
-                            str2 = (char *)malloc_2(strlen(str) + 2);
-                            *str2 = '=';
-                            strcpy(str2 + 1, str);
-                            free_2(str);
+                    if (str) {
+                        str2 = (char *)malloc_2(strlen(str) + 2);
+                        *str2 = '=';
+                        strcpy(str2 + 1, str);
+                        free_2(str);
 
-                            t->asciivalue = str2;
-                        } else {
-                            t->asciivalue = NULL;
-                        }
+                        t->asciivalue = str2;
+                    } else {
+                        t->asciivalue = NULL;
                     }
-                } else {
-                    t->asciivalue = NULL;
                 }
             }
         }